@@ -66,6 +66,9 @@ using DistGraphPtr =
  * this argument assigns a weight to give each node.
  * @param edgeWeight When using a read policy that involves nodes and edges,
  * this argument assigns a weight to give each edge.
+ * @param streamBatchEdges If nonzero, policies that send edges stream the
+ * graph from disk in blocks of at most this many edges instead of reading
+ * the whole range up front; 0 disables streaming
  *
  * @tparam PartitionPolicy Partitioning policy object that specifies the
  * placement of nodes/edges during partitioning.
@@ -89,7 +92,8 @@ cuspPartitionGraph(std::string graphFile, CUSP_GRAPH_TYPE inputType,
                    uint32_t cuspStateRounds = 100,
                    galois::graphs::MASTERS_DISTRIBUTION readPolicy =
                        galois::graphs::BALANCED_EDGES_OF_MASTERS,
-                   uint32_t nodeWeight = 0, uint32_t edgeWeight = 0) {
+                   uint32_t nodeWeight = 0, uint32_t edgeWeight = 0,
+                   uint64_t streamBatchEdges = 0) {
   auto& net = galois::runtime::getSystemNetworkInterface();
   using DistGraphConstructor =
       galois::graphs::NewDistGraphGeneric<NodeData, EdgeData, PartitionPolicy>;
@@ -127,13 +131,15 @@ cuspPartitionGraph(std::string graphFile, CUSP_GRAPH_TYPE inputType,
 
     return std::make_unique<DistGraphConstructor>(
         inputToUse, net.ID, net.Num, cuspAsync, cuspStateRounds, useTranspose,
-        readPolicy, nodeWeight, edgeWeight, masterBlockFile);
+        readPolicy, nodeWeight, edgeWeight, masterBlockFile, false,
+        "local_graph", 1, streamBatchEdges);
   } else {
     // symmetric graph path: assume the passed in graphFile is a symmetric
     // graph; output is also symmetric
     return std::make_unique<DistGraphConstructor>(
         graphFile, net.ID, net.Num, cuspAsync, cuspStateRounds, false,
-        readPolicy, nodeWeight, edgeWeight, masterBlockFile);
+        readPolicy, nodeWeight, edgeWeight, masterBlockFile, false,
+        "local_graph", 1, streamBatchEdges);
   }
 }
 } // end namespace galois
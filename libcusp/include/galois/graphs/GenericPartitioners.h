@@ -7,6 +7,11 @@
 #include <cmath>
 #include <limits>
 
+//! Number of grid columns used by GenericCVC and GenericCVCColumnFlip; 0 (the
+//! default) picks the most square grid with at least as many rows as columns.
+//! Must divide the number of hosts.
+inline unsigned cartesianColumnHosts = 0;
+
 class NoCommunication : public galois::graphs::ReadMasterAssignment {
 public:
   NoCommunication(uint32_t, uint32_t numHosts, uint64_t, uint64_t)
@@ -69,13 +74,19 @@ class GenericCVC : public galois::graphs::ReadMasterAssignment {
   unsigned _h_offset;
 
   void factorizeHosts() {
-    numColumnHosts = sqrt(_numHosts);
+    if (cartesianColumnHosts) {
+      GALOIS_ASSERT((_numHosts % cartesianColumnHosts) == 0,
+                    "cartesian grid columns must divide the number of hosts");
+      numColumnHosts = cartesianColumnHosts;
+    } else {
+      numColumnHosts = sqrt(_numHosts);
 
-    while ((_numHosts % numColumnHosts) != 0)
-      numColumnHosts--;
+      while ((_numHosts % numColumnHosts) != 0)
+        numColumnHosts--;
+    }
 
     numRowHosts = _numHosts / numColumnHosts;
-    assert(numRowHosts >= numColumnHosts);
+    assert(cartesianColumnHosts || numRowHosts >= numColumnHosts);
 
     // if (moreColumnHosts) {
     //  std::swap(numRowHosts, numColumnHosts);
@@ -145,13 +156,20 @@ class GenericCVCColumnFlip : public galois::graphs::ReadMasterAssignment {
   unsigned _h_offset;
 
   void factorizeHosts() {
-    numColumnHosts = sqrt(_numHosts);
+    if (cartesianColumnHosts) {
+      GALOIS_ASSERT((_numHosts % cartesianColumnHosts) == 0,
+                    "cartesian grid columns must divide the number of hosts");
+      // rows before the flip become the columns
+      numColumnHosts = _numHosts / cartesianColumnHosts;
+    } else {
+      numColumnHosts = sqrt(_numHosts);
 
-    while ((_numHosts % numColumnHosts) != 0)
-      numColumnHosts--;
+      while ((_numHosts % numColumnHosts) != 0)
+        numColumnHosts--;
+    }
 
     numRowHosts = _numHosts / numColumnHosts;
-    assert(numRowHosts >= numColumnHosts);
+    assert(cartesianColumnHosts || numRowHosts >= numColumnHosts);
 
     // column flip
     std::swap(numRowHosts, numColumnHosts);
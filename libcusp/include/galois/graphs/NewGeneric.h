@@ -31,6 +31,7 @@
 #include "galois/DReducible.h"
 #include <optional>
 #include <sstream>
+#include <thread>
 
 #define CUSP_PT_TIMER 0
 
@@ -55,6 +56,14 @@ class NewDistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
   std::vector<galois::DGAccumulator<uint64_t>> hostLoads;
   std::vector<uint64_t> old_hostLoads;
 
+  //! Graph file re-read block by block in streaming mode
+  std::string streamFile;
+  //! (node, edge) boundaries of the streamed blocks of this host's read range;
+  //! empty when streaming is off
+  std::vector<std::pair<uint64_t, uint64_t>> streamBlocks;
+  //! bytes read by streamed blocks so far
+  uint64_t streamBytesRead = 0;
+
   uint32_t G2LEdgeCut(uint64_t gid, uint32_t globalOffset) const {
     assert(base_DistGraph::isLocal(gid));
     // optimized for edge cuts
@@ -152,6 +161,100 @@ public:
     }
   }
 
+  /**
+   * Splits this host's read range into blocks of at most batchEdges edges
+   * (and at most batchEdges nodes) for streaming edge assignment.
+   *
+   * @param g Offline view of the graph file, used to find edge offsets
+   * @param nodeBegin First node read by this host
+   * @param nodeEnd One past the last node read by this host
+   * @param batchEdges Maximum number of edges per block
+   */
+  void setupStreamBlocks(galois::graphs::OfflineGraph& g, uint64_t nodeBegin,
+                         uint64_t nodeEnd, uint64_t batchEdges) {
+    streamBlocks.clear();
+    streamBlocks.emplace_back(nodeBegin, *g.edge_begin(nodeBegin));
+    uint64_t cur = nodeBegin;
+    while (cur < nodeEnd) {
+      uint64_t firstEdge = *g.edge_begin(cur);
+      // largest end such that the block stays within batchEdges edges; a
+      // single node with more edges than that gets a block of its own
+      uint64_t lo = cur + 1;
+      uint64_t hi = std::min(nodeEnd, cur + batchEdges);
+      while (lo < hi) {
+        uint64_t mid = lo + (hi - lo + 1) / 2;
+        if (*g.edge_begin(mid) - firstEdge <= batchEdges) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      cur = lo;
+      streamBlocks.emplace_back(cur, *g.edge_begin(cur));
+    }
+  }
+
+  /**
+   * Runs fn(graph, beginNode, endNode) over this host's read range.
+   *
+   * Without streaming, graph is the fully loaded bufGraph and the range is
+   * split into edge state rounds. With streaming, each block is loaded into
+   * its own buffered graph; the next block is read on a separate thread
+   * while fn works on the current one, so at most two blocks are in memory
+   * and the network is kept busy during reads.
+   */
+  template <typename FnTy>
+  void forEachReadBlock(galois::graphs::BufferedGraph<EdgeTy>& bufGraph,
+                        FnTy&& fn) {
+    if (streamBlocks.empty()) {
+      for (unsigned syncRound = 0; syncRound < _edgeStateRounds;
+           syncRound++) {
+        uint64_t beginNode;
+        uint64_t endNode;
+        std::tie(beginNode, endNode) = galois::block_range(
+            base_DistGraph::gid2host[base_DistGraph::id].first,
+            base_DistGraph::gid2host[base_DistGraph::id].second, syncRound,
+            _edgeStateRounds);
+        fn(bufGraph, beginNode, endNode);
+        syncEdgeLoad();
+      }
+      return;
+    }
+
+    // two buffered graphs are reused for all blocks: per-thread read counters
+    // cannot be allocated per block
+    galois::graphs::BufferedGraph<EdgeTy> blocks[2];
+    auto loadBlock = [&](size_t i) {
+      blocks[i % 2].loadPartialGraph(
+          streamFile, streamBlocks[i].first, streamBlocks[i + 1].first,
+          streamBlocks[i].second, streamBlocks[i + 1].second,
+          base_DistGraph::numGlobalNodes, base_DistGraph::numGlobalEdges);
+    };
+
+    size_t numBlocks = streamBlocks.size() - 1;
+    loadBlock(0);
+    for (size_t i = 0; i < numBlocks; i++) {
+      std::thread reader;
+      if (i + 1 < numBlocks) {
+        blocks[(i + 1) % 2].resetAndFree();
+        reader = std::thread(loadBlock, i + 1);
+      }
+      fn(blocks[i % 2], streamBlocks[i].first, streamBlocks[i + 1].first);
+      if (reader.joinable()) {
+        reader.join();
+      }
+      streamBytesRead += blocks[i % 2].getBytesRead();
+    }
+  }
+
+  //! @returns bytes read from disk by bufGraph or by streamed blocks
+  uint64_t
+  readBlockBytes(galois::graphs::BufferedGraph<EdgeTy>& bufGraph) {
+    uint64_t bytes  = bufGraph.getBytesRead() + streamBytesRead;
+    streamBytesRead = 0;
+    return bytes;
+  }
+
   /**
    * Constructor
    */
@@ -162,7 +265,7 @@ public:
       uint32_t nodeWeight = 0, uint32_t edgeWeight = 0,
       std::string masterBlockFile = "", bool readFromFile = false,
       std::string localGraphFileName = "local_graph",
-      uint32_t edgeStateRounds       = 1)
+      uint32_t edgeStateRounds = 1, uint64_t streamBatchEdges = 0)
       : base_DistGraph(host, _numHosts), _edgeStateRounds(edgeStateRounds) {
     galois::runtime::reportParam("dGraph", "GenericPartitioner", "0");
     galois::CondStatTimer<MORE_DIST_STATS> Tgraph_construct(
@@ -222,16 +325,36 @@ public:
 
     // phase 0
 
-    galois::gPrint("[", base_DistGraph::id, "] Starting graph reading.\n");
+    // streaming needs the whole read range only for master assignment and
+    // has nothing to overlap with for edge cuts
+    bool streaming = streamBatchEdges && nodeBegin < nodeEnd &&
+                     !graphPartitioner->masterAssignPhase() &&
+                     !graphPartitioner->noCommunication();
+    if (streaming && _edgeStateRounds > 1) {
+      galois::gWarn("Streaming edge assignment ignored: it requires a single "
+                    "edge state round");
+      streaming = false;
+    }
+
     galois::graphs::BufferedGraph<EdgeTy> bufGraph;
     bufGraph.resetReadCounters();
-    galois::StatTimer graphReadTimer("GraphReading", GRNAME);
-    graphReadTimer.start();
-    bufGraph.loadPartialGraph(filename, nodeBegin, nodeEnd, *edgeBegin,
-                              *edgeEnd, base_DistGraph::numGlobalNodes,
-                              base_DistGraph::numGlobalEdges);
-    graphReadTimer.stop();
-    galois::gPrint("[", base_DistGraph::id, "] Reading graph complete.\n");
+    if (streaming) {
+      streamFile = filename;
+      setupStreamBlocks(g, nodeBegin, nodeEnd, streamBatchEdges);
+      galois::runtime::reportStat_Single(GRNAME, "StreamedBlocks",
+                                         streamBlocks.size() - 1);
+      galois::gPrint("[", base_DistGraph::id, "] Streaming graph in ",
+                     streamBlocks.size() - 1, " blocks.\n");
+    } else {
+      galois::gPrint("[", base_DistGraph::id, "] Starting graph reading.\n");
+      galois::StatTimer graphReadTimer("GraphReading", GRNAME);
+      graphReadTimer.start();
+      bufGraph.loadPartialGraph(filename, nodeBegin, nodeEnd, *edgeBegin,
+                                *edgeEnd, base_DistGraph::numGlobalNodes,
+                                base_DistGraph::numGlobalEdges);
+      graphReadTimer.stop();
+      galois::gPrint("[", base_DistGraph::id, "] Reading graph complete.\n");
+    }
 
     if (graphPartitioner->masterAssignPhase()) {
       // loop over all nodes, determine where neighbors are, assign masters
@@ -1723,7 +1846,7 @@ private:
 
     inspectionTimer.stop();
     // report edge inspection time
-    uint64_t allBytesRead = bufGraph.getBytesRead();
+    uint64_t allBytesRead = readBlockBytes(bufGraph);
     galois::gPrint(
         "[", base_DistGraph::id,
         "] Edge inspection time: ", inspectionTimer.get_usec() / 1000000.0f,
@@ -1773,24 +1896,21 @@ private:
     uint64_t globalOffset = base_DistGraph::gid2host[base_DistGraph::id].first;
     uint32_t globalNodes  = base_DistGraph::numGlobalNodes;
 
-    for (unsigned syncRound = 0; syncRound < _edgeStateRounds; syncRound++) {
-      uint32_t beginNode;
-      uint32_t endNode;
-      std::tie(beginNode, endNode) = galois::block_range(
-          globalOffset, base_DistGraph::gid2host[base_DistGraph::id].second,
-          syncRound, _edgeStateRounds);
+    forEachReadBlock(bufGraph, [&](galois::graphs::BufferedGraph<EdgeTy>&
+                                       blockGraph,
+                                   uint64_t beginNode, uint64_t endNode) {
       // TODO maybe edge range this?
 
       galois::do_all(
           // iterate over my read nodes
           galois::iterate(beginNode, endNode),
           [&](size_t src) {
-            auto ee            = bufGraph.edgeBegin(src);
-            auto ee_end        = bufGraph.edgeEnd(src);
+            auto ee            = blockGraph.edgeBegin(src);
+            auto ee_end        = blockGraph.edgeEnd(src);
             uint64_t numEdgesL = std::distance(ee, ee_end);
 
             for (; ee != ee_end; ee++) {
-              uint32_t dst         = bufGraph.edgeDestination(*ee);
+              uint32_t dst         = blockGraph.edgeDestination(*ee);
               uint32_t hostBelongs = -1;
               hostBelongs = graphPartitioner->getEdgeOwner(src, dst, numEdgesL);
               if (_edgeStateRounds > 1) {
@@ -1830,8 +1950,7 @@ private:
           galois::loopname("AssignEdges"),
 #endif
           galois::steal(), galois::no_stats());
-      syncEdgeLoad();
-    }
+    });
   }
 
   /**
@@ -2593,7 +2712,7 @@ private:
 
     // sends data
     sendEdges(graph, bufGraph, receivedNodes);
-    uint64_t bufBytesRead = bufGraph.getBytesRead();
+    uint64_t bufBytesRead = readBlockBytes(bufGraph);
     // get data from graph back (don't need it after sending things out)
     bufGraph.resetAndFree();
 
@@ -2640,14 +2759,9 @@ private:
     bytesSent.reset();
     maxBytesSent.reset();
 
-    for (unsigned syncRound = 0; syncRound < _edgeStateRounds; syncRound++) {
-      uint32_t beginNode;
-      uint32_t endNode;
-      std::tie(beginNode, endNode) = galois::block_range(
-          base_DistGraph::gid2host[base_DistGraph::id].first,
-          base_DistGraph::gid2host[base_DistGraph::id].second, syncRound,
-          _edgeStateRounds);
-
+    forEachReadBlock(bufGraph, [&](galois::graphs::BufferedGraph<EdgeTy>&
+                                       blockGraph,
+                                   uint64_t beginNode, uint64_t endNode) {
       // Go over assigned nodes and distribute edges.
       galois::do_all(
           galois::iterate(beginNode, endNode),
@@ -2660,8 +2774,8 @@ private:
                   *graph.edge_begin(lsrc, galois::MethodFlag::UNPROTECTED);
             }
 
-            auto ee            = bufGraph.edgeBegin(src);
-            auto ee_end        = bufGraph.edgeEnd(src);
+            auto ee            = blockGraph.edgeBegin(src);
+            auto ee_end        = blockGraph.edgeEnd(src);
             uint64_t numEdgesL = std::distance(ee, ee_end);
             auto& gdst_vec     = *gdst_vecs.getLocal();
             auto& gdata_vec    = *gdata_vecs.getLocal();
@@ -2674,8 +2788,8 @@ private:
             }
 
             for (; ee != ee_end; ++ee) {
-              uint32_t gdst = bufGraph.edgeDestination(*ee);
-              auto gdata    = bufGraph.edgeData(*ee);
+              uint32_t gdst = blockGraph.edgeDestination(*ee);
+              auto gdata    = blockGraph.edgeData(*ee);
 
               uint32_t hostBelongs =
                   graphPartitioner->getEdgeOwner(src, gdst, numEdgesL);
@@ -2735,9 +2849,8 @@ private:
           galois::loopname("EdgeLoadingLoop"),
 #endif
           galois::steal(), galois::no_stats());
-      syncEdgeLoad();
       // printEdgeLoad();
-    }
+    });
 
     // flush buffers
     for (unsigned threadNum = 0; threadNum < sendBuffers.size(); ++threadNum) {
@@ -2793,14 +2906,9 @@ private:
     bytesSent.reset();
     maxBytesSent.reset();
 
-    for (unsigned syncRound = 0; syncRound < _edgeStateRounds; syncRound++) {
-      uint64_t beginNode;
-      uint64_t endNode;
-      std::tie(beginNode, endNode) = galois::block_range(
-          base_DistGraph::gid2host[base_DistGraph::id].first,
-          base_DistGraph::gid2host[base_DistGraph::id].second, syncRound,
-          _edgeStateRounds);
-
+    forEachReadBlock(bufGraph, [&](galois::graphs::BufferedGraph<EdgeTy>&
+                                       blockGraph,
+                                   uint64_t beginNode, uint64_t endNode) {
       // Go over assigned nodes and distribute edges.
       galois::do_all(
           galois::iterate(beginNode, endNode),
@@ -2813,8 +2921,8 @@ private:
                   *graph.edge_begin(lsrc, galois::MethodFlag::UNPROTECTED);
             }
 
-            auto ee            = bufGraph.edgeBegin(src);
-            auto ee_end        = bufGraph.edgeEnd(src);
+            auto ee            = blockGraph.edgeBegin(src);
+            auto ee_end        = blockGraph.edgeEnd(src);
             uint64_t numEdgesL = std::distance(ee, ee_end);
             auto& gdst_vec     = *gdst_vecs.getLocal();
 
@@ -2824,7 +2932,7 @@ private:
             }
 
             for (; ee != ee_end; ++ee) {
-              uint32_t gdst = bufGraph.edgeDestination(*ee);
+              uint32_t gdst = blockGraph.edgeDestination(*ee);
               uint32_t hostBelongs =
                   graphPartitioner->getEdgeOwner(src, gdst, numEdgesL);
               if (_edgeStateRounds > 1) {
@@ -2881,9 +2989,8 @@ private:
           galois::loopname("EdgeLoading"),
 #endif
           galois::steal(), galois::no_stats());
-      syncEdgeLoad();
       // printEdgeLoad();
-    }
+    });
 
     // flush buffers
     for (unsigned threadNum = 0; threadNum < sendBuffers.size(); ++threadNum) {
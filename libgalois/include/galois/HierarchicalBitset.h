@@ -0,0 +1,349 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2019, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file galois/HierarchicalBitset.h
+ *
+ * Contains the HierarchicalBitSet class, a DynamicBitSet with a summary level
+ * that marks its non-empty words.
+ */
+
+#ifndef _GALOIS_HIERARCHICAL_BIT_SET_
+#define _GALOIS_HIERARCHICAL_BIT_SET_
+
+#include <vector>
+
+#include "galois/DynamicBitset.h"
+
+namespace galois {
+/**
+ * Concurrent dynamically allocated bitset with a second, summary level.
+ *
+ * Bit i of summary word s is set if word (64 * s + i) of the underlying
+ * DynamicBitSet may be non-zero, so one summary word covers 4096 bits.
+ * Setting a bit only touches the summary when it makes its word non-empty;
+ * resetting a single bit leaves the summary conservative. Clearing, counting,
+ * iterating and extracting offsets only visit the words the summary marks,
+ * so they cost time proportional to the number of non-empty words (plus a
+ * scan of the summary, which is 4096 times smaller than the bitset).
+ *
+ * The underlying DynamicBitSet can only be written to directly through
+ * modify_bitset() (e.g. when deserializing it or copying it from a device),
+ * which rebuilds the summary afterwards.
+ */
+class HierarchicalBitSet {
+  DynamicBitSet bits;
+  galois::PODResizeableArray<galois::CopyableAtomic<uint64_t>> summary;
+  static constexpr uint32_t bits_uint64 = sizeof(uint64_t) * CHAR_BIT;
+
+  static unsigned popcount(uint64_t n) {
+#ifdef __GNUC__
+    return __builtin_popcountll(n);
+#else
+    n = n - ((n >> 1) & 0x5555555555555555UL);
+    n = (n & 0x3333333333333333UL) + ((n >> 2) & 0x3333333333333333UL);
+    return (((n + (n >> 4)) & 0xF0F0F0F0F0F0F0FUL) * 0x101010101010101UL) >>
+           56;
+#endif
+  }
+
+  static unsigned lowestBit(uint64_t n) {
+#ifdef __GNUC__
+    return __builtin_ctzll(n);
+#else
+    unsigned i = 0;
+    while (!(n & 1)) {
+      n >>= 1;
+      ++i;
+    }
+    return i;
+#endif
+  }
+
+  //! Calls f(word index, word) on each non-empty word under summary word s
+  template <typename F>
+  void forEachWord(size_t s, F& f) const {
+    const auto& bitvec = bits.get_vec();
+    uint64_t mask      = summary[s].load(std::memory_order_relaxed);
+    while (mask) {
+      size_t w = s * bits_uint64 + lowestBit(mask);
+      mask &= mask - 1;
+      uint64_t word = bitvec[w].load(std::memory_order_relaxed);
+      if (word)
+        f(w, word);
+    }
+  }
+
+  //! Calls f(bit index) on each set bit under summary word s in order
+  template <typename F>
+  void forEachBit(size_t s, F& f) const {
+    auto visit = [&](size_t w, uint64_t word) {
+      do {
+        f(w * bits_uint64 + lowestBit(word));
+        word &= word - 1;
+      } while (word);
+    };
+    forEachWord(s, visit);
+  }
+
+  //! Number of set bits under summary word s
+  uint64_t countBlock(size_t s) const {
+    uint64_t mask = summary[s].load(std::memory_order_relaxed);
+    uint64_t ret  = 0;
+    if (mask == ~uint64_t{0}) {
+      // dense block: a contiguous loop the compiler can vectorize
+      const auto* words = &bits.get_vec()[s * bits_uint64];
+      size_t num = std::min<size_t>(bits_uint64,
+                                    bits.get_vec().size() - s * bits_uint64);
+      for (size_t i = 0; i < num; ++i)
+        ret += popcount(words[i].load(std::memory_order_relaxed));
+    } else {
+      auto visit = [&](size_t, uint64_t word) { ret += popcount(word); };
+      forEachWord(s, visit);
+    }
+    return ret;
+  }
+
+  /**
+   * Writes the set bits in order into offsets, which must be sized to hold
+   * them all.
+   */
+  template <typename VecTy>
+  void fillOffsets(VecTy& offsets, const std::vector<size_t>& prefix) const {
+    galois::do_all(
+        galois::iterate(size_t{0}, summary.size()),
+        [&](size_t s) {
+          size_t pos = prefix[s];
+          auto write = [&](size_t i) { offsets[pos++] = i; };
+          forEachBit(s, write);
+        },
+        galois::steal(), galois::chunk_size<1>(), galois::no_stats());
+  }
+
+  //! Returns the exclusive prefix sum of the set bits per summary word
+  std::vector<size_t> blockPrefixCounts() const {
+    std::vector<size_t> prefix(summary.size() + 1, 0);
+    galois::do_all(
+        galois::iterate(size_t{0}, summary.size()),
+        [&](size_t s) { prefix[s + 1] = countBlock(s); }, galois::steal(),
+        galois::chunk_size<1>(), galois::no_stats());
+    for (size_t s = 1; s < prefix.size(); ++s)
+      prefix[s] += prefix[s - 1];
+    return prefix;
+  }
+
+public:
+  //! Returns the underlying bitset
+  const DynamicBitSet& get_bitset() const { return bits; }
+
+  /**
+   * Calls f on the underlying bitset and then rebuilds the summary.
+   * Do NOT call in a parallel region.
+   *
+   * @param f function that modifies the DynamicBitSet passed to it
+   */
+  template <typename F>
+  void modify_bitset(F f) {
+    f(bits);
+    rebuild_summary();
+  }
+
+  /**
+   * Resizes the bitset and unsets every bit. Resizing to the current size
+   * only clears the non-empty words.
+   *
+   * @param n Size to change the bitset to
+   */
+  void resize(uint64_t n) {
+    if (n == bits.size()) {
+      reset();
+      return;
+    }
+    bits.resize(n);
+    summary.resize((bits.get_vec().size() + bits_uint64 - 1) / bits_uint64);
+    std::fill(summary.begin(), summary.end(), 0);
+  }
+
+  /**
+   * Reserves capacity for the bitset.
+   *
+   * @param n Size to reserve the capacity of the bitset to
+   */
+  void reserve(uint64_t n) {
+    bits.reserve(n);
+    summary.reserve((n + bits_uint64 * bits_uint64 - 1) /
+                    (bits_uint64 * bits_uint64));
+  }
+
+  /**
+   * Gets the size of the bitset
+   * @returns The number of bits held by the bitset
+   */
+  size_t size() const { return bits.size(); }
+
+  /**
+   * Unset every bit in the bitset. Only words marked in the summary are
+   * cleared. Do NOT call in a parallel region.
+   */
+  void reset() {
+    auto& bitvec = bits.get_vec();
+    galois::do_all(
+        galois::iterate(size_t{0}, summary.size()),
+        [&](size_t s) {
+          uint64_t mask = summary[s];
+          while (mask) {
+            bitvec[s * bits_uint64 + lowestBit(mask)] = 0;
+            mask &= mask - 1;
+          }
+          summary[s] = 0;
+        },
+        galois::steal(), galois::chunk_size<1>(), galois::no_stats());
+  }
+
+  /**
+   * Unset a range of bits given an inclusive range; the summary is left
+   * conservative.
+   *
+   * @param begin first bit in range to reset
+   * @param end last bit in range to reset
+   */
+  void reset(size_t begin, size_t end) { bits.reset(begin, end); }
+
+  /**
+   * Check a bit to see if it is currently set.
+   *
+   * @param index Bit to check to see if set
+   * @returns true if index is set
+   */
+  bool test(size_t index) const { return bits.test(index); }
+
+  /**
+   * Set a bit in the bitset.
+   *
+   * @param index Bit to set
+   * @returns the old value
+   */
+  bool set(size_t index) {
+    size_t bit_index    = index / bits_uint64;
+    uint64_t bit_offset = 1;
+    bit_offset <<= (index % bits_uint64);
+    auto& word       = bits.get_vec()[bit_index];
+    uint64_t old_val = word;
+    while (((old_val & bit_offset) == 0) &&
+           !word.compare_exchange_weak(old_val, old_val | bit_offset,
+                                       std::memory_order_relaxed))
+      ;
+    // only the thread that makes the word non-empty updates the summary
+    if (old_val == 0) {
+      summary[bit_index / bits_uint64].fetch_or(
+          uint64_t{1} << (bit_index % bits_uint64), std::memory_order_relaxed);
+    }
+    return (old_val & bit_offset);
+  }
+
+  /**
+   * Reset a bit in the bitset.
+   *
+   * @param index Bit to reset
+   * @returns the old value
+   */
+  bool reset(size_t index) { return bits.reset(index); }
+
+  /**
+   * Recomputes the summary from the underlying bitset.
+   * Do NOT call in a parallel region.
+   */
+  void rebuild_summary() {
+    const auto& bitvec = bits.get_vec();
+    galois::do_all(
+        galois::iterate(size_t{0}, summary.size()),
+        [&](size_t s) {
+          size_t begin  = s * bits_uint64;
+          size_t end    = std::min<size_t>(begin + bits_uint64, bitvec.size());
+          uint64_t mask = 0;
+          for (size_t w = begin; w < end; ++w)
+            mask |= uint64_t{bitvec[w] != 0} << (w - begin);
+          summary[s] = mask;
+        },
+        galois::no_stats());
+  }
+
+  /**
+   * Count how many bits are set in the bitset
+   *
+   * @returns number of set bits in the bitset
+   */
+  uint64_t count() const {
+    galois::GAccumulator<uint64_t> ret;
+    galois::do_all(
+        galois::iterate(size_t{0}, summary.size()),
+        [&](size_t s) { ret += countBlock(s); }, galois::steal(),
+        galois::chunk_size<1>(), galois::no_stats());
+    return ret.reduce();
+  }
+
+  /**
+   * Calls f on the index of every set bit in parallel.
+   * Do NOT call in a parallel region as it uses galois::do_all.
+   *
+   * @param f function to call on each set bit
+   * @param args additional arguments to galois::do_all, e.g. the loopname
+   */
+  template <typename F, typename... Args>
+  void for_each_set(const F& f, Args&&... args) const {
+    galois::do_all(
+        galois::iterate(size_t{0}, summary.size()),
+        [&](size_t s) { forEachBit(s, f); }, galois::steal(),
+        galois::chunk_size<1>(), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Returns a vector containing the set bits in this bitset in order
+   * from left to right.
+   * Do NOT call in a parallel region as it uses galois::do_all.
+   *
+   * @returns vector with offsets into set bits
+   */
+  std::vector<uint32_t> getOffsets() const {
+    std::vector<uint32_t> offsets;
+    getOffsets(offsets);
+    return offsets;
+  }
+
+  /**
+   * Saves the set bits in this bitset in order into offsets, resizing it to
+   * the number of set bits if there are any.
+   * Do NOT call in a parallel region as it uses galois::do_all.
+   *
+   * @param offsets output: vector-like container of the set bits
+   * @returns number of set bits
+   */
+  template <typename VecTy>
+  size_t getOffsets(VecTy& offsets) const {
+    std::vector<size_t> prefix = blockPrefixCounts();
+    size_t bitsetCount         = prefix.back();
+    if (bitsetCount > 0) {
+      offsets.resize(bitsetCount);
+      fillOffsets(offsets, prefix);
+    }
+    return bitsetCount;
+  }
+};
+} // namespace galois
+#endif
@@ -123,6 +123,14 @@ static inline void reportPageAlloc(const char* label) {
  * conform to <code>nhFunc(item)</code> and should visit every element in the
  * neighborhood of active element item.
  *
+ * Every task in the current window whose neighborhood is not claimed by an
+ * earlier task is executed, so sources must be stable: a task the operator
+ * creates must never conflict with an earlier task of the same window. New
+ * tasks must not be ordered before the task creating them (checked with
+ * assertions). Algorithms that may create such tasks, e.g., discrete-event
+ * simulation, must use the overload taking a stability test instead;
+ * otherwise the result silently differs from the serial order.
+ *
  * @param b begining of range of initial items
  * @param e end of range of initial items
  * @param cmp comparison function
@@ -146,7 +154,9 @@ void for_each_ordered(Iter b, Iter e, const Cmp& cmp, const NhFunc& nhFunc,
  * conform to <code>nhFunc(item)</code> and should visit every element in the
  * neighborhood of active element item. The stability test should conform to
  * <code>bool r = stabilityTest(item)</code> where r is true if item is a stable
- * source.
+ * source, or to <code>bool r = stabilityTest(item, earliest)</code> where
+ * earliest is the earliest pending task (e.g., to apply a lookahead). The
+ * earliest pending tasks are always executed.
  *
  * @param b begining of range of initial items
  * @param e end of range of initial items
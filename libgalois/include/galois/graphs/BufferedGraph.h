@@ -133,6 +133,8 @@ private:
    */
   void loadEdgeDest(std::ifstream& graphFile, uint64_t edgeStart,
                     uint64_t numEdgesToLoad, uint64_t numGlobalNodes) {
+    // edgeBegin of the first loaded node relies on this even with no edges
+    edgeOffset = edgeStart;
     if (numEdgesToLoad == 0) {
       return;
     }
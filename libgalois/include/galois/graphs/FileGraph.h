@@ -689,7 +689,7 @@ public:
   void phase1() { outIdx.resize(numNodes); }
 
   //! Increments degree of id by delta
-  void incrementDegree(size_t id, int delta = 1) {
+  void incrementDegree(size_t id, int64_t delta = 1) {
     assert(id < numNodes);
     outIdx[id] += delta;
   }
@@ -737,6 +737,21 @@ public:
     }
   }
 
+  //! Returns the index of the first edge of src; valid after phase2()
+  size_t edgeBegin(size_t src) const { return src ? outIdx[src - 1] : 0; }
+
+  /**
+   * Sets the destination of edge idx. Unlike addNeighbor, this can be called
+   * in parallel as long as each edge is set once.
+   */
+  void setNeighbor(size_t idx, size_t dst) {
+    if (numNodes <= std::numeric_limits<uint32_t>::max()) {
+      outs[idx] = dst;
+    } else {
+      outs64[idx] = dst;
+    }
+  }
+
   /**
    * Finish making graph. Returns pointer to block of memory that should be
    * used to store edge data.
@@ -1008,6 +1008,54 @@ public:
     graphFile.close();
   }
 
+  /**
+   * Uses existing CSR arrays (e.g., owned by NumPy or Arrow) as the topology
+   * of this graph without copying them. Node data is allocated and
+   * constructed as usual.
+   *
+   * The arrays must outlive the graph and are never freed by it. Operations
+   * that reorder edges, such as sortAllEdgesByDst, modify them in place.
+   *
+   * @param nNodes number of nodes
+   * @param offsets nNodes + 1 edge offsets; offsets[0] must be 0 and
+   * offsets[nNodes] is the number of edges
+   * @param dsts destination of each edge
+   * @param values value of each edge; unused if EdgeTy is void
+   */
+  void fromArrays(uint32_t nNodes, uint64_t* offsets, uint32_t* dsts,
+                  void* values = nullptr) {
+    static_assert(std::is_void<EdgeTy>::value ||
+                      std::is_trivially_destructible<EdgeTy>::value,
+                  "edge data of wrapped arrays must be trivially destructible");
+    if (offsets[0] != 0) {
+      GALOIS_DIE("edge offsets must start at 0");
+    }
+    if (EdgeData::has_value && !values && offsets[nNodes] > 0) {
+      GALOIS_DIE("graph has edge data but no edge values were given");
+    }
+
+    deallocate();
+    numNodes = nNodes;
+    numEdges = offsets[nNodes];
+
+    // edge_end(n) is edgeIndData[n], i.e., the offsets without the leading 0
+    edgeIndData = EdgeIndData(offsets + 1, numNodes);
+    edgeDst     = EdgeDst(dsts, numEdges);
+    if constexpr (EdgeData::has_value) {
+      edgeData = EdgeData(values, numEdges);
+    }
+
+    if (UseNumaAlloc) {
+      nodeData.allocateBlocked(numNodes);
+      this->outOfLineAllocateBlocked(numNodes);
+    } else {
+      nodeData.allocateInterleaved(numNodes);
+      this->outOfLineAllocateInterleaved(numNodes);
+    }
+    constructNodes();
+    initializeLocalRanges();
+  }
+
   /**
    * Given a manually created graph, initialize the local ranges on this graph
    * so that threads can iterate over a balanced number of vertices.
@@ -0,0 +1,573 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_GRAPHS_LC_DYNAMIC_CSR_GRAPH_H
+#define GALOIS_GRAPHS_LC_DYNAMIC_CSR_GRAPH_H
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "galois/config.h"
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/ParallelSTL.h"
+#include "galois/Reduction.h"
+#include "galois/graphs/Details.h"
+#include "galois/graphs/FileGraph.h"
+
+namespace galois::graphs {
+
+namespace internal {
+//! An edge to add to a LC_Dynamic_CSR_Graph
+template <typename EdgeTy>
+struct DynamicEdgeInsertion {
+  uint32_t src;
+  uint32_t dst;
+  EdgeTy data;
+
+  const EdgeTy& value() const { return data; }
+};
+
+template <>
+struct DynamicEdgeInsertion<void> {
+  uint32_t src;
+  uint32_t dst;
+
+  void* value() const { return nullptr; }
+};
+} // namespace internal
+
+/**
+ * Local computation graph in compressed-sparse-row (CSR) format whose edges
+ * can be inserted and deleted in parallel batches.
+ *
+ * Every node owns a contiguous range of edge slots of which only a prefix is
+ * in use, so the iteration API is the same as LC_CSR_Graph: the out edges of
+ * a node are the counting range [edge_begin(N), edge_end(N)). The edge array
+ * keeps spare slots after the ranges of all nodes; a node whose free slots
+ * cannot hold its insertions moves its edges to a new, larger range taken
+ * from the spare slots, leaving every other node in place. Only when the
+ * spare slots run out is the whole array rebuilt, giving every node slack
+ * proportional to its degree. Deletions compact the graph once compaction
+ * would at least halve its storage.
+ *
+ * Batch updates must not run concurrently with any other access to the graph.
+ *
+ * @tparam NodeTy data on nodes
+ * @tparam EdgeTy data on out edges
+ */
+template <typename NodeTy, typename EdgeTy, bool HasNoLockable = false,
+          typename FileEdgeTy = EdgeTy>
+class LC_Dynamic_CSR_Graph : private boost::noncopyable {
+public:
+  template <bool _has_no_lockable>
+  struct with_no_lockable {
+    typedef LC_Dynamic_CSR_Graph<NodeTy, EdgeTy, _has_no_lockable, FileEdgeTy>
+        type;
+  };
+
+  template <typename _node_data>
+  struct with_node_data {
+    typedef LC_Dynamic_CSR_Graph<_node_data, EdgeTy, HasNoLockable, FileEdgeTy>
+        type;
+  };
+
+  template <typename _edge_data>
+  struct with_edge_data {
+    typedef LC_Dynamic_CSR_Graph<NodeTy, _edge_data, HasNoLockable, FileEdgeTy>
+        type;
+  };
+
+  template <typename _file_edge_data>
+  struct with_file_edge_data {
+    typedef LC_Dynamic_CSR_Graph<NodeTy, EdgeTy, HasNoLockable,
+                                 _file_edge_data>
+        type;
+  };
+
+  typedef read_default_graph_tag read_tag;
+
+protected:
+  typedef LargeArray<EdgeTy> EdgeData;
+  typedef LargeArray<uint32_t> EdgeDst;
+  typedef internal::NodeInfoBaseTypes<NodeTy, !HasNoLockable> NodeInfoTypes;
+  typedef internal::NodeInfoBase<NodeTy, !HasNoLockable> NodeInfo;
+  typedef LargeArray<uint64_t> EdgeIndData;
+  typedef LargeArray<uint32_t> DegreeData;
+  typedef LargeArray<NodeInfo> NodeData;
+
+public:
+  typedef uint32_t GraphNode;
+  typedef EdgeTy edge_data_type;
+  typedef FileEdgeTy file_edge_data_type;
+  typedef NodeTy node_data_type;
+  typedef typename EdgeData::reference edge_data_reference;
+  typedef typename NodeInfoTypes::reference node_data_reference;
+  typedef internal::DynamicEdgeInsertion<EdgeTy> EdgeInsertion;
+  typedef std::pair<GraphNode, GraphNode> EdgeDeletion;
+  using edge_iterator =
+      boost::counting_iterator<typename EdgeIndData::value_type>;
+  using iterator = boost::counting_iterator<typename EdgeDst::value_type>;
+  typedef iterator const_iterator;
+
+protected:
+  NodeData nodeData;
+  //! first edge slot of each node
+  EdgeIndData slotStart;
+  //! number of edge slots owned by each node
+  DegreeData slotCapacity;
+  //! number of slots of each node that hold an edge
+  DegreeData degree;
+  EdgeDst edgeDst;
+  EdgeData edgeData;
+
+  uint64_t numNodes = 0;
+  uint64_t numEdges = 0;
+  //! slots owned by nodes or left behind by relocated nodes; the slots after
+  //! them are spare
+  uint64_t slotsTaken = 0;
+
+  //! free slots given to a node as a fraction of its degree on rebuild
+  double slackRatio = 0.25;
+  //! free slots given to every node on rebuild
+  uint32_t minSlack = 2;
+
+  uint64_t slotBegin(GraphNode N) const { return slotStart[N]; }
+
+  uint64_t capacityFor(uint64_t deg) const {
+    return deg +
+           std::max<uint64_t>(minSlack, static_cast<uint64_t>(deg * slackRatio));
+  }
+
+  //! size of an edge array whose nodes own numSlots slots: adds spare slots
+  //! for relocating nodes that overflow
+  uint64_t allocationFor(uint64_t numSlots) const {
+    uint64_t spare = static_cast<uint64_t>(numSlots * slackRatio);
+    return numSlots + std::max<uint64_t>(spare, 1024);
+  }
+
+  //! upper bound on the slots nodes own right after a rebuild
+  uint64_t compactedSlots() const {
+    return static_cast<uint64_t>(numEdges * (1 + slackRatio)) +
+           uint64_t{minSlack} * numNodes;
+  }
+
+  //! Sets slotStart to the exclusive prefix sum of slotCapacity and allocates
+  //! the edge arrays; returns the number of slots owned by nodes
+  uint64_t layoutSlots(EdgeIndData& start, DegreeData& capacity,
+                       EdgeDst& dsts, EdgeData& data) {
+    // summing in place keeps the prefix sums 64-bit
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) { start[n] = capacity[n]; }, galois::no_stats());
+    galois::ParallelSTL::partial_sum(start.begin(), start.end(), start.begin());
+    uint64_t numSlots = numNodes ? start[numNodes - 1] : 0;
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) { start[n] -= capacity[n]; }, galois::no_stats(),
+        galois::loopname("DynamicCSR-SlotStarts"));
+    dsts.allocateInterleaved(allocationFor(numSlots));
+    data.allocateInterleaved(allocationFor(numSlots));
+    return numSlots;
+  }
+
+  //! copies count edges of one node from slot from to slot to
+  void moveEdges(EdgeDst& dsts, EdgeData& data, uint64_t to, uint64_t from,
+                 uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      dsts[to + i] = edgeDst[from + i];
+      data.set(to + i, edgeData[from + i]);
+    }
+  }
+
+  //! dies if an endpoint of the batch is not a node of the graph
+  template <typename T, typename GetEnds>
+  void checkEndpoints(const std::vector<T>& batch, GetEnds getEnds) const {
+    galois::GReduceLogicalOr outOfRange;
+    galois::do_all(
+        galois::iterate(size_t{0}, batch.size()),
+        [&](size_t i) {
+          auto ends = getEnds(batch[i]);
+          if (ends.first >= numNodes || ends.second >= numNodes)
+            outOfRange.update(true);
+        },
+        galois::no_stats(), galois::loopname("DynamicCSR-CheckEndpoints"));
+    if (outOfRange.reduce())
+      GALOIS_DIE("edge endpoint out of range: graph has ", numNodes, " nodes");
+  }
+
+  template <bool _A1 = HasNoLockable>
+  void acquireNode(GraphNode N, MethodFlag mflag,
+                   typename std::enable_if<!_A1>::type* = 0) {
+    galois::runtime::acquire(&nodeData[N], mflag);
+  }
+
+  template <bool _A1 = HasNoLockable>
+  void acquireNode(GraphNode, MethodFlag,
+                   typename std::enable_if<_A1>::type* = 0) {}
+
+  /**
+   * Calls fn(src, begin, end) once per run of equal sources in the sorted
+   * batch [first, first + size).
+   */
+  template <typename T, typename GetSrc, typename Fn>
+  static void forEachSourceRun(const T* first, size_t size, GetSrc getSrc,
+                               Fn fn, const char* loopname) {
+    galois::do_all(
+        galois::iterate(size_t{0}, size),
+        [&](size_t i) {
+          GraphNode src = getSrc(first[i]);
+          if (i != 0 && getSrc(first[i - 1]) == src)
+            return;
+          size_t j = i + 1;
+          while (j < size && getSrc(first[j]) == src)
+            ++j;
+          fn(src, i, j);
+        },
+        galois::steal(), galois::no_stats(), galois::loopname(loopname));
+  }
+
+  /**
+   * Moves the edges of every node to a freshly allocated edge array where
+   * node N gets capacityFor(degree(N) + extra(N)) slots.
+   */
+  template <typename ExtraFn>
+  void rebuild(ExtraFn extra) {
+    EdgeIndData newSlotStart;
+    DegreeData newSlotCapacity;
+    newSlotStart.allocateInterleaved(numNodes);
+    newSlotCapacity.allocateInterleaved(numNodes);
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) {
+          newSlotCapacity[n] = capacityFor(degree[n] + extra(n));
+        },
+        galois::no_stats(), galois::loopname("DynamicCSR-Capacities"));
+
+    EdgeDst newEdgeDst;
+    EdgeData newEdgeData;
+    slotsTaken =
+        layoutSlots(newSlotStart, newSlotCapacity, newEdgeDst, newEdgeData);
+
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) {
+          moveEdges(newEdgeDst, newEdgeData, newSlotStart[n], slotBegin(n),
+                    degree[n]);
+        },
+        galois::steal(), galois::no_stats(),
+        galois::loopname("DynamicCSR-MoveEdges"));
+
+    swap(slotStart, newSlotStart);
+    swap(slotCapacity, newSlotCapacity);
+    swap(edgeDst, newEdgeDst);
+    swap(edgeData, newEdgeData);
+  }
+
+public:
+  LC_Dynamic_CSR_Graph() = default;
+
+  node_data_reference getData(GraphNode N,
+                              MethodFlag mflag = MethodFlag::WRITE) {
+    NodeInfo& NI = nodeData[N];
+    acquireNode(N, mflag);
+    return NI.getData();
+  }
+
+  edge_data_reference
+  getEdgeData(edge_iterator ni,
+              MethodFlag GALOIS_UNUSED(mflag) = MethodFlag::UNPROTECTED) {
+    return edgeData[*ni];
+  }
+
+  GraphNode getEdgeDst(edge_iterator ni) { return edgeDst[*ni]; }
+
+  size_t size() const { return numNodes; }
+  size_t sizeEdges() const { return numEdges; }
+  //! Number of edge slots, used or free
+  size_t capacityEdges() const { return edgeDst.size(); }
+
+  iterator begin() const { return iterator(0); }
+  iterator end() const { return iterator(numNodes); }
+
+  edge_iterator edge_begin(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    acquireNode(N, mflag);
+    edge_iterator ii = edge_iterator(slotBegin(N));
+    if (!HasNoLockable && galois::runtime::shouldLock(mflag)) {
+      for (edge_iterator ee = ii + degree[N]; ii != ee; ++ii) {
+        acquireNode(edgeDst[*ii], mflag);
+      }
+      ii = edge_iterator(slotBegin(N));
+    }
+    return ii;
+  }
+
+  edge_iterator edge_end(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    acquireNode(N, mflag);
+    return edge_iterator(slotBegin(N) + degree[N]);
+  }
+
+  edge_iterator findEdge(GraphNode N1, GraphNode N2) {
+    return std::find_if(edge_begin(N1), edge_end(N1),
+                        [=](edge_iterator e) { return getEdgeDst(e) == N2; });
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  edges(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    return internal::make_no_deref_range(edge_begin(N, mflag),
+                                         edge_end(N, mflag));
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  out_edges(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    return edges(N, mflag);
+  }
+
+  /**
+   * Sets the free slots each node gets whenever the edge array is rebuilt:
+   * max(minimum, ratio * degree). Takes effect at the next rebuild.
+   */
+  void setSlack(double ratio, uint32_t minimum) {
+    slackRatio = ratio;
+    minSlack   = minimum;
+  }
+
+  /**
+   * Creates nNodes default-constructed nodes without edges.
+   */
+  void constructEmpty(uint32_t nNodes) {
+    numNodes = nNodes;
+    numEdges = 0;
+    nodeData.create(numNodes);
+    degree.create(numNodes, 0);
+    slotStart.create(numNodes, 0);
+    rebuild([](uint64_t) { return 0; });
+  }
+
+  void allocateFrom(FileGraph& graph) {
+    numNodes = graph.size();
+    numEdges = graph.sizeEdges();
+    nodeData.allocateInterleaved(numNodes);
+    degree.allocateInterleaved(numNodes);
+    slotStart.allocateInterleaved(numNodes);
+    slotCapacity.allocateInterleaved(numNodes);
+
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) {
+          slotCapacity[n] = capacityFor(
+              std::distance(graph.edge_begin(n), graph.edge_end(n)));
+        },
+        galois::no_stats(), galois::loopname("DynamicCSR-Capacities"));
+    slotsTaken = layoutSlots(slotStart, slotCapacity, edgeDst, edgeData);
+  }
+
+  void constructFrom(FileGraph& graph, unsigned tid, unsigned total,
+                     const bool readUnweighted = false) {
+    auto r = galois::block_range(uint64_t{0}, numNodes, tid, total);
+    for (uint64_t n = r.first; n != r.second; ++n) {
+      nodeData.constructAt(n);
+      uint64_t slot = slotBegin(n);
+      uint32_t deg  = 0;
+      for (FileGraph::edge_iterator nn = graph.edge_begin(n),
+                                    en = graph.edge_end(n);
+           nn != en; ++nn, ++slot, ++deg) {
+        edgeDst[slot] = graph.getEdgeDst(nn);
+        constructEdgeValue(graph, nn, slot, readUnweighted);
+      }
+      degree[n] = deg;
+    }
+  }
+
+  /**
+   * Adds a batch of edges in parallel. Parallel edges are kept, as in
+   * LC_CSR_Graph. The relative order of the existing edges of a node is
+   * preserved and new edges are appended after them.
+   */
+  void insertEdges(std::vector<EdgeInsertion> batch) {
+    if (batch.empty())
+      return;
+    checkEndpoints(batch, [](const EdgeInsertion& e) {
+      return std::make_pair(e.src, e.dst);
+    });
+
+    galois::ParallelSTL::sort(batch.begin(), batch.end(),
+                              [](const EdgeInsertion& a,
+                                 const EdgeInsertion& b) {
+                                return a.src < b.src;
+                              });
+    auto getSrc = [](const EdgeInsertion& e) { return e.src; };
+    auto overflows = [&](GraphNode src, size_t count) {
+      return degree[src] + count > slotCapacity[src];
+    };
+
+    // slots needed by nodes whose own free slots are too few
+    galois::GAccumulator<uint64_t> relocated;
+    forEachSourceRun(
+        batch.data(), batch.size(), getSrc,
+        [&](GraphNode src, size_t b, size_t e) {
+          if (overflows(src, e - b))
+            relocated += capacityFor(degree[src] + (e - b));
+        },
+        "DynamicCSR-CheckSlack");
+
+    if (slotsTaken + relocated.reduce() > capacityEdges()) {
+      LargeArray<uint32_t> extra;
+      extra.create(numNodes, 0);
+      forEachSourceRun(
+          batch.data(), batch.size(), getSrc,
+          [&](GraphNode src, size_t b, size_t e) { extra[src] = e - b; },
+          "DynamicCSR-CountInsertions");
+      rebuild([&](uint64_t n) { return extra[n]; });
+    } else if (relocated.reduce()) {
+      forEachSourceRun(
+          batch.data(), batch.size(), getSrc,
+          [&](GraphNode src, size_t b, size_t e) {
+            if (!overflows(src, e - b))
+              return;
+            uint64_t capacity = capacityFor(degree[src] + (e - b));
+            uint64_t to       = __sync_fetch_and_add(&slotsTaken, capacity);
+            moveEdges(edgeDst, edgeData, to, slotBegin(src), degree[src]);
+            slotStart[src]    = to;
+            slotCapacity[src] = capacity;
+          },
+          "DynamicCSR-Relocate");
+    }
+
+    forEachSourceRun(
+        batch.data(), batch.size(), getSrc,
+        [&](GraphNode src, size_t b, size_t e) {
+          uint64_t slot = slotBegin(src) + degree[src];
+          for (size_t i = b; i < e; ++i, ++slot) {
+            edgeDst[slot] = batch[i].dst;
+            edgeData.set(slot, batch[i].value());
+          }
+          degree[src] += e - b;
+        },
+        "DynamicCSR-Insert");
+
+    numEdges += batch.size();
+  }
+
+  /**
+   * Removes every edge (src, dst) in the batch in parallel, including all
+   * parallel copies. The relative order of the remaining edges is preserved.
+   *
+   * @returns number of edges removed
+   */
+  size_t deleteEdges(std::vector<EdgeDeletion> batch) {
+    if (batch.empty())
+      return 0;
+    checkEndpoints(batch, [](const EdgeDeletion& e) { return e; });
+
+    galois::ParallelSTL::sort(batch.begin(), batch.end());
+    auto getSrc = [](const EdgeDeletion& e) { return e.first; };
+
+    galois::GAccumulator<size_t> removed;
+    forEachSourceRun(
+        batch.data(), batch.size(), getSrc,
+        [&](GraphNode src, size_t b, size_t e) {
+          auto isDeleted = [&](GraphNode dst) {
+            return std::binary_search(batch.begin() + b, batch.begin() + e,
+                                      EdgeDeletion(src, dst));
+          };
+          uint64_t first = slotBegin(src);
+          uint64_t last  = first + degree[src];
+          uint64_t out   = first;
+          for (uint64_t in = first; in != last; ++in) {
+            if (isDeleted(edgeDst[in]))
+              continue;
+            if (out != in) {
+              edgeDst[out] = edgeDst[in];
+              edgeData.set(out, edgeData[in]);
+            }
+            ++out;
+          }
+          removed += last - out;
+          degree[src] = out - first;
+        },
+        "DynamicCSR-Delete");
+
+    size_t numRemoved = removed.reduce();
+    numEdges -= numRemoved;
+    if (capacityEdges() > 2 * allocationFor(compactedSlots()))
+      compact();
+    return numRemoved;
+  }
+
+  /**
+   * Reclaims free edge slots, including those left behind by relocated nodes:
+   * rebuilds the edge array so that every node has only its configured slack.
+   */
+  void compact() {
+    rebuild([](uint64_t) { return 0; });
+  }
+
+  void sortEdgesByDst(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    acquireNode(N, mflag);
+    typedef internal::EdgeSortIterator<GraphNode, uint64_t, EdgeDst, EdgeData>
+        edge_sort_iterator;
+    typedef EdgeSortValue<GraphNode, EdgeTy> EdgeSortVal;
+    std::sort(edge_sort_iterator(slotBegin(N), &edgeDst, &edgeData),
+              edge_sort_iterator(slotBegin(N) + degree[N], &edgeDst,
+                                 &edgeData),
+              [=](const EdgeSortVal& e1, const EdgeSortVal& e2) {
+                return e1.dst < e2.dst;
+              });
+  }
+
+  void sortAllEdgesByDst(MethodFlag mflag = MethodFlag::WRITE) {
+    galois::do_all(
+        galois::iterate(size_t{0}, this->size()),
+        [=](GraphNode N) { this->sortEdgesByDst(N, mflag); },
+        galois::no_stats(), galois::steal());
+  }
+
+private:
+  template <bool _A1 = EdgeData::has_value,
+            bool _A2 = LargeArray<FileEdgeTy>::has_value>
+  void constructEdgeValue(FileGraph& graph,
+                          typename FileGraph::edge_iterator nn, uint64_t slot,
+                          bool readUnweighted,
+                          typename std::enable_if<_A1 && _A2>::type* = 0) {
+    if (readUnweighted)
+      edgeData.set(slot, {});
+    else
+      edgeData.set(slot, graph.getEdgeData<FileEdgeTy>(nn));
+  }
+
+  template <bool _A1 = EdgeData::has_value,
+            bool _A2 = LargeArray<FileEdgeTy>::has_value>
+  void constructEdgeValue(FileGraph&, typename FileGraph::edge_iterator,
+                          uint64_t slot, bool,
+                          typename std::enable_if<_A1 && !_A2>::type* = 0) {
+    edgeData.set(slot, {});
+  }
+
+  template <bool _A1 = EdgeData::has_value>
+  void constructEdgeValue(FileGraph&, typename FileGraph::edge_iterator,
+                          uint64_t, bool,
+                          typename std::enable_if<!_A1>::type* = 0) {}
+};
+
+} // namespace galois::graphs
+
+#endif
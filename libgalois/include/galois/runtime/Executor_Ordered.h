@@ -20,31 +20,386 @@
 #ifndef GALOIS_RUNTIME_EXECUTOR_ORDERED_H
 #define GALOIS_RUNTIME_EXECUTOR_ORDERED_H
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <deque>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
 #include "galois/config.h"
+#include "galois/gIO.h"
+#include "galois/gstl.h"
+#include "galois/runtime/Context.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/runtime/Substrate.h"
+#include "galois/runtime/UserContextAccess.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "galois/substrate/ThreadPool.h"
+#include "galois/Threads.h"
+#include "galois/Timer.h"
 
 namespace galois {
 namespace runtime {
 
-// TODO(ddn): Pull in and integrate in executors from exp
+namespace internal {
+
+//! Compares items with a user comparator that may be either < or <=
+template <typename T, typename Cmp>
+struct OrderedBefore {
+  const Cmp& cmp;
+  bool operator()(const T& a, const T& b) const {
+    return cmp(a, b) && !cmp(b, a);
+  }
+};
+
+/**
+ * Conflict detection for one task of the current window. While the
+ * neighborhood function runs, every lockable is marked with the earliest
+ * task that touches it; tasks that lose some mark are not ready.
+ */
+template <typename T, typename Cmp>
+class OrderedContext : public SimpleRuntimeContext {
+  OrderedBefore<T, Cmp> before;
+
+public:
+  T item;
+  //! set by any thread that steals a mark while neighborhoods are marked;
+  //! barriers order these writes before the owner reads the flag
+  std::atomic<bool> notReady;
+  bool firstPass;
+
+  OrderedContext(const T& it, const Cmp& cmp)
+      : SimpleRuntimeContext(true), before{cmp}, item(it), notReady(false),
+        firstPass(true) {}
+
+  void reset(const T& it) {
+    item = it;
+    notReady.store(false, std::memory_order_relaxed);
+    firstPass = true;
+  }
+
+  bool isReady() const { return !notReady.load(std::memory_order_relaxed); }
+
+  void markNotReady() { notReady.store(true, std::memory_order_relaxed); }
+
+  //! Total order on tasks: priority, then address among equal priorities
+  bool precedes(const OrderedContext* other) const {
+    if (before(item, other->item))
+      return true;
+    if (before(other->item, item))
+      return false;
+    return this < other;
+  }
+
+  virtual void subAcquire(Lockable* lockable, galois::MethodFlag) {
+    // the operator runs only after its neighborhood has been marked
+    if (!firstPass)
+      return;
+
+    if (this->tryLock(lockable))
+      this->addToNhood(lockable);
+
+    OrderedContext* other;
+    do {
+      other = static_cast<OrderedContext*>(this->getOwner(lockable));
+      if (other == this)
+        return;
+      if (other && other->precedes(this)) {
+        markNotReady();
+        return;
+      }
+    } while (!this->stealByCAS(lockable, other));
+
+    if (other)
+      other->markNotReady();
+  }
+};
+
+/**
+ * Windowed ordered executor (in the style of IKDG).
+ *
+ * Pending tasks live in per-thread min-heaps. Each round, every thread pops
+ * its share of the window; the window is cut at the earliest last-popped
+ * item of any thread that still has pending tasks, so the window is always a
+ * prefix of all pending tasks in comparator order. The neighborhood function
+ * of every window task then marks its lockables with the earliest task
+ * touching them, and the tasks that own all of their marks are sources:
+ * no earlier pending task conflicts with them, so they are executed
+ * together. The remaining tasks and all new tasks go back to the heaps. The
+ * window grows while most tasks commit and shrinks when conflicts dominate.
+ *
+ * Without a stability test, the operator must only create tasks that cannot
+ * conflict with an earlier task of the same window (stable sources). With a
+ * stability test, a source only executes if it is stable or if it is among
+ * the earliest pending tasks. The stability test is either called as
+ * stableTest(item) or, if it accepts two arguments, as
+ * stableTest(item, earliest) with the earliest pending task, which lets
+ * conservative algorithms apply a lookahead.
+ */
+template <typename T, typename Cmp, typename NhFunc, typename OpFunc,
+          typename StableTest>
+class OrderedExecutor {
+  typedef OrderedContext<T, Cmp> Context;
+  typedef UserContextAccess<T> UserCtx;
+
+  struct ThreadData {
+    std::vector<T> heap;
+    std::vector<T> popped;
+    std::deque<Context> contexts; //!< reused across rounds
+    size_t numWindow;
+    UserCtx userCtx;
+    size_t commits;
+    size_t conflicts;
+    ThreadData() : numWindow(0), commits(0), conflicts(0) {}
+  };
+
+  static const size_t MIN_WINDOW_PER_THREAD = 16;
+
+  const Cmp& cmp;
+  const NhFunc& nhFunc;
+  const OpFunc& opFunc;
+  const StableTest& stableTest;
+  const char* loopname;
+  OrderedBefore<T, Cmp> before;
+  //! min-heap order for std::push_heap and friends
+  struct Later {
+    OrderedBefore<T, Cmp> before;
+    bool operator()(const T& a, const T& b) const { return before(b, a); }
+  } later;
+
+  substrate::PerThreadStorage<ThreadData> data;
+  substrate::Barrier& barrier;
+  unsigned numThreads;
+
+  // shared round state, written by thread 0 between barriers; limit and
+  // earliest point into the popped items of some thread
+  size_t windowSize;
+  const T* limit;
+  const T* earliest;
+  bool done;
+  size_t rounds;
+  // per-round counters for window adaptation
+  std::atomic<size_t> roundWindow;
+  std::atomic<size_t> roundCommits;
+
+  //! Calls stableTest(item, earliest) if supported, else stableTest(item)
+  bool isStable(const T& item) const {
+    if constexpr (std::is_invocable_r_v<bool, const StableTest&, const T&,
+                                        const T&>)
+      return stableTest(item, *earliest);
+    else
+      return stableTest(item);
+  }
+
+  void pushHeap(ThreadData& td, const T& item) {
+    td.heap.push_back(item);
+    std::push_heap(td.heap.begin(), td.heap.end(), later);
+  }
+
+  //! Pops this thread's share of the next window
+  void popShare(ThreadData& td) {
+    size_t share = (windowSize + numThreads - 1) / numThreads;
+    td.popped.clear();
+    while (!td.heap.empty() && td.popped.size() < share) {
+      std::pop_heap(td.heap.begin(), td.heap.end(), later);
+      td.popped.push_back(td.heap.back());
+      td.heap.pop_back();
+    }
+  }
+
+  //! Thread 0: cuts the window so that it is a prefix of all pending tasks
+  void computeLimit() {
+    limit    = nullptr;
+    earliest = nullptr;
+    for (unsigned i = 0; i < numThreads; ++i) {
+      ThreadData& td = *data.getRemote(i);
+      if (td.popped.empty())
+        continue;
+      if (!earliest || before(td.popped.front(), *earliest))
+        earliest = &td.popped.front();
+      if (!td.heap.empty() && (!limit || before(td.popped.back(), *limit)))
+        limit = &td.popped.back();
+    }
+    done = !earliest;
+    if (!done)
+      ++rounds;
+  }
+
+  void markNeighborhoods(ThreadData& td) {
+    td.numWindow = 0;
+    for (auto& item : td.popped) {
+      if (limit && before(*limit, item)) {
+        // past the window; a later round will pick it up again
+        pushHeap(td, item);
+        continue;
+      }
+      if (td.numWindow == td.contexts.size())
+        td.contexts.emplace_back(item, cmp);
+      else
+        td.contexts[td.numWindow].reset(item);
+      Context& ctx = td.contexts[td.numWindow++];
+      setThreadContext(&ctx);
+      nhFunc(ctx.item);
+    }
+    setThreadContext(nullptr);
+  }
+
+  size_t executeSources(ThreadData& td) {
+    size_t executed = 0;
+    for (size_t i = 0; i < td.numWindow; ++i) {
+      Context& ctx = td.contexts[i];
+      if (!ctx.isReady())
+        continue;
+      if (!before(*earliest, ctx.item) || isStable(ctx.item)) {
+        ctx.firstPass = false;
+        setThreadContext(&ctx);
+        td.userCtx.resetAlloc();
+        opFunc(ctx.item, td.userCtx.data());
+        for (auto& pushed : td.userCtx.getPushBuffer()) {
+          assert(!before(pushed, ctx.item) &&
+                 "ordered operator created a task earlier than itself");
+          pushHeap(td, pushed);
+        }
+        td.userCtx.resetPushBuffer();
+        ++executed;
+      } else {
+        // a source that may still be preceded by a task yet to be created
+        ctx.markNotReady();
+      }
+    }
+    setThreadContext(nullptr);
+    return executed;
+  }
+
+  void releaseWindow(ThreadData& td) {
+    for (size_t i = 0; i < td.numWindow; ++i) {
+      Context& ctx = td.contexts[i];
+      if (!ctx.isReady()) {
+        pushHeap(td, ctx.item);
+        ++td.conflicts;
+      } else {
+        ++td.commits;
+      }
+      ctx.commitIteration();
+    }
+  }
+
+  //! Thread 0: adapts the window size to the commit ratio of the last round
+  void resize() {
+    size_t window  = roundWindow.exchange(0);
+    size_t commits = roundCommits.exchange(0);
+    if (!window)
+      return;
+    size_t minWindow = MIN_WINDOW_PER_THREAD * numThreads;
+    if (4 * commits >= 3 * window)
+      windowSize = 2 * windowSize;
+    else if (4 * commits < window)
+      windowSize = std::max(minWindow, windowSize / 2);
+  }
+
+  void go() {
+    unsigned tid   = substrate::ThreadPool::getTID();
+    ThreadData& td = *data.getLocal();
+
+    while (true) {
+      popShare(td);
+      barrier.wait();
+      if (tid == 0) {
+        resize();
+        computeLimit();
+      }
+      barrier.wait();
+      if (done)
+        break;
+
+      markNeighborhoods(td);
+      barrier.wait();
+
+      size_t executed = executeSources(td);
+      roundWindow += td.numWindow;
+      roundCommits += executed;
+      barrier.wait();
+
+      // the next popShare only touches thread-local heaps, so no barrier is
+      // needed before it
+      releaseWindow(td);
+    }
+  }
+
+public:
+  OrderedExecutor(const Cmp& c, const NhFunc& nh, const OpFunc& op,
+                  const StableTest& st, const char* ln)
+      : cmp(c), nhFunc(nh), opFunc(op), stableTest(st),
+        loopname(ln ? ln : "for_each_ordered"), before{c}, later{{c}},
+        barrier(getBarrier(galois::getActiveThreads())),
+        numThreads(galois::getActiveThreads()),
+        windowSize(MIN_WINDOW_PER_THREAD * galois::getActiveThreads()),
+        limit(nullptr), earliest(nullptr), done(false), rounds(0),
+        roundWindow(0),
+        roundCommits(0) {}
+
+  template <typename Iter>
+  void run(Iter beg, Iter end) {
+    galois::StatTimer timer("Time", loopname);
+    timer.start();
+
+    substrate::getThreadPool().run(numThreads, [&, this]() {
+      ThreadData& td = *data.getLocal();
+      auto range     = galois::block_range(beg, end,
+                                       substrate::ThreadPool::getTID(),
+                                       numThreads);
+      td.heap.assign(range.first, range.second);
+      std::make_heap(td.heap.begin(), td.heap.end(), later);
+      barrier.wait();
+      go();
+    });
+
+    timer.stop();
+
+    size_t commits   = 0;
+    size_t conflicts = 0;
+    for (unsigned i = 0; i < numThreads; ++i) {
+      commits += data.getRemote(i)->commits;
+      conflicts += data.getRemote(i)->conflicts;
+    }
+    reportStat_Single(loopname, "Commits", commits);
+    reportStat_Single(loopname, "Conflicts", conflicts);
+    reportStat_Single(loopname, "Rounds", rounds);
+  }
+};
+
+struct AlwaysStable {
+  template <typename T>
+  bool operator()(const T&) const {
+    return true;
+  }
+};
+
+} // namespace internal
 
 template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc>
-void for_each_ordered_impl(Iter GALOIS_UNUSED(beg), Iter GALOIS_UNUSED(end),
-                           const Cmp& GALOIS_UNUSED(cmp),
-                           const NhFunc& GALOIS_UNUSED(nhFunc),
-                           const OpFunc& GALOIS_UNUSED(opFunc),
-                           const char* GALOIS_UNUSED(loopname)) {
-  GALOIS_DIE("not yet implemented");
+void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
+                           const NhFunc& nhFunc, const OpFunc& opFunc,
+                           const char* loopname) {
+  typedef typename std::iterator_traits<Iter>::value_type T;
+  internal::AlwaysStable stable;
+  internal::OrderedExecutor<T, Cmp, NhFunc, OpFunc, internal::AlwaysStable> e(
+      cmp, nhFunc, opFunc, stable, loopname);
+  e.run(beg, end);
 }
 
 template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc,
           typename StableTest>
-void for_each_ordered_impl(Iter GALOIS_UNUSED(beg), Iter GALOIS_UNUSED(end),
-                           const Cmp& GALOIS_UNUSED(cmp),
-                           const NhFunc& GALOIS_UNUSED(nhFunc),
-                           const OpFunc& GALOIS_UNUSED(opFunc),
-                           const StableTest& GALOIS_UNUSED(stabilityTest),
-                           const char* GALOIS_UNUSED(loopname)) {
-  GALOIS_DIE("not yet implemented");
+void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
+                           const NhFunc& nhFunc, const OpFunc& opFunc,
+                           const StableTest& stabilityTest,
+                           const char* loopname) {
+  typedef typename std::iterator_traits<Iter>::value_type T;
+  internal::OrderedExecutor<T, Cmp, NhFunc, OpFunc, StableTest> e(
+      cmp, nhFunc, opFunc, stabilityTest, loopname);
+  e.run(beg, end);
 }
 
 } // end namespace runtime
@@ -0,0 +1,88 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/graphs/LC_CSR_Graph.h"
+
+#include <vector>
+
+// Graphs built with fromArrays use the caller's arrays in place.
+
+void testVoidEdges() {
+  typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_no_lockable<
+      true>::type Graph;
+
+  // 0 -> 1, 2; 1 -> 2; 2 -> (none); 3 -> 0
+  std::vector<uint64_t> offsets{0, 2, 3, 3, 4};
+  std::vector<uint32_t> dsts{1, 2, 2, 0};
+
+  Graph g;
+  g.fromArrays(4, offsets.data(), dsts.data());
+  GALOIS_ASSERT(g.size() == 4 && g.sizeEdges() == 4);
+
+  std::vector<uint32_t> degree{2, 1, 0, 1};
+  for (auto n : g) {
+    GALOIS_ASSERT(std::distance(g.edge_begin(n), g.edge_end(n)) ==
+                      (long)degree[n],
+                  "wrong degree of node ", n);
+  }
+
+  // no copy: changes to the arrays are visible through the graph
+  dsts[3] = 2;
+  GALOIS_ASSERT(g.getEdgeDst(*g.edge_begin(3)) == 2);
+
+  // node data is owned by the graph
+  galois::do_all(galois::iterate(g), [&](uint32_t n) { g.getData(n) = 0; });
+  galois::do_all(galois::iterate(g), [&](uint32_t n) {
+    for (auto e : g.edges(n))
+      __sync_fetch_and_add(&g.getData(g.getEdgeDst(e)), 1);
+  });
+  std::vector<uint32_t> inDegree{0, 1, 3, 0};
+  for (auto n : g)
+    GALOIS_ASSERT(g.getData(n) == inDegree[n], "wrong in-degree of node ", n);
+}
+
+void testEdgeValues() {
+  typedef galois::graphs::LC_CSR_Graph<uint32_t, float> Graph;
+
+  std::vector<uint64_t> offsets{0, 1, 3};
+  std::vector<uint32_t> dsts{1, 0, 1};
+  std::vector<float> weights{0.5f, 1.5f, 2.5f};
+
+  Graph g;
+  g.fromArrays(2, offsets.data(), dsts.data(), weights.data());
+  float sum = 0;
+  for (auto n : g)
+    for (auto e : g.edges(n))
+      sum += g.getEdgeData(e);
+  GALOIS_ASSERT(sum == 4.5f);
+
+  weights[0] = 10;
+  GALOIS_ASSERT(g.getEdgeData(*g.edge_begin(0)) == 10);
+}
+
+int main() {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(2);
+
+  testVoidEdges();
+  testEdgeValues();
+
+  return 0;
+}
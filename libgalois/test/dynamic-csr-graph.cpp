@@ -0,0 +1,157 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/graphs/LC_Dynamic_CSR_Graph.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using Graph = galois::graphs::LC_Dynamic_CSR_Graph<unsigned, unsigned>::
+    with_no_lockable<true>::type;
+using VoidGraph =
+    galois::graphs::LC_Dynamic_CSR_Graph<unsigned, void>::with_no_lockable<
+        true>::type;
+
+//! reference model: (src, dst) -> edge data of every copy of the edge
+using Model = std::map<std::pair<unsigned, unsigned>, std::vector<unsigned>>;
+
+void check(Graph& g, const Model& model, const std::string& prefix) {
+  Model actual;
+  size_t edges = 0;
+  for (auto n : g) {
+    for (auto e : g.edges(n)) {
+      actual[std::make_pair(n, g.getEdgeDst(e))].push_back(g.getEdgeData(e));
+      ++edges;
+    }
+  }
+  GALOIS_ASSERT(edges == g.sizeEdges(), prefix);
+  GALOIS_ASSERT(g.sizeEdges() <= g.capacityEdges(), prefix);
+  // parallel edges of one batch may be inserted in any order
+  Model expected = model;
+  for (auto& kv : actual)
+    std::sort(kv.second.begin(), kv.second.end());
+  for (auto& kv : expected)
+    std::sort(kv.second.begin(), kv.second.end());
+  GALOIS_ASSERT(actual == expected, prefix);
+}
+
+void testWeighted(unsigned numNodes, unsigned numBatches, unsigned batchSize) {
+  Graph g;
+  g.constructEmpty(numNodes);
+  Model model;
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<unsigned> node(0, numNodes - 1);
+  for (unsigned b = 0; b < numBatches; ++b) {
+    std::vector<Graph::EdgeInsertion> insertions;
+    for (unsigned i = 0; i < batchSize; ++i) {
+      Graph::EdgeInsertion ins{node(gen), node(gen), b * batchSize + i};
+      insertions.push_back(ins);
+      model[std::make_pair(ins.src, ins.dst)].push_back(ins.data);
+    }
+    g.insertEdges(insertions);
+    check(g, model, "insert batch " + std::to_string(b));
+
+    // delete roughly a third of the batch
+    std::vector<Graph::EdgeDeletion> deletions;
+    for (unsigned i = 0; i < batchSize; i += 3) {
+      auto edge = std::make_pair(insertions[i].src, insertions[i].dst);
+      deletions.push_back(edge);
+      model.erase(edge);
+    }
+    g.deleteEdges(deletions);
+    check(g, model, "delete batch " + std::to_string(b));
+  }
+
+  // deleting everything must leave an empty, compacted graph
+  std::vector<Graph::EdgeDeletion> all;
+  for (auto& kv : model)
+    all.push_back(kv.first);
+  g.deleteEdges(all);
+  model.clear();
+  check(g, model, "delete all");
+}
+
+void testVoid(unsigned numNodes) {
+  VoidGraph g;
+  g.constructEmpty(numNodes);
+
+  // a ring inserted three times; the third copy exceeds the default slack
+  // and forces a rebuild
+  for (unsigned round = 0; round < 3; ++round) {
+    std::vector<VoidGraph::EdgeInsertion> ring;
+    for (unsigned n = 0; n < numNodes; ++n)
+      ring.push_back({n, (n + 1) % numNodes});
+    g.insertEdges(ring);
+  }
+  GALOIS_ASSERT(g.sizeEdges() == 3 * numNodes);
+  for (auto n : g) {
+    GALOIS_ASSERT(std::distance(g.edge_begin(n), g.edge_end(n)) == 3);
+    GALOIS_ASSERT(g.getEdgeDst(g.findEdge(n, (n + 1) % numNodes)) ==
+                  (n + 1) % numNodes);
+  }
+}
+
+void testRelocation(unsigned numNodes) {
+  VoidGraph g;
+  g.constructEmpty(numNodes);
+  std::vector<VoidGraph::EdgeInsertion> ring;
+  for (unsigned n = 0; n < numNodes; ++n)
+    ring.push_back({n, (n + 1) % numNodes});
+  g.insertEdges(ring);
+
+  std::vector<uint64_t> starts;
+  for (auto n : g)
+    starts.push_back(*g.edge_begin(n));
+  size_t capacity = g.capacityEdges();
+
+  // overflowing one node moves only that node
+  std::vector<VoidGraph::EdgeInsertion> hub;
+  for (unsigned i = 0; i < 16; ++i)
+    hub.push_back({0, i});
+  g.insertEdges(hub);
+  GALOIS_ASSERT(g.capacityEdges() == capacity, "overflow rebuilt the graph");
+  GALOIS_ASSERT(std::distance(g.edge_begin(0), g.edge_end(0)) == 17);
+  GALOIS_ASSERT(g.getEdgeDst(g.edge_begin(0)) == 1);
+  for (unsigned n = 1; n < numNodes; ++n)
+    GALOIS_ASSERT(*g.edge_begin(n) == starts[n], "node ", n, " moved");
+
+  // deleting from a sparse graph frees too little to compact
+  g.deleteEdges({std::make_pair(1u, 2u)});
+  GALOIS_ASSERT(g.capacityEdges() == capacity, "sparse graph was compacted");
+  GALOIS_ASSERT(*g.edge_begin(2) == starts[2]);
+}
+
+int main() {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(4);
+
+  testWeighted(50, 20, 200);
+  testWeighted(2000, 5, 10000);
+  testVoid(1000);
+  testRelocation(1000);
+
+  std::cout << "OK\n";
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/HierarchicalBitset.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+void check(const galois::HierarchicalBitSet& bitset,
+           const std::set<uint32_t>& expected, const std::string& prefix) {
+  std::vector<uint32_t> model(expected.begin(), expected.end());
+  GALOIS_ASSERT(bitset.count() == model.size(), prefix);
+  GALOIS_ASSERT(bitset.getOffsets() == model, prefix);
+
+  galois::PODResizeableArray<unsigned int> offsets;
+  GALOIS_ASSERT(bitset.getOffsets(offsets) == model.size(), prefix);
+  GALOIS_ASSERT(std::equal(model.begin(), model.end(), offsets.begin()),
+                prefix);
+
+  galois::InsertBag<uint32_t> bag;
+  bitset.for_each_set([&](size_t i) { bag.push(i); });
+  std::vector<uint32_t> visited(bag.begin(), bag.end());
+  std::sort(visited.begin(), visited.end());
+  GALOIS_ASSERT(visited == model, prefix);
+
+  // the flat bitset underneath agrees
+  GALOIS_ASSERT(bitset.get_bitset().count() == model.size(), prefix);
+}
+
+void testRandom(size_t numBits, size_t numSet) {
+  galois::HierarchicalBitSet bitset;
+  bitset.resize(numBits);
+  std::set<uint32_t> expected;
+  check(bitset, expected, "empty");
+
+  std::mt19937 gen(numBits);
+  std::uniform_int_distribution<uint32_t> bit(0, numBits - 1);
+  std::vector<uint32_t> toSet;
+  for (size_t i = 0; i < numSet; ++i)
+    toSet.push_back(bit(gen));
+  // duplicates race on the same words
+  galois::do_all(galois::iterate(toSet),
+                 [&](uint32_t i) { bitset.set(i); });
+  expected.insert(toSet.begin(), toSet.end());
+  for (auto i : expected)
+    GALOIS_ASSERT(bitset.test(i));
+  check(bitset, expected, "set");
+
+  // resetting single bits leaves the summary conservative
+  std::vector<uint32_t> toReset(expected.begin(), expected.end());
+  toReset.resize(toReset.size() / 2);
+  for (auto i : toReset) {
+    GALOIS_ASSERT(bitset.reset(i));
+    expected.erase(i);
+  }
+  check(bitset, expected, "reset bits");
+
+  // direct writes to the flat bitset are picked up by the summary
+  uint32_t last = numBits - 1;
+  bitset.modify_bitset([&](galois::DynamicBitSet& bits) { bits.set(last); });
+  expected.insert(last);
+  check(bitset, expected, "rebuild");
+
+  bitset.reset();
+  expected.clear();
+  check(bitset, expected, "reset");
+  for (size_t i = 0; i < numBits; i += 997)
+    GALOIS_ASSERT(!bitset.test(i));
+
+  // a resize to the same size clears; to a new size reallocates
+  bitset.set(0);
+  bitset.resize(numBits);
+  check(bitset, expected, "same resize");
+  bitset.resize(numBits + 4096);
+  bitset.set(numBits + 4095);
+  expected.insert(numBits + 4095);
+  check(bitset, expected, "grow");
+}
+
+void testDense(size_t numBits) {
+  galois::HierarchicalBitSet bitset;
+  bitset.resize(numBits);
+  std::set<uint32_t> expected;
+  galois::do_all(galois::iterate(size_t{0}, numBits),
+                 [&](size_t i) { bitset.set(i); });
+  for (size_t i = 0; i < numBits; ++i)
+    expected.insert(i);
+  check(bitset, expected, "dense");
+}
+
+int main() {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(4);
+
+  testRandom(100, 10);
+  testRandom(64 * 64 * 3 + 17, 500);
+  testRandom(1 << 20, 20000);
+  testDense(64 * 64 * 2 + 5);
+
+  std::cout << "OK\n";
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <vector>
+
+// Priority-ordered updates on a 2D mesh: every task reads its 4 neighbors and
+// writes its cell, so the result depends on the order of overlapping tasks.
+
+struct Cell : public galois::runtime::Lockable {
+  uint64_t value = 0;
+};
+
+struct MeshTask {
+  unsigned priority;
+  unsigned cell;
+};
+
+struct MeshTaskLess {
+  bool operator()(const MeshTask& a, const MeshTask& b) const {
+    return a.priority < b.priority;
+  }
+};
+
+struct Mesh {
+  unsigned dim;
+  std::vector<Cell> cells;
+
+  explicit Mesh(unsigned d) : dim(d), cells(d * d) {}
+
+  template <typename F>
+  void neighborhood(unsigned c, F f) {
+    unsigned x = c % dim;
+    unsigned y = c / dim;
+    f(c);
+    if (x > 0)
+      f(c - 1);
+    if (x + 1 < dim)
+      f(c + 1);
+    if (y > 0)
+      f(c - dim);
+    if (y + 1 < dim)
+      f(c + dim);
+  }
+
+  void acquire(const MeshTask& t) {
+    neighborhood(t.cell, [&](unsigned c) {
+      galois::runtime::acquire(&cells[c], galois::MethodFlag::WRITE);
+    });
+  }
+
+  void update(const MeshTask& t) {
+    uint64_t sum = 0;
+    neighborhood(t.cell, [&](unsigned c) { sum += cells[c].value; });
+    cells[t.cell].value = sum * 31 + t.priority;
+  }
+};
+
+std::vector<MeshTask> makeMeshTasks(unsigned dim, unsigned num) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<unsigned> cell(0, dim * dim - 1);
+  std::vector<unsigned> prio(num);
+  for (unsigned i = 0; i < num; ++i)
+    prio[i] = i;
+  std::shuffle(prio.begin(), prio.end(), gen);
+  std::vector<MeshTask> tasks;
+  for (unsigned i = 0; i < num; ++i)
+    tasks.push_back(MeshTask{prio[i], cell(gen)});
+  return tasks;
+}
+
+void testMesh(unsigned dim, unsigned num) {
+  auto tasks = makeMeshTasks(dim, num);
+
+  Mesh serial(dim);
+  auto sorted = tasks;
+  std::sort(sorted.begin(), sorted.end(), MeshTaskLess());
+  for (auto& t : sorted)
+    serial.update(t);
+
+  Mesh ordered(dim);
+  galois::for_each_ordered(
+      tasks.begin(), tasks.end(), MeshTaskLess(),
+      [&](const MeshTask& t) { ordered.acquire(t); },
+      [&](const MeshTask& t, galois::UserContext<MeshTask>&) {
+        ordered.update(t);
+      },
+      "ordered-mesh");
+
+  for (unsigned c = 0; c < dim * dim; ++c)
+    GALOIS_ASSERT(serial.cells[c].value == ordered.cells[c].value,
+                  "mesh cell ", c, " differs from serial execution");
+
+}
+
+// Discrete-event simulation: events at a station are processed in time order
+// and schedule a later event at another station. Larger runs comparing the
+// executors live in lonestar/scientific/cpu/des.
+
+struct Station : public galois::runtime::Lockable {
+  std::vector<unsigned> log;
+};
+
+struct Event {
+  unsigned time;
+  unsigned station;
+  unsigned id; //!< the chain of events this event belongs to
+};
+
+struct EventLess {
+  bool operator()(const Event& a, const Event& b) const {
+    return a.time < b.time;
+  }
+};
+
+struct EventGreater {
+  bool operator()(const Event& a, const Event& b) const {
+    return a.time > b.time;
+  }
+};
+
+struct Simulation {
+  unsigned horizon;
+  unsigned minDelay;
+  std::vector<Station> stations;
+
+  Simulation(unsigned n, unsigned h, unsigned d)
+      : horizon(h), minDelay(d), stations(n) {}
+
+  //! processes e and returns whether it schedules a next event
+  bool process(const Event& e, Event& next) {
+    stations[e.station].log.push_back(e.time);
+    next.time    = e.time + minDelay + (e.time * 7 + e.id) % 5;
+    next.station = (e.id * 2654435761u + e.time * 40503u) % stations.size();
+    next.id      = e.id;
+    return next.time < horizon;
+  }
+};
+
+void testSimulation(unsigned numStations, unsigned numEvents, unsigned horizon,
+                    unsigned minDelay) {
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<unsigned> station(0, numStations - 1);
+  std::uniform_int_distribution<unsigned> time(0, horizon / 4);
+  std::vector<Event> initial;
+  for (unsigned i = 0; i < numEvents; ++i)
+    initial.push_back(Event{time(gen), station(gen), i});
+
+  Simulation serial(numStations, horizon, minDelay);
+  std::priority_queue<Event, std::vector<Event>, EventGreater> pq(
+      initial.begin(), initial.end());
+  while (!pq.empty()) {
+    Event e = pq.top();
+    pq.pop();
+    Event next;
+    if (serial.process(e, next))
+      pq.push(next);
+  }
+
+  // a new event is at least minDelay later than the one scheduling it, so
+  // events within the lookahead of the earliest pending event are stable
+  Simulation sim(numStations, horizon, minDelay);
+  galois::for_each_ordered(
+      initial.begin(), initial.end(), EventLess(),
+      [&](const Event& e) {
+        galois::runtime::acquire(&sim.stations[e.station],
+                                 galois::MethodFlag::WRITE);
+      },
+      [&](const Event& e, galois::UserContext<Event>& ctx) {
+        Event next;
+        if (sim.process(e, next))
+          ctx.push(next);
+      },
+      [&](const Event& e, const Event& earliest) {
+        return e.time < earliest.time + minDelay;
+      },
+      "ordered-des");
+
+  for (unsigned s = 0; s < numStations; ++s) {
+    auto& log = sim.stations[s].log;
+    GALOIS_ASSERT(std::is_sorted(log.begin(), log.end()), "station ", s,
+                  " processed events out of order");
+    GALOIS_ASSERT(log == serial.stations[s].log, "station ", s,
+                  " differs from serial simulation");
+  }
+}
+
+int main() {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(4);
+
+  testMesh(16, 2000);
+  testMesh(64, 10000);
+  testSimulation(64, 1000, 500, 1);
+  testSimulation(256, 2000, 500, 4);
+
+  return 0;
+}
@@ -26,14 +26,18 @@
 #ifndef _GALOIS_GLUONSUB_H_
 #define _GALOIS_GLUONSUB_H_
 
+#include <array>
 #include <unordered_map>
 #include <fstream>
+#include <numeric>
 
 #include "galois/runtime/GlobalObj.h"
 #include "galois/runtime/DistStats.h"
 #include "galois/runtime/SyncStructures.h"
 #include "galois/runtime/DataCommMode.h"
 #include "galois/DynamicBitset.h"
+#include "galois/HierarchicalBitset.h"
+#include "galois/ParallelSTL.h"
 
 #ifdef GALOIS_ENABLE_GPU
 #include "galois/cuda/HostDecls.h"
@@ -122,12 +126,23 @@ private:
   std::vector<std::vector<size_t>>& mirrorNodes;
   //! Maximum size of master or mirror nodes on different hosts
   size_t maxSharedSize;
+  //! Positions in masterNodes[h] sorted by local id, for each host h
+  std::vector<std::vector<uint32_t>> masterOrder;
+  //! Positions in mirrorNodes[h] sorted by local id, for each host h
+  std::vector<std::vector<uint32_t>> mirrorOrder;
+
+  //! Masters, mirrors and edges of every host, gathered during
+  //! communication setup for the partition report
+  std::vector<std::array<uint64_t, 3>> hostProxyCounts;
+  //! mirrorsByMaster[h][x] = number of mirrors on host h whose master is on
+  //! host x (the communication matrix)
+  std::vector<std::vector<uint64_t>> mirrorsByMaster;
 
 #ifdef GALOIS_USE_BARE_MPI
   std::vector<MPI_Group> mpi_identity_groups;
 #endif
   // Used for efficient comms
-  galois::DynamicBitSet syncBitset;
+  galois::HierarchicalBitSet syncBitset;
   galois::PODResizeableArray<unsigned int> syncOffsets;
 
   /**
@@ -216,6 +231,17 @@ private:
     uint64_t global_total_mirror_nodes =
         userGraph.size() - userGraph.numMasters();
     uint64_t global_total_owned_nodes = userGraph.numMasters();
+    uint64_t local_edges              = userGraph.sizeEdges();
+    std::vector<uint64_t> myMirrorsByMaster(numHosts);
+    for (unsigned x = 0; x < numHosts; ++x) {
+      myMirrorsByMaster[x] = mirrorNodes[x].size();
+    }
+
+    hostProxyCounts.assign(numHosts, {0, 0, 0});
+    mirrorsByMaster.assign(numHosts, std::vector<uint64_t>());
+    hostProxyCounts[id] = {global_total_owned_nodes, global_total_mirror_nodes,
+                           local_edges};
+    mirrorsByMaster[id] = myMirrorsByMaster;
 
     // send info to host
     for (unsigned x = 0; x < numHosts; ++x) {
@@ -223,7 +249,8 @@ private:
         continue;
 
       galois::runtime::SendBuffer b;
-      gSerialize(b, global_total_mirror_nodes, global_total_owned_nodes);
+      gSerialize(b, global_total_mirror_nodes, global_total_owned_nodes,
+                 local_edges, myMirrorsByMaster);
       net.sendTagged(x, galois::runtime::evilPhase, b);
     }
 
@@ -239,8 +266,14 @@ private:
 
       uint64_t total_mirror_nodes_from_others;
       uint64_t total_owned_nodes_from_others;
+      uint64_t edges_from_others;
       galois::runtime::gDeserialize(p->second, total_mirror_nodes_from_others,
-                                    total_owned_nodes_from_others);
+                                    total_owned_nodes_from_others,
+                                    edges_from_others,
+                                    mirrorsByMaster[p->first]);
+      hostProxyCounts[p->first] = {total_owned_nodes_from_others,
+                                   total_mirror_nodes_from_others,
+                                   edges_from_others};
       global_total_mirror_nodes += total_mirror_nodes_from_others;
       global_total_owned_nodes += total_owned_nodes_from_others;
     }
@@ -253,6 +286,33 @@ private:
     }
   }
 
+  /**
+   * Computes, for every host, the permutation of its shared nodes that sorts
+   * them by local id.
+   *
+   * @param shared master or mirror nodes (local ids) of every host
+   * @param order OUTPUT: order[h] lists the positions in shared[h] in
+   * increasing order of local id
+   */
+  void sortSharedNodes(const std::vector<std::vector<size_t>>& shared,
+                       std::vector<std::vector<uint32_t>>& order) {
+    order.resize(shared.size());
+    for (uint32_t h = 0; h < shared.size(); ++h) {
+      const auto& nodes = shared[h];
+      order[h].resize(nodes.size());
+      std::iota(order[h].begin(), order[h].end(), 0);
+      galois::ParallelSTL::sort(
+          order[h].begin(), order[h].end(),
+          [&](uint32_t a, uint32_t b) { return nodes[a] < nodes[b]; });
+    }
+  }
+
+  //! Sorted positions of the nodes this host extracts for host h
+  template <SyncType syncType>
+  const std::vector<uint32_t>& sharedOrder(unsigned h) const {
+    return (syncType == syncReduce) ? mirrorOrder[h] : masterOrder[h];
+  }
+
   /**
    * Sets up the communication between the different hosts that contain
    * different parts of the graph by exchanging master/mirror information.
@@ -295,6 +355,9 @@ private:
           galois::no_stats());
     }
 
+    sortSharedNodes(masterNodes, masterOrder);
+    sortSharedNodes(mirrorNodes, mirrorOrder);
+
     Tcomm_setup.stop();
 
     maxSharedSize = 0;
@@ -350,6 +413,60 @@ private:
         RNAME, "TotalNodes", userGraph.globalSize());
     galois::runtime::reportStatCond_Single<MORE_DIST_STATS>(
         RNAME, "TotalGlobalMirrorNodes", global_total_mirror_nodes);
+
+    // max over mean across hosts
+    galois::runtime::reportStat_Single(RNAME, "MasterImbalance",
+                                       proxyImbalance(0)[1]);
+    galois::runtime::reportStat_Single(RNAME, "EdgeImbalance",
+                                       proxyImbalance(2)[1]);
+  }
+
+  /**
+   * Min, max/mean and mean across hosts of one column of hostProxyCounts.
+   *
+   * @param column 0 for masters, 1 for mirrors, 2 for edges
+   * @returns {min/mean, max/mean, mean}; ratios are 1 if the mean is 0
+   */
+  std::array<double, 3> proxyImbalance(unsigned column) const {
+    uint64_t minCount = std::numeric_limits<uint64_t>::max();
+    uint64_t maxCount = 0;
+    double total      = 0;
+    for (auto& counts : hostProxyCounts) {
+      minCount = std::min(minCount, counts[column]);
+      maxCount = std::max(maxCount, counts[column]);
+      total += counts[column];
+    }
+    double mean = total / hostProxyCounts.size();
+    if (mean == 0) {
+      return {1, 1, 0};
+    }
+    return {minCount / mean, maxCount / mean, mean};
+  }
+
+  /**
+   * Estimated bytes moved by one reduce or one broadcast of a field if every
+   * proxy is updated: each mirror sends or receives one value. Ignores
+   * message metadata and the row/column restriction of Cartesian cuts, so it
+   * is an upper bound for a dense round.
+   */
+  uint64_t estimatedSyncBytes(size_t fieldBytes) const {
+    return totalMirrors() * fieldBytes;
+  }
+
+  //! @returns number of mirrors on all hosts
+  uint64_t totalMirrors() const {
+    uint64_t mirrors = 0;
+    for (auto& counts : hostProxyCounts) {
+      mirrors += counts[1];
+    }
+    return mirrors;
+  }
+
+  //! @returns replication factor from the gathered proxy counts
+  double gatheredReplicationFactor() const {
+    uint64_t globalNodes = userGraph.globalSize();
+    return globalNodes ? (double)(globalNodes + totalMirrors()) / globalNodes
+                       : 1.0;
   }
 
   ////////////////////////////////////////////////////////////////////////////////
@@ -458,6 +575,87 @@ public:
     Tgraph_construct_comm.stop();
   }
 
+  ////////////////////////////////////////////////////////////////////////////////
+  // Partition quality report
+  ////////////////////////////////////////////////////////////////////////////////
+
+  /**
+   * Prints partition quality gathered during communication setup: replication
+   * factor, per-host masters/mirrors/edges, load imbalance, the
+   * communication matrix and estimated bytes per sync. Every host has the
+   * data; callers normally print on one host.
+   *
+   * @param fieldBytes size of one synchronized value in bytes
+   */
+  void printPartitionReport(size_t fieldBytes) const {
+    uint64_t syncBytes = estimatedSyncBytes(fieldBytes);
+    galois::gPrint("Partition report (", numHosts, " hosts)\n",
+                   "  replication factor: ", gatheredReplicationFactor(),
+                   "\n  host masters mirrors edges\n");
+    for (unsigned h = 0; h < numHosts; ++h) {
+      galois::gPrint("  ", h, "  ", hostProxyCounts[h][0], "  ",
+                     hostProxyCounts[h][1], "  ", hostProxyCounts[h][2], "\n");
+    }
+    const char* names[3] = {"masters", "mirrors", "edges"};
+    for (unsigned c = 0; c < 3; ++c) {
+      auto imbalance = proxyImbalance(c);
+      galois::gPrint("  ", names[c], " min/mean ", imbalance[0],
+                     " max/mean ", imbalance[1], " mean ", imbalance[2],
+                     "\n");
+    }
+    galois::gPrint("  mirrors on host (row) mastered on host (column):\n");
+    for (unsigned h = 0; h < numHosts; ++h) {
+      galois::gPrint("   ");
+      for (unsigned x = 0; x < numHosts; ++x) {
+        galois::gPrint(" ", mirrorsByMaster[h][x]);
+      }
+      galois::gPrint("\n");
+    }
+    galois::gPrint("  estimated bytes per reduce or broadcast of a ",
+                   fieldBytes, "-byte field: ", syncBytes, "\n");
+  }
+
+  /**
+   * Writes the partition report printed by printPartitionReport as JSON.
+   *
+   * @param os stream to write to
+   * @param fieldBytes size of one synchronized value in bytes
+   */
+  void writePartitionReport(std::ostream& os, size_t fieldBytes) const {
+    uint64_t syncBytes = estimatedSyncBytes(fieldBytes);
+    os << "{\n  \"hosts\": " << numHosts
+       << ",\n  \"globalNodes\": " << userGraph.globalSize()
+       << ",\n  \"globalEdges\": " << userGraph.globalSizeEdges()
+       << ",\n  \"replicationFactor\": " << gatheredReplicationFactor()
+       << ",\n  \"perHost\": [";
+    for (unsigned h = 0; h < numHosts; ++h) {
+      os << (h ? ",\n" : "\n") << "    {\"host\": " << h
+         << ", \"masters\": " << hostProxyCounts[h][0]
+         << ", \"mirrors\": " << hostProxyCounts[h][1]
+         << ", \"edges\": " << hostProxyCounts[h][2] << "}";
+    }
+    os << "\n  ],\n  \"imbalance\": {";
+    const char* names[3] = {"masters", "mirrors", "edges"};
+    for (unsigned c = 0; c < 3; ++c) {
+      auto imbalance = proxyImbalance(c);
+      os << (c ? ",\n" : "\n") << "    \"" << names[c]
+         << "\": {\"minOverMean\": " << imbalance[0]
+         << ", \"maxOverMean\": " << imbalance[1]
+         << ", \"mean\": " << imbalance[2] << "}";
+    }
+    os << "\n  },\n  \"mirrorsByMaster\": [";
+    for (unsigned h = 0; h < numHosts; ++h) {
+      os << (h ? ",\n" : "\n") << "    [";
+      for (unsigned x = 0; x < numHosts; ++x) {
+        os << (x ? ", " : "") << mirrorsByMaster[h][x];
+      }
+      os << "]";
+    }
+    os << "\n  ],\n  \"fieldBytes\": " << fieldBytes
+       << ",\n  \"estimatedReduceBytes\": " << syncBytes
+       << ",\n  \"estimatedBroadcastBytes\": " << syncBytes << "\n}\n";
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   // Data extraction from bitsets
   ////////////////////////////////////////////////////////////////////////////////
@@ -478,7 +676,7 @@ private:
    */
   template <SyncType syncType>
   void getOffsetsFromBitset(const std::string& loopName,
-                            const galois::DynamicBitSet& bitset_comm,
+                            const galois::HierarchicalBitSet& bitset_comm,
                             galois::PODResizeableArray<unsigned int>& offsets,
                             size_t& bit_set_count) const {
     // timer creation
@@ -489,74 +687,90 @@ private:
                                                       RNAME);
 
     Toffsets.start();
+    // only the non-empty words of the bitset are visited
+    bit_set_count = bitset_comm.getOffsets(offsets);
+    Toffsets.stop();
+  }
 
-    auto activeThreads = galois::getActiveThreads();
-    std::vector<unsigned int> t_prefix_bit_counts(activeThreads);
-
-    // count how many bits are set on each thread
-    galois::on_each([&](unsigned tid, unsigned nthreads) {
-      // TODO use block_range instead
-      unsigned int block_size = bitset_comm.size() / nthreads;
-      if ((bitset_comm.size() % nthreads) > 0)
-        ++block_size;
-      assert((block_size * nthreads) >= bitset_comm.size());
-
-      unsigned int start = tid * block_size;
-      unsigned int end   = (tid + 1) * block_size;
-      if (end > bitset_comm.size())
-        end = bitset_comm.size();
-
-      unsigned int count = 0;
-      for (unsigned int i = start; i < end; ++i) {
-        if (bitset_comm.test(i))
-          ++count;
-      }
+  /**
+   * Sets bit n of bitset_comm for every position n of indices whose node is
+   * set in bitset_compute by testing every index.
+   *
+   * @param doall_str name of the loop
+   * @param indices local ids of the nodes that may need to be synchronized
+   * @param bitset_compute bitset of the nodes that were updated
+   * @param bitset_comm OUTPUT: positions in indices of the updated nodes
+   */
+  template <typename BitsetTy>
+  void markUpdatedIndicesDense(const std::string& GALOIS_UNUSED(doall_str),
+                               const std::vector<size_t>& indices,
+                               const BitsetTy& bitset_compute,
+                               galois::HierarchicalBitSet& bitset_comm) const {
+    galois::do_all(
+        galois::iterate(size_t{0}, indices.size()),
+        [&](size_t n) {
+          // assumes each lid is unique as test is not thread safe
+          size_t lid = indices[n];
+          if (bitset_compute.test(lid)) {
+            bitset_comm.set(n);
+          }
+        },
+#if GALOIS_COMM_STATS
+        galois::loopname(get_run_identifier(doall_str).c_str()),
+#endif
+        galois::no_stats());
+  }
 
-      t_prefix_bit_counts[tid] = count;
-    });
+  //! Flat compute bitsets can only be tested index by index
+  void markUpdatedIndices(const std::string& doall_str,
+                          const std::vector<size_t>& indices,
+                          const std::vector<uint32_t>&,
+                          const galois::DynamicBitSet& bitset_compute,
+                          galois::HierarchicalBitSet& bitset_comm) const {
+    markUpdatedIndicesDense(doall_str, indices, bitset_compute, bitset_comm);
+  }
 
-    // calculate prefix sum of bits per thread
-    for (unsigned int i = 1; i < activeThreads; ++i) {
-      t_prefix_bit_counts[i] += t_prefix_bit_counts[i - 1];
+  /**
+   * Hierarchical compute bitsets: when few nodes were updated, walks the set
+   * bits of bitset_compute through its summary and finds the position of each
+   * updated node in indices by binary search over order, instead of testing
+   * every index. Late rounds, in which few nodes change, then cost time
+   * proportional to the number of updates rather than to the number of
+   * shared nodes.
+   *
+   * @param order positions in indices sorted by local id
+   */
+  void markUpdatedIndices(const std::string& doall_str,
+                          const std::vector<size_t>& indices,
+                          const std::vector<uint32_t>& order,
+                          const galois::HierarchicalBitSet& bitset_compute,
+                          galois::HierarchicalBitSet& bitset_comm) const {
+    size_t updated = bitset_compute.count();
+    if (updated == 0) {
+      return;
+    }
+    // a search costs about log2(indices.size()) tests
+    size_t searchCost = 1;
+    while ((size_t{1} << searchCost) < indices.size()) {
+      ++searchCost;
+    }
+    if (updated * searchCost >= indices.size()) {
+      markUpdatedIndicesDense(doall_str, indices, bitset_compute, bitset_comm);
+      return;
     }
-    // total num of set bits
-    bit_set_count = t_prefix_bit_counts[activeThreads - 1];
-
-    // calculate the indices of the set bits and save them to the offset
-    // vector
-    if (bit_set_count > 0) {
-      offsets.resize(bit_set_count);
-      galois::on_each([&](unsigned tid, unsigned nthreads) {
-        // TODO use block_range instead
-        // TODO this is same calculation as above; maybe refactor it
-        // into function?
-        unsigned int block_size = bitset_comm.size() / nthreads;
-        if ((bitset_comm.size() % nthreads) > 0)
-          ++block_size;
-        assert((block_size * nthreads) >= bitset_comm.size());
-
-        unsigned int start = tid * block_size;
-        unsigned int end   = (tid + 1) * block_size;
-        if (end > bitset_comm.size())
-          end = bitset_comm.size();
-
-        unsigned int count = 0;
-        unsigned int t_prefix_bit_count;
-        if (tid == 0) {
-          t_prefix_bit_count = 0;
-        } else {
-          t_prefix_bit_count = t_prefix_bit_counts[tid - 1];
-        }
 
-        for (unsigned int i = start; i < end; ++i) {
-          if (bitset_comm.test(i)) {
-            offsets[t_prefix_bit_count + count] = i;
-            ++count;
+    auto byLID = [&](uint32_t pos, size_t lid) { return indices[pos] < lid; };
+    bitset_compute.for_each_set(
+        [&](size_t lid) {
+          auto it = std::lower_bound(order.begin(), order.end(), lid, byLID);
+          if (it != order.end() && indices[*it] == lid) {
+            bitset_comm.set(*it);
           }
-        }
-      });
-    }
-    Toffsets.stop();
+        },
+#if GALOIS_COMM_STATS
+        galois::loopname(get_run_identifier(doall_str).c_str()),
+#endif
+        galois::no_stats());
   }
 
   /**
@@ -572,6 +786,7 @@ private:
    * @param loopName loopname used to name the timer for the function
    * @param indices A vector that contains the local ids of the nodes that
    * you want to potentially synchronize
+   * @param order positions in indices sorted by local id
    * @param bitset_compute Contains the full bitset of all nodes in this
    * graph
    * @param bitset_comm OUTPUT: bitset that marks which indices in the passed
@@ -581,16 +796,16 @@ private:
    * @param data_mode OUTPUT: the way that this data should be communicated
    * based on how much data needs to be sent out
    */
-  template <typename FnTy, SyncType syncType>
+  template <typename FnTy, SyncType syncType, typename BitsetTy>
   void getBitsetAndOffsets(const std::string& loopName,
                            const std::vector<size_t>& indices,
-                           const galois::DynamicBitSet& bitset_compute,
-                           galois::DynamicBitSet& bitset_comm,
+                           const std::vector<uint32_t>& order,
+                           const BitsetTy& bitset_compute,
+                           galois::HierarchicalBitSet& bitset_comm,
                            galois::PODResizeableArray<unsigned int>& offsets,
                            size_t& bit_set_count,
                            DataCommMode& data_mode) const {
     if (substrateDataMode != onlyData) {
-      bitset_comm.reset();
       std::string syncTypeStr =
           (syncType == syncReduce) ? "Reduce" : "Broadcast";
       std::string doall_str(syncTypeStr + "Bitset_" + loopName);
@@ -598,19 +813,8 @@ private:
       bitset_comm.reset();
       // determine which local nodes in the indices array need to be
       // sychronized
-      galois::do_all(
-          galois::iterate(size_t{0}, indices.size()),
-          [&](size_t n) {
-            // assumes each lid is unique as test is not thread safe
-            size_t lid = indices[n];
-            if (bitset_compute.test(lid)) {
-              bitset_comm.set(n);
-            }
-          },
-#if GALOIS_COMM_STATS
-          galois::loopname(get_run_identifier(doall_str).c_str()),
-#endif
-          galois::no_stats());
+      markUpdatedIndices(doall_str, indices, order, bitset_compute,
+                         bitset_comm);
 
       // get the number of set bits and the offsets into the comm bitset
       getOffsetsFromBitset<syncType>(loopName, bitset_comm, offsets,
@@ -741,6 +945,9 @@ private:
                                   get_run_identifier(loopName));
 
     galois::runtime::reportStat_Tsum(RNAME, statSendBytes_str, b.size());
+    // all syncs of the run, for comparison with -partition=auto predictions
+    galois::runtime::reportStat_Tsum(
+        RNAME, "SyncBytes_" + std::to_string(num_run), b.size());
   }
   template <
       SyncType syncType, typename SyncFnTy, typename BitsetFnTy, typename VecTy,
@@ -758,6 +965,9 @@ private:
                                   get_run_identifier(loopName));
 
     galois::runtime::reportStat_Tsum(RNAME, statSendBytes_str, b.size());
+    // all syncs of the run, for comparison with -partition=auto predictions
+    galois::runtime::reportStat_Tsum(
+        RNAME, "SyncBytes_" + std::to_string(num_run), b.size());
   }
 
   /**
@@ -781,7 +991,8 @@ private:
   void serializeMessage(std::string loopName, DataCommMode data_mode,
                         size_t bit_set_count, std::vector<size_t>& indices,
                         galois::PODResizeableArray<unsigned int>& offsets,
-                        galois::DynamicBitSet& bit_set_comm, VecType& val_vec,
+                        galois::HierarchicalBitSet& bit_set_comm,
+                        VecType& val_vec,
                         galois::runtime::SendBuffer& b) {
     std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
     std::string serialize_timer_str(syncTypeStr + "SerializeMessage_" +
@@ -810,7 +1021,8 @@ private:
     } else if (data_mode == bitsetData) {
       val_vec.resize(bit_set_count);
       Tserialize.start();
-      gSerialize(b, data_mode, bit_set_count, bit_set_comm, val_vec);
+      gSerialize(b, data_mode, bit_set_count, bit_set_comm.get_bitset(),
+                 val_vec);
       Tserialize.stop();
     } else { // onlyData
       Tserialize.start();
@@ -848,7 +1060,7 @@ private:
                           uint32_t num, galois::runtime::RecvBuffer& buf,
                           size_t& bit_set_count,
                           galois::PODResizeableArray<unsigned int>& offsets,
-                          galois::DynamicBitSet& bit_set_comm,
+                          galois::HierarchicalBitSet& bit_set_comm,
                           size_t& buf_start, size_t& retval, VecType& val_vec) {
     std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
     std::string serialize_timer_str(syncTypeStr + "DeserializeMessage_" +
@@ -868,7 +1080,9 @@ private:
         galois::runtime::gDeserialize(buf, offsets);
       } else if (data_mode == bitsetData) {
         bit_set_comm.resize(num);
-        galois::runtime::gDeserialize(buf, bit_set_comm);
+        bit_set_comm.modify_bitset([&](galois::DynamicBitSet& bits) {
+          galois::runtime::gDeserialize(buf, bits);
+        });
       } else if (data_mode == dataSplit) {
         galois::runtime::gDeserialize(buf, buf_start);
       } else if (data_mode == dataSplitFirst) {
@@ -1047,10 +1261,11 @@ private:
   template <typename SyncFnTy>
   void reportRedundantSize(std::string loopName, std::string syncTypeStr,
                            uint32_t totalToSend, size_t bitSetCount,
-                           const galois::DynamicBitSet& bitSetComm) {
+                           const galois::HierarchicalBitSet& bitSetComm) {
     size_t redundant_size =
         (totalToSend - bitSetCount) * sizeof(typename SyncFnTy::ValTy);
-    size_t bit_set_size = (bitSetComm.get_vec().size() * sizeof(uint64_t));
+    size_t bit_set_size =
+        (bitSetComm.get_bitset().get_vec().size() * sizeof(uint64_t));
 
     if (redundant_size > bit_set_size) {
       std::string statSavedBytes_str(syncTypeStr + "SavedBytes_" +
@@ -1375,9 +1590,9 @@ private:
    * @param bit_set_compute bitset indicating which nodes have changed; updated
    * if reduction causes a change
    */
-  template <typename FnTy, SyncType syncType, bool async>
+  template <typename FnTy, SyncType syncType, bool async, typename BitsetTy>
   inline void setWrapper(size_t lid, typename FnTy::ValTy val,
-                         galois::DynamicBitSet& bit_set_compute) {
+                         BitsetTy& bit_set_compute) {
     if (syncType == syncReduce) {
       if (FnTy::reduce(lid, userGraph.getData(lid), val)) {
         if (bit_set_compute.size() != 0)
@@ -1407,10 +1622,9 @@ private:
    * if reduction causes a change
    * @param vecIndex which element of the vector to reduce in the node
    */
-  template <typename FnTy, SyncType syncType, bool async>
+  template <typename FnTy, SyncType syncType, bool async, typename BitsetTy>
   inline void setWrapper(size_t lid, typename FnTy::ValTy val,
-                         galois::DynamicBitSet& bit_set_compute,
-                         unsigned vecIndex) {
+                         BitsetTy& bit_set_compute, unsigned vecIndex) {
     if (syncType == syncReduce) {
       if (FnTy::reduce(lid, userGraph.getData(lid), val, vecIndex)) {
         if (bit_set_compute.size() != 0)
@@ -1449,11 +1663,11 @@ private:
    */
   template <typename IndicesVecTy, typename FnTy, SyncType syncType,
             typename VecTy, bool async, bool identity_offsets = false,
-            bool parallelize = true>
+            bool parallelize = true, typename BitsetTy>
   void setSubset(const std::string& loopName, const IndicesVecTy& indices,
                  size_t size,
                  const galois::PODResizeableArray<unsigned int>& offsets,
-                 VecTy& val_vec, galois::DynamicBitSet& bit_set_compute,
+                 VecTy& val_vec, BitsetTy& bit_set_compute,
                  size_t start = 0) {
     std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
     std::string doall_str(syncTypeStr + "SetVal_" +
@@ -1525,11 +1739,12 @@ private:
   template <typename IndicesVecTy, typename FnTy, SyncType syncType,
             typename VecTy, bool async, bool identity_offsets = false,
             bool parallelize = true, bool vecSync = false,
-            typename std::enable_if<vecSync>::type* = nullptr>
+            typename std::enable_if<vecSync>::type* = nullptr,
+            typename BitsetTy>
   void setSubset(const std::string& loopName, const IndicesVecTy& indices,
                  size_t size,
                  const galois::PODResizeableArray<unsigned int>& offsets,
-                 VecTy& val_vec, galois::DynamicBitSet& bit_set_compute,
+                 VecTy& val_vec, BitsetTy& bit_set_compute,
                  unsigned vecIndex, size_t start = 0) {
     std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
     std::string doall_str(syncTypeStr + "SetValVector_" +
@@ -1811,7 +2026,7 @@ private:
                    std::vector<size_t>& indices,
                    galois::runtime::SendBuffer& b) {
     uint32_t num                        = indices.size();
-    galois::DynamicBitSet& bit_set_comm = syncBitset;
+    galois::HierarchicalBitSet& bit_set_comm = syncBitset;
     static VecTy val_vec; // sometimes wasteful
     galois::PODResizeableArray<unsigned int>& offsets = syncOffsets;
 
@@ -1856,11 +2071,11 @@ private:
         offsets.resize(num);
         val_vec.resize(num);
         Textractalloc.stop();
-        const galois::DynamicBitSet& bit_set_compute = BitsetFnTy::get();
+        const auto& bit_set_compute = BitsetFnTy::get();
 
         getBitsetAndOffsets<SyncFnTy, syncType>(
-            loopName, indices, bit_set_compute, bit_set_comm, offsets,
-            bit_set_count, data_mode);
+            loopName, indices, sharedOrder<syncType>(from_id), bit_set_compute,
+            bit_set_comm, offsets, bit_set_count, data_mode);
 
         if (data_mode == onlyData) {
           bit_set_count = indices.size();
@@ -1946,10 +2161,11 @@ private:
       SyncType syncType, typename SyncFnTy, typename BitsetFnTy, typename VecTy,
       bool async,
       typename std::enable_if<BitsetFnTy::is_vector_bitset()>::type* = nullptr>
-  void syncExtract(std::string loopName, unsigned, std::vector<size_t>& indices,
+  void syncExtract(std::string loopName, unsigned from_id,
+                   std::vector<size_t>& indices,
                    galois::runtime::SendBuffer& b) {
     uint32_t num                        = indices.size();
-    galois::DynamicBitSet& bit_set_comm = syncBitset;
+    galois::HierarchicalBitSet& bit_set_comm = syncBitset;
     static VecTy val_vec; // sometimes wasteful
     galois::PODResizeableArray<unsigned int>& offsets = syncOffsets;
 
@@ -1980,11 +2196,11 @@ private:
         size_t bit_set_count = 0;
 
         // No GPU support currently
-        const galois::DynamicBitSet& bit_set_compute = BitsetFnTy::get(i);
+        const auto& bit_set_compute = BitsetFnTy::get(i);
 
         getBitsetAndOffsets<SyncFnTy, syncType>(
-            loopName, indices, bit_set_compute, bit_set_comm, offsets,
-            bit_set_count, data_mode);
+            loopName, indices, sharedOrder<syncType>(from_id), bit_set_compute,
+            bit_set_comm, offsets, bit_set_count, data_mode);
 
         // note the extra template argument which specifies that this is a
         // vector extract, i.e. get element i of the vector (i passed in as
@@ -2223,7 +2439,7 @@ private:
     galois::CondStatTimer<GALOIS_COMM_STATS> Tsetbatch(
         set_batch_timer_str.c_str(), RNAME);
 
-    galois::DynamicBitSet& bit_set_comm = syncBitset;
+    galois::HierarchicalBitSet& bit_set_comm = syncBitset;
     static VecTy val_vec;
     galois::PODResizeableArray<unsigned int>& offsets = syncOffsets;
 
@@ -2260,7 +2476,7 @@ private:
           offsets.reserve(maxSharedSize);
           val_vec.reserve(maxSharedSize);
 
-          galois::DynamicBitSet& bit_set_compute = BitsetFnTy::get();
+          auto& bit_set_compute = BitsetFnTy::get();
 
           if (data_mode == bitsetData) {
             size_t bit_set_count2;
@@ -2331,7 +2547,7 @@ private:
                               get_run_identifier(loopName));
     galois::CondStatTimer<GALOIS_COMM_STATS> Tset(set_timer_str.c_str(), RNAME);
 
-    galois::DynamicBitSet& bit_set_comm = syncBitset;
+    galois::HierarchicalBitSet& bit_set_comm = syncBitset;
     static VecTy val_vec;
     galois::PODResizeableArray<unsigned int>& offsets = syncOffsets;
 
@@ -2357,7 +2573,7 @@ private:
                                        bit_set_count, offsets, bit_set_comm,
                                        buf_start, retval, val_vec);
 
-          galois::DynamicBitSet& bit_set_compute = BitsetFnTy::get(i);
+          auto& bit_set_compute = BitsetFnTy::get(i);
 
           if (data_mode == bitsetData) {
             size_t bit_set_count2;
@@ -3082,6 +3298,230 @@ public:
     Tsync.stop();
   }
 
+  ////////////////////////////////////////////////////////////////////////////////
+  // Overlapped sync
+  ////////////////////////////////////////////////////////////////////////////////
+private:
+  //! Number of interior slices computed between polls for reduce messages
+  constexpr static unsigned OVERLAP_SLICES = 16;
+
+  //! Nodes with edges ordered boundary first, per write location; built on
+  //! first use by overlapSync
+  std::array<std::vector<uint32_t>, 3> overlapNodes;
+  //! Number of boundary nodes at the front of overlapNodes, per write location
+  std::array<size_t, 3> numBoundaryNodes;
+  //! Marks which write locations have been classified
+  std::array<bool, 3> overlapClassified{};
+  //! Reduce messages still expected by the current overlapped sync
+  unsigned overlapPending = 0;
+
+  /**
+   * Splits the nodes with edges into boundary nodes, whose updates reach a
+   * mirror, and interior nodes, whose updates stay on masters. For
+   * writeDestination a node is boundary if it has an edge to a mirror; for
+   * writeSource if it is itself a mirror; writeAny takes both.
+   *
+   * @tparam writeLocation Location data is written (src or dst)
+   */
+  template <WriteLocation writeLocation>
+  void classifyBoundaryNodes() {
+    galois::CondStatTimer<MORE_DIST_STATS> Tclassify(
+        "BoundaryClassificationTime", RNAME);
+    Tclassify.start();
+
+    const uint32_t numMasters   = userGraph.numMasters();
+    const uint32_t numWithEdges = userGraph.getNumNodesWithEdges();
+    std::vector<uint8_t> isBoundary(numWithEdges, 0);
+
+    galois::do_all(
+        galois::iterate(uint32_t{0}, numWithEdges),
+        [&](uint32_t n) {
+          if (writeLocation != writeDestination && n >= numMasters) {
+            isBoundary[n] = 1;
+            return;
+          }
+          if (writeLocation != writeSource) {
+            for (auto e : userGraph.edges(n)) {
+              if (userGraph.getEdgeDst(e) >= numMasters) {
+                isBoundary[n] = 1;
+                return;
+              }
+            }
+          }
+        },
+        galois::no_stats(), galois::steal());
+
+    auto& nodes = overlapNodes[writeLocation];
+    nodes.resize(numWithEdges);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    // stable so that both halves keep local id order
+    auto interior =
+        std::stable_partition(nodes.begin(), nodes.end(),
+                              [&](uint32_t n) { return isBoundary[n]; });
+    numBoundaryNodes[writeLocation]  = interior - nodes.begin();
+    overlapClassified[writeLocation] = true;
+
+    Tclassify.stop();
+    galois::runtime::reportStatCond_Tsum<MORE_DIST_STATS>(
+        RNAME, "BoundaryNodes", numBoundaryNodes[writeLocation]);
+  }
+
+  //! True if sync for these locations reduces mirrors onto masters
+  bool syncReduces(WriteLocation writeLocation) const {
+    if (writeLocation == writeSource) {
+      return transposed || isVertexCut;
+    } else if (writeLocation == writeDestination) {
+      return !transposed || isVertexCut;
+    }
+    return true;
+  }
+
+  //! True if sync for these locations broadcasts masters to mirrors
+  bool syncBroadcasts(ReadLocation readLocation) const {
+    if (readLocation == readSource) {
+      return transposed || isVertexCut;
+    } else if (readLocation == readDestination) {
+      return !transposed || isVertexCut;
+    }
+    return true;
+  }
+
+  /**
+   * Applies the reduce messages of the current overlapped sync that have
+   * arrived so far. When blocking, waits for all of them and closes the
+   * communication phase.
+   *
+   * @param loopName used to name timers for statistics
+   * @param block wait for every expected message if true
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            typename SyncFnTy, typename BitsetFnTy, typename VecTy, bool async>
+  void overlapRecv(std::string loopName, bool block) {
+    if (async) {
+      // bulk-asynchronous receives never wait
+      syncRecv<writeLocation, readLocation, syncReduce, SyncFnTy, BitsetFnTy,
+               VecTy, async>(loopName);
+      return;
+    }
+
+    auto& net = galois::runtime::getSystemNetworkInterface();
+    galois::CondStatTimer<GALOIS_COMM_STATS> TRecvTime(
+        ("ReduceRecv_" + get_run_identifier(loopName)).c_str(), RNAME);
+
+    TRecvTime.start();
+    while (overlapPending > 0) {
+      auto p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+      if (!p) {
+        if (!block)
+          break;
+        continue;
+      }
+      syncRecvApply<syncReduce, SyncFnTy, BitsetFnTy, VecTy, async>(
+          p->first, p->second, loopName);
+      --overlapPending;
+    }
+    if (block) {
+      incrementEvilPhase();
+    }
+    TRecvTime.stop();
+  }
+
+public:
+  /**
+   * Runs one round of a compute operator and its sync with communication
+   * overlapped. Boundary nodes are computed first and their mirror updates
+   * sent; interior nodes are then computed in slices, applying the reduce
+   * messages that have arrived after each slice. The round closes with the
+   * remaining receives and the broadcast, so the result is the same as
+   * computing all nodes with edges followed by sync.
+   *
+   * Since received values land on masters while the round is still running,
+   * the operator must tolerate reading them early, as monotone reductions
+   * (min, max, or) do. Transposed graphs, partition agnostic sync, and bare
+   * MPI fall back to compute followed by a blocking sync.
+   *
+   * @tparam writeLocation Location data is written (src or dst)
+   * @tparam readLocation Location data is read (src or dst)
+   * @tparam SyncFnTy sync structure for the field
+   * @tparam BitsetFnTy struct that has info on how to access the bitset
+   * @tparam ComputeFnTy callable taking a [begin, end) range of local node
+   * ids that runs the operator over it
+   *
+   * @param loopName used to name timers for statistics
+   * @param compute runs the operator over a range of nodes
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            typename SyncFnTy, typename BitsetFnTy = galois::InvalidBitsetFnTy,
+            bool async = false, typename ComputeFnTy>
+  void overlapSync(std::string loopName, ComputeFnTy&& compute) {
+    if (!overlapClassified[writeLocation]) {
+      classifyBoundaryNodes<writeLocation>();
+    }
+    const auto& nodes = overlapNodes[writeLocation];
+
+    bool overlap = !transposed && !partitionAgnostic;
+#ifdef GALOIS_USE_BARE_MPI
+    overlap = overlap && (bare_mpi == noBareMPI);
+#endif
+    if (!overlap) {
+      compute(nodes.cbegin(), nodes.cend());
+      sync<writeLocation, readLocation, SyncFnTy, BitsetFnTy, async>(loopName);
+      return;
+    }
+
+    typedef typename SyncFnTy::ValTy T;
+    typedef
+        typename std::conditional<galois::runtime::is_memory_copyable<T>::value,
+                                  galois::PODResizeableArray<T>,
+                                  galois::gstl::Vector<T>>::type VecTy;
+
+    std::string timer_str("Sync_" + loopName + "_" + get_run_identifier());
+    galois::StatTimer Tsync(timer_str.c_str(), RNAME);
+    const bool reduces = syncReduces(writeLocation);
+
+    auto boundaryEnd = nodes.cbegin() + numBoundaryNodes[writeLocation];
+    compute(nodes.cbegin(), boundaryEnd);
+
+    Tsync.start();
+    if (reduces) {
+      overlapPending = 0;
+      for (unsigned x = 0; x < numHosts; ++x) {
+        if (x != id &&
+            !nothingToRecv(x, syncReduce, writeLocation, readLocation)) {
+          ++overlapPending;
+        }
+      }
+      syncSend<writeLocation, readLocation, syncReduce, SyncFnTy, BitsetFnTy,
+               VecTy, async>(loopName);
+    }
+    Tsync.stop();
+
+    size_t numInterior = nodes.cend() - boundaryEnd;
+    size_t slice       = (numInterior + OVERLAP_SLICES - 1) / OVERLAP_SLICES;
+    for (auto b = boundaryEnd; b != nodes.cend();) {
+      auto e = b + std::min<size_t>(slice, nodes.cend() - b);
+      compute(b, e);
+      b = e;
+      if (reduces) {
+        Tsync.start();
+        overlapRecv<writeLocation, readLocation, SyncFnTy, BitsetFnTy, VecTy,
+                    async>(loopName, false);
+        Tsync.stop();
+      }
+    }
+
+    Tsync.start();
+    if (reduces) {
+      overlapRecv<writeLocation, readLocation, SyncFnTy, BitsetFnTy, VecTy,
+                  async>(loopName, true);
+    }
+    if (syncBroadcasts(readLocation)) {
+      broadcast<writeLocation, readLocation, SyncFnTy, BitsetFnTy, async>(
+          loopName);
+    }
+    Tsync.stop();
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   // Sync on demand code (unmaintained, may not work)
   ////////////////////////////////////////////////////////////////////////////////
@@ -31,6 +31,7 @@
 #include <galois/AtomicHelpers.h>        // for galois::max, min
 #include <galois/runtime/DataCommMode.h> // for galois::max, min
 #include <galois/gIO.h>                  // for GALOIS DIE
+#include <galois/HierarchicalBitset.h>   // for node bitsets
 
 ////////////////////////////////////////////////////////////////////////////////
 // Field flag class
@@ -1905,7 +1906,9 @@ public:
 /**
  * Sync structure for dynamic bitsets.
  *
- * Bitsets are expected to have the following naming scheme:
+ * Bitsets are expected to be galois::HierarchicalBitSet objects, so that
+ * synchronization only visits their non-empty words, with the following
+ * naming scheme:
  * bitset_<fieldname>
  *
  * In addition, you will have to declare and appropriately resize the bitset
@@ -1919,10 +1922,12 @@ public:
     static constexpr bool is_vector_bitset() { return false; }                 \
     static bool is_valid() { return true; }                                    \
                                                                                \
-    static galois::DynamicBitSet& get() {                                      \
+    static galois::HierarchicalBitSet& get() {                                 \
       if (personality == GPU_CUDA)                                             \
-        get_bitset_##fieldname##_cuda(                                         \
-            cuda_ctx, (uint64_t*)bitset_##fieldname.get_vec().data());         \
+        bitset_##fieldname.modify_bitset([](galois::DynamicBitSet& bits) {     \
+          get_bitset_##fieldname##_cuda(cuda_ctx,                              \
+                                        (uint64_t*)bits.get_vec().data());     \
+        });                                                                    \
       return bitset_##fieldname;                                               \
     }                                                                          \
                                                                                \
@@ -1943,7 +1948,7 @@ public:
                                                                                \
     static constexpr bool is_valid() { return true; }                          \
                                                                                \
-    static galois::DynamicBitSet& get() { return bitset_##fieldname; }         \
+    static galois::HierarchicalBitSet& get() { return bitset_##fieldname; }    \
                                                                                \
     static void reset_range(size_t begin, size_t end) {                        \
       bitset_##fieldname.reset(begin, end);                                    \
@@ -1955,8 +1960,9 @@ public:
  * Sync structure for a vector of dynamic bitsets. Function signatures
  * allow indexing into this vector to get the correct bitset
  *
- * Bitsets are expected to have the following naming scheme:
- * bitset_<fieldname>
+ * Bitsets are expected to be a vector of galois::HierarchicalBitSet with the
+ * following naming scheme:
+ * vbitset_<fieldname>
  *
  * In addition, you will have to declare and appropriately resize the bitset
  * in your main program as well as set the bitset appropriately (i.e. when you
@@ -1970,7 +1976,7 @@ public:
                                                                                \
     static constexpr bool is_valid() { return true; }                          \
                                                                                \
-    static galois::DynamicBitSet& get(unsigned i) {                            \
+    static galois::HierarchicalBitSet& get(unsigned i) {                       \
       return vbitset_##fieldname[i];                                           \
     }                                                                          \
                                                                                \
@@ -448,7 +448,6 @@ private:
   unsigned num_blocks;
   StrQpMapFreq qp_map; // quick patterns map for counting the frequency
   StrCgMapFreq cg_map; // canonical graph map for couting the frequency
-  LocalStrQpMapFreq qp_localmaps; // quick patterns local map for each thread
   LocalStrCgMapFreq cg_localmaps; // canonical graph local map for each thread
   std::vector<BYTE> is_wedge;     // indicate a 3-vertex embedding is a wedge or
                                   // chain (v0-cntered or v1-centered)
@@ -470,6 +469,7 @@ private:
   }
 
 protected:
+  LocalStrQpMapFreq qp_localmaps; // quick patterns local map for each thread
   int npatterns;
   UlongAccu total_num;
   std::vector<UlongAccu> accumulators;
@@ -478,6 +478,15 @@ protected:
   inline unsigned find_motif_pattern_id(unsigned n, unsigned idx, VertexId dst,
                                         const EmbeddingTy& emb,
                                         unsigned pos = 0) {
+    BYTE unused = 0;
+    return find_motif_pattern_id(n, idx, dst, emb,
+                                 use_wedge ? is_wedge[pos] : unused);
+  }
+
+  // wedge is set when a 3-vertex embedding is found to be a wedge, and read
+  // when extending a 3-chain (only with use_wedge)
+  inline unsigned find_motif_pattern_id(unsigned n, unsigned idx, VertexId dst,
+                                        const EmbeddingTy& emb, BYTE& wedge) {
     unsigned pid = 0;
     if (n == 2) { // count 3-motifs
       pid = 1;    // 3-chain
@@ -485,7 +494,7 @@ protected:
         if (this->is_connected(emb.get_vertex(1), dst))
           pid = 0; // triangle
         else if (use_wedge && this->max_size == 4)
-          is_wedge[pos] = 1; // wedge; used for 4-motif
+          wedge = 1; // wedge; used for 4-motif
       }
     } else if (n == 3) { // count 4-motifs
       unsigned num_edges = 1;
@@ -509,7 +518,7 @@ protected:
           pid             = 0; // p0: 3-path
           unsigned center = 1;
           if (use_wedge) {
-            if (is_wedge[pos])
+            if (wedge)
               center = 0;
           } else
             center = this->is_connected(emb.get_vertex(1), emb.get_vertex(2))
@@ -521,7 +530,7 @@ protected:
           pid             = 2; // p2: 4-cycle
           unsigned center = 1;
           if (use_wedge) {
-            if (is_wedge[pos])
+            if (wedge)
               center = 0;
           } else
             center = this->is_connected(emb.get_vertex(1), emb.get_vertex(2))
@@ -0,0 +1,195 @@
+#ifndef DFS_VERTEX_MINER_H
+#define DFS_VERTEX_MINER_H
+#include "galois/substrate/PerThreadStorage.h"
+#include "pangolin/BfsMining/vertex_miner.h"
+
+// Depth-first vertex miner: same API hooks (toExtend/toAdd) and reductions as
+// the BFS VertexMiner, but embeddings beyond the single-edge level are never
+// materialized. Each thread keeps one embedding and a stack of candidate
+// lists (one per level, reused), so the memory used for extension is bounded
+// by max_size * max_size * max_degree per thread instead of growing with the
+// number of embeddings. The single-edge level is scheduled with a LIFO
+// work-stealing worklist and heavy 2-vertex prefixes are split into separate
+// tasks so that high-degree vertices do not serialize on one thread.
+template <typename ElementTy, typename EmbeddingTy, typename API,
+          bool enable_dag = false, bool is_single = true,
+          bool use_wedge = false, bool use_match_order = false>
+class DfsVertexMiner
+    : public VertexMiner<ElementTy, EmbeddingTy, API, enable_dag, is_single,
+                         use_wedge, use_match_order> {
+  typedef VertexMiner<ElementTy, EmbeddingTy, API, enable_dag, is_single,
+                      use_wedge, use_match_order>
+      BaseMiner;
+
+  // a vertex that extends the current embedding; pid and wedge are only used
+  // when extending 2-vertex embeddings for 4-motif counting
+  struct Candidate {
+    VertexId dst;
+    unsigned pid;
+    BYTE wedge;
+  };
+
+  // per-thread DFS state
+  struct Stack {
+    EmbeddingTy emb;
+    std::vector<std::vector<Candidate>> levels; // candidates of each size
+    size_t peak;                                // max candidates at once
+    BYTE prefixIsWedge; // whether the 3-vertex prefix of emb is a wedge
+  };
+
+  // embedding prefix (at most 3 vertices) scheduled as one task
+  struct Task {
+    VertexId vertices[3];
+    unsigned pid;
+    BYTE size;
+    BYTE wedge;
+  };
+
+  // 2-vertex prefixes with more candidates than this are split into tasks
+  static const size_t SPLIT_THRESHOLD = 64;
+
+public:
+  DfsVertexMiner(unsigned max_sz, int nt, unsigned nb)
+      : BaseMiner(max_sz, nt, nb) {}
+  virtual ~DfsVertexMiner() {}
+
+  void solver() {
+    if (use_match_order)
+      GALOIS_DIE("matching order is not supported by the DFS engine");
+    size_t nnz = this->emb_list.size();
+    std::cout << "number of single-edge embeddings: " << nnz << "\n";
+    for (auto i = 0; i < this->num_threads; i++) {
+      Stack* s = stacks.getLocal(i);
+      s->levels.resize(this->max_size);
+      s->peak          = 0;
+      s->prefixIsWedge = 0;
+    }
+
+    galois::InsertBag<Task> initial;
+    galois::do_all(
+        galois::iterate((size_t)0, nnz),
+        [&](const size_t& pos) {
+          Task t;
+          t.vertices[0] = this->emb_list.get_idx(1, pos);
+          t.vertices[1] = this->emb_list.get_vid(1, pos);
+          t.size        = 2;
+          t.pid         = 0;
+          t.wedge       = 0;
+          initial.push(t);
+        },
+        galois::loopname("DfsInit"));
+
+    galois::GAccumulator<size_t> num_split;
+    galois::for_each(
+        galois::iterate(initial),
+        [&](const Task& t, auto& ctx) {
+          Stack& s = *stacks.getLocal();
+          s.emb.clean();
+          for (unsigned i = 0; i < t.size; ++i)
+            s.emb.push_back(ElementTy(t.vertices[i]));
+          this->set_prefix(s, t.pid, t.wedge);
+          auto& cands = this->expand(s);
+          if (t.size == 2 && cands.size() > SPLIT_THRESHOLD) {
+            num_split += cands.size();
+            for (auto& c : cands) {
+              Task child = t;
+              child.vertices[2] = c.dst;
+              child.size        = 3;
+              child.pid         = c.pid;
+              child.wedge       = c.wedge;
+              ctx.push(child);
+            }
+          } else {
+            this->descend(s);
+          }
+        },
+        galois::wl<galois::worklists::PerSocketChunkLIFO<CHUNK_SIZE>>(),
+        galois::disable_conflict_detection(),
+        galois::loopname("DfsExtending"));
+
+    size_t peak = 0;
+    for (auto i = 0; i < this->num_threads; i++)
+      peak = std::max(peak, stacks.getLocal(i)->peak);
+    galois::runtime::reportStat_Single("DfsExtending", "SplitTasks",
+                                       num_split.reduce());
+    galois::runtime::reportStat_Single("DfsExtending", "PeakCandidates", peak);
+
+    if (this->max_size >= 5 && !this->is_single_pattern()) {
+      this->merge_qp_map();
+      this->canonical_reduce();
+      this->merge_cg_map();
+    }
+  }
+
+private:
+  galois::substrate::PerThreadStorage<Stack> stacks;
+
+  // restores the pattern state of a 3-vertex embedding for 4-motif counting
+  void set_prefix(Stack& s, unsigned pid, BYTE wedge) {
+    if (!is_single && s.emb.size() == 3 && this->max_size == 4) {
+      s.emb.set_pid(pid);
+      s.prefixIsWedge = wedge;
+    }
+  }
+
+  // counts a complete embedding
+  void reduce(unsigned n, unsigned i, VertexId dst, Stack& s) {
+    if (is_single)
+      this->total_num += 1;
+    else if (n < 4)
+      this->accumulators[this->find_motif_pattern_id(n, i, dst, s.emb,
+                                                     s.prefixIsWedge)] += 1;
+    else
+      this->quick_reduce(n, i, dst, s.emb, this->qp_localmaps.getLocal());
+  }
+
+  // records the candidates extending s.emb, or reduces them if the extended
+  // embeddings are complete
+  std::vector<Candidate>& expand(Stack& s) {
+    unsigned n  = s.emb.size();
+    auto& cands = s.levels[n];
+    cands.clear();
+    bool last = n == this->max_size - 1;
+    for (unsigned i = 0; i < n; ++i) {
+      // cliques are only extended from the last vertex
+      if (is_single ? i != n - 1 : !API::toExtend(n, s.emb, i))
+        continue;
+      auto src = s.emb.get_vertex(i);
+      for (auto e : this->graph.edges(src)) {
+        GNode dst = this->graph.getEdgeDst(e);
+        if (!API::toAdd(n, this->graph, s.emb, i, dst))
+          continue;
+        if (last) {
+          reduce(n, i, dst, s);
+          continue;
+        }
+        Candidate c{dst, 0, 0};
+        if (!is_single && n == 2 && this->max_size == 4)
+          c.pid = this->find_motif_pattern_id(n, i, dst, s.emb, c.wedge);
+        cands.push_back(c);
+      }
+    }
+    size_t live = 0;
+    for (unsigned l = 2; l <= n; ++l)
+      live += s.levels[l].size();
+    s.peak = std::max(s.peak, live);
+    return cands;
+  }
+
+  // extends every candidate of the current level depth-first
+  void descend(Stack& s) {
+    unsigned n = s.emb.size();
+    // expand() of deeper levels only touches s.levels[n + 1] and beyond
+    auto& cands = s.levels[n];
+    for (size_t c = 0; c < cands.size(); ++c) {
+      s.emb.push_back(ElementTy(cands[c].dst));
+      set_prefix(s, cands[c].pid, cands[c].wedge);
+      expand(s);
+      descend(s);
+      s.emb.pop_back();
+    }
+    cands.clear();
+  }
+};
+
+#endif // DFS_VERTEX_MINER_H
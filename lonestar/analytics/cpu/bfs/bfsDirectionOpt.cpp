@@ -19,7 +19,7 @@
 
 #include "galois/Galois.h"
 #include "galois/AtomicHelpers.h"
-#include "galois/DynamicBitset.h"
+#include "galois/HierarchicalBitset.h"
 #include "galois/gstl.h"
 #include "galois/Reduction.h"
 #include "galois/Timer.h"
@@ -175,7 +175,7 @@ struct OneTilePushWrap {
 };
 
 template <typename WL>
-void WlToBitset(WL& wl, galois::DynamicBitSet& bitset) {
+void WlToBitset(WL& wl, galois::HierarchicalBitSet& bitset) {
   galois::do_all(
       galois::iterate(wl), [&](const GNode& src) { bitset.set(src); },
       galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
@@ -183,18 +183,11 @@ void WlToBitset(WL& wl, galois::DynamicBitSet& bitset) {
 }
 
 template <typename WL>
-void BitsetToWl(const Graph& graph, const galois::DynamicBitSet& bitset,
-                WL& wl) {
+void BitsetToWl(const galois::HierarchicalBitSet& bitset, WL& wl) {
   wl.clear();
-  galois::do_all(
-      galois::iterate(graph),
-      [&](const GNode& src) {
-        if (bitset.test(src))
-          // pushWrap(wl, src);
-          wl.push(src);
-      },
-      galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
-      galois::loopname("BitsetToWl"));
+  // visits only the non-empty words of the bitset
+  bitset.for_each_set([&](size_t src) { wl.push(src); },
+                      galois::loopname("BitsetToWl"));
 }
 
 template <bool CONCURRENT, typename T, typename P, typename R>
@@ -211,7 +204,7 @@ void syncDOAlgo(Graph& graph, GNode source, const P& pushWrap,
 
   Loop loop;
 
-  galois::DynamicBitSet front_bitset, next_bitset;
+  galois::HierarchicalBitSet front_bitset, next_bitset;
   front_bitset.resize(graph.size());
   next_bitset.resize(graph.size());
 
@@ -295,7 +288,7 @@ void syncDOAlgo(Graph& graph, GNode source, const P& pushWrap,
       } while (work_items.reduce() >= old_workItemNum ||
                (work_items.reduce() > numNodes / beta));
 
-      BitsetToWl(graph, front_bitset, *next);
+      BitsetToWl(front_bitset, *next);
       scout_count = 1;
     } else {
       // c_push++;
@@ -539,7 +539,7 @@ MetisGraph* coarsenOnce(MetisGraph* fineMetisGraph, scheduleMode sch,
 } // namespace
 
 MetisGraph* coarsen(MetisGraph* fineMetisGraph, unsigned coarsenTo,
-                    scheduleMode sch) {
+                    scheduleMode sch, unsigned K) {
 
   MetisGraph* coarseGraph = fineMetisGraph;
   unsigned size =
@@ -549,7 +549,8 @@ MetisGraph* coarsen(MetisGraph* fineMetisGraph, unsigned coarsenTo,
   const float ratio  = 55.0 / 45.0; // change if needed
   const float tol    = std::max(ratio, 1 - ratio) - 1;
   const int hi       = (1 + tol) * size / (2 + tol);
-  LIMIT              = hi / 4;
+  // keep clusters small enough that K parts can still be balanced
+  LIMIT = hi / (2 * std::max(K, 2u));
 
   // std::cout<<"inital weight is "<<totw<<"\n";
   unsigned Size    = size;
@@ -0,0 +1,535 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * Direct k-way refinement of the connectivity-minus-one (km1) objective.
+ *
+ * Every level of the multilevel hierarchy is refined with parallel label
+ * propagation followed by localized FM searches. Each FM search runs on one
+ * thread with that thread's gain buckets, claims the cells it touches so no
+ * two searches move the same cell, performs a bounded number of moves and
+ * rolls back to the best prefix it has seen.
+ */
+
+#include "bipart.h"
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+//! Moves a single localized FM search may make
+constexpr unsigned FM_MAX_MOVES = 200;
+//! Consecutive non-improving moves after which a search gives up
+constexpr unsigned FM_STALL_LIMIT = 40;
+//! Boundary cells seeding one localized FM search
+constexpr unsigned FM_SEEDS = 8;
+//! Hyperedges larger than this do not propagate gain updates during FM
+constexpr unsigned FM_MAX_HEDGE_SCAN = 1000;
+
+constexpr unsigned FREE  = 0;
+constexpr unsigned MOVED = UINT_MAX;
+
+struct Move {
+  unsigned to;
+  int gain;
+};
+
+struct MoveRecord {
+  GNode cell;
+  unsigned from;
+  unsigned to;
+};
+
+//! Bucket priority queue keyed by km1 gain; gains are bounded by the degree.
+class GainBuckets {
+  std::vector<std::vector<std::pair<GNode, int>>> buckets;
+  int offset = 0;
+  int top    = -1;
+  int low    = INT_MAX;
+
+public:
+  void reset(int maxGain) {
+    clear();
+    offset = maxGain;
+    if (buckets.size() < (size_t)(2 * maxGain + 1))
+      buckets.resize(2 * maxGain + 1);
+  }
+
+  void push(GNode c, int gain) {
+    int b = std::max(0, std::min(2 * offset, gain + offset));
+    buckets[b].emplace_back(c, gain);
+    top = std::max(top, b);
+    low = std::min(low, b);
+  }
+
+  bool pop(GNode& c, int& gain) {
+    while (top >= 0 && buckets[top].empty())
+      --top;
+    if (top < 0)
+      return false;
+    c    = buckets[top].back().first;
+    gain = buckets[top].back().second;
+    buckets[top].pop_back();
+    return true;
+  }
+
+  void clear() {
+    for (int b = low; b <= top; ++b)
+      buckets[b].clear();
+    top = -1;
+    low = INT_MAX;
+  }
+};
+
+struct ThreadScratch {
+  std::vector<int> conn;
+  std::vector<uint64_t> seen;
+  uint64_t stamp = 0;
+  std::vector<unsigned> touched;
+  GainBuckets buckets;
+  std::vector<GNode> claimed;
+  std::vector<MoveRecord> moves;
+};
+
+//! Refinement state of one level: per-part pin counts of every hyperedge,
+//! the cell to hyperedge incidence (the graph only stores hyperedge to cell
+//! edges), part weights and the cell ownership used by FM searches.
+class KWayLevel {
+  GGraph& g;
+  const unsigned K;
+  std::vector<uint64_t> incOffset;
+  std::vector<GNode> incHedges;
+  std::vector<galois::CopyableAtomic<unsigned>> pins;
+  std::vector<galois::CopyableAtomic<int64_t>> partWeight;
+  std::vector<galois::CopyableAtomic<unsigned>> owner;
+  galois::substrate::PerThreadStorage<ThreadScratch> scratch;
+  int64_t maxWeight;
+  int maxDegree;
+
+  unsigned hedgeSize(GNode h) const {
+    return std::distance(g.edge_begin(h, flag_no_lock),
+                         g.edge_end(h, flag_no_lock));
+  }
+
+  unsigned part(GNode c) const {
+    return g.getData(c, flag_no_lock).getPart();
+  }
+
+  int weight(GNode c) const { return g.getData(c, flag_no_lock).getWeight(); }
+
+  void buildIncidence() {
+    const size_t numCells = g.hnodes;
+    std::vector<galois::CopyableAtomic<uint64_t>> degree(numCells);
+    galois::do_all(
+        galois::iterate(size_t{0}, g.hedges),
+        [&](GNode h) {
+          for (auto e : g.edges(h, flag_no_lock))
+            degree[g.getEdgeDst(e) - g.hedges].fetch_add(
+                1, std::memory_order_relaxed);
+        },
+        galois::steal(), galois::loopname("KWayIncidenceCount"));
+
+    incOffset.resize(numCells + 1);
+    incOffset[0] = 0;
+    for (size_t c = 0; c < numCells; ++c)
+      incOffset[c + 1] = incOffset[c] + degree[c];
+    incHedges.resize(incOffset[numCells]);
+
+    galois::do_all(
+        galois::iterate(size_t{0}, numCells),
+        [&](size_t c) { degree[c] = incOffset[c]; },
+        galois::loopname("KWayIncidenceCursor"));
+    galois::do_all(
+        galois::iterate(size_t{0}, g.hedges),
+        [&](GNode h) {
+          for (auto e : g.edges(h, flag_no_lock)) {
+            auto pos = degree[g.getEdgeDst(e) - g.hedges].fetch_add(
+                1, std::memory_order_relaxed);
+            incHedges[pos] = h;
+          }
+        },
+        galois::steal(), galois::loopname("KWayIncidenceFill"));
+
+    galois::GReduceMax<int> maxDeg;
+    galois::do_all(
+        galois::iterate(size_t{0}, numCells),
+        [&](size_t c) { maxDeg.update(incOffset[c + 1] - incOffset[c]); },
+        galois::loopname("KWayMaxDegree"));
+    maxDegree = std::max(1, maxDeg.reduce());
+  }
+
+  void buildPins() {
+    pins.assign((size_t)g.hedges * K, galois::CopyableAtomic<unsigned>(0));
+    galois::do_all(
+        galois::iterate(size_t{0}, g.hedges),
+        [&](GNode h) {
+          for (auto e : g.edges(h, flag_no_lock))
+            ++pins[(size_t)h * K + part(g.getEdgeDst(e))];
+        },
+        galois::steal(), galois::loopname("KWayPinCounts"));
+  }
+
+  // Best km1 move for cell c among the parts its hyperedges already touch;
+  // with anyPart the lightest part is also considered so an overweight part
+  // can always shed cells. Returns to == K if no move fits the balance bound.
+  Move bestMove(GNode c, ThreadScratch& ts, bool anyPart = false) {
+    const unsigned from = part(c);
+    const int64_t w     = weight(c);
+    int base = 0, deg = 0;
+    ts.conn.resize(K, 0);
+    ts.seen.resize(K, 0);
+    for (auto i = incOffset[c - g.hedges]; i < incOffset[c - g.hedges + 1];
+         ++i) {
+      const size_t row = (size_t)incHedges[i] * K;
+      ++deg;
+      if (pins[row + from] == 1)
+        ++base;
+      // small hyperedges are cheaper to scan through their pins than
+      // through all K pin counters
+      const GNode h = incHedges[i];
+      if (hedgeSize(h) < K) {
+        ++ts.stamp;
+        for (auto e : g.edges(h, flag_no_lock)) {
+          unsigned b = part(g.getEdgeDst(e));
+          if (b == from || ts.seen[b] == ts.stamp)
+            continue;
+          ts.seen[b] = ts.stamp;
+          if (ts.conn[b]++ == 0)
+            ts.touched.push_back(b);
+        }
+      } else {
+        for (unsigned b = 0; b < K; ++b) {
+          if (b != from && pins[row + b] > 0 && ts.conn[b]++ == 0)
+            ts.touched.push_back(b);
+        }
+      }
+    }
+
+    Move best{K, INT_MIN};
+    for (auto b : ts.touched) {
+      int gain = base - deg + ts.conn[b];
+      ts.conn[b] = 0;
+      if (partWeight[b] + w > maxWeight)
+        continue;
+      if (gain > best.gain ||
+          (gain == best.gain && partWeight[b] < partWeight[best.to]))
+        best = Move{b, gain};
+    }
+    ts.touched.clear();
+
+    if (anyPart) {
+      unsigned lightest = from == 0 ? 1 : 0;
+      for (unsigned b = 0; b < K; ++b)
+        if (b != from && partWeight[b] < partWeight[lightest])
+          lightest = b;
+      if (best.to == K && partWeight[lightest] + w <= maxWeight)
+        best = Move{lightest, base - deg};
+    }
+    return best;
+  }
+
+  bool reserve(unsigned to, int64_t w) {
+    if (partWeight[to].fetch_add(w) + w > maxWeight) {
+      partWeight[to].fetch_sub(w);
+      return false;
+    }
+    return true;
+  }
+
+  void applyMove(GNode c, unsigned from, unsigned to) {
+    g.getData(c, flag_no_lock).setPart(to);
+    for (auto i = incOffset[c - g.hedges]; i < incOffset[c - g.hedges + 1];
+         ++i) {
+      const size_t row = (size_t)incHedges[i] * K;
+      pins[row + from].fetch_sub(1);
+      pins[row + to].fetch_add(1);
+    }
+  }
+
+  bool isBoundary(GNode c) const {
+    const unsigned from = part(c);
+    for (auto i = incOffset[c - g.hedges]; i < incOffset[c - g.hedges + 1];
+         ++i) {
+      GNode h = incHedges[i];
+      if (pins[(size_t)h * K + from] < hedgeSize(h))
+        return true;
+    }
+    return false;
+  }
+
+  bool claim(GNode c, unsigned me) {
+    unsigned expected = FREE;
+    return owner[c - g.hedges].compare_exchange_strong(expected, me);
+  }
+
+  // Inserts cell c into this search's buckets if it is free or already ours.
+  void enqueue(GNode c, unsigned me, ThreadScratch& ts) {
+    unsigned o = owner[c - g.hedges];
+    if (o == MOVED || (o != me && o != FREE))
+      return;
+    if (o == FREE) {
+      if (!claim(c, me))
+        return;
+      ts.claimed.push_back(c);
+    }
+    Move m = bestMove(c, ts);
+    if (m.to != K)
+      ts.buckets.push(c, m.gain);
+  }
+
+  int localizedFM(const GNode* seeds, size_t numSeeds) {
+    ThreadScratch& ts = *scratch.getLocal();
+    const unsigned me = galois::substrate::ThreadPool::getTID() + 1;
+    ts.buckets.reset(maxDegree);
+    for (size_t i = 0; i < numSeeds; ++i)
+      enqueue(seeds[i], me, ts);
+
+    int gainSum = 0, bestGain = 0;
+    size_t bestPrefix = 0;
+    unsigned stall    = 0;
+    GNode c;
+    int key;
+    while (ts.moves.size() < FM_MAX_MOVES && ts.buckets.pop(c, key)) {
+      if (owner[c - g.hedges] != me)
+        continue;
+      Move m = bestMove(c, ts);
+      if (m.to == K)
+        continue;
+      if (m.gain < key) {
+        ts.buckets.push(c, m.gain);
+        continue;
+      }
+      const int64_t w = weight(c);
+      if (!reserve(m.to, w))
+        continue;
+      const unsigned from = part(c);
+      applyMove(c, from, m.to);
+      partWeight[from].fetch_sub(w);
+      owner[c - g.hedges] = MOVED;
+      ts.moves.push_back(MoveRecord{c, from, m.to});
+
+      gainSum += m.gain;
+      if (gainSum > bestGain) {
+        bestGain   = gainSum;
+        bestPrefix = ts.moves.size();
+        stall      = 0;
+      } else if (++stall >= FM_STALL_LIMIT) {
+        break;
+      }
+
+      // km1 gains of the other pins only change when h just left or entered
+      // a part or when a single pin of h remains in one
+      for (auto i = incOffset[c - g.hedges]; i < incOffset[c - g.hedges + 1];
+           ++i) {
+        GNode h = incHedges[i];
+        if (hedgeSize(h) > FM_MAX_HEDGE_SCAN ||
+            (pins[(size_t)h * K + from] > 1 && pins[(size_t)h * K + m.to] > 2))
+          continue;
+        for (auto e : g.edges(h, flag_no_lock)) {
+          GNode u = g.getEdgeDst(e);
+          if (u != c)
+            enqueue(u, me, ts);
+        }
+      }
+    }
+
+    // roll back everything after the best prefix
+    for (size_t i = ts.moves.size(); i > bestPrefix; --i) {
+      const MoveRecord& r = ts.moves[i - 1];
+      const int64_t w     = weight(r.cell);
+      applyMove(r.cell, r.to, r.from);
+      partWeight[r.from].fetch_add(w);
+      partWeight[r.to].fetch_sub(w);
+    }
+    for (auto u : ts.claimed)
+      if (owner[u - g.hedges] == me)
+        owner[u - g.hedges] = FREE;
+    ts.claimed.clear();
+    ts.moves.clear();
+    ts.buckets.clear();
+    return bestGain;
+  }
+
+public:
+  KWayLevel(GGraph& graph, unsigned k, double imbalance)
+      : g(graph), K(k), partWeight(k), owner(graph.hnodes) {
+    buildIncidence();
+    buildPins();
+    int64_t total = 0;
+    for (GNode c = g.hedges; c < g.size(); ++c)
+      partWeight[part(c)] += weight(c);
+    for (unsigned b = 0; b < K; ++b)
+      total += partWeight[b];
+    maxWeight = (int64_t)std::ceil((1.0 + imbalance) *
+                                   std::ceil((double)total / (double)K));
+    maxWeight = std::max<int64_t>(maxWeight, 1);
+  }
+
+  //! One round of parallel label propagation; returns the summed gain
+  int labelPropagation() {
+    galois::GAccumulator<int> gain;
+    galois::do_all(
+        galois::iterate(g.hedges, g.size()),
+        [&](GNode c) {
+          Move m = bestMove(c, *scratch.getLocal());
+          if (m.to == K || m.gain <= 0)
+            return;
+          const int64_t w = weight(c);
+          if (!reserve(m.to, w))
+            return;
+          const unsigned from = part(c);
+          applyMove(c, from, m.to);
+          partWeight[from].fetch_sub(w);
+          gain += m.gain;
+        },
+        galois::steal(), galois::loopname("KWayLabelPropagation"));
+    return gain.reduce();
+  }
+
+  //! One round of localized FM seeded from every boundary cell
+  int fm() {
+    GNodeBag bag;
+    galois::do_all(
+        galois::iterate(g.hedges, g.size()),
+        [&](GNode c) {
+          if (isBoundary(c))
+            bag.push(c);
+        },
+        galois::loopname("KWayBoundary"));
+    std::vector<GNode> seeds(bag.begin(), bag.end());
+    std::sort(seeds.begin(), seeds.end());
+
+    galois::GAccumulator<int> gain;
+    const size_t numSearches = (seeds.size() + FM_SEEDS - 1) / FM_SEEDS;
+    galois::do_all(
+        galois::iterate(size_t{0}, numSearches),
+        [&](size_t s) {
+          size_t begin = s * FM_SEEDS;
+          size_t end   = std::min(seeds.size(), begin + FM_SEEDS);
+          gain += localizedFM(&seeds[begin], end - begin);
+        },
+        galois::steal(), galois::loopname("KWayFM"));
+    galois::do_all(
+        galois::iterate(size_t{0}, (size_t)g.hnodes),
+        [&](size_t c) { owner[c] = FREE; }, galois::loopname("KWayUnlock"));
+    return gain.reduce();
+  }
+
+  //! Moves cells out of overweight parts, cheapest km1 loss first
+  void rebalance() {
+    for (unsigned p = 0; p < K; ++p) {
+      if (partWeight[p] <= maxWeight)
+        continue;
+      galois::InsertBag<std::pair<int, GNode>> bag;
+      galois::do_all(
+          galois::iterate(g.hedges, g.size()),
+          [&](GNode c) {
+            if (part(c) != p)
+              return;
+            Move m = bestMove(c, *scratch.getLocal(), true);
+            if (m.to != K)
+              bag.push(std::make_pair(m.gain, c));
+          },
+          galois::loopname("KWayRebalanceGains"));
+      std::vector<std::pair<int, GNode>> cand(bag.begin(), bag.end());
+      std::sort(cand.begin(), cand.end(),
+                [](const std::pair<int, GNode>& a,
+                   const std::pair<int, GNode>& b) {
+                  return a.first > b.first ||
+                         (a.first == b.first && a.second < b.second);
+                });
+      ThreadScratch& ts = *scratch.getLocal();
+      for (auto& cg : cand) {
+        if (partWeight[p] <= maxWeight)
+          break;
+        Move m = bestMove(cg.second, ts, true);
+        if (m.to == K)
+          continue;
+        const int64_t w = weight(cg.second);
+        applyMove(cg.second, p, m.to);
+        partWeight[m.to] += w;
+        partWeight[p] -= w;
+      }
+    }
+  }
+};
+
+void projectPartKWay(MetisGraph* Graph) {
+  GGraph* fineGraph   = Graph->getFinerGraph()->getGraph();
+  GGraph* coarseGraph = Graph->getGraph();
+  galois::do_all(
+      galois::iterate(fineGraph->hedges, fineGraph->size()),
+      [&](GNode n) {
+        auto parent = fineGraph->getData(n).getParent();
+        fineGraph->getData(n).setPart(coarseGraph->getData(parent).getPart());
+      },
+      galois::loopname("KWayProject"));
+}
+
+} // namespace
+
+void refineKWay(MetisGraph* coarseGraph, unsigned K, double imbalance,
+                unsigned iters) {
+  do {
+    MetisGraph* fineGraph = coarseGraph->getFinerGraph();
+    KWayLevel level(*coarseGraph->getGraph(), K, imbalance);
+    level.rebalance();
+    for (unsigned i = 0; i < iters; ++i) {
+      int gain = level.labelPropagation();
+      gain += level.fm();
+      if (gain <= 0)
+        break;
+    }
+    level.rebalance();
+    if (fineGraph)
+      projectPartKWay(coarseGraph);
+  } while ((coarseGraph = coarseGraph->getFinerGraph()));
+}
+
+unsigned computeKm1(GGraph& g, unsigned K) {
+  galois::GAccumulator<unsigned> km1;
+  galois::substrate::PerThreadStorage<std::vector<unsigned>> seen;
+  galois::do_all(
+      galois::iterate(size_t{0}, g.hedges),
+      [&](GNode h) {
+        auto& mark = *seen.getLocal();
+        mark.resize(K, UINT_MAX);
+        unsigned lambda = 0;
+        for (auto e : g.edges(h, flag_no_lock)) {
+          unsigned p = g.getData(g.getEdgeDst(e), flag_no_lock).getPart();
+          if (mark[p] != h) {
+            mark[p] = h;
+            ++lambda;
+          }
+        }
+        if (lambda > 1)
+          km1 += lambda - 1;
+      },
+      galois::steal(), galois::loopname("km1"));
+  return km1.reduce();
+}
@@ -98,6 +98,20 @@ static cll::opt<bool>
     output("output", cll::desc("Specify if partitions need to be written"),
            cll::init(false));
 
+static cll::opt<bool> hmetisOutput(
+    "hmetisOutput",
+    cll::desc("Write partitions in hMetis format (one part id per line)"),
+    cll::init(false));
+
+enum partitionMode { RB, KWAY };
+
+static cll::opt<partitionMode> partMode(
+    "partMode", cll::desc("Choose how the k parts are computed:"),
+    cll::values(clEnumVal(RB, "recursive bisection (default)"),
+                clEnumVal(KWAY, "multilevel direct k-way refinement of the "
+                                "connectivity-1 (km1) objective")),
+    cll::init(RB));
+
 // const double COARSEN_FRACTION = 0.9;
 
 /*int cutsize(GGraph& g) {
@@ -219,104 +233,11 @@ int hash(unsigned val) {
   return ((unsigned)(seed / 65536) % 32768);
 }
 
-int main(int argc, char** argv) {
-  galois::SharedMemSys G;
-  LonestarStart(argc, argv, name, desc, url, &inputFile);
-
-  galois::StatTimer totalTime("TimerTotal");
-  totalTime.start();
-
-  if (!hMetisGraph) {
-    GALOIS_DIE("This application requires a hMetis graph input;"
-               " please use the -hMetisGraph flag "
-               " to indicate the input is a hMetisGraph graph.");
-  }
-
-  // srand(-1);
-  MetisGraph metisGraph;
-  GGraph& graph = *metisGraph.getGraph();
-  std::ifstream f(inputFile.c_str());
-  // GGraph graph;// = *metisGraph.getGraph();
-  std::string line;
-  std::getline(f, line);
-  std::stringstream ss(line);
-  uint32_t i1;
-  uint64_t i2;
-  ss >> i1 >> i2;
-  const uint32_t hedges = i1;
-  const uint64_t nodes  = i2;
-  std::cout << "hedges: " << hedges << "\n";
-  std::cout << "nodes: " << nodes << "\n\n";
-
-  galois::StatTimer T("buildingG");
-  T.start();
-  // read rest of input and initialize hedges (build hgraph)
-  galois::gstl::Vector<galois::PODResizeableArray<uint32_t>> edges_id(hedges +
-                                                                      nodes);
-  std::vector<std::vector<EdgeTy>> edges_data(hedges + nodes);
-  std::vector<uint64_t> prefix_edges(nodes + hedges);
-  uint32_t cnt   = 0;
-  uint32_t edges = 0;
-  while (std::getline(f, line)) {
-    if (cnt >= hedges) {
-      printf("ERROR: too many lines in input file\n");
-      exit(-1);
-    }
-    std::stringstream ss(line);
-    int val;
-    while (ss >> val) {
-      if ((val < 1) || (val > static_cast<long>(nodes))) {
-        printf("ERROR: node value %d out of bounds\n", val);
-        exit(-1);
-      }
-      unsigned newval = hedges + (val - 1);
-      edges_id[cnt].push_back(newval);
-      edges++;
-    }
-    cnt++;
-  }
-  f.close();
-  graph.hedges = hedges;
-  graph.hnodes = nodes;
-  std::cout << "number of edges " << edges << "\n";
-  uint32_t sizes = hedges + nodes;
-  galois::do_all(galois::iterate(uint32_t{0}, sizes),
-                 [&](uint32_t c) { prefix_edges[c] = edges_id[c].size(); });
-
-  for (uint64_t c = 1; c < nodes + hedges; ++c) {
-    prefix_edges[c] += prefix_edges[c - 1];
-  }
-  // edges = #edges, hedgecount = how many edges each node has, edges_id: for
-  // each node, which ndoes it is connected to edges_data: data for each edge =
-  // 1
-  graph.constructFrom(nodes + hedges, edges, prefix_edges, edges_id,
-                      edges_data);
-  galois::do_all(galois::iterate(graph), [&](GNode n) {
-    if (n < hedges)
-      graph.getData(n).netnum = n + 1;
-    else
-      graph.getData(n).netnum = INT_MAX;
-    graph.getData(n).netrand = INT_MAX;
-    graph.getData(n).netval  = INT_MAX;
-    graph.getData(n).nodeid  = n + 1;
-  });
-  T.stop();
-  std::cout << "time to build a graph " << T.get() << "\n";
-  graphStat(graph);
-  std::cout << "\n";
-  galois::preAlloc(galois::runtime::numPagePoolAllocTotal() * 5);
-  galois::reportPageAlloc("MeminfoPre");
-  galois::do_all(
-      galois::iterate(graph.hedges, graph.size()),
-      [&](GNode item) {
-        // accum += g->getData(item).getWeight();
-        graph.getData(item, galois::MethodFlag::UNPROTECTED)
-            .initRefine(0, true);
-        graph.getData(item, galois::MethodFlag::UNPROTECTED).initPartition();
-      },
-      galois::loopname("initPart"));
-
-  const int k = numPartitions;
+/**
+ * Splits the cells of graph into k parts by recursive bisection, one level
+ * of the bisection tree at a time. Cells must start out in part 0.
+ */
+void recursiveBisection(GGraph& graph, const int k) {
   // calculating number of iterations/levels required
   int num = log2(k) + 1;
 
@@ -391,7 +312,7 @@ int main(int argc, char** argv) {
             galois::iterate(uint32_t{0}, totalnodes),
             [&](uint32_t c) {
               pre_edges[c] = edges_ids[c].size();
-              num_edges_acc += prefix_edges[c];
+              num_edges_acc += pre_edges[c];
             },
             galois::steal());
         edges = num_edges_acc.reduce();
@@ -410,6 +331,8 @@ int main(int argc, char** argv) {
           gr.getData(n).netval  = INT_MAX;
           gr.getData(n).nodeid  = n + 1;
         });
+        for (auto n : nodesvec)
+          gr.getData(nodemap[n]).setWeight(graph.getData(n).getWeight());
         Partition(&metisG, 25, kValue[i]);
         MetisGraph* mcg = &metisG;
 
@@ -437,15 +360,162 @@ int main(int argc, char** argv) {
             graph.getData(v).setPart(i + (tmp + 1) / 2);
           }
         }
-        delete mcg;
+        if (mcg != &metisG)
+          delete mcg;
       }
     }
 
     toProcess = toProcessNew;
     toProcessNew.clear();
   }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url, &inputFile);
+
+  galois::StatTimer totalTime("TimerTotal");
+  totalTime.start();
+
+  if (!hMetisGraph) {
+    GALOIS_DIE("This application requires a hMetis graph input;"
+               " please use the -hMetisGraph flag "
+               " to indicate the input is a hMetisGraph graph.");
+  }
+
+  // srand(-1);
+  MetisGraph metisGraph;
+  GGraph& graph = *metisGraph.getGraph();
+  std::ifstream f(inputFile.c_str());
+  // GGraph graph;// = *metisGraph.getGraph();
+  std::string line;
+  std::getline(f, line);
+  std::stringstream ss(line);
+  uint32_t i1;
+  uint64_t i2;
+  ss >> i1 >> i2;
+  const uint32_t hedges = i1;
+  const uint64_t nodes  = i2;
+  std::cout << "hedges: " << hedges << "\n";
+  std::cout << "nodes: " << nodes << "\n\n";
+
+  galois::StatTimer T("buildingG");
+  T.start();
+  // read rest of input and initialize hedges (build hgraph)
+  galois::gstl::Vector<galois::PODResizeableArray<uint32_t>> edges_id(hedges +
+                                                                      nodes);
+  std::vector<std::vector<EdgeTy>> edges_data(hedges + nodes);
+  std::vector<uint64_t> prefix_edges(nodes + hedges);
+  uint32_t cnt   = 0;
+  uint32_t edges = 0;
+  while (std::getline(f, line)) {
+    if (cnt >= hedges) {
+      printf("ERROR: too many lines in input file\n");
+      exit(-1);
+    }
+    std::stringstream ss(line);
+    int val;
+    while (ss >> val) {
+      if ((val < 1) || (val > static_cast<long>(nodes))) {
+        printf("ERROR: node value %d out of bounds\n", val);
+        exit(-1);
+      }
+      unsigned newval = hedges + (val - 1);
+      edges_id[cnt].push_back(newval);
+      edges++;
+    }
+    cnt++;
+  }
+  f.close();
+  graph.hedges = hedges;
+  graph.hnodes = nodes;
+  std::cout << "number of edges " << edges << "\n";
+  uint32_t sizes = hedges + nodes;
+  galois::do_all(galois::iterate(uint32_t{0}, sizes),
+                 [&](uint32_t c) { prefix_edges[c] = edges_id[c].size(); });
+
+  for (uint64_t c = 1; c < nodes + hedges; ++c) {
+    prefix_edges[c] += prefix_edges[c - 1];
+  }
+  // edges = #edges, hedgecount = how many edges each node has, edges_id: for
+  // each node, which ndoes it is connected to edges_data: data for each edge =
+  // 1
+  graph.constructFrom(nodes + hedges, edges, prefix_edges, edges_id,
+                      edges_data);
+  galois::do_all(galois::iterate(graph), [&](GNode n) {
+    if (n < hedges)
+      graph.getData(n).netnum = n + 1;
+    else
+      graph.getData(n).netnum = INT_MAX;
+    graph.getData(n).netrand = INT_MAX;
+    graph.getData(n).netval  = INT_MAX;
+    graph.getData(n).nodeid  = n + 1;
+  });
+  T.stop();
+  std::cout << "time to build a graph " << T.get() << "\n";
+  graphStat(graph);
+  std::cout << "\n";
+  galois::preAlloc(galois::runtime::numPagePoolAllocTotal() * 5);
+  galois::reportPageAlloc("MeminfoPre");
+  galois::do_all(
+      galois::iterate(graph.hedges, graph.size()),
+      [&](GNode item) {
+        // accum += g->getData(item).getWeight();
+        graph.getData(item, galois::MethodFlag::UNPROTECTED)
+            .initRefine(0, true);
+        graph.getData(item, galois::MethodFlag::UNPROTECTED).initPartition();
+      },
+      galois::loopname("initPart"));
+
+  const int k = numPartitions;
+  if (partMode == KWAY) {
+    if (k < 2)
+      GALOIS_DIE("k-way mode requires at least 2 partitions");
+    galois::StatTimer execTime("Timer_0");
+    execTime.start();
+
+    galois::StatTimer T("CoarsenKWay");
+    T.start();
+    MetisGraph* mcg = coarsen(&metisGraph, std::max<unsigned>(csize, 20 * k),
+                              schedulingMode, k);
+    T.stop();
+
+    // the coarsest graph is small: split it by recursive bisection
+    galois::StatTimer T2("PartitionKWay");
+    T2.start();
+    GGraph& coarsest = *mcg->getGraph();
+    galois::do_all(
+        galois::iterate(coarsest.hedges, coarsest.size()),
+        [&](GNode item) {
+          coarsest.getData(item).initRefine(0, true);
+          coarsest.getData(item).initPartition();
+        },
+        galois::loopname("initPartKWay"));
+    recursiveBisection(coarsest, k);
+    T2.stop();
+
+    galois::StatTimer T3("RefineKWay");
+    T3.start();
+    refineKWay(mcg, k, imbalance, refiter);
+    T3.stop();
+    std::cout << "coarsen:," << T.get() << "\n";
+    std::cout << "clustering:," << T2.get() << '\n';
+    std::cout << "Refinement:," << T3.get() << "\n";
+    execTime.stop();
+
+    // coarsen() may hand back a graph whose coarser level was discarded
+    delete mcg->getCoarserGraph();
+    while (mcg != &metisGraph) {
+      MetisGraph* finer = mcg->getFinerGraph();
+      delete mcg;
+      mcg = finer;
+    }
+  } else {
+    recursiveBisection(graph, k);
+  }
   // std::cout<<"Total Edge Cut: "<<computingCut(graph)<<"\n";
   galois::runtime::reportStat_Single("HyPar", "Edge Cut", computingCut(graph));
+  galois::runtime::reportStat_Single("HyPar", "Km1", computeKm1(graph, k));
   galois::runtime::reportStat_Single("HyParzo", "zero-one",
                                      computingBalance(graph));
   // galois::reportPageAlloc("MeminfoPost");
@@ -466,8 +536,13 @@ int main(int argc, char** argv) {
 
     std::ofstream outputFile(outfile.c_str());
 
-    for (size_t i = 0; i < parts.size(); i++)
-      outputFile << IDs[i] << " " << parts[i] << "\n";
+    // hMETIS writes one 0-based part per line in cell order
+    for (size_t i = 0; i < parts.size(); i++) {
+      if (hmetisOutput)
+        outputFile << parts[i] << "\n";
+      else
+        outputFile << IDs[i] << " " << parts[i] << "\n";
+    }
 
     outputFile.close();
   }
@@ -190,11 +190,15 @@ public:
 unsigned graphStat(GGraph& graph);
 // Coarsening
 MetisGraph* coarsen(MetisGraph* fineMetisGraph, unsigned coarsenTo,
-                    scheduleMode sMode);
+                    scheduleMode sMode, unsigned K = 2);
 
 // Partitioning
 void partition(MetisGraph* coarseMetisGraph, unsigned K);
 // Refinement
 void refine(MetisGraph* coarseGraph, unsigned K);
+// Direct k-way refinement of the km1 objective
+void refineKWay(MetisGraph* coarseGraph, unsigned K, double imbalance,
+                unsigned iters);
+unsigned computeKm1(GGraph& graph, unsigned K);
 
 #endif
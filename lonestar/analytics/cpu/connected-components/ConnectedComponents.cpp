@@ -20,6 +20,7 @@
 #include "galois/Galois.h"
 #include "galois/AtomicHelpers.h"
 #include "galois/Bag.h"
+#include "galois/LargeArray.h"
 #include "galois/ParallelSTL.h"
 #include "galois/Reduction.h"
 #include "galois/Timer.h"
@@ -36,6 +37,7 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <numeric>
 
 #include <ostream>
 #include <fstream>
@@ -56,6 +58,7 @@ enum Algo {
   afforest,
   edgeafforest,
   edgetiledafforest,
+  flatafforest,
 };
 
 static cll::opt<std::string>
@@ -76,7 +79,9 @@ static cll::opt<Algo> algo(
         clEnumValN(Algo::edgeafforest, "EdgeAfforest",
                    "Using Afforest sampling, Edge-wise"),
         clEnumValN(Algo::edgetiledafforest, "EdgetiledAfforest",
-                   "Using Afforest sampling, EdgeTiled")
+                   "Using Afforest sampling, EdgeTiled"),
+        clEnumValN(Algo::flatafforest, "FlatAfforest",
+                   "Using Afforest sampling on a flat parent array")
 
             ),
     cll::init(Algo::edgetiledasync));
@@ -84,6 +89,11 @@ static cll::opt<Algo> algo(
 static cll::opt<std::string>
     largestComponentFilename("outputLargestComponent",
                              cll::desc("[output graph file]"), cll::init(""));
+static cll::opt<std::string> componentsFilename(
+    "outputComponents",
+    cll::desc("(For FlatAfforest) [output file of the compact component id "
+              "of each node as binary uint32]"),
+    cll::init(""));
 static cll::opt<std::string>
     permutationFilename("outputNodePermutation",
                         cll::desc("[output node permutation file]"),
@@ -1035,6 +1045,335 @@ struct EdgeTiledAfforestAlgo {
   }
 };
 
+/**
+ * CC w/ Afforest sampling on a flat array of parents.
+ *
+ * Same algorithm as AfforestAlgo, but the union-find forest is a LargeArray of
+ * 32-bit node ids instead of pointers embedded in the node data, so link and
+ * compress touch a dense array half the size. Compression runs over
+ * contiguous blocks of nodes in branch-free passes that the compiler can turn
+ * into gathers. At the end every node is labelled with a compact component id
+ * in [0, number of components) and a histogram of component sizes is printed.
+ */
+struct FlatAfforestAlgo {
+  struct NodeData {
+    using component_type = uint32_t;
+    //! compact id of the component of this node
+    component_type comp;
+    //! true if this node is the root of its component
+    bool rep;
+
+    component_type component() { return comp; }
+    bool isRep() { return rep; }
+    bool isRepComp(unsigned int) { return false; } // verify
+  };
+  using Graph =
+      galois::graphs::LC_CSR_Graph<NodeData,
+                                   void>::with_no_lockable<true>::type;
+  using GNode          = Graph::GraphNode;
+  using component_type = NodeData::component_type;
+
+  //! nodes per task of the passes over the parent array
+  static const uint32_t BLOCK_SIZE = 4096;
+
+  //! parent of each node; a node is a root iff it is its own parent
+  galois::LargeArray<uint32_t> parent;
+  //! number of components found by the last run
+  uint32_t numComponents = 0;
+  //! root of the sampled largest component of the last run
+  uint32_t largestRoot = 0;
+
+  template <typename G>
+  void readGraph(G& graph) {
+    galois::graphs::readGraph(graph, inputFile);
+  }
+
+  template <typename F>
+  void forEachBlock(uint32_t numNodes, const F& fn, const char* loopname) {
+    uint32_t numBlocks = (numNodes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    galois::do_all(
+        galois::iterate(uint32_t{0}, numBlocks),
+        [&](uint32_t block) {
+          uint32_t begin = block * BLOCK_SIZE;
+          uint32_t end   = std::min(begin + BLOCK_SIZE, numNodes);
+          fn(block, begin, end);
+        },
+        galois::steal(), galois::loopname(loopname));
+  }
+
+  //! Hooks the higher root onto the lower one until a and b share a root
+  void link(uint32_t a, uint32_t b) {
+    uint32_t* p = parent.data();
+    uint32_t pa = __atomic_load_n(&p[a], __ATOMIC_RELAXED);
+    uint32_t pb = __atomic_load_n(&p[b], __ATOMIC_RELAXED);
+    while (pa != pb) {
+      uint32_t high  = std::max(pa, pb);
+      uint32_t low   = std::min(pa, pb);
+      uint32_t pHigh = __atomic_load_n(&p[high], __ATOMIC_RELAXED);
+      if (pHigh == low ||
+          (pHigh == high && __sync_bool_compare_and_swap(&p[high], high, low)))
+        break;
+      pa = __atomic_load_n(&p[pHigh], __ATOMIC_RELAXED);
+      pb = __atomic_load_n(&p[low], __ATOMIC_RELAXED);
+    }
+  }
+
+  /**
+   * Points every node directly to its root. No links may run concurrently;
+   * passes over a block only replace parents with ancestors, so blocks can
+   * be compressed independently.
+   */
+  void compress(uint32_t numNodes, const char* loopname) {
+    uint32_t* p = parent.data();
+    forEachBlock(
+        numNodes,
+        [&](uint32_t, uint32_t begin, uint32_t end) {
+          bool changed;
+          do {
+            changed = false;
+            for (uint32_t i = begin; i < end; ++i) {
+              uint32_t pi  = p[i];
+              uint32_t gpi = p[pi];
+              changed |= (pi != gpi);
+              p[i] = gpi;
+            }
+          } while (changed);
+        },
+        loopname);
+  }
+
+  //! Most frequent root among COMPONENT_SAMPLES random nodes
+  uint32_t approxLargestRoot(uint32_t numNodes) {
+    std::unordered_map<uint32_t, uint32_t> freq(COMPONENT_SAMPLES);
+    std::random_device rd;
+    std::mt19937 rng(rd());
+    std::uniform_int_distribution<uint32_t> dist(0, numNodes - 1);
+    for (uint32_t i = 0; i < COMPONENT_SAMPLES; i++) {
+      freq[parent[dist(rng)]]++;
+    }
+
+    auto mostFrequent = std::max_element(
+        freq.begin(), freq.end(),
+        [](const std::pair<const uint32_t, uint32_t>& a,
+           const std::pair<const uint32_t, uint32_t>& b) {
+          return a.second < b.second;
+        });
+
+    galois::gDebug("Approximate largest intermediate component: ",
+                   mostFrequent->first, " (hit rate ",
+                   100.0 * (mostFrequent->second) / COMPONENT_SAMPLES, "%)");
+
+    return mostFrequent->first;
+  }
+
+  /**
+   * Numbers the roots contiguously in node order and labels every node with
+   * the number of its root. Returns the number of components.
+   */
+  uint32_t assignCompactIds(Graph& graph) {
+    const uint32_t numNodes  = graph.size();
+    const uint32_t numBlocks = (numNodes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const uint32_t* p        = parent.data();
+    std::vector<uint32_t> blockOffsets(numBlocks + 1, 0);
+
+    forEachBlock(
+        numNodes,
+        [&](uint32_t block, uint32_t begin, uint32_t end) {
+          uint32_t roots = 0;
+          for (uint32_t i = begin; i < end; ++i) {
+            roots += (p[i] == i);
+          }
+          blockOffsets[block + 1] = roots;
+        },
+        "FlatAfforest-CountRoots");
+
+    std::partial_sum(blockOffsets.begin(), blockOffsets.end(),
+                     blockOffsets.begin());
+
+    forEachBlock(
+        numNodes,
+        [&](uint32_t block, uint32_t begin, uint32_t end) {
+          uint32_t id = blockOffsets[block];
+          for (uint32_t i = begin; i < end; ++i) {
+            NodeData& data = graph.getData(i, galois::MethodFlag::UNPROTECTED);
+            data.rep       = (p[i] == i);
+            if (data.rep) {
+              data.comp = id++;
+            }
+          }
+        },
+        "FlatAfforest-NumberRoots");
+
+    forEachBlock(
+        numNodes,
+        [&](uint32_t, uint32_t begin, uint32_t end) {
+          for (uint32_t i = begin; i < end; ++i) {
+            NodeData& data = graph.getData(i, galois::MethodFlag::UNPROTECTED);
+            if (!data.rep) {
+              data.comp =
+                  graph.getData(p[i], galois::MethodFlag::UNPROTECTED).comp;
+            }
+          }
+        },
+        "FlatAfforest-Label");
+
+    return blockOffsets[numBlocks];
+  }
+
+  /**
+   * Prints how many components fall in each power-of-two size range. Nodes
+   * of the sampled largest component are counted with a reduction to avoid
+   * contending on a single counter.
+   */
+  void reportHistogram(Graph& graph, uint32_t numComponents,
+                       uint32_t largestRoot) {
+    const uint32_t numNodes = graph.size();
+    const uint32_t* p       = parent.data();
+    const component_type largest =
+        graph.getData(largestRoot, galois::MethodFlag::UNPROTECTED).comp;
+
+    galois::LargeArray<uint32_t> sizes;
+    sizes.create(numComponents, 0);
+    galois::GAccumulator<uint32_t> largestSize;
+
+    forEachBlock(
+        numNodes,
+        [&](uint32_t, uint32_t begin, uint32_t end) {
+          for (uint32_t i = begin; i < end; ++i) {
+            if (p[i] == largestRoot) {
+              largestSize += 1;
+            } else {
+              __sync_fetch_and_add(
+                  &sizes[graph.getData(i, galois::MethodFlag::UNPROTECTED)
+                             .comp],
+                  1);
+            }
+          }
+        },
+        "FlatAfforest-ComponentSizes");
+    sizes[largest] = largestSize.reduce();
+
+    const unsigned numBuckets = 33;
+    std::vector<galois::GAccumulator<size_t>> buckets(numBuckets);
+    galois::GReduceMax<uint32_t> maxSize;
+    galois::do_all(
+        galois::iterate(uint32_t{0}, numComponents),
+        [&](uint32_t c) {
+          uint32_t size = sizes[c];
+          buckets[31 - __builtin_clz(size)] += 1;
+          maxSize.update(size);
+        },
+        galois::loopname("FlatAfforest-Histogram"));
+
+    std::cout << "Components: " << numComponents
+              << " (largest size: " << maxSize.reduce() << ")\n";
+    std::cout << "Component size histogram:\n";
+    for (unsigned b = 0; b < numBuckets; ++b) {
+      size_t count = buckets[b].reduce();
+      if (count) {
+        std::cout << "  [" << (1UL << b) << ", " << (2UL << b)
+                  << "): " << count << "\n";
+      }
+    }
+    galois::runtime::reportStat_Single("FlatAfforest", "Components",
+                                       numComponents);
+    galois::runtime::reportStat_Single("FlatAfforest", "LargestComponent",
+                                       maxSize.reduce());
+  }
+
+  void writeComponents(Graph& graph) {
+    std::ofstream file(componentsFilename, std::ios::binary);
+    if (!file) {
+      GALOIS_DIE("failed to open ", componentsFilename);
+    }
+    for (GNode n : graph) {
+      component_type c =
+          graph.getData(n, galois::MethodFlag::UNPROTECTED).comp;
+      file.write(reinterpret_cast<const char*>(&c), sizeof(c));
+    }
+  }
+
+  void operator()(Graph& graph) {
+    const uint32_t numNodes = graph.size();
+    if (numNodes == 0)
+      return;
+
+    parent.allocateBlocked(numNodes);
+    uint32_t* p = parent.data();
+    forEachBlock(
+        numNodes,
+        [&](uint32_t, uint32_t begin, uint32_t end) {
+          for (uint32_t i = begin; i < end; ++i) {
+            p[i] = i;
+          }
+        },
+        "FlatAfforest-Init");
+
+    // (bozhi) should NOT go through single direction in sampling step: nodes
+    // with edges less than NEIGHBOR_SAMPLES will fail
+    for (uint32_t r = 0; r < NEIGHBOR_SAMPLES; ++r) {
+      galois::do_all(
+          galois::iterate(graph),
+          [&](const GNode& src) {
+            auto ii = graph.edge_begin(src, galois::MethodFlag::UNPROTECTED);
+            auto ei = graph.edge_end(src, galois::MethodFlag::UNPROTECTED);
+            std::advance(ii, r);
+            if (ii < ei) {
+              link(src, graph.getEdgeDst(ii));
+            }
+          },
+          galois::steal(), galois::loopname("FlatAfforest-VNS-Link"));
+      compress(numNodes, "FlatAfforest-VNS-Compress");
+    }
+
+    galois::StatTimer StatTimer_Sampling("FlatAfforest-LCS-Sampling");
+    StatTimer_Sampling.start();
+    const uint32_t c = approxLargestRoot(numNodes);
+    StatTimer_Sampling.stop();
+
+    // Edges into the largest component are linked from the other endpoint,
+    // so its nodes can be skipped entirely on a symmetric graph
+    galois::do_all(
+        galois::iterate(graph),
+        [&](const GNode& src) {
+          if (__atomic_load_n(&p[src], __ATOMIC_RELAXED) == c)
+            return;
+          auto ii = graph.edge_begin(src, galois::MethodFlag::UNPROTECTED);
+          auto ei = graph.edge_end(src, galois::MethodFlag::UNPROTECTED);
+          for (std::advance(ii, NEIGHBOR_SAMPLES.getValue()); ii < ei; ++ii) {
+            link(src, graph.getEdgeDst(ii));
+          }
+        },
+        galois::steal(), galois::loopname("FlatAfforest-LCS-Link"));
+
+    compress(numNodes, "FlatAfforest-LCS-Compress");
+
+    numComponents = assignCompactIds(graph);
+    largestRoot   = p[c];
+  }
+
+  //! Statistics and output of the last run; not part of the timed region
+  void report(Graph& graph) {
+    if (graph.size() == 0)
+      return;
+    reportHistogram(graph, numComponents, largestRoot);
+
+    if (componentsFilename != "") {
+      writeComponents(graph);
+    }
+  }
+};
+
+//! Calls algo.report(graph) after the timed region if the algorithm has it
+template <typename Algo, typename Graph>
+auto reportResults(Algo& algo, Graph& graph, int)
+    -> decltype(algo.report(graph)) {
+  algo.report(graph);
+}
+
+template <typename Algo, typename Graph>
+void reportResults(Algo&, Graph&, long) {}
+
 template <typename Graph>
 bool verify(
     Graph&,
@@ -1194,6 +1533,7 @@ void run() {
   execTime.stop();
 
   galois::reportPageAlloc("MeminfoPost");
+  reportResults(algo, graph, 0);
 
   if (!skipVerify || largestComponentFilename != "" ||
       permutationFilename != "") {
@@ -1248,6 +1588,9 @@ int main(int argc, char** argv) {
   case Algo::edgetiledafforest:
     run<EdgeTiledAfforestAlgo>();
     break;
+  case Algo::flatafforest:
+    run<FlatAfforestAlgo>();
+    break;
 
   default:
     std::cerr << "Unknown algorithm\n";
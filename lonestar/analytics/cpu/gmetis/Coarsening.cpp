@@ -19,6 +19,8 @@
 
 #include "Metis.h"
 #include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/ParallelSTL.h"
 #include "galois/Reduction.h"
 #include "galois/substrate/PerThreadStorage.h"
 #include "galois/gstl.h"
@@ -88,16 +90,15 @@ typedef galois::GAccumulator<unsigned> Pcounter;
  nodes. RM.h
  3. Heavy Edge Matching matches the vertex which is connected by the heaviest
  edge. HEM.h
- 4. This function can also create the multinode, i.e. the node which is created
- on combining two matched nodes.
- 5. You can enable/disable 4th by changing variantMetis::mergeMatching
+ 4. Matched nodes record each other as parent; unmatched nodes record
+ themselves when selfMatch is set. createCoarseGraph turns the pairs into
+ the nodes of the coarser graph.
 */
 template <MatchingPolicy matcher, typename WL>
-void parallelMatchAndCreateNodes(MetisGraph* graph, Pcounter& pc,
-                                 GNodeBag& noEdgeBag, bool selfMatch) {
-  GGraph* fineGGraph   = graph->getFinerGraph()->getGraph();
-  GGraph* coarseGGraph = graph->getGraph();
-  assert(fineGGraph != coarseGGraph);
+void parallelMatch(MetisGraph* graph, Pcounter& pc, GNodeBag& noEdgeBag,
+                   bool selfMatch) {
+  GGraph* fineGGraph = graph->getFinerGraph()->getGraph();
+  assert(fineGGraph != graph->getGraph());
 
   galois::for_each(
       galois::iterate(*fineGGraph),
@@ -124,101 +125,208 @@ void parallelMatchAndCreateNodes(MetisGraph* graph, Pcounter& pc,
         // lock before (final) read ensures that we will see any write to
         // matched
 
-        unsigned numEdges = std::distance(
-            fineGGraph->edge_begin(item, galois::MethodFlag::UNPROTECTED),
-            fineGGraph->edge_end(item, galois::MethodFlag::UNPROTECTED));
-        // assert(numEdges == std::distance(fineGGraph->edge_begin(item),
-        // fineGGraph->edge_end(item)));
-
-        GNode N;
         if (ret != item) {
           // match found
-          numEdges += std::distance(
-              fineGGraph->edge_begin(ret, galois::MethodFlag::UNPROTECTED),
-              fineGGraph->edge_end(ret, galois::MethodFlag::UNPROTECTED));
-          // Cautious point
-          N = coarseGGraph->createNode(numEdges,
-                                       fineGGraph->getData(item).getWeight() +
-                                           fineGGraph->getData(ret).getWeight(),
-                                       item, ret);
           fineGGraph->getData(item).setMatched();
           fineGGraph->getData(ret).setMatched();
-          fineGGraph->getData(item).setParent(N);
-          fineGGraph->getData(ret).setParent(N);
-        } else {
-          // assertAllMatched(item, fineGGraph);
-          // Cautious point
+          fineGGraph->getData(item).setParent(ret);
+          fineGGraph->getData(ret).setParent(item);
+        } else if (selfMatch) {
           // no match
-          if (selfMatch) {
-            pc.update(1U);
-            N = coarseGGraph->createNode(
-                numEdges, fineGGraph->getData(item).getWeight(), item);
-            fineGGraph->getData(item).setMatched();
-            fineGGraph->getData(item).setParent(N);
-          }
+          pc.update(1U);
+          fineGGraph->getData(item).setMatched();
+          fineGGraph->getData(item).setParent(item);
         }
       },
       galois::wl<WL>(), galois::no_pushes(), galois::loopname("match"));
 }
 
 /*
- * This function is responsible for doing a union find of the edges
- * between matched nodes and populate the edges in the coarser graph
- * node.
+ * Scratch arrays shared by every level of one coarsening run. They are sized
+ * by the finest level and reused while the graphs shrink, so building a level
+ * allocates nothing but the coarse CSR itself.
+ */
+struct CoarseningArena {
+  galois::LargeArray<GNode> coarseId;
+  galois::LargeArray<GNode> child0;
+  galois::LargeArray<GNode> child1;
+  galois::LargeArray<uint64_t> bound;
+  galois::LargeArray<uint64_t> degree;
+  galois::LargeArray<GNode> edgeDst;
+  galois::LargeArray<int> edgeWeight;
+
+  template <typename T>
+  static void reserve(galois::LargeArray<T>& a, size_t n) {
+    if (a.size() >= n)
+      return;
+    a.deallocate();
+    a.allocateInterleaved(n);
+  }
+};
+
+/*
+ * Per thread open addressing table that merges the parallel edges of a coarse
+ * node. It maps a coarse neighbor to the position of its merged edge.
+ */
+class EdgeMerger {
+  std::vector<GNode> keys;
+  std::vector<uint32_t> slots;
+  std::vector<uint32_t> used;
+  uint32_t mask = 0;
+
+public:
+  void reset(uint64_t maxEdges) {
+    uint64_t cap = 16;
+    while (cap < 2 * maxEdges)
+      cap <<= 1;
+    if (keys.size() < cap) {
+      keys.assign(cap, NO_NODE);
+      slots.resize(cap);
+    }
+    mask = cap - 1;
+  }
+
+  //! Returns the slot of key and whether it was just inserted
+  std::pair<uint32_t, bool> insert(GNode key, uint32_t slot) {
+    uint32_t h = (key * 2654435761u) & mask;
+    while (keys[h] != NO_NODE) {
+      if (keys[h] == key)
+        return std::make_pair(slots[h], false);
+      h = (h + 1) & mask;
+    }
+    keys[h]  = key;
+    slots[h] = slot;
+    used.push_back(h);
+    return std::make_pair(slot, true);
+  }
+
+  void clear() {
+    for (auto h : used)
+      keys[h] = NO_NODE;
+    used.clear();
+  }
+};
+
+/*
+ * Builds the coarser graph straight into a CSR. Matched pairs are numbered by
+ * a prefix sum over their representatives (the smaller node id), and each
+ * coarse node merges the edges of its children into the arena at offsets
+ * given by a prefix sum of the pair degrees. A second prefix sum over the
+ * merged degrees compacts them into the coarse graph.
  */
-void createCoarseEdges(MetisGraph* graph) {
+void createCoarseGraph(MetisGraph* graph, CoarseningArena& arena) {
   GGraph* coarseGGraph = graph->getGraph();
   GGraph* fineGGraph   = graph->getFinerGraph()->getGraph();
   assert(fineGGraph != coarseGGraph);
+  constexpr auto flag = galois::MethodFlag::UNPROTECTED;
 
-  typedef galois::gstl::Vector<std::pair<GNode, unsigned>> VecTy;
-  typedef galois::substrate::PerThreadStorage<VecTy> ThreadLocalData;
-  ThreadLocalData edgesThreadLocal;
+  auto degreeOf = [&](GNode n) -> uint64_t {
+    return std::distance(fineGGraph->edge_begin(n, flag),
+                         fineGGraph->edge_end(n, flag));
+  };
 
+  const size_t numFine = fineGGraph->size();
+  arena.reserve(arena.coarseId, numFine);
   galois::do_all(
-      galois::iterate(*coarseGGraph),
-      [&](GNode node) {
-        //    std::cout << 'p';
-        // fineGGraph is read only in this loop, so skip locks
-        MetisNode& nodeData =
-            coarseGGraph->getData(node, galois::MethodFlag::UNPROTECTED);
-
-        auto& edges = *edgesThreadLocal.getLocal();
-        edges.clear();
-        for (unsigned x = 0; x < nodeData.numChildren(); ++x) {
-          for (auto ii : fineGGraph->edges(nodeData.getChild(x),
-                                           galois::MethodFlag::UNPROTECTED)) {
-            GNode dst = fineGGraph->getEdgeDst(ii);
-            GNode p = fineGGraph->getData(dst, galois::MethodFlag::UNPROTECTED)
-                          .getParent();
-            edges.emplace_back(p, fineGGraph->getEdgeData(
-                                      ii, galois::MethodFlag::UNPROTECTED));
-          }
-        }
-
-        // slightly faster not ordering by edge weight
-        // std::sort(edges.begin(), edges.end(), [] (const std::pair<GNode,
-        // unsigned>& lhs, const std::pair<GNode, unsigned>& rhs) { return
-        // lhs.first < rhs.first; } );
-
-        // insert edges
-        for (auto pp = edges.begin(), ep = edges.end(); pp != ep;) {
-          GNode dst    = pp->first;
-          unsigned sum = pp->second;
-          ++pp;
-          if (node != dst) { // no self edges
-            while (pp != ep && pp->first == dst) {
-              sum += pp->second;
-              ++pp;
+      galois::iterate(size_t{0}, numFine),
+      [&](GNode n) {
+        arena.coarseId[n] =
+            fineGGraph->getData(n, flag).getParent() >= n ? 1 : 0;
+      },
+      galois::loopname("markRepresentatives"));
+  galois::ParallelSTL::partial_sum(arena.coarseId.begin(),
+                                   arena.coarseId.begin() + numFine,
+                                   arena.coarseId.begin());
+  const size_t numCoarse = numFine ? arena.coarseId[numFine - 1] : 0;
+
+  arena.reserve(arena.child0, numCoarse);
+  arena.reserve(arena.child1, numCoarse);
+  arena.reserve(arena.bound, numCoarse);
+  arena.reserve(arena.degree, numCoarse);
+  galois::do_all(
+      galois::iterate(size_t{0}, numFine),
+      [&](GNode n) {
+        GNode mate = fineGGraph->getData(n, flag).getParent();
+        if (mate < n)
+          return;
+        GNode c         = arena.coarseId[n] - 1;
+        arena.child0[c] = n;
+        arena.child1[c] = mate == n ? NO_NODE : mate;
+        arena.bound[c]  = degreeOf(n) + (mate == n ? 0 : degreeOf(mate));
+      },
+      galois::loopname("collectPairs"));
+  galois::do_all(
+      galois::iterate(size_t{0}, numFine),
+      [&](GNode n) {
+        auto& nd = fineGGraph->getData(n, flag);
+        nd.setParent(arena.coarseId[std::min(n, nd.getParent())] - 1);
+      },
+      galois::loopname("setParents"));
+  galois::ParallelSTL::partial_sum(arena.bound.begin(),
+                                   arena.bound.begin() + numCoarse,
+                                   arena.bound.begin());
+  const uint64_t maxEdges = numCoarse ? arena.bound[numCoarse - 1] : 0;
+  arena.reserve(arena.edgeDst, maxEdges);
+  arena.reserve(arena.edgeWeight, maxEdges);
+
+  galois::substrate::PerThreadStorage<EdgeMerger> mergers;
+  galois::do_all(
+      galois::iterate(size_t{0}, numCoarse),
+      [&](GNode c) {
+        uint64_t begin     = c ? arena.bound[c - 1] : 0;
+        EdgeMerger& merger = *mergers.getLocal();
+        merger.reset(arena.bound[c] - begin);
+        uint32_t count = 0;
+        for (GNode child : {arena.child0[c], arena.child1[c]}) {
+          if (child == NO_NODE)
+            continue;
+          for (auto ii : fineGGraph->edges(child, flag)) {
+            GNode dst = fineGGraph->getData(fineGGraph->getEdgeDst(ii), flag)
+                            .getParent();
+            if (dst == c) // no self edges
+              continue;
+            int w     = fineGGraph->getEdgeData(ii, flag);
+            auto slot = merger.insert(dst, count);
+            if (slot.second) {
+              arena.edgeDst[begin + count]    = dst;
+              arena.edgeWeight[begin + count] = w;
+              ++count;
+            } else {
+              arena.edgeWeight[begin + slot.first] += w;
             }
-            coarseGGraph->addMultiEdge(node, dst,
-                                       galois::MethodFlag::UNPROTECTED, sum);
           }
         }
-        //    assert(e);
-        // nodeData.setNumEdges(e);
+        merger.clear();
+        arena.degree[c] = count;
+      },
+      galois::steal(), galois::loopname("mergeEdges"));
+  galois::ParallelSTL::partial_sum(arena.degree.begin(),
+                                   arena.degree.begin() + numCoarse,
+                                   arena.degree.begin());
+
+  coarseGGraph->allocateFrom(numCoarse,
+                             numCoarse ? arena.degree[numCoarse - 1] : 0);
+  coarseGGraph->constructNodes();
+  galois::do_all(
+      galois::iterate(size_t{0}, numCoarse),
+      [&](GNode c) {
+        GNode c0   = arena.child0[c];
+        GNode c1   = arena.child1[c];
+        int weight = fineGGraph->getData(c0, flag).getWeight();
+        if (c1 != NO_NODE)
+          weight += fineGGraph->getData(c1, flag).getWeight();
+        coarseGGraph->getData(c, flag) = MetisNode(weight, c0, c1);
+
+        uint64_t src = c ? arena.bound[c - 1] : 0;
+        uint64_t dst = c ? arena.degree[c - 1] : 0;
+        uint64_t end = arena.degree[c];
+        coarseGGraph->fixEndEdge(c, end);
+        for (; dst < end; ++dst, ++src)
+          coarseGGraph->constructEdge(dst, arena.edgeDst[src],
+                                      arena.edgeWeight[src]);
       },
-      galois::steal(), galois::loopname("popedge"));
+      galois::steal(), galois::loopname("buildCSR"));
+  coarseGGraph->initializeLocalRanges();
 }
 
 struct HighDegreeIndexer {
@@ -267,29 +375,22 @@ struct WeightIndexer {
   return num;
 }*/
 
-unsigned fixupLoners(GNodeBag& b, GGraph* coarseGGraph, GGraph* fineGGraph) {
+unsigned fixupLoners(GNodeBag& b, GGraph* fineGGraph) {
   unsigned count = 0;
   auto ii = b.begin(), ee = b.end();
   while (ii != ee) {
     auto i2 = ii;
     ++i2;
     if (i2 != ee) {
-      GNode N =
-          coarseGGraph->createNode(0,
-                                   fineGGraph->getData(*ii).getWeight() +
-                                       fineGGraph->getData(*i2).getWeight(),
-                                   *ii, *i2);
       fineGGraph->getData(*ii).setMatched();
       fineGGraph->getData(*i2).setMatched();
-      fineGGraph->getData(*ii).setParent(N);
-      fineGGraph->getData(*i2).setParent(N);
+      fineGGraph->getData(*ii).setParent(*i2);
+      fineGGraph->getData(*i2).setParent(*ii);
       ++ii;
       ++count;
     } else {
-      GNode N = coarseGGraph->createNode(
-          0, fineGGraph->getData(*ii).getWeight(), *ii);
       fineGGraph->getData(*ii).setMatched();
-      fineGGraph->getData(*ii).setParent(N);
+      fineGGraph->getData(*ii).setParent(*ii);
     }
     ++ii;
   }
@@ -315,7 +416,7 @@ unsigned findMatching(MetisGraph* coarseMetisGraph, bool useRM, bool use2Hop,
 
   typedef galois::worklists::StableIterator<true> WL;
   if (useRM) {
-    parallelMatchAndCreateNodes<RMmatch, WL>(coarseMetisGraph, pc, bagOfLoners,
+    parallelMatch<RMmatch, WL>(coarseMetisGraph, pc, bagOfLoners,
                                              !use2Hop);
   } else {
     // FIXME: use obim for SHEM matching
@@ -329,14 +430,13 @@ unsigned findMatching(MetisGraph* coarseMetisGraph, bool useRM, bool use2Hop,
 
     HighDegreeIndexer::indexgraph = fineMetisGraph->getGraph();
     if (useOBIM)
-      parallelMatchAndCreateNodes<HEMmatch, pLD>(coarseMetisGraph, pc,
+      parallelMatch<HEMmatch, pLD>(coarseMetisGraph, pc,
                                                  bagOfLoners, !use2Hop);
     else
-      parallelMatchAndCreateNodes<HEMmatch, WL>(coarseMetisGraph, pc,
+      parallelMatch<HEMmatch, WL>(coarseMetisGraph, pc,
                                                 bagOfLoners, !use2Hop);
   }
-  unsigned c = fixupLoners(bagOfLoners, coarseMetisGraph->getGraph(),
-                           fineMetisGraph->getGraph());
+  unsigned c = fixupLoners(bagOfLoners, fineMetisGraph->getGraph());
   if (verbose && c)
     std::cout << "\n\tLone Matches " << c;
   if (use2Hop) {
@@ -351,18 +451,19 @@ unsigned findMatching(MetisGraph* coarseMetisGraph, bool useRM, bool use2Hop,
     HighDegreeIndexer::indexgraph = fineMetisGraph->getGraph();
     Pcounter pc2;
     if (useOBIM)
-      parallelMatchAndCreateNodes<TwoHopMatcher<HEMmatch>, pLD>(
+      parallelMatch<TwoHopMatcher<HEMmatch>, pLD>(
           coarseMetisGraph, pc2, bagOfLoners, true);
     else
-      parallelMatchAndCreateNodes<TwoHopMatcher<HEMmatch>, WL>(
+      parallelMatch<TwoHopMatcher<HEMmatch>, WL>(
           coarseMetisGraph, pc2, bagOfLoners, true);
     return pc2.reduce();
   }
   return pc.reduce();
 }
 
-MetisGraph* coarsenOnce(MetisGraph* fineMetisGraph, unsigned& rem, bool useRM,
-                        bool with2Hop, bool verbose) {
+MetisGraph* coarsenOnce(MetisGraph* fineMetisGraph, CoarseningArena& arena,
+                        unsigned& rem, bool useRM, bool with2Hop,
+                        bool verbose) {
   MetisGraph* coarseMetisGraph = new MetisGraph(fineMetisGraph);
   galois::Timer t, t2;
   if (verbose)
@@ -373,7 +474,7 @@ MetisGraph* coarsenOnce(MetisGraph* fineMetisGraph, unsigned& rem, bool useRM,
     std::cout << "\n\tTime Matching " << t.get() << "\n";
     t2.start();
   }
-  createCoarseEdges(coarseMetisGraph);
+  createCoarseGraph(coarseMetisGraph, arena);
   if (verbose) {
     t2.stop();
     std::cout << "\tTime Creating " << t2.get() << "\n";
@@ -391,13 +492,15 @@ MetisGraph* coarsen(MetisGraph* fineMetisGraph, unsigned coarsenTo,
   unsigned iterNum        = 0;
   bool with2Hop           = false;
   unsigned stat           = 0;
+  CoarseningArena arena;
   while (true) { // overflow
     if (verbose) {
       std::cout << "Coarsening " << iterNum << "\t";
       stat = graphStat(*coarseGraph->getGraph());
     }
     unsigned rem     = 0;
-    coarseGraph      = coarsenOnce(coarseGraph, rem, false, with2Hop, verbose);
+    coarseGraph =
+        coarsenOnce(coarseGraph, arena, rem, false, with2Hop, verbose);
     unsigned newSize = size / 2 + rem / 2;
     if (verbose) {
       std::cout << "\tTO\t";
@@ -192,7 +192,7 @@ int main(int argc, char** argv) {
           // weight+=1;
         }
       },
-      galois::loopname("initMorphGraph"));
+      galois::loopname("initGraph"));
 
   graphStat(graph);
   std::cout << "\n";
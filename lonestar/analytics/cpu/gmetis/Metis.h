@@ -20,13 +20,19 @@
 #ifndef METIS_H_
 #define METIS_H_
 
-#include "galois/graphs/LC_Morph_Graph.h"
+#include "galois/graphs/LC_CSR_Graph.h"
+
+#include <limits>
 
 class MetisNode;
-using GGraph   = galois::graphs::LC_Morph_Graph<MetisNode, int>;
+using GGraph =
+    galois::graphs::LC_CSR_Graph<MetisNode, int>::with_numa_alloc<true>::type;
 using GNode    = GGraph::GraphNode;
 using GNodeBag = galois::InsertBag<GNode>;
 
+//! Marks a missing node, e.g. the second child of an unmatched coarse node
+constexpr GNode NO_NODE = std::numeric_limits<GNode>::max();
+
 // algorithms
 enum InitialPartMode { GGP, GGGP, MGGGP };
 enum refinementMode { BKL, BKL2, ROBO, GRACLUS };
@@ -52,7 +58,7 @@ class MetisNode {
   void initCoarsen() {
     data.cd.matched     = false;
     data.cd.failedmatch = false;
-    data.cd.parent      = NULL;
+    data.cd.parent      = NO_NODE;
   }
 
 public:
@@ -61,9 +67,10 @@ public:
   explicit MetisNode(int weight) : _weight(weight) {
     initCoarsen();
     initPartition();
+    children[0] = children[1] = NO_NODE;
   }
 
-  MetisNode(unsigned weight, GNode child0, GNode child1 = NULL)
+  MetisNode(unsigned weight, GNode child0, GNode child1 = NO_NODE)
       : _weight(weight) {
     initCoarsen();
     initPartition();
@@ -74,6 +81,7 @@ public:
   MetisNode() : _weight(1) {
     initCoarsen();
     initPartition();
+    children[0] = children[1] = NO_NODE;
   }
 
   // call to switch data to refining
@@ -87,7 +95,7 @@ public:
 
   void setParent(GNode p) { data.cd.parent = p; }
   GNode getParent() const {
-    assert(data.cd.parent);
+    assert(data.cd.parent != NO_NODE);
     return data.cd.parent;
   }
 
@@ -98,7 +106,7 @@ public:
   bool isFailedMatch() const { return data.cd.failedmatch; }
 
   GNode getChild(unsigned x) const { return children[x]; }
-  unsigned numChildren() const { return children[1] ? 2 : 1; }
+  unsigned numChildren() const { return children[1] != NO_NODE ? 2 : 1; }
 
   unsigned getPart() const { return data.rd.partition; }
   void setPart(unsigned val) { data.rd.partition = val; }
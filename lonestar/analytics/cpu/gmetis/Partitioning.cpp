@@ -281,8 +281,8 @@ void refine_kl(GGraph& graph, std::vector<GNode>& boundary, int oldPartNum,
       PerThreadPartInfo iterationInfo;
       for (unsigned int i = 0; i < iterationInfo.size(); i++) {
         iterationInfo.getRemote(i)->first         = INT_MIN;
-        iterationInfo.getRemote(i)->second.first  = NULL;
-        iterationInfo.getRemote(i)->second.second = NULL;
+        iterationInfo.getRemote(i)->second.first  = NO_NODE;
+        iterationInfo.getRemote(i)->second.second = NO_NODE;
       }
       KLMatch(graph, boundary, iterationInfo, oldPartNum, newPartNum);
       PartMatch bestMatch;
@@ -293,7 +293,8 @@ void refine_kl(GGraph& graph, std::vector<GNode>& boundary, int oldPartNum,
           bestMatch = match;
         }
       }
-      if (bestMatch.second.first == NULL || bestMatch.second.second == NULL)
+      if (bestMatch.second.first == NO_NODE ||
+          bestMatch.second.second == NO_NODE)
         break;
       auto& m1 = graph.getData(bestMatch.second.first);
       auto& m2 = graph.getData(bestMatch.second.second);
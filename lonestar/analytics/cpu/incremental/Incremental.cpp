@@ -0,0 +1,558 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Bag.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LC_Dynamic_CSR_Graph.h"
+#include "galois/graphs/ReadGraph.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace cll = llvm::cl;
+
+static const char* name = "Incremental Graph Analytics";
+static const char* desc =
+    "Maintains BFS levels, shortest path distances or connected components "
+    "of a symmetric graph while batches of edges are inserted and deleted";
+static const char* url = nullptr;
+
+enum Algo { bfs, sssp, cc };
+
+static cll::opt<std::string>
+    inputFile(cll::Positional, cll::desc("<input file>"), cll::Required);
+static cll::opt<Algo> algo(
+    "algo", cll::desc("Choose an analytic:"),
+    cll::values(clEnumValN(Algo::bfs, "bfs", "Breadth-first search (default)"),
+                clEnumValN(Algo::sssp, "sssp", "Single-source shortest paths"),
+                clEnumValN(Algo::cc, "cc", "Connected components")),
+    cll::init(Algo::bfs));
+static cll::opt<unsigned int>
+    startNode("startNode",
+              cll::desc("Node to start search from (default value 0)"),
+              cll::init(0));
+static cll::opt<unsigned int>
+    stepShift("delta",
+              cll::desc("Shift value for the deltastep (default value 13)"),
+              cll::init(13));
+static cll::opt<unsigned int>
+    numBatches("numBatches",
+               cll::desc("Number of update batches to apply (default 10)"),
+               cll::init(10));
+static cll::opt<unsigned int> insertionsPerBatch(
+    "insertionsPerBatch",
+    cll::desc("Undirected edges inserted per batch (default 10000)"),
+    cll::init(10000));
+static cll::opt<unsigned int> deletionsPerBatch(
+    "deletionsPerBatch",
+    cll::desc("Undirected edges deleted per batch (default 1000)"),
+    cll::init(1000));
+static cll::opt<unsigned int>
+    maxWeight("maxWeight",
+              cll::desc("Maximum weight of inserted edges (default 100)"),
+              cll::init(100));
+
+struct NodeData {
+  //! bfs/sssp: distance in the upper 32 bits and parent in the lower 32 bits
+  //! so that both change in one CAS; cc: union-find parent
+  std::atomic<uint64_t> label;
+};
+
+using Graph = galois::graphs::LC_Dynamic_CSR_Graph<NodeData, uint32_t>::
+    with_no_lockable<true>::type;
+using GNode = Graph::GraphNode;
+
+constexpr galois::MethodFlag flag = galois::MethodFlag::UNPROTECTED;
+
+/**
+ * A batch of updates to a symmetric graph; both directions of every edge are
+ * listed.
+ */
+struct Batch {
+  std::vector<Graph::EdgeInsertion> insertions;
+  std::vector<Graph::EdgeDeletion> deletions;
+};
+
+/**
+ * BFS levels or SSSP distances from startNode, kept together with a shortest
+ * path tree so that deletions only invalidate the subtrees below deleted tree
+ * edges.
+ */
+class ShortestPaths {
+  using Dist = uint32_t;
+
+  static constexpr Dist DIST_INFINITY = std::numeric_limits<Dist>::max() / 2 - 1;
+  static constexpr GNode NO_PARENT    = std::numeric_limits<GNode>::max();
+
+  struct UpdateRequest {
+    GNode src;
+    Dist dist;
+  };
+
+  struct UpdateRequestIndexer {
+    unsigned shift;
+    unsigned int operator()(const UpdateRequest& req) const {
+      return req.dist >> shift;
+    }
+  };
+
+  using OBIM = galois::worklists::OrderedByIntegerMetric<
+      UpdateRequestIndexer, galois::worklists::PerSocketChunkFIFO<64>>;
+
+  Graph& graph;
+  GNode source;
+  bool useWeights;
+
+  static uint64_t pack(Dist dist, GNode parent) {
+    return (static_cast<uint64_t>(dist) << 32) | parent;
+  }
+  static Dist distOf(uint64_t label) { return label >> 32; }
+  static GNode parentOf(uint64_t label) { return static_cast<GNode>(label); }
+
+  Dist dist(GNode n) { return distOf(graph.getData(n, flag).label); }
+
+  Dist weight(Graph::edge_iterator e) {
+    return useWeights ? graph.getEdgeData(e) : 1;
+  }
+
+  //! Lowers the distance of n to d through parent; true if it improved
+  bool improve(GNode n, Dist d, GNode parent) {
+    auto& label  = graph.getData(n, flag).label;
+    uint64_t old = label.load(std::memory_order_relaxed);
+    while (distOf(old) > d) {
+      if (label.compare_exchange_weak(old, pack(d, parent),
+                                      std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  //! Label-correcting relaxation from the seeds until distances are stable
+  void relax(galois::InsertBag<UpdateRequest>& seeds) {
+    galois::for_each(
+        galois::iterate(seeds),
+        [&](const UpdateRequest& req, auto& ctx) {
+          Dist sdist = dist(req.src);
+          if (sdist < req.dist)
+            return;
+          for (auto e : graph.edges(req.src, flag)) {
+            GNode dst    = graph.getEdgeDst(e);
+            Dist newDist = sdist + weight(e);
+            if (improve(dst, newDist, req.src))
+              ctx.push(UpdateRequest{dst, newDist});
+          }
+        },
+        galois::wl<OBIM>(UpdateRequestIndexer{stepShift}),
+        galois::disable_conflict_detection(),
+        galois::loopname("Incremental-Relax"));
+  }
+
+  /**
+   * Resets the distance of every node whose tree path used a deleted edge and
+   * returns those nodes.
+   */
+  void invalidate(const std::vector<Graph::EdgeDeletion>& deletions,
+                  galois::InsertBag<GNode>& invalid) {
+    galois::InsertBag<GNode> roots;
+    galois::do_all(
+        galois::iterate(deletions),
+        [&](const Graph::EdgeDeletion& del) {
+          GNode child  = del.second;
+          auto& label  = graph.getData(child, flag).label;
+          uint64_t old = label.load(std::memory_order_relaxed);
+          if (child != source && distOf(old) != DIST_INFINITY &&
+              parentOf(old) == del.first &&
+              label.compare_exchange_strong(old,
+                                            pack(DIST_INFINITY, NO_PARENT)))
+            roots.push(child);
+        },
+        galois::loopname("Incremental-InvalidateRoots"));
+
+    galois::for_each(
+        galois::iterate(roots),
+        [&](GNode n, auto& ctx) {
+          invalid.push(n);
+          for (auto e : graph.edges(n, flag)) {
+            GNode child  = graph.getEdgeDst(e);
+            auto& label  = graph.getData(child, flag).label;
+            uint64_t old = label.load(std::memory_order_relaxed);
+            if (distOf(old) != DIST_INFINITY && parentOf(old) == n &&
+                label.compare_exchange_strong(old,
+                                              pack(DIST_INFINITY, NO_PARENT)))
+              ctx.push(child);
+          }
+        },
+        galois::disable_conflict_detection(),
+        galois::loopname("Incremental-InvalidateSubtrees"));
+  }
+
+public:
+  ShortestPaths(Graph& g, GNode s, bool weights)
+      : graph(g), source(s), useWeights(weights) {}
+
+  void compute() {
+    galois::do_all(galois::iterate(graph), [&](GNode n) {
+      graph.getData(n, flag).label = pack(DIST_INFINITY, NO_PARENT);
+    });
+    graph.getData(source, flag).label = pack(0, source);
+
+    galois::InsertBag<UpdateRequest> seeds;
+    seeds.push(UpdateRequest{source, 0});
+    relax(seeds);
+  }
+
+  void update(Batch& batch) {
+    graph.deleteEdges(batch.deletions);
+
+    // Deletions can only lengthen paths: nodes outside the invalidated
+    // subtrees keep their distances, and invalidated nodes restart from the
+    // best of their valid neighbors (in-neighbors, since the graph is
+    // symmetric)
+    galois::InsertBag<GNode> invalid;
+    invalidate(batch.deletions, invalid);
+
+    galois::InsertBag<UpdateRequest> seeds;
+    galois::do_all(
+        galois::iterate(invalid),
+        [&](GNode n) {
+          for (auto e : graph.edges(n, flag)) {
+            GNode nbr    = graph.getEdgeDst(e);
+            Dist nbrDist = dist(nbr);
+            if (nbrDist != DIST_INFINITY)
+              improve(n, nbrDist + weight(e), nbr);
+          }
+          if (dist(n) != DIST_INFINITY)
+            seeds.push(UpdateRequest{n, dist(n)});
+        },
+        galois::steal(), galois::loopname("Incremental-Reseed"));
+
+    graph.insertEdges(batch.insertions);
+
+    // Insertions can only shorten paths: relax from the new edges
+    galois::do_all(
+        galois::iterate(batch.insertions),
+        [&](const Graph::EdgeInsertion& ins) {
+          Dist srcDist = dist(ins.src);
+          if (srcDist != DIST_INFINITY &&
+              improve(ins.dst, srcDist + (useWeights ? ins.data : 1), ins.src))
+            seeds.push(UpdateRequest{ins.dst, dist(ins.dst)});
+        },
+        galois::loopname("Incremental-SeedInsertions"));
+
+    relax(seeds);
+
+    galois::runtime::reportStat_Tsum("Incremental", "Invalidated",
+                                     std::distance(invalid.begin(),
+                                                   invalid.end()));
+  }
+
+  //! Distances of all nodes
+  std::vector<Dist> distances() {
+    std::vector<Dist> d(graph.size());
+    galois::do_all(galois::iterate(graph), [&](GNode n) { d[n] = dist(n); });
+    return d;
+  }
+
+  size_t reachable() {
+    galois::GAccumulator<size_t> count;
+    galois::do_all(galois::iterate(graph), [&](GNode n) {
+      if (dist(n) != DIST_INFINITY)
+        count += 1;
+    });
+    return count.reduce();
+  }
+};
+
+/**
+ * Connected components as a union-find forest where every root is the
+ * smallest node of its component. Insertions link their endpoints; deletions
+ * recompute only the components they touch.
+ */
+class Components {
+  Graph& graph;
+  //! marks the nodes found to be in a touched component during one batch
+  galois::LargeArray<uint8_t> inReset;
+
+  uint32_t parent(GNode n) {
+    return graph.getData(n, flag).label.load(std::memory_order_relaxed);
+  }
+
+  //! Root of n with path halving; only non-roots are written, and always to
+  //! one of their ancestors, so concurrent finds and links stay consistent
+  GNode find(GNode n) {
+    GNode p = parent(n);
+    while (p != n) {
+      GNode gp = parent(p);
+      if (gp != p)
+        graph.getData(n, flag).label.store(gp, std::memory_order_relaxed);
+      n = p;
+      p = gp;
+    }
+    return n;
+  }
+
+  //! Hooks the higher root onto the lower one until a and b share a root
+  void link(GNode a, GNode b) {
+    while (true) {
+      GNode ra = find(a);
+      GNode rb = find(b);
+      if (ra == rb)
+        return;
+      GNode high        = std::max(ra, rb);
+      uint64_t expected = high;
+      if (graph.getData(high, flag)
+              .label.compare_exchange_strong(expected, std::min(ra, rb)))
+        return;
+    }
+  }
+
+  template <typename Range>
+  void compress(Range& range) {
+    galois::do_all(
+        galois::iterate(range),
+        [&](GNode n) {
+          graph.getData(n, flag).label.store(find(n),
+                                             std::memory_order_relaxed);
+        },
+        galois::steal(), galois::loopname("Incremental-Compress"));
+  }
+
+  template <typename Range>
+  void linkAll(Range& range) {
+    galois::do_all(
+        galois::iterate(range),
+        [&](GNode n) {
+          for (auto e : graph.edges(n, flag)) {
+            link(n, graph.getEdgeDst(e));
+          }
+        },
+        galois::steal(), galois::loopname("Incremental-Link"));
+  }
+
+public:
+  explicit Components(Graph& g) : graph(g) {}
+
+  void compute() {
+    inReset.create(graph.size(), 0);
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) { graph.getData(n, flag).label = n; });
+    linkAll(graph);
+    compress(graph);
+  }
+
+  void update(Batch& batch) {
+    graph.deleteEdges(batch.deletions);
+
+    // A deletion may split its component. Every piece of a split component
+    // still contains an endpoint of a deleted edge, so a traversal from the
+    // endpoints finds exactly the nodes of the touched components; they are
+    // reset and the edges that remain among them are relinked
+    galois::InsertBag<GNode> reset;
+    auto visit = [&](GNode n, auto& ctx) {
+      if (!__sync_bool_compare_and_swap(&inReset[n], 0, 1))
+        return;
+      reset.push(n);
+      graph.getData(n, flag).label = n;
+      for (auto e : graph.edges(n, flag)) {
+        GNode dst = graph.getEdgeDst(e);
+        if (!inReset[dst])
+          ctx.push(dst);
+      }
+    };
+    std::vector<GNode> endpoints(batch.deletions.size());
+    galois::do_all(
+        galois::iterate(size_t{0}, batch.deletions.size()),
+        [&](size_t i) { endpoints[i] = batch.deletions[i].first; },
+        galois::no_stats());
+    galois::for_each(galois::iterate(endpoints), visit,
+                     galois::disable_conflict_detection(),
+                     galois::loopname("Incremental-FindTouched"));
+    linkAll(reset);
+    galois::do_all(galois::iterate(reset), [&](GNode n) { inReset[n] = 0; },
+                   galois::no_stats());
+
+    graph.insertEdges(batch.insertions);
+    galois::do_all(
+        galois::iterate(batch.insertions),
+        [&](const Graph::EdgeInsertion& ins) { link(ins.src, ins.dst); },
+        galois::loopname("Incremental-LinkInsertions"));
+
+    // Linking may have hooked whole components under a new root. Only the
+    // relinked nodes are compressed; the others reach their new root through
+    // their old one, and find() halves those paths as it walks them
+    compress(reset);
+    galois::runtime::reportStat_Tsum("Incremental", "Reset",
+                                     std::distance(reset.begin(), reset.end()));
+  }
+
+  std::vector<uint32_t> components() {
+    std::vector<uint32_t> c(graph.size());
+    galois::do_all(galois::iterate(graph), [&](GNode n) { c[n] = find(n); });
+    return c;
+  }
+
+  size_t numComponents() {
+    galois::GAccumulator<size_t> count;
+    galois::do_all(galois::iterate(graph), [&](GNode n) {
+      if (parent(n) == n)
+        count += 1;
+    });
+    return count.reduce();
+  }
+};
+
+/**
+ * Random batch of undirected insertions and deletions of existing edges.
+ */
+Batch makeBatch(Graph& graph, unsigned seed) {
+  Batch batch;
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<GNode> node(0, graph.size() - 1);
+  std::uniform_int_distribution<uint32_t> weight(1, maxWeight);
+
+  for (unsigned i = 0; i < insertionsPerBatch; ++i) {
+    GNode a = node(gen);
+    GNode b = node(gen);
+    if (a == b)
+      continue;
+    uint32_t w = weight(gen);
+    batch.insertions.push_back(Graph::EdgeInsertion{a, b, w});
+    batch.insertions.push_back(Graph::EdgeInsertion{b, a, w});
+  }
+
+  if (graph.sizeEdges() == 0)
+    return batch;
+  for (unsigned i = 0; i < deletionsPerBatch; ++i) {
+    GNode a = node(gen);
+    // bounded retries so that very sparse graphs do not stall
+    for (unsigned tries = 0; tries < 16 && graph.edge_begin(a, flag) ==
+                                               graph.edge_end(a, flag);
+         ++tries)
+      a = node(gen);
+    auto degree = std::distance(graph.edge_begin(a, flag),
+                                graph.edge_end(a, flag));
+    if (degree == 0)
+      continue;
+    std::uniform_int_distribution<long> pick(0, degree - 1);
+    GNode b = graph.getEdgeDst(graph.edge_begin(a, flag) + pick(gen));
+    batch.deletions.push_back(std::make_pair(a, b));
+    batch.deletions.push_back(std::make_pair(b, a));
+  }
+  return batch;
+}
+
+template <typename Analytic, typename ResultFn>
+void run(Graph& graph, Analytic& analytic, ResultFn result, Analytic& fresh) {
+  galois::StatTimer initTime("InitialCompute");
+  initTime.start();
+  analytic.compute();
+  initTime.stop();
+
+  // batches are sampled from the input graph up front so that only the
+  // updates are timed; a deletion of an edge an earlier batch already
+  // removed is a no-op
+  std::vector<Batch> batches;
+  for (unsigned b = 0; b < numBatches; ++b)
+    batches.push_back(makeBatch(graph, b));
+
+  galois::StatTimer updateTime("IncrementalUpdate");
+  galois::StatTimer execTime("Timer_0");
+  execTime.start();
+  for (unsigned b = 0; b < numBatches; ++b) {
+    Batch& batch = batches[b];
+    galois::Timer batchTime;
+    batchTime.start();
+    updateTime.start();
+    analytic.update(batch);
+    updateTime.stop();
+    batchTime.stop();
+    std::cout << "Batch " << b << ": " << batch.insertions.size()
+              << " insertions, " << batch.deletions.size() << " deletions, "
+              << batchTime.get() << " ms\n";
+  }
+  execTime.stop();
+
+  std::cout << "Edges after updates: " << graph.sizeEdges() << " (capacity "
+            << graph.capacityEdges() << ")\n";
+
+  if (!skipVerify) {
+    auto incremental = result(analytic);
+    fresh.compute();
+    if (incremental != result(fresh)) {
+      GALOIS_DIE("incremental result differs from recomputation");
+    }
+    std::cout << "Verification successful.\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url, &inputFile);
+
+  galois::StatTimer totalTime("TimerTotal");
+  totalTime.start();
+
+  if (!symmetricGraph) {
+    GALOIS_DIE("This application requires a symmetric graph input;"
+               " please use the -symmetricGraph flag "
+               " to indicate the input is a symmetric graph.");
+  }
+
+  Graph graph;
+  std::cout << "Reading from file: " << inputFile << "\n";
+  galois::graphs::readGraph(graph, inputFile, algo != Algo::sssp);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+
+  if (startNode >= graph.size()) {
+    GALOIS_DIE("failed to set source: ", startNode);
+  }
+
+  switch (algo) {
+  case Algo::bfs:
+  case Algo::sssp: {
+    ShortestPaths paths(graph, startNode, algo == Algo::sssp);
+    ShortestPaths fresh(graph, startNode, algo == Algo::sssp);
+    run(graph, paths, [](ShortestPaths& p) { return p.distances(); }, fresh);
+    std::cout << "Reachable nodes: " << paths.reachable() << "\n";
+    break;
+  }
+  case Algo::cc: {
+    Components comps(graph);
+    Components fresh(graph);
+    run(graph, comps, [](Components& c) { return c.components(); }, fresh);
+    std::cout << "Components: " << comps.numComponents() << "\n";
+    break;
+  }
+  default:
+    GALOIS_DIE("unknown algorithm");
+  }
+
+  totalTime.stop();
+
+  return 0;
+}
@@ -265,6 +265,7 @@ void executeUntilConverged(const StepFunction& sf, Graph& g, Fn fn) {
   LatentValue rate    = learningRate;
 
   galois::StatTimer executeAlgoTimer("Algorithm Execution Time");
+  size_t totalUpdates = 0;
   galois::TimeAccumulator elapsed;
   elapsed.start();
 
@@ -296,12 +297,16 @@ void executeUntilConverged(const StepFunction& sf, Graph& g, Fn fn) {
     unsigned long millis = curElapsed - lastTime;
     lastTime             = curElapsed;
 
-    double gflops = countFlops(g.sizeEdges(), deltaRound, LATENT_VECTOR_SIZE) /
+    double gflops = countFlops(g.sizeEdges(), deltaRound,
+                               Graph::node_data_type::LATENT_SIZE) /
                     millis / 1e6;
+    // every round does one gradient update per rating
+    double mupdates = (double)g.sizeEdges() * deltaRound / millis / 1e3;
+    totalUpdates += g.sizeEdges() * deltaRound;
 
     int curRound = round + deltaRound;
     galois::gPrint("R: ", curRound, " elapsed (ms): ", curElapsed,
-                   " GFLOP/s: ", gflops);
+                   " GFLOP/s: ", gflops, " MUpdates/s: ", mupdates);
     if (useExactError) {
       galois::gPrint(" RMSE (R ", curRound,
                      "): ", std::sqrt(error / g.sizeEdges()), "\n");
@@ -325,12 +330,20 @@ void executeUntilConverged(const StepFunction& sf, Graph& g, Fn fn) {
     }
     last = error;
   }
+
+  elapsed.stop();
+  if (elapsed.get() > 0) {
+    galois::runtime::reportStat_Single(
+        "MatrixCompletion", "UpdatesPerSec",
+        (size_t)(totalUpdates * 1000.0 / elapsed.get()));
+  }
 }
 
 /*
  * Divides the Items and users into 2D blocks.
  * Locks each block to work on it.
  */
+template <int N, typename StorageTy>
 struct SGDBlockJumpAlgo {
   bool isSgd() const { return true; }
   typedef galois::substrate::PaddedLock<true> SpinLock;
@@ -338,14 +351,12 @@ struct SGDBlockJumpAlgo {
 
   std::string name() const { return "sgdBlockJumpAlgo"; }
 
-  struct Node {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
+  typedef LatentNode<N, StorageTy> Node;
 
-  typedef galois::graphs::LC_CSR_Graph<Node, EdgeType>
-      //    ::with_numa_alloc<true>::type
-      ::with_no_lockable<true>::type Graph;
-  typedef Graph::GraphNode GNode;
+  typedef typename galois::graphs::LC_CSR_Graph<Node, EdgeType>
+      //    ::template with_numa_alloc<true>::type
+      ::template with_no_lockable<true>::type Graph;
+  typedef typename Graph::GraphNode GNode;
 
   void readGraph(Graph& g) { galois::graphs::readGraph(g, inputFile); }
 
@@ -388,7 +399,7 @@ struct SGDBlockJumpAlgo {
       Graph* g;
       GetDst() {}
       GetDst(Graph* _g) : g(_g) {}
-      GNode operator()(Graph::edge_iterator ii) const {
+      GNode operator()(typename Graph::edge_iterator ii) const {
         return g->getEdgeDst(ii);
       }
     };
@@ -404,7 +415,8 @@ struct SGDBlockJumpAlgo {
                     typename std::enable_if<!Enable>::type* = 0) {
       if (si.updates >= maxUpdates)
         return 0;
-      typedef galois::NoDerefIterator<Graph::edge_iterator> no_deref_iterator;
+      typedef galois::NoDerefIterator<typename Graph::edge_iterator>
+          no_deref_iterator;
       typedef boost::transform_iterator<GetDst, no_deref_iterator>
           edge_dst_iterator;
 
@@ -414,7 +426,7 @@ struct SGDBlockJumpAlgo {
 
       // Set up item iterators
       size_t itemId      = 0;
-      Graph::iterator mm = g.begin(), em = g.begin();
+      typename Graph::iterator mm = g.begin(), em = g.begin();
       std::advance(mm, si.itemStart);
       std::advance(em, si.itemEnd);
 
@@ -470,7 +482,7 @@ struct SGDBlockJumpAlgo {
 
       // Set up item iterators
       size_t itemId      = 0;
-      Graph::iterator mm = g.begin(), em = g.begin();
+      typename Graph::iterator mm = g.begin(), em = g.begin();
       std::advance(mm, si.itemStart);
       std::advance(em, si.itemEnd);
 
@@ -656,14 +668,11 @@ struct SGDBlockJumpAlgo {
  * Simple SGD going over all the destination(users) for a given
  * source(Item)
  */
+template <int N, typename StorageTy>
 class SGDItemsAlgo {
   static const bool makeSerializable = false;
 
-  struct BasicNode {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
-
-  using Node = BasicNode;
+  using Node = LatentNode<N, StorageTy>;
 
 public:
   bool isSgd() const { return true; }
@@ -734,12 +743,12 @@ public:
  * Simple by-edge grouped by items (only one edge per item on the WL at any
  * time)
  */
+template <int N, typename StorageTy>
 class SGDEdgeItem {
   static const bool makeSerializable = false;
 
-  struct BasicNode {
-    // latent vector to be learned.
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
+  // latent vector to be learned.
+  struct BasicNode : public LatentNode<N, StorageTy> {
     // if a item's update is interrupted, where to start when resuming.
     unsigned int edge_offset;
   };
@@ -838,14 +847,11 @@ public:
  * Locks blocks (blocks may share Items or Users) to work on them.
  *
  */
+template <int N, typename StorageTy>
 class SGDBlockEdgeAlgo {
   static const bool makeSerializable = false;
 
-  struct BasicNode {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
-
-  using Node = BasicNode;
+  using Node = LatentNode<N, StorageTy>;
 
 public:
   bool isSgd() const { return true; }
@@ -913,20 +919,21 @@ public:
 
 #ifdef HAS_EIGEN
 
+template <int N>
 struct SimpleALSalgo {
   bool isSgd() const { return false; }
   std::string name() const { return "AlternatingLeastSquares"; }
-  struct Node {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
+  // Eigen maps latent vectors in place, so they are always stored as
+  // LatentValue
+  typedef LatentNode<N, LatentValue> Node;
 
   typedef typename galois::graphs::LC_CSR_Graph<
-      Node, EdgeType>::with_no_lockable<true>::type Graph;
-  typedef Graph::GraphNode GNode;
+      Node, EdgeType>::template with_no_lockable<true>::type Graph;
+  typedef typename Graph::GraphNode GNode;
   // Column-major access
   typedef Eigen::SparseMatrix<LatentValue> Sp;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> MT;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, 1> V;
+  typedef Eigen::Matrix<LatentValue, N, Eigen::Dynamic> MT;
+  typedef Eigen::Matrix<LatentValue, N, 1> V;
   typedef Eigen::Map<V> MapV;
 
   Sp A;
@@ -982,11 +989,11 @@ struct SimpleALSalgo {
     // squares problems:
     //   (W^T W + lambda I) H^T = W^T A (solving for H^T)
     //   (H^T H + lambda I) W^T = H^T A^T (solving for W^T)
-    MT WT{LATENT_VECTOR_SIZE, NUM_ITEM_NODES};
-    MT HT{LATENT_VECTOR_SIZE, g.size() - NUM_ITEM_NODES};
-    typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, LATENT_VECTOR_SIZE>
+    MT WT{N, NUM_ITEM_NODES};
+    MT HT{N, g.size() - NUM_ITEM_NODES};
+    typedef Eigen::Matrix<LatentValue, N, N>
         XTX;
-    typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> XTSp;
+    typedef Eigen::Matrix<LatentValue, N, Eigen::Dynamic> XTSp;
     typedef galois::substrate::PerThreadStorage<XTX> PerThrdXTX;
 
     galois::gPrint("ALS::Start initializeA\n");
@@ -1022,13 +1029,13 @@ struct SimpleALSalgo {
             // Compute WTW = W^T * W for sparse A
             XTX& WTW = *xtxs.getLocal();
             WTW.setConstant(0);
-            for (Sp::InnerIterator it(A, col); it; ++it)
-              WTW.triangularView<Eigen::Upper>() +=
+            for (typename Sp::InnerIterator it(A, col); it; ++it)
+              WTW.template triangularView<Eigen::Upper>() +=
                   WT.col(it.row()) * WT.col(it.row()).transpose();
-            for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+            for (int i = 0; i < N; ++i)
               WTW(i, i) += lambda;
             HT.col(col) =
-                WTW.selfadjointView<Eigen::Upper>().llt().solve(WTA.col(col));
+                WTW.template selfadjointView<Eigen::Upper>().llt().solve(WTA.col(col));
           });
       update1Time.stop();
 
@@ -1044,13 +1051,13 @@ struct SimpleALSalgo {
             // Compute HTH = H^T * H for sparse A
             XTX& HTH = *xtxs.getLocal();
             HTH.setConstant(0);
-            for (Sp::InnerIterator it(AT, col); it; ++it)
-              HTH.triangularView<Eigen::Upper>() +=
+            for (typename Sp::InnerIterator it(AT, col); it; ++it)
+              HTH.template triangularView<Eigen::Upper>() +=
                   HT.col(it.row()) * HT.col(it.row()).transpose();
-            for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+            for (int i = 0; i < N; ++i)
               HTH(i, i) += lambda;
             WT.col(col) =
-                HTH.selfadjointView<Eigen::Upper>().llt().solve(HTAT.col(col));
+                HTH.template selfadjointView<Eigen::Upper>().llt().solve(HTAT.col(col));
           });
       update2Time.stop();
 
@@ -1078,15 +1085,14 @@ struct SimpleALSalgo {
   }
 };
 
+template <int N>
 struct SyncALSalgo {
 
   bool isSgd() const { return false; }
 
   std::string name() const { return "SynchronousAlternatingLeastSquares"; }
 
-  struct Node {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
+  typedef LatentNode<N, LatentValue> Node;
 
   static const bool NEEDS_LOCKS = false;
   typedef typename galois::graphs::LC_CSR_Graph<Node, EdgeType> BaseGraph;
@@ -1097,12 +1103,12 @@ struct SyncALSalgo {
   typedef typename Graph::GraphNode GNode;
   // Column-major access
   typedef Eigen::SparseMatrix<LatentValue> Sp;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> MT;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, 1> V;
+  typedef Eigen::Matrix<LatentValue, N, Eigen::Dynamic> MT;
+  typedef Eigen::Matrix<LatentValue, N, 1> V;
   typedef Eigen::Map<V> MapV;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, LATENT_VECTOR_SIZE>
+  typedef Eigen::Matrix<LatentValue, N, N>
       XTX;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> XTSp;
+  typedef Eigen::Matrix<LatentValue, N, Eigen::Dynamic> XTSp;
 
   typedef galois::substrate::PerThreadStorage<XTX> PerThrdXTX;
   typedef galois::substrate::PerThreadStorage<V> PerThrdV;
@@ -1159,30 +1165,30 @@ struct SyncALSalgo {
     if (col < NUM_ITEM_NODES) {
       r.setConstant(0);
       // HTAT = HT * AT; r = HTAT.col(col)
-      for (Sp::InnerIterator it(AT, col); it; ++it)
+      for (typename Sp::InnerIterator it(AT, col); it; ++it)
         r += it.value() * HT.col(it.row());
       XTX& HTH = *xtxs.getLocal();
       HTH.setConstant(0);
-      for (Sp::InnerIterator it(AT, col); it; ++it)
-        HTH.triangularView<Eigen::Upper>() +=
+      for (typename Sp::InnerIterator it(AT, col); it; ++it)
+        HTH.template triangularView<Eigen::Upper>() +=
             HT.col(it.row()) * HT.col(it.row()).transpose();
-      for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+      for (int i = 0; i < N; ++i)
         HTH(i, i) += lambda;
-      WT.col(col) = HTH.selfadjointView<Eigen::Upper>().llt().solve(r);
+      WT.col(col) = HTH.template selfadjointView<Eigen::Upper>().llt().solve(r);
     } else {
       col = col - NUM_ITEM_NODES;
       r.setConstant(0);
       // WTA = WT * A; x = WTA.col(col)
-      for (Sp::InnerIterator it(A, col); it; ++it)
+      for (typename Sp::InnerIterator it(A, col); it; ++it)
         r += it.value() * WT.col(it.row());
       XTX& WTW = *xtxs.getLocal();
       WTW.setConstant(0);
-      for (Sp::InnerIterator it(A, col); it; ++it)
-        WTW.triangularView<Eigen::Upper>() +=
+      for (typename Sp::InnerIterator it(A, col); it; ++it)
+        WTW.template triangularView<Eigen::Upper>() +=
             WT.col(it.row()) * WT.col(it.row()).transpose();
-      for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+      for (int i = 0; i < N; ++i)
         WTW(i, i) += lambda;
-      HT.col(col) = WTW.selfadjointView<Eigen::Upper>().llt().solve(r);
+      HT.col(col) = WTW.template selfadjointView<Eigen::Upper>().llt().solve(r);
     }
   }
 
@@ -1237,8 +1243,8 @@ struct SyncALSalgo {
     // squares problems:
     //   (W^T W + lambda I) H^T = W^T A (solving for H^T)
     //   (H^T H + lambda I) W^T = H^T A^T (solving for W^T)
-    MT WT{LATENT_VECTOR_SIZE, NUM_ITEM_NODES};
-    MT HT{LATENT_VECTOR_SIZE, g.size() - NUM_ITEM_NODES};
+    MT WT{N, NUM_ITEM_NODES};
+    MT HT{N, g.size() - NUM_ITEM_NODES};
 
     initializeA(g);
     copyFromGraph(g, WT, HT);
@@ -1312,7 +1318,8 @@ size_t initializeGraphData(Graph& g) {
   galois::gPrint("initializeGraphData\n");
   galois::StatTimer initTimer("InitializeGraph");
   initTimer.start();
-  double top = 1.0 / std::sqrt(LATENT_VECTOR_SIZE);
+  constexpr int N = Graph::node_data_type::LATENT_SIZE;
+  double top      = 1.0 / std::sqrt(N);
   galois::substrate::PerThreadStorage<std::mt19937> gen;
 
 #if __cplusplus >= 201103L || defined(HAVE_CXX11_UNIFORM_INT_DISTRIBUTION)
@@ -1325,7 +1332,7 @@ size_t initializeGraphData(Graph& g) {
     galois::do_all(galois::iterate(g), [&](typename Graph::GraphNode n) {
       auto& data = g.getData(n);
       auto val   = genVal(n);
-      for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
+      for (int i = 0; i < N; i++) {
         data.latentVector[i] = val;
       }
     });
@@ -1337,11 +1344,11 @@ size_t initializeGraphData(Graph& g) {
       // a thread local one
       if (useSameLatentVector) {
         std::mt19937 sameGen;
-        for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
+        for (int i = 0; i < N; i++) {
           data.latentVector[i] = dist(sameGen);
         }
       } else {
-        for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
+        for (int i = 0; i < N; i++) {
           data.latentVector[i] = dist(*gen.getLocal());
         }
       }
@@ -1403,8 +1410,9 @@ void writeBinaryLatentVectors(Graph& g, const std::string& filename) {
   std::ofstream file(filename);
   for (auto ii = g.begin(), ei = g.end(); ii != ei; ++ii) {
     auto& v = g.getData(*ii).latentVector;
-    for (int i = 0; i < LATENT_VECTOR_SIZE; ++i) {
-      file.write(reinterpret_cast<char*>(&v[i]), sizeof(v[i]));
+    // always written as LatentValue regardless of the storage type
+    for (LatentValue val : v) {
+      file.write(reinterpret_cast<char*>(&val), sizeof(val));
     }
   }
   file.close();
@@ -1415,8 +1423,8 @@ void writeAsciiLatentVectors(Graph& g, const std::string& filename) {
   std::ofstream file(filename);
   for (auto ii = g.begin(), ei = g.end(); ii != ei; ++ii) {
     auto& v = g.getData(*ii).latentVector;
-    for (int i = 0; i < LATENT_VECTOR_SIZE; ++i) {
-      file << v[i] << " ";
+    for (LatentValue val : v) {
+      file << val << " ";
     }
     file << "\n";
   }
@@ -1453,7 +1461,10 @@ void run() {
             << " num ratings: " << g.sizeEdges() << "\n";
 
   std::unique_ptr<StepFunction> sf{newStepFunction()};
-  std::cout << "latent vector size: " << LATENT_VECTOR_SIZE
+  std::cout << "latent vector size: "
+            << Algo::Graph::node_data_type::LATENT_SIZE
+            << " latent storage: "
+            << (latentStorage == LatentStorage::bf16 ? "bf16" : "fp32")
             << " algo: " << algo.name() << " lambda: " << lambda;
 
   if (algo.isSgd()) {
@@ -1495,6 +1506,73 @@ void run() {
   galois::runtime::reportNumaAlloc("NumaAlloc");
 }
 
+/**
+ * Instantiates an SGD algorithm with the latent vector size and storage type
+ * chosen on the command line.
+ */
+template <template <int, typename> class Algo>
+void runSGD() {
+  switch (latentVectorSize) {
+  case 20:
+    if (latentStorage == LatentStorage::bf16)
+      run<Algo<20, BFloat16>>();
+    else
+      run<Algo<20, LatentValue>>();
+    break;
+  case 32:
+    if (latentStorage == LatentStorage::bf16)
+      run<Algo<32, BFloat16>>();
+    else
+      run<Algo<32, LatentValue>>();
+    break;
+  case 64:
+    if (latentStorage == LatentStorage::bf16)
+      run<Algo<64, BFloat16>>();
+    else
+      run<Algo<64, LatentValue>>();
+    break;
+  case 128:
+    if (latentStorage == LatentStorage::bf16)
+      run<Algo<128, BFloat16>>();
+    else
+      run<Algo<128, LatentValue>>();
+    break;
+  default:
+    GALOIS_DIE("unsupported latent vector size ", latentVectorSize,
+               "; use 20, 32, 64 or 128");
+  }
+}
+
+#ifdef HAS_EIGEN
+/**
+ * Instantiates an ALS algorithm with the latent vector size chosen on the
+ * command line.
+ */
+template <template <int> class Algo>
+void runALS() {
+  if (latentStorage != LatentStorage::fp32) {
+    GALOIS_DIE("ALS algorithms only support fp32 latent storage");
+  }
+  switch (latentVectorSize) {
+  case 20:
+    run<Algo<20>>();
+    break;
+  case 32:
+    run<Algo<32>>();
+    break;
+  case 64:
+    run<Algo<64>>();
+    break;
+  case 128:
+    run<Algo<128>>();
+    break;
+  default:
+    GALOIS_DIE("unsupported latent vector size ", latentVectorSize,
+               "; use 20, 32, 64 or 128");
+  }
+}
+#endif
+
 int main(int argc, char** argv) {
   galois::SharedMemSys G;
   LonestarStart(argc, argv, name, desc, nullptr, &inputFile);
@@ -1505,23 +1583,23 @@ int main(int argc, char** argv) {
   switch (algo) {
 #ifdef HAS_EIGEN
   case Algo::syncALS:
-    run<SyncALSalgo>();
+    runALS<SyncALSalgo>();
     break;
   case Algo::simpleALS:
-    run<SimpleALSalgo>();
+    runALS<SimpleALSalgo>();
     break;
 #endif
   case Algo::sgdByItems:
-    run<SGDItemsAlgo>();
+    runSGD<SGDItemsAlgo>();
     break;
   case Algo::sgdByEdges:
-    run<SGDEdgeItem>();
+    runSGD<SGDEdgeItem>();
     break;
   case Algo::sgdBlockEdge:
-    run<SGDBlockEdgeAlgo>();
+    runSGD<SGDBlockEdgeAlgo>();
     break;
   case Algo::sgdBlockJump:
-    run<SGDBlockJumpAlgo>();
+    runSGD<SGDBlockJumpAlgo>();
     break;
   default:
     GALOIS_DIE("unknown algorithm");
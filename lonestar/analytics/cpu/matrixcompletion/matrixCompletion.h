@@ -21,6 +21,8 @@
 #define LONESTAR_MATRIXCOMPLETION_H
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <galois/gstl.h>
 #include <string>
 #include "llvm/Support/CommandLine.h"
@@ -29,8 +31,14 @@ typedef float LatentValue;
 typedef float EdgeType;
 
 // Purdue, CSGD: 100; Intel: 20
-// static const int LATENT_VECTOR_SIZE = 100;
-static const int LATENT_VECTOR_SIZE = 20; // Purdue, CSGD: 100; Intel: 20
+static const int DEFAULT_LATENT_VECTOR_SIZE = 20;
+
+/**
+ * Storage type of latent vectors. Computation is always done in LatentValue
+ * (float); bf16 halves the memory traffic of each update at the cost of
+ * precision of the stored model.
+ */
+enum LatentStorage { fp32, bf16 };
 
 /**
  * Common commandline parameters to for matrix completion algorithms
@@ -98,6 +106,18 @@ static cll::opt<OutputType>
                            clEnumValN(OutputType::ascii, "ascii", "ASCII")),
                cll::init(OutputType::binary));
 
+static cll::opt<unsigned int> latentVectorSize(
+    "latentVectorSize",
+    cll::desc("Size of the latent vectors: 20, 32, 64 or 128 (default 20)"),
+    cll::init(DEFAULT_LATENT_VECTOR_SIZE));
+static cll::opt<LatentStorage> latentStorage(
+    "latentStorage", cll::desc("Storage type of latent vectors:"),
+    cll::values(clEnumValN(LatentStorage::fp32, "fp32", "float (default)"),
+                clEnumValN(LatentStorage::bf16, "bf16",
+                           "bfloat16 storage with float accumulation (SGD "
+                           "algorithms only)")),
+    cll::init(LatentStorage::fp32));
+
 static cll::opt<unsigned int>
     updatesPerEdge("updatesPerEdge", cll::desc("number of updates per edge"),
                    cll::init(1));
@@ -116,43 +136,95 @@ static cll::opt<bool>
                cll::init(false));
 
 /**
- * Inner product of 2 vectors.
+ * bfloat16: upper half of an IEEE float. Converts implicitly to and from
+ * float so that it can be used as latent vector storage in place of
+ * LatentValue.
+ */
+struct BFloat16 {
+  uint16_t bits;
+
+  BFloat16() = default;
+  BFloat16(float v) {
+    uint32_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    // round to nearest even; NaNs stay NaNs since their exponent is all ones
+    // and a quiet bit is forced on
+    if ((u & 0x7FFFFFFFU) > 0x7F800000U) {
+      bits = static_cast<uint16_t>((u >> 16) | 0x40U);
+    } else {
+      bits = static_cast<uint16_t>((u + 0x7FFFU + ((u >> 16) & 1U)) >> 16);
+    }
+  }
+
+  operator float() const {
+    uint32_t u = static_cast<uint32_t>(bits) << 16;
+    float v;
+    std::memcpy(&v, &u, sizeof(v));
+    return v;
+  }
+};
+
+/**
+ * Largest power of two (up to a cache line) that divides the size of a latent
+ * vector. Aligning to it lets the vectorized kernels use aligned loads without
+ * adding padding to the node data.
+ */
+template <int N, typename StorageTy>
+constexpr size_t latentAlignment() {
+  return ((N * sizeof(StorageTy)) & (64 - 1)) == 0
+             ? 64
+             : ((N * sizeof(StorageTy)) & -(N * sizeof(StorageTy)));
+}
+
+/**
+ * Node data shared by all algorithms: an aligned latent vector of N elements
+ * stored as StorageTy.
+ */
+template <int N, typename StorageTy>
+struct LatentNode {
+  static const int LATENT_SIZE = N;
+  typedef StorageTy LatentStorageTy;
+
+  alignas(latentAlignment<N, StorageTy>()) StorageTy latentVector[N];
+};
+
+/**
+ * Inner product of 2 latent vectors accumulated in LatentValue.
  *
- * Like std::inner_product but rewritten here to check vectorization
+ * Like std::inner_product but with the length known at compile time so that
+ * the loop is fully vectorized.
  *
- * @param first1 Pointer to beginning of vector 1
- * @param last1 Pointer to end of vector 1. Should be exactly LATENT_VECTOR_SIZE
- * away from first1
- * @param first2 Pointer to beginning of vector 2. Should have at least
- * LATENT_VECTOR_SIZE elements from this point.
+ * @param first1 Latent vector 1
+ * @param first2 Latent vector 2
  * @param init Initial value to accumulate sum into
  *
  * @returns init + the inner product (i.e. the inner product if init is 0, error
  * if init is -"ground truth"
  */
-template <typename T>
-T innerProduct(T* __restrict__ first1,
-               T* __restrict__ GALOIS_USED_ONLY_IN_DEBUG(last1),
-               T* __restrict__ first2, T init) {
-  assert(first1 + LATENT_VECTOR_SIZE == last1);
-  for (int i = 0; i < LATENT_VECTOR_SIZE; ++i) {
-    init += first1[i] * first2[i];
+template <int N, typename T>
+LatentValue innerProduct(const T (&__restrict__ first1)[N],
+                         const T (&__restrict__ first2)[N], LatentValue init) {
+  for (int i = 0; i < N; ++i) {
+    init += static_cast<LatentValue>(first1[i]) *
+            static_cast<LatentValue>(first2[i]);
   }
   return init;
 }
 
-template <typename T>
-T predictionError(T* __restrict__ itemLatent, T* __restrict__ userLatent,
-                  double actual) {
-  T v = actual;
-  return innerProduct(itemLatent, itemLatent + LATENT_VECTOR_SIZE, userLatent,
-                      -v);
+template <int N, typename T>
+LatentValue predictionError(const T (&__restrict__ itemLatent)[N],
+                            const T (&__restrict__ userLatent)[N],
+                            double actual) {
+  LatentValue v = actual;
+  return innerProduct(itemLatent, userLatent, -v);
 }
 
 /**
  * Objective: squared loss with weighted-square-norm regularization
  *
- * Updates latent vectors to reduce the error from the edge value.
+ * Updates latent vectors to reduce the error from the edge value. Both
+ * vectors are widened to LatentValue once, the error is computed while they
+ * are loaded, and the update is stored back in a single pass.
  *
  * @param itemLatent latent vector of the item
  * @param userLatent latent vector of the user
@@ -164,22 +236,28 @@ T predictionError(T* __restrict__ itemLatent, T* __restrict__ userLatent,
  *
  * @return Error before gradient update
  */
-template <typename T>
-T doGradientUpdate(T* __restrict__ itemLatent, T* __restrict__ userLatent,
-                   double lambda, double edgeRating, double stepSize) {
-  // Implicit cast to type T
-  T l      = lambda;
-  T step   = stepSize;
-  T rating = edgeRating;
-  T error  = innerProduct(itemLatent, itemLatent + LATENT_VECTOR_SIZE,
-                         userLatent, -rating);
+template <int N, typename T>
+LatentValue doGradientUpdate(T (&__restrict__ itemLatent)[N],
+                             T (&__restrict__ userLatent)[N], double lambda,
+                             double edgeRating, double stepSize) {
+  // Implicit cast to LatentValue
+  LatentValue l      = lambda;
+  LatentValue step   = stepSize;
+  LatentValue rating = edgeRating;
+
+  LatentValue prevItem[N];
+  LatentValue prevUser[N];
+  LatentValue error = -rating;
+  for (int i = 0; i < N; i++) {
+    prevItem[i] = itemLatent[i];
+    prevUser[i] = userLatent[i];
+    error += prevItem[i] * prevUser[i];
+  }
 
   // Take gradient step to reduce error
-  for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
-    T prevItem = itemLatent[i];
-    T prevUser = userLatent[i];
-    itemLatent[i] -= step * (error * prevUser + l * prevItem);
-    userLatent[i] -= step * (error * prevItem + l * prevUser);
+  for (int i = 0; i < N; i++) {
+    itemLatent[i] = prevItem[i] - step * (error * prevUser[i] + l * prevItem[i]);
+    userLatent[i] = prevUser[i] - step * (error * prevItem[i] + l * prevUser[i]);
   }
 
   return error;
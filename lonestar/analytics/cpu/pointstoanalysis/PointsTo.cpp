@@ -23,7 +23,9 @@
 #include <iostream>
 #include <fstream>
 #include <deque>
+#include <type_traits>
 #include "SparseBitVector.h"
+#include "SharedPointsToSet.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Command line parameters
@@ -65,6 +67,13 @@ static cll::opt<unsigned>
                            "(default 500000)"),
                  cll::init(500000));
 
+static cll::opt<bool>
+    useSharedSets("sharedSets",
+                  cll::desc("If set, points-to sets are hash-consed and "
+                            "shared between variables with equal sets "
+                            "(serial only) (default false)"),
+                  cll::init(false));
+
 ////////////////////////////////////////////////////////////////////////////////
 // Declaration of strutures, types, and variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -128,19 +137,29 @@ public:
  *
  * @tparam IsConcurrent if set to true, the data structures used for points
  * to results and outgoing edges will be thread safe
+ * @tparam PtsSet set type used for points to results; either a sparse bit
+ * vector or a galois::SharedPointsToSet (serial only)
  */
-template <bool IsConcurrent>
+template <bool IsConcurrent,
+          typename PtsSet = galois::SparseBitVector<IsConcurrent>>
 class PTABase {
   // sparse bit vector is concurrent or serial based on template parameter
   using SparseBitVector = galois::SparseBitVector<IsConcurrent>;
 
   using PointsToConstraints = std::vector<PtsToCons>;
-  using PointsToInfo        = std::vector<SparseBitVector>;
+  using PointsToInfo        = std::vector<PtsSet>;
   using EdgeVector          = std::vector<SparseBitVector>;
 
   using NodeAllocator =
       galois::FixedSizeAllocator<typename SparseBitVector::Node>;
 
+  static constexpr bool SharedSets =
+      std::is_same<PtsSet, galois::SharedPointsToSet>::value;
+  static_assert(!(SharedSets && IsConcurrent),
+                "shared points-to sets are serial only");
+
+  using SetID = galois::PointsToSetTable::SetID;
+
 protected:
   PointsToInfo pointsToResult; // pointsTo results for nodes
   EdgeVector outgoingEdges;    // holds outgoing edges of a node
@@ -150,13 +169,18 @@ protected:
 
   size_t numNodes = 0;
 
+  // table backing the points-to sets when they are shared
+  galois::PointsToSetTable* setTable = nullptr;
+  // set each load/store constraint saw when it was last processed
+  std::vector<SetID> lastVisited;
+
   ////////////////////////////////////////////////////////////////////////////////
   /**
    * Online Cycle Detection and elimination structure + functions.
    */
   struct OnlineCycleDetection {
   private:
-    PTABase<IsConcurrent>&
+    PTABase<IsConcurrent, PtsSet>&
         outerPTA; // reference to outer PTA instance to get runtime info
 
     galois::gstl::Vector<unsigned> ancestors; // TODO find better representation
@@ -284,7 +308,7 @@ protected:
     }
 
   public:
-    OnlineCycleDetection(PTABase<IsConcurrent>& o) : outerPTA(o) {}
+    OnlineCycleDetection(PTABase<IsConcurrent, PtsSet>& o) : outerPTA(o) {}
 
     /**
      * Init fields (outerPTA needs to have numNodes set).
@@ -359,6 +383,36 @@ protected:
 
   OnlineCycleDetection ocd; // cycle detector/squasher; only works with serial
 
+  /**
+   * Calls fn on every pointee of var that load/store constraint c needs to
+   * look at. Shared sets remember the set the constraint saw last time, so
+   * only the difference to it is walked; otherwise everything is walked.
+   *
+   * @param c index of the load/store constraint
+   * @param var node whose points-to set is walked
+   * @param fn functor called on each pointee
+   */
+  template <typename Fn>
+  void forEachNewPointee(size_t c, unsigned var, const Fn& fn) {
+    if constexpr (SharedSets) {
+      SetID current = pointsToResult[var].getID();
+      SetID delta   = setTable->difference(current, lastVisited[c]);
+
+      setTable->acquire(current);
+      setTable->release(lastVisited[c]);
+      lastVisited[c] = current;
+
+      for (unsigned pointee : setTable->get(delta)) {
+        fn(pointee);
+      }
+    } else {
+      for (auto pointee = pointsToResult[var].begin();
+           pointee != pointsToResult[var].end(); pointee++) {
+        fn(*pointee);
+      }
+    }
+  }
+
   /**
    * Adds edges to the graph based on load/store constraints.
    *
@@ -381,7 +435,11 @@ protected:
   void processLoadStore(const PointsToConstraints& constraints,
                         VecType& updates) {
 
-    LoopInvoker()(galois::iterate(constraints), [&](auto constraint) {
+    auto indices = galois::iterate(size_t{0}, constraints.size());
+
+    LoopInvoker()(indices, [&](size_t c) {
+      const PtsToCons& constraint = constraints[c];
+
       unsigned src;
       unsigned dst;
       std::tie(src, dst) = constraint.getSrcDst();
@@ -390,9 +448,8 @@ protected:
       unsigned dstRepr = ocd.getFinalRepresentative(dst);
 
       if (constraint.getType() == PtsToCons::Load) {
-        for (auto pointee = pointsToResult[srcRepr].begin();
-             pointee != pointsToResult[srcRepr].end(); pointee++) {
-          unsigned pointeeRepr = ocd.getFinalRepresentative(*pointee);
+        forEachNewPointee(c, srcRepr, [&](unsigned pointee) {
+          unsigned pointeeRepr = ocd.getFinalRepresentative(pointee);
 
           // add edge from pointee to dst if it doesn't already exist
           if (pointeeRepr != dstRepr &&
@@ -401,13 +458,12 @@ protected:
 
             updates.push_back(pointeeRepr);
           }
-        }
+        });
       } else { // store whatever src has into whatever dst points to
         bool newEdgeAdded = false;
 
-        for (auto pointee = pointsToResult[dstRepr].begin();
-             pointee != pointsToResult[dstRepr].end(); pointee++) {
-          unsigned pointeeRepr = ocd.getFinalRepresentative(*pointee);
+        forEachNewPointee(c, dstRepr, [&](unsigned pointee) {
+          unsigned pointeeRepr = ocd.getFinalRepresentative(pointee);
 
           // add edge from src -> pointee if it doesn't exist
           if (srcRepr != pointeeRepr &&
@@ -416,7 +472,7 @@ protected:
 
             newEdgeAdded = true;
           }
-        }
+        });
 
         if (newEdgeAdded) {
           updates.push_back(srcRepr);
@@ -501,8 +557,12 @@ public:
    * @param n Number of nodes in the constraint graph
    * @param nodeAllocator galois allocator object to allocate nodes in the
    * sparse bit vector
+   * @param ptsContext object the points-to sets are initialized with: the
+   * node allocator for sparse bit vectors, the set table for shared sets
    */
-  void initialize(size_t n, NodeAllocator& nodeAllocator) {
+  template <typename PtsContext>
+  void initialize(size_t n, NodeAllocator& nodeAllocator,
+                  PtsContext& ptsContext) {
     numNodes = n;
 
     // initialize different constructs based on which version is being run
@@ -511,10 +571,19 @@ public:
 
     // initialize vectors
     for (unsigned i = 0; i < numNodes; i++) {
-      pointsToResult[i].init(&nodeAllocator);
+      pointsToResult[i].init(&ptsContext);
       outgoingEdges[i].init(&nodeAllocator);
     }
 
+    if constexpr (SharedSets) {
+      setTable = &ptsContext;
+      lastVisited.assign(loadStoreConstraints.size(),
+                         galois::PointsToSetTable::EMPTY);
+      for (SetID id : lastVisited) {
+        setTable->acquire(id);
+      }
+    }
+
     ocd.init();
   }
 
@@ -524,6 +593,37 @@ public:
       pointsToResult[i].freeAll();
       outgoingEdges[i].freeAll();
     }
+
+    if constexpr (SharedSets) {
+      for (SetID id : lastVisited) {
+        setTable->release(id);
+      }
+      lastVisited.clear();
+      setTable->sweep();
+    }
+  }
+
+  //! frees shared points-to sets that are no longer held by anything
+  void collectGarbage() {
+    if constexpr (SharedSets) {
+      setTable->sweep();
+    }
+  }
+
+  //! reports statistics of the shared set table, if one is used
+  void reportSetStats() {
+    if constexpr (SharedSets) {
+      galois::runtime::reportStat_Single("PointsTo", "SharedSetsCreated",
+                                         setTable->numCreatedSets());
+      galois::runtime::reportStat_Single("PointsTo", "SharedSetsLive",
+                                         setTable->numLiveSets());
+      galois::runtime::reportStat_Single("PointsTo", "SharedSetsBytes",
+                                         setTable->memoryBytes());
+      galois::runtime::reportStat_Single("PointsTo", "SetCacheHits",
+                                         setTable->cacheHits());
+      galois::runtime::reportStat_Single("PointsTo", "SetCacheMisses",
+                                         setTable->cacheMisses());
+    }
   }
 
   /**
@@ -665,22 +765,28 @@ public:
 
 /**
  * Serial points to executor.
+ *
+ * @tparam PtsSet set type used for points to results
  */
-class PTASerial : public PTABase<false> {
+template <typename PtsSet = galois::SparseBitVector<false>>
+class PTASerial : public PTABase<false, PtsSet> {
 public:
   /**
    * Run points-to-analysis on a single thread.
    */
   void run() {
-    galois::gDebug(
-        "no of addr+copy constraints = ", addressCopyConstraints.size(),
-        ", no of load+store constraints = ", loadStoreConstraints.size());
-    galois::gDebug("no of nodes = ", numNodes);
+    galois::gDebug("no of addr+copy constraints = ",
+                   this->addressCopyConstraints.size(),
+                   ", no of load+store constraints = ",
+                   this->loadStoreConstraints.size());
+    galois::gDebug("no of nodes = ", this->numNodes);
 
     std::deque<unsigned> updates;
-    updates = processAddressOfCopy<galois::StdForEach, std::deque<unsigned>>(
-        addressCopyConstraints);
-    processLoadStore<galois::StdForEach>(loadStoreConstraints, updates);
+    updates = this->template processAddressOfCopy<galois::StdForEach,
+                                                  std::deque<unsigned>>(
+        this->addressCopyConstraints);
+    this->template processLoadStore<galois::StdForEach>(
+        this->loadStoreConstraints, updates);
 
     unsigned numUps = 0;
 
@@ -689,12 +795,12 @@ public:
       unsigned src = updates.front();
       updates.pop_front();
 
-      for (auto dst = outgoingEdges[src].begin();
-           dst != outgoingEdges[src].end(); dst++) {
-        unsigned newPtsTo = propagate(src, *dst);
+      for (auto dst = this->outgoingEdges[src].begin();
+           dst != this->outgoingEdges[src].end(); dst++) {
+        unsigned newPtsTo = this->propagate(src, *dst);
 
         if (newPtsTo) { // newPtsTo is positive if dst changed
-          updates.push_back(ocd.getFinalRepresentative(*dst));
+          updates.push_back(this->ocd.getFinalRepresentative(*dst));
         }
 
         numUps++;
@@ -702,15 +808,19 @@ public:
 
       if (updates.empty() || numUps >= THRESHOLD_LS) {
         galois::gDebug("No of points-to facts computed = ",
-                       countPointsToFacts());
+                       this->countPointsToFacts());
         numUps = 0;
 
         // After propagating all constraints, see if load/store
         // constraints need to be added in since graph was potentially updated
-        processLoadStore<galois::StdForEach>(loadStoreConstraints, updates);
+        this->template processLoadStore<galois::StdForEach>(
+            this->loadStoreConstraints, updates);
 
         // do cycle squashing
-        ocd.process(updates);
+        this->ocd.process(updates);
+
+        // sets replaced since the last round are no longer needed
+        this->collectGarbage();
       }
     }
   }
@@ -768,10 +878,10 @@ public:
 /**
  * Method from running PTA.
  */
-template <typename PTAClass, typename Alloc>
-void runPTA(PTAClass& pta, Alloc& nodeAllocator) {
+template <typename PTAClass, typename Alloc, typename PtsContext>
+void runPTA(PTAClass& pta, Alloc& nodeAllocator, PtsContext& ptsContext) {
   size_t numNodes = pta.readConstraints(inputFile.c_str());
-  pta.initialize(numNodes, nodeAllocator);
+  pta.initialize(numNodes, nodeAllocator, ptsContext);
 
   galois::StatTimer execTime("Timer_0");
 
@@ -780,6 +890,7 @@ void runPTA(PTAClass& pta, Alloc& nodeAllocator) {
   execTime.stop();
 
   galois::gInfo("No of points-to facts computed = ", pta.countPointsToFacts());
+  pta.reportSetStats();
 
   if (!skipVerify) {
     galois::gInfo("Doing verification step");
@@ -804,6 +915,10 @@ int main(int argc, char** argv) {
 
   // depending on serial or concurrent, create the correct class and pass it
   // into the run harness which takes care of the rest
+  if (useSharedSets && !useSerial) {
+    GALOIS_DIE("-sharedSets is only supported by the serial version (-serial)");
+  }
+
   if (!useSerial) {
     galois::gInfo("-------- Parallel version: ", galois::getActiveThreads(),
                   " threads.");
@@ -813,17 +928,24 @@ int main(int argc, char** argv) {
     PTAConcurrent p;
     galois::FixedSizeAllocator<typename galois::SparseBitVector<true>::Node>
         nodeAllocator;
-    runPTA(p, nodeAllocator);
+    runPTA(p, nodeAllocator, nodeAllocator);
   } else {
     galois::gInfo("-------- Sequential version.");
     galois::gInfo(
         "The load store threshold (-lsThreshold) may need tweaking for "
         "best performance; its current setting may not be the best for "
         "your input and may actually degrade performance.");
-    PTASerial p;
     galois::FixedSizeAllocator<typename galois::SparseBitVector<false>::Node>
         nodeAllocator;
-    runPTA(p, nodeAllocator);
+
+    if (useSharedSets) {
+      galois::PointsToSetTable setTable;
+      PTASerial<galois::SharedPointsToSet> p;
+      runPTA(p, nodeAllocator, setTable);
+    } else {
+      PTASerial<> p;
+      runPTA(p, nodeAllocator, nodeAllocator);
+    }
   }
 
   totalTime.stop();
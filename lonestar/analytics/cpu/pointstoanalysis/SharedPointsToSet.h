@@ -0,0 +1,658 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef _GALOIS_SHAREDPOINTSTOSET_
+#define _GALOIS_SHAREDPOINTSTOSET_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/iterator/iterator_facade.hpp>
+
+namespace galois {
+
+/**
+ * Immutable set of unsigned integers stored as roaring-style chunks. Each
+ * chunk holds the elements that share their upper 16 bits as a sorted array,
+ * a 65536-bit bitmap or a list of runs, whichever is smallest. The choice
+ * depends only on the contents, so equal sets have identical chunks and can
+ * be compared and hashed chunk by chunk.
+ *
+ * Bitmap unions and differences are plain word loops that the compiler
+ * vectorizes.
+ */
+class HybridSet {
+public:
+  enum Kind : uint8_t { Array, Bitmap, Run };
+
+  //! largest cardinality stored as an array
+  static constexpr unsigned ARRAY_MAX = 4096;
+  //! number of 64-bit words in a bitmap chunk
+  static constexpr unsigned BITMAP_WORDS = 1024;
+
+  struct Chunk {
+    uint16_t key;
+    Kind kind;
+    uint32_t card;
+    //! sorted values (Array) or inclusive [first, last] pairs (Run)
+    std::vector<uint16_t> values;
+    //! bits (Bitmap)
+    std::vector<uint64_t> words;
+
+    bool operator==(const Chunk& o) const {
+      return key == o.key && kind == o.kind && card == o.card &&
+             values == o.values && words == o.words;
+    }
+  };
+
+private:
+  std::vector<Chunk> chunks;
+  uint32_t cardinality = 0;
+  uint64_t hashValue   = 0;
+
+  static Kind chooseKind(uint32_t card, uint32_t runs) {
+    uint64_t arrayBytes = card <= ARRAY_MAX ? 2 * card : UINT64_MAX;
+    uint64_t bitmapBytes = 8 * BITMAP_WORDS;
+    uint64_t runBytes    = 4 * (uint64_t)runs;
+    if (runBytes < std::min(arrayBytes, bitmapBytes))
+      return Run;
+    return arrayBytes <= bitmapBytes ? Array : Bitmap;
+  }
+
+  static void setRange(uint64_t* w, unsigned first, unsigned last) {
+    for (unsigned v = first; v <= last; ++v)
+      w[v >> 6] |= uint64_t(1) << (v & 63);
+  }
+
+  static void clearRange(uint64_t* w, unsigned first, unsigned last) {
+    for (unsigned v = first; v <= last; ++v)
+      w[v >> 6] &= ~(uint64_t(1) << (v & 63));
+  }
+
+  static void orInto(const Chunk& c, uint64_t* w) {
+    switch (c.kind) {
+    case Array:
+      for (auto v : c.values)
+        w[v >> 6] |= uint64_t(1) << (v & 63);
+      break;
+    case Run:
+      for (size_t i = 0; i < c.values.size(); i += 2)
+        setRange(w, c.values[i], c.values[i + 1]);
+      break;
+    case Bitmap:
+      for (unsigned k = 0; k < BITMAP_WORDS; ++k)
+        w[k] |= c.words[k];
+      break;
+    }
+  }
+
+  static void andNotInto(const Chunk& c, uint64_t* w) {
+    switch (c.kind) {
+    case Array:
+      for (auto v : c.values)
+        w[v >> 6] &= ~(uint64_t(1) << (v & 63));
+      break;
+    case Run:
+      for (size_t i = 0; i < c.values.size(); i += 2)
+        clearRange(w, c.values[i], c.values[i + 1]);
+      break;
+    case Bitmap:
+      for (unsigned k = 0; k < BITMAP_WORDS; ++k)
+        w[k] &= ~c.words[k];
+      break;
+    }
+  }
+
+  static bool chunkContains(const Chunk& c, uint16_t low) {
+    switch (c.kind) {
+    case Array:
+      return std::binary_search(c.values.begin(), c.values.end(), low);
+    case Bitmap:
+      return (c.words[low >> 6] >> (low & 63)) & 1;
+    case Run: {
+      size_t lo = 0, hi = c.values.size() / 2;
+      while (lo < hi) { // first run whose last value is >= low
+        size_t mid = (lo + hi) / 2;
+        if (c.values[2 * mid + 1] < low)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return lo < c.values.size() / 2 && c.values[2 * lo] <= low;
+    }
+    }
+    return false;
+  }
+
+  //! Builds the canonical chunk for the bits in w; card is 0 if w is empty
+  static Chunk fromWords(uint16_t key, const uint64_t* w) {
+    Chunk c{key, Array, 0, {}, {}};
+    uint32_t runs = 0;
+    for (unsigned k = 0; k < BITMAP_WORDS; ++k) {
+      c.card += __builtin_popcountll(w[k]);
+      uint64_t carry = k ? w[k - 1] >> 63 : 0;
+      runs += __builtin_popcountll(w[k] & ~((w[k] << 1) | carry));
+    }
+    if (!c.card)
+      return c;
+    c.kind = chooseKind(c.card, runs);
+    if (c.kind == Bitmap) {
+      c.words.assign(w, w + BITMAP_WORDS);
+    } else if (c.kind == Array) {
+      c.values.reserve(c.card);
+      for (unsigned k = 0; k < BITMAP_WORDS; ++k)
+        for (uint64_t b = w[k]; b; b &= b - 1)
+          c.values.push_back(k * 64 + __builtin_ctzll(b));
+    } else {
+      c.values.reserve(2 * runs);
+      bool inRun = false;
+      for (unsigned v = 0; v < BITMAP_WORDS * 64; ++v) {
+        bool bit = (w[v >> 6] >> (v & 63)) & 1;
+        if (bit && !inRun)
+          c.values.push_back(v);
+        else if (!bit && inRun)
+          c.values.push_back(v - 1);
+        inRun = bit;
+      }
+      if (inRun)
+        c.values.push_back(BITMAP_WORDS * 64 - 1);
+    }
+    return c;
+  }
+
+  //! Builds the canonical chunk for sorted, distinct low halves
+  static Chunk fromSortedLow(uint16_t key, std::vector<uint16_t>&& low) {
+    uint32_t runs = 0;
+    for (size_t i = 0; i < low.size(); ++i)
+      if (i == 0 || low[i] != low[i - 1] + 1)
+        ++runs;
+    Chunk c{key, chooseKind(low.size(), runs), (uint32_t)low.size(), {}, {}};
+    if (c.kind == Array) {
+      c.values = std::move(low);
+    } else if (c.kind == Run) {
+      c.values.reserve(2 * runs);
+      for (size_t i = 0; i < low.size(); ++i) {
+        if (i == 0 || low[i] != low[i - 1] + 1) {
+          if (i)
+            c.values.push_back(low[i - 1]);
+          c.values.push_back(low[i]);
+        }
+      }
+      c.values.push_back(low.back());
+    } else {
+      c.words.assign(BITMAP_WORDS, 0);
+      for (auto v : low)
+        c.words[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+    return c;
+  }
+
+  static Chunk unionChunk(const Chunk& x, const Chunk& y) {
+    if (x.kind == Array && y.kind == Array) {
+      std::vector<uint16_t> merged;
+      merged.reserve(x.values.size() + y.values.size());
+      std::set_union(x.values.begin(), x.values.end(), y.values.begin(),
+                     y.values.end(), std::back_inserter(merged));
+      return fromSortedLow(x.key, std::move(merged));
+    }
+    uint64_t w[BITMAP_WORDS] = {0};
+    orInto(x, w);
+    orInto(y, w);
+    return fromWords(x.key, w);
+  }
+
+  static Chunk differenceChunk(const Chunk& x, const Chunk& y) {
+    if (x.kind == Array) {
+      std::vector<uint16_t> kept;
+      for (auto v : x.values)
+        if (!chunkContains(y, v))
+          kept.push_back(v);
+      if (kept.empty())
+        return Chunk{x.key, Array, 0, {}, {}};
+      return fromSortedLow(x.key, std::move(kept));
+    }
+    uint64_t w[BITMAP_WORDS] = {0};
+    orInto(x, w);
+    andNotInto(y, w);
+    return fromWords(x.key, w);
+  }
+
+  void finalize() {
+    cardinality = 0;
+    hashValue   = 14695981039346656037ULL;
+    auto mix    = [&](uint64_t x) {
+      hashValue = (hashValue ^ x) * 1099511628211ULL;
+    };
+    for (const Chunk& c : chunks) {
+      cardinality += c.card;
+      mix(c.key | ((uint64_t)c.kind << 16) | ((uint64_t)c.card << 32));
+      for (auto v : c.values)
+        mix(v);
+      for (auto w : c.words)
+        mix(w);
+    }
+  }
+
+public:
+  /**
+   * Iterator over the elements in increasing order.
+   */
+  class const_iterator
+      : public boost::iterator_facade<const_iterator, const unsigned,
+                                      boost::forward_traversal_tag> {
+    const std::vector<Chunk>* chunks = nullptr;
+    size_t chunk                     = 0;
+    size_t index                     = 0; // value, run pair or word index
+    uint64_t state                   = 0; // current run value or word bits
+    unsigned value                   = 0;
+
+    void enterChunk() {
+      index = 0;
+      state = 0;
+      if (chunk < chunks->size()) {
+        const Chunk& c = (*chunks)[chunk];
+        if (c.kind == Run)
+          state = c.values[0];
+        else if (c.kind == Bitmap)
+          state = c.words[0];
+      }
+    }
+
+    void settle() {
+      while (chunk < chunks->size()) {
+        const Chunk& c = (*chunks)[chunk];
+        unsigned base  = unsigned(c.key) << 16;
+        if (c.kind == Array && index < c.values.size()) {
+          value = base | c.values[index];
+          return;
+        }
+        if (c.kind == Run && index < c.values.size()) {
+          value = base | unsigned(state);
+          return;
+        }
+        if (c.kind == Bitmap) {
+          while (!state && index + 1 < BITMAP_WORDS)
+            state = c.words[++index];
+          if (state) {
+            value = base | unsigned(index * 64 + __builtin_ctzll(state));
+            return;
+          }
+        }
+        ++chunk;
+        enterChunk();
+      }
+      index = 0;
+      state = 0;
+    }
+
+    friend class boost::iterator_core_access;
+
+    void increment() {
+      const Chunk& c = (*chunks)[chunk];
+      if (c.kind == Array) {
+        ++index;
+      } else if (c.kind == Run) {
+        if (state < c.values[index + 1]) {
+          ++state;
+        } else {
+          index += 2;
+          state = index < c.values.size() ? c.values[index] : 0;
+        }
+      } else {
+        state &= state - 1;
+      }
+      settle();
+    }
+
+    bool equal(const const_iterator& o) const {
+      return chunk == o.chunk && index == o.index && state == o.state;
+    }
+
+    const unsigned& dereference() const { return value; }
+
+  public:
+    const_iterator() = default;
+
+    const_iterator(const std::vector<Chunk>* c, bool atEnd) : chunks(c) {
+      chunk = atEnd ? chunks->size() : 0;
+      enterChunk();
+      if (!atEnd)
+        settle();
+    }
+  };
+
+  HybridSet() { finalize(); }
+
+  /**
+   * @param elements sorted, duplicate-free elements
+   */
+  static HybridSet fromSorted(const std::vector<unsigned>& elements) {
+    HybridSet s;
+    for (size_t i = 0; i < elements.size();) {
+      uint16_t key = elements[i] >> 16;
+      std::vector<uint16_t> low;
+      for (; i < elements.size() && (elements[i] >> 16) == key; ++i)
+        low.push_back(elements[i] & 0xFFFF);
+      s.chunks.push_back(fromSortedLow(key, std::move(low)));
+    }
+    s.finalize();
+    return s;
+  }
+
+  //! @returns a | b
+  static HybridSet unite(const HybridSet& a, const HybridSet& b) {
+    HybridSet s;
+    auto ia = a.chunks.begin(), ib = b.chunks.begin();
+    while (ia != a.chunks.end() || ib != b.chunks.end()) {
+      if (ib == b.chunks.end() || (ia != a.chunks.end() && ia->key < ib->key))
+        s.chunks.push_back(*ia++);
+      else if (ia == a.chunks.end() || ib->key < ia->key)
+        s.chunks.push_back(*ib++);
+      else
+        s.chunks.push_back(unionChunk(*ia++, *ib++));
+    }
+    s.finalize();
+    return s;
+  }
+
+  //! @returns a & ~b
+  static HybridSet difference(const HybridSet& a, const HybridSet& b) {
+    HybridSet s;
+    auto ib = b.chunks.begin();
+    for (const Chunk& c : a.chunks) {
+      while (ib != b.chunks.end() && ib->key < c.key)
+        ++ib;
+      if (ib == b.chunks.end() || ib->key != c.key) {
+        s.chunks.push_back(c);
+      } else {
+        Chunk d = differenceChunk(c, *ib);
+        if (d.card)
+          s.chunks.push_back(std::move(d));
+      }
+    }
+    s.finalize();
+    return s;
+  }
+
+  bool contains(unsigned v) const {
+    uint16_t key = v >> 16;
+    auto it      = std::lower_bound(
+        chunks.begin(), chunks.end(), key,
+        [](const Chunk& c, uint16_t k) { return c.key < k; });
+    return it != chunks.end() && it->key == key &&
+           chunkContains(*it, v & 0xFFFF);
+  }
+
+  bool operator==(const HybridSet& o) const {
+    return cardinality == o.cardinality && chunks == o.chunks;
+  }
+
+  unsigned count() const { return cardinality; }
+  uint64_t hash() const { return hashValue; }
+
+  //! @returns approximate number of bytes used by this set
+  size_t memoryBytes() const {
+    size_t bytes = sizeof(*this) + chunks.capacity() * sizeof(Chunk);
+    for (const Chunk& c : chunks)
+      bytes += c.values.capacity() * sizeof(uint16_t) +
+               c.words.capacity() * sizeof(uint64_t);
+    return bytes;
+  }
+
+  const_iterator begin() const { return const_iterator(&chunks, false); }
+  const_iterator end() const { return const_iterator(&chunks, true); }
+};
+
+/**
+ * Hash-consing table of immutable points-to sets. Equal sets share one id,
+ * so copying a set is copying its id and modifying one creates (or finds)
+ * another. Union and difference results are memoized in a direct-mapped
+ * cache keyed by operand ids; since ids are never reused, a cached entry is
+ * valid as long as its result is still alive.
+ *
+ * Sets are reference counted by their holders. Unreferenced sets stay in the
+ * table (and in the cache) until the next sweep().
+ *
+ * Not thread safe.
+ */
+class PointsToSetTable {
+public:
+  using SetID                  = uint32_t;
+  static constexpr SetID EMPTY = 0;
+
+private:
+  enum Op : uint32_t { NoOp, Union, Difference };
+
+  struct CacheEntry {
+    SetID a;
+    SetID b;
+    SetID result;
+    Op op;
+  };
+
+  std::vector<std::unique_ptr<HybridSet>> sets;
+  std::vector<uint32_t> refs;
+  std::unordered_multimap<uint64_t, SetID> index;
+  std::vector<SetID> unreferenced;
+  std::vector<CacheEntry> cache;
+  size_t cacheMask;
+  size_t liveBytes = 0;
+  size_t numLive   = 0;
+  uint64_t hits    = 0;
+  uint64_t misses  = 0;
+
+  CacheEntry& cacheSlot(SetID a, SetID b, Op op) {
+    uint64_t h = ((uint64_t)a * 0x9E3779B97F4A7C15ULL) ^
+                 ((uint64_t)b * 0xC2B2AE3D27D4EB4FULL) ^ op;
+    return cache[(h >> 17) & cacheMask];
+  }
+
+  bool alive(SetID id) const { return id < sets.size() && sets[id]; }
+
+  template <typename Compute>
+  SetID cached(SetID a, SetID b, Op op, Compute compute) {
+    CacheEntry& e = cacheSlot(a, b, op);
+    if (e.op == op && e.a == a && e.b == b && alive(e.result)) {
+      ++hits;
+      return e.result;
+    }
+    ++misses;
+    SetID r = intern(compute());
+    e       = CacheEntry{a, b, r, op};
+    return r;
+  }
+
+public:
+  /**
+   * @param cacheBits log2 of the number of operation cache entries
+   */
+  explicit PointsToSetTable(unsigned cacheBits = 18)
+      : cache(size_t(1) << cacheBits, CacheEntry{0, 0, 0, NoOp}),
+        cacheMask((size_t(1) << cacheBits) - 1) {
+    SetID empty = intern(HybridSet());
+    acquire(empty); // the empty set lives forever
+  }
+
+  const HybridSet& get(SetID id) const { return *sets[id]; }
+
+  //! @returns the id of the set equal to s, adding s if it is new
+  SetID intern(HybridSet&& s) {
+    auto range = index.equal_range(s.hash());
+    for (auto it = range.first; it != range.second; ++it)
+      if (*sets[it->second] == s)
+        return it->second;
+    SetID id = sets.size();
+    index.emplace(s.hash(), id);
+    liveBytes += s.memoryBytes();
+    ++numLive;
+    sets.emplace_back(new HybridSet(std::move(s)));
+    refs.push_back(0);
+    unreferenced.push_back(id);
+    return id;
+  }
+
+  SetID singleton(unsigned v) {
+    return intern(HybridSet::fromSorted(std::vector<unsigned>{v}));
+  }
+
+  //! @returns the id of a | b
+  SetID unite(SetID a, SetID b) {
+    if (a == b || b == EMPTY)
+      return a;
+    if (a == EMPTY)
+      return b;
+    if (a > b)
+      std::swap(a, b);
+    return cached(a, b, Union,
+                  [&] { return HybridSet::unite(get(a), get(b)); });
+  }
+
+  //! @returns the id of a & ~b
+  SetID difference(SetID a, SetID b) {
+    if (a == b || a == EMPTY)
+      return EMPTY;
+    if (b == EMPTY)
+      return a;
+    return cached(a, b, Difference,
+                  [&] { return HybridSet::difference(get(a), get(b)); });
+  }
+
+  //! a is a subset of b exactly when a | b is b, which the cache remembers
+  bool isSubsetEq(SetID a, SetID b) { return unite(a, b) == b; }
+
+  void acquire(SetID id) { ++refs[id]; }
+
+  void release(SetID id) {
+    if (--refs[id] == 0)
+      unreferenced.push_back(id);
+  }
+
+  //! Frees every set that nobody holds
+  void sweep() {
+    for (SetID id : unreferenced) {
+      if (!alive(id) || refs[id] != 0 || id == EMPTY)
+        continue;
+      auto range = index.equal_range(sets[id]->hash());
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+          index.erase(it);
+          break;
+        }
+      }
+      liveBytes -= sets[id]->memoryBytes();
+      --numLive;
+      sets[id].reset();
+    }
+    unreferenced.clear();
+  }
+
+  size_t numLiveSets() const { return numLive; }
+  size_t numCreatedSets() const { return sets.size(); }
+  size_t memoryBytes() const { return liveBytes; }
+  uint64_t cacheHits() const { return hits; }
+  uint64_t cacheMisses() const { return misses; }
+};
+
+/**
+ * Points-to set handle with the interface of SparseBitVector, backed by a
+ * PointsToSetTable. Holding a set costs one id; updates are copy-on-write.
+ */
+class SharedPointsToSet {
+  using SetID = PointsToSetTable::SetID;
+
+  PointsToSetTable* table = nullptr;
+  SetID id                = PointsToSetTable::EMPTY;
+
+  void assign(SetID newID) {
+    table->acquire(newID);
+    table->release(id);
+    id = newID;
+  }
+
+public:
+  using Context        = PointsToSetTable;
+  using const_iterator = HybridSet::const_iterator;
+
+  void init(PointsToSetTable* t) {
+    table = t;
+    id    = PointsToSetTable::EMPTY;
+    table->acquire(id);
+  }
+
+  void freeAll() {
+    if (table)
+      table->release(id);
+    table = nullptr;
+  }
+
+  SetID getID() const { return id; }
+
+  bool test(unsigned v) const { return table->get(id).contains(v); }
+
+  //! @returns true if v was not in the set before
+  bool set(unsigned v) {
+    if (test(v))
+      return false;
+    assign(table->unite(id, table->singleton(v)));
+    return true;
+  }
+
+  //! @returns number of elements added
+  unsigned unify(const SharedPointsToSet& other) {
+    SetID u = table->unite(id, other.id);
+    if (u == id)
+      return 0;
+    unsigned added = table->get(u).count() - table->get(id).count();
+    assign(u);
+    return added;
+  }
+
+  bool isSubsetEq(const SharedPointsToSet& other) const {
+    return table->isSubsetEq(id, other.id);
+  }
+
+  unsigned count() const { return table->get(id).count(); }
+
+  const_iterator begin() const { return table->get(id).begin(); }
+  const_iterator end() const { return table->get(id).end(); }
+
+  std::vector<unsigned> getAllSetBits() const {
+    return std::vector<unsigned>(begin(), end());
+  }
+
+  void print(std::ostream& out, std::string prefix = std::string("")) const {
+    std::vector<unsigned> setBits = getAllSetBits();
+    out << "Elements(" << setBits.size() << "): ";
+
+    for (auto setBitNum : setBits) {
+      out << prefix << setBitNum << ", ";
+    }
+
+    out << "\n";
+  }
+};
+
+} // namespace galois
+
+#endif
@@ -0,0 +1,679 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause
+ * BSD License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2019, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/AtomicHelpers.h"
+#include "galois/Bag.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/graphs/LC_CSR_CSC_Graph.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <fstream>
+#include <limits>
+#include <vector>
+
+constexpr static const char* const REGION_NAME = "SCC";
+constexpr static const char* const name = "Strongly Connected Components";
+constexpr static const char* const desc =
+    "Computes the strongly connected components of a directed graph";
+
+/*******************************************************************************
+ * Declaration of command line arguments
+ ******************************************************************************/
+namespace cll = llvm::cl;
+
+enum Algo { MultiStep = 0, Coloring };
+
+static cll::opt<std::string>
+    inputFile(cll::Positional, cll::desc("<input file>"), cll::Required);
+
+static cll::opt<Algo> algo(
+    "algo", cll::desc("Choose an algorithm (default MultiStep):"),
+    cll::values(clEnumVal(MultiStep, "Trim, one forward-backward search from "
+                                     "a high-degree pivot, then coloring"),
+                clEnumVal(Coloring, "Trim, then coloring only")),
+    cll::init(MultiStep));
+
+static cll::opt<std::string> componentsFilename(
+    "outputComponents",
+    cll::desc("[output file of the component id (a member node of the "
+              "component) of each node as binary uint32]"),
+    cll::init(""));
+
+/*******************************************************************************
+ * Graph structure declarations + other inits
+ ******************************************************************************/
+
+//! Component of a node that is still in the graph
+constexpr static const uint32_t UNASSIGNED =
+    std::numeric_limits<uint32_t>::max();
+
+struct NodeData {
+  //! id of a node in the same SCC once found; UNASSIGNED while the node is
+  //! still in the remaining graph
+  std::atomic<uint32_t> component;
+  //! max id of a remaining node that reaches this one (coloring)
+  std::atomic<uint32_t> color;
+  //! forward-backward search marks
+  std::atomic<uint8_t> fwVisited;
+  std::atomic<uint8_t> bwVisited;
+};
+
+//! Typedef for graph used, CSR graph with in-edges (edge-type is void).
+using Graph = galois::graphs::LC_CSR_CSC_Graph<NodeData, void, false, true>;
+//! Typedef for node type in the CSR graph.
+using GNode = Graph::GraphNode;
+
+//! Chunksize for for_each worklist: best chunksize will depend on input.
+constexpr static const unsigned CHUNK_SIZE = 64u;
+
+/*******************************************************************************
+ * Functions for running the algorithm
+ ******************************************************************************/
+
+bool isRemaining(Graph& graph, GNode n) {
+  return graph.getData(n, galois::MethodFlag::UNPROTECTED).component ==
+         UNASSIGNED;
+}
+
+/**
+ * Removes nodes with no remaining in-neighbors or no remaining out-neighbors
+ * (trim-1); each is an SCC by itself. Only neighbors of removed nodes are
+ * checked again in the next round.
+ *
+ * @param graph Graph to operate on
+ * @param candidates Nodes to check first; consumed
+ * @returns number of trimmed nodes
+ */
+size_t trim1(Graph& graph, galois::InsertBag<GNode>& candidates) {
+  galois::InsertBag<GNode>* current = &candidates;
+  galois::InsertBag<GNode> nextBag;
+  galois::InsertBag<GNode>* next = &nextBag;
+  galois::GAccumulator<size_t> trimmed;
+
+  while (!current->empty()) {
+    galois::do_all(
+        galois::iterate(*current),
+        [&](GNode n) {
+          if (!isRemaining(graph, n)) {
+            return;
+          }
+          bool hasIn = false;
+          for (auto e : graph.in_edges(n, galois::MethodFlag::UNPROTECTED)) {
+            GNode src = graph.getInEdgeDst(e);
+            if (src != n && isRemaining(graph, src)) {
+              hasIn = true;
+              break;
+            }
+          }
+          bool hasOut = false;
+          if (hasIn) {
+            for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+              GNode dst = graph.getEdgeDst(e);
+              if (dst != n && isRemaining(graph, dst)) {
+                hasOut = true;
+                break;
+              }
+            }
+          }
+          if (hasIn && hasOut) {
+            return;
+          }
+
+          graph.getData(n, galois::MethodFlag::UNPROTECTED).component = n;
+          trimmed += 1;
+          for (auto e : graph.in_edges(n, galois::MethodFlag::UNPROTECTED)) {
+            GNode src = graph.getInEdgeDst(e);
+            if (isRemaining(graph, src)) {
+              next->push(src);
+            }
+          }
+          for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+            GNode dst = graph.getEdgeDst(e);
+            if (isRemaining(graph, dst)) {
+              next->push(dst);
+            }
+          }
+        },
+        galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+        galois::loopname("Trim1"));
+
+    current->clear();
+    std::swap(current, next);
+  }
+  candidates.clear();
+  return trimmed.reduce();
+}
+
+/**
+ * Returns the only remaining neighbor of n other than n itself, or
+ * UNASSIGNED if there are none or several.
+ */
+template <bool incoming>
+GNode onlyNeighbor(Graph& graph, GNode n) {
+  GNode only = UNASSIGNED;
+  auto visit = [&](GNode other) {
+    if (other == n || other == only || !isRemaining(graph, other)) {
+      return true;
+    }
+    if (only != UNASSIGNED) {
+      only = UNASSIGNED;
+      return false;
+    }
+    only = other;
+    return true;
+  };
+  if (incoming) {
+    for (auto e : graph.in_edges(n, galois::MethodFlag::UNPROTECTED)) {
+      if (!visit(graph.getInEdgeDst(e))) {
+        return UNASSIGNED;
+      }
+    }
+  } else {
+    for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+      if (!visit(graph.getEdgeDst(e))) {
+        return UNASSIGNED;
+      }
+    }
+  }
+  return only;
+}
+
+/**
+ * Finds SCCs of size two (trim-2): u and v whose only remaining in-neighbors
+ * (or only remaining out-neighbors) are each other form a cycle nothing else
+ * enters (or leaves).
+ *
+ * @param graph Graph to operate on
+ * @returns number of removed nodes
+ */
+size_t trim2(Graph& graph) {
+  galois::GAccumulator<size_t> trimmed;
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode u) {
+        if (!isRemaining(graph, u)) {
+          return;
+        }
+        GNode v = onlyNeighbor<true>(graph, u);
+        if (v == UNASSIGNED || v < u || onlyNeighbor<true>(graph, v) != u) {
+          v = onlyNeighbor<false>(graph, u);
+          if (v == UNASSIGNED || v < u ||
+              onlyNeighbor<false>(graph, v) != u) {
+            return;
+          }
+        }
+        // u < v, so the pair is only claimed from u
+        graph.getData(v, galois::MethodFlag::UNPROTECTED).component = u;
+        graph.getData(u, galois::MethodFlag::UNPROTECTED).component = u;
+        trimmed += 2;
+      },
+      galois::steal(), galois::loopname("Trim2"));
+  return trimmed.reduce();
+}
+
+/**
+ * Level-synchronous reachability from root over remaining nodes, along out-
+ * (forward) or in-edges (backward). A backward search only enters nodes the
+ * forward search reached, since only their intersection is needed.
+ */
+template <bool forward>
+void reach(Graph& graph, GNode root) {
+  auto mark = [&](GNode n) -> std::atomic<uint8_t>& {
+    auto& data = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+    return forward ? data.fwVisited : data.bwVisited;
+  };
+  auto allowed = [&](GNode n) {
+    return isRemaining(graph, n) &&
+           (forward ||
+            graph.getData(n, galois::MethodFlag::UNPROTECTED).fwVisited);
+  };
+
+  galois::InsertBag<GNode> frontierA;
+  galois::InsertBag<GNode> frontierB;
+  galois::InsertBag<GNode>* current = &frontierA;
+  galois::InsertBag<GNode>* next    = &frontierB;
+  mark(root) = 1;
+  current->push(root);
+
+  auto tryVisit = [&](GNode n) {
+    if (allowed(n) && !mark(n)) {
+      uint8_t expected = 0;
+      if (mark(n).compare_exchange_strong(expected, 1)) {
+        next->push(n);
+      }
+    }
+  };
+
+  while (!current->empty()) {
+    galois::do_all(
+        galois::iterate(*current),
+        [&](GNode n) {
+          if (forward) {
+            for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+              tryVisit(graph.getEdgeDst(e));
+            }
+          } else {
+            for (auto e :
+                 graph.in_edges(n, galois::MethodFlag::UNPROTECTED)) {
+              tryVisit(graph.getInEdgeDst(e));
+            }
+          }
+        },
+        galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+        galois::loopname(forward ? "ForwardReach" : "BackwardReach"));
+    current->clear();
+    std::swap(current, next);
+  }
+}
+
+/**
+ * One forward-backward step: the SCC of a high in-degree x out-degree pivot
+ * is the intersection of the nodes it reaches and the nodes reaching it. On
+ * power-law graphs this removes the giant SCC in two searches.
+ *
+ * @param graph Graph to operate on
+ * @returns number of removed nodes
+ */
+size_t forwardBackward(Graph& graph) {
+  // (capped degree product << 32) | node, so the max identifies the pivot
+  galois::GReduceMax<uint64_t> best;
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode n) {
+        if (!isRemaining(graph, n)) {
+          return;
+        }
+        uint64_t in = std::distance(
+            graph.in_edge_begin(n, galois::MethodFlag::UNPROTECTED),
+            graph.in_edge_end(n, galois::MethodFlag::UNPROTECTED));
+        uint64_t out = std::distance(
+            graph.edge_begin(n, galois::MethodFlag::UNPROTECTED),
+            graph.edge_end(n, galois::MethodFlag::UNPROTECTED));
+        uint64_t score = std::min<uint64_t>(
+            in * out, std::numeric_limits<uint32_t>::max() - 1);
+        best.update(((score + 1) << 32) | n);
+      },
+      galois::loopname("PickPivot"));
+  uint64_t picked = best.reduce();
+  if (picked == 0) {
+    return 0;
+  }
+  GNode pivot = picked & std::numeric_limits<uint32_t>::max();
+
+  reach<true>(graph, pivot);
+  reach<false>(graph, pivot);
+
+  galois::GAccumulator<size_t> removed;
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode n) {
+        auto& data = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+        if (data.fwVisited && data.bwVisited) {
+          data.component = pivot;
+          removed += 1;
+        }
+        data.fwVisited = 0;
+        data.bwVisited = 0;
+      },
+      galois::loopname("ForwardBackwardAssign"));
+  return removed.reduce();
+}
+
+/**
+ * One coloring step: every remaining node takes the max id of a remaining
+ * node that reaches it. A node whose color is its own id is the root of its
+ * SCC, which is the set of same-colored nodes reaching the root. Removes at
+ * least one SCC per color.
+ *
+ * @param graph Graph to operate on
+ * @returns number of removed nodes
+ */
+size_t coloring(Graph& graph) {
+  galois::InsertBag<GNode> remaining;
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode n) {
+        if (isRemaining(graph, n)) {
+          graph.getData(n, galois::MethodFlag::UNPROTECTED).color = n;
+          remaining.push(n);
+        }
+      },
+      galois::loopname("ColoringInit"));
+
+  galois::for_each(
+      galois::iterate(remaining),
+      [&](GNode n, auto& ctx) {
+        uint32_t color =
+            graph.getData(n, galois::MethodFlag::UNPROTECTED).color;
+        for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+          GNode dst = graph.getEdgeDst(e);
+          if (!isRemaining(graph, dst)) {
+            continue;
+          }
+          auto& dstData = graph.getData(dst, galois::MethodFlag::UNPROTECTED);
+          if (galois::atomicMax(dstData.color, color) < color) {
+            ctx.push(dst);
+          }
+        }
+      },
+      galois::disable_conflict_detection(), galois::chunk_size<CHUNK_SIZE>(),
+      galois::loopname("ColorPropagation"));
+
+  // roots claim their SCC backward, staying inside their color; components
+  // are only assigned after the search, so it sees a fixed remaining graph
+  galois::InsertBag<GNode> roots;
+  galois::do_all(
+      galois::iterate(remaining),
+      [&](GNode n) {
+        auto& data = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+        if (data.color == n) {
+          data.bwVisited = 1;
+          roots.push(n);
+        }
+      },
+      galois::loopname("ColoringRoots"));
+
+  galois::for_each(
+      galois::iterate(roots),
+      [&](GNode n, auto& ctx) {
+        uint32_t color =
+            graph.getData(n, galois::MethodFlag::UNPROTECTED).color;
+        for (auto e : graph.in_edges(n, galois::MethodFlag::UNPROTECTED)) {
+          GNode src     = graph.getInEdgeDst(e);
+          auto& srcData = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+          if (srcData.component != UNASSIGNED || srcData.color != color ||
+              srcData.bwVisited) {
+            continue;
+          }
+          uint8_t expected = 0;
+          if (srcData.bwVisited.compare_exchange_strong(expected, 1)) {
+            ctx.push(src);
+          }
+        }
+      },
+      galois::disable_conflict_detection(), galois::chunk_size<CHUNK_SIZE>(),
+      galois::loopname("ColoringBackward"));
+
+  galois::GAccumulator<size_t> removed;
+  galois::do_all(
+      galois::iterate(remaining),
+      [&](GNode n) {
+        auto& data = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+        if (data.bwVisited) {
+          data.component = data.color.load();
+          data.bwVisited = 0;
+          removed += 1;
+        }
+      },
+      galois::loopname("ColoringAssign"));
+  return removed.reduce();
+}
+
+/**
+ * Multistep SCC: trim-1, trim-2, optionally one forward-backward step for the
+ * giant SCC, then alternate trim-1 and coloring until every node has a
+ * component.
+ *
+ * @param graph Graph to operate on
+ */
+void computeSCC(Graph& graph) {
+  galois::InsertBag<GNode> candidates;
+  galois::do_all(
+      galois::iterate(graph), [&](GNode n) { candidates.push(n); },
+      galois::loopname("TrimInit"));
+
+  size_t left = graph.size();
+  left -= trim1(graph, candidates);
+  left -= trim2(graph);
+
+  if (algo == MultiStep && left) {
+    left -= forwardBackward(graph);
+  }
+
+  unsigned colorRounds = 0;
+  while (left) {
+    galois::do_all(
+        galois::iterate(graph),
+        [&](GNode n) {
+          if (isRemaining(graph, n)) {
+            candidates.push(n);
+          }
+        },
+        galois::loopname("TrimCandidates"));
+    left -= trim1(graph, candidates);
+    if (left) {
+      left -= coloring(graph);
+      ++colorRounds;
+    }
+  }
+  galois::runtime::reportStat_Single(REGION_NAME, "ColoringRounds",
+                                     colorRounds);
+}
+
+/*******************************************************************************
+ * Output and sanity check operators
+ ******************************************************************************/
+
+/**
+ * Prints the number of SCCs and a histogram of their sizes in power-of-two
+ * buckets.
+ *
+ * @param graph Graph with components assigned
+ */
+void reportHistogram(Graph& graph) {
+  galois::LargeArray<uint32_t> sizes;
+  sizes.create(graph.size(), 0);
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode n) {
+        __sync_fetch_and_add(
+            &sizes[graph.getData(n, galois::MethodFlag::UNPROTECTED)
+                       .component],
+            1);
+      },
+      galois::loopname("ComponentSizes"));
+
+  const unsigned numBuckets = 33;
+  std::vector<galois::GAccumulator<size_t>> buckets(numBuckets);
+  galois::GAccumulator<size_t> numComponents;
+  galois::GReduceMax<uint32_t> maxSize;
+  galois::do_all(
+      galois::iterate(size_t{0}, graph.size()),
+      [&](size_t c) {
+        uint32_t size = sizes[c];
+        if (size) {
+          buckets[31 - __builtin_clz(size)] += 1;
+          numComponents += 1;
+          maxSize.update(size);
+        }
+      },
+      galois::loopname("Histogram"));
+
+  galois::gPrint("Strongly connected components: ", numComponents.reduce(),
+                 " (largest size: ", maxSize.reduce(), ")\n");
+  galois::gPrint("Component size histogram:\n");
+  for (unsigned b = 0; b < numBuckets; ++b) {
+    size_t count = buckets[b].reduce();
+    if (count) {
+      galois::gPrint("  [", 1UL << b, ", ", 2UL << b, "): ", count, "\n");
+    }
+  }
+  galois::runtime::reportStat_Single(REGION_NAME, "Components",
+                                     numComponents.reduce());
+  galois::runtime::reportStat_Single(REGION_NAME, "LargestComponentSize",
+                                     maxSize.reduce());
+}
+
+//! Writes the component of each node as binary uint32
+void writeComponents(Graph& graph) {
+  std::ofstream file(componentsFilename, std::ios::binary);
+  if (!file) {
+    GALOIS_DIE("failed to open ", componentsFilename);
+  }
+  for (GNode n : graph) {
+    uint32_t c = graph.getData(n, galois::MethodFlag::UNPROTECTED).component;
+    file.write(reinterpret_cast<const char*>(&c), sizeof(c));
+  }
+}
+
+/**
+ * Checks the components against a serial iterative Tarjan: both must induce
+ * the same partition of the nodes.
+ *
+ * @param graph Graph with components assigned
+ * @returns true if the partitions match
+ */
+bool verify(Graph& graph) {
+  const uint32_t numNodes = graph.size();
+  std::vector<uint32_t> index(numNodes, UNASSIGNED);
+  std::vector<uint32_t> low(numNodes);
+  std::vector<uint32_t> tarjan(numNodes, UNASSIGNED);
+  std::vector<GNode> stack;
+  std::vector<std::pair<GNode, Graph::edge_iterator>> callStack;
+  uint32_t nextIndex = 0;
+
+  for (GNode root = 0; root < numNodes; ++root) {
+    if (index[root] != UNASSIGNED) {
+      continue;
+    }
+    index[root] = low[root] = nextIndex++;
+    stack.push_back(root);
+    callStack.emplace_back(root, graph.edge_begin(root));
+    while (!callStack.empty()) {
+      GNode n  = callStack.back().first;
+      auto& ei = callStack.back().second;
+      if (ei != graph.edge_end(n)) {
+        GNode dst = graph.getEdgeDst(*ei);
+        ++ei;
+        if (index[dst] == UNASSIGNED) {
+          index[dst] = low[dst] = nextIndex++;
+          stack.push_back(dst);
+          callStack.emplace_back(dst, graph.edge_begin(dst));
+        } else if (tarjan[dst] == UNASSIGNED) {
+          low[n] = std::min(low[n], index[dst]);
+        }
+        continue;
+      }
+      callStack.pop_back();
+      if (!callStack.empty()) {
+        GNode parent = callStack.back().first;
+        low[parent]  = std::min(low[parent], low[n]);
+      }
+      if (low[n] == index[n]) {
+        GNode member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          tarjan[member] = n;
+        } while (member != n);
+      }
+    }
+  }
+
+  // the map from Tarjan roots to computed components must be a bijection
+  std::vector<uint32_t> toComputed(numNodes, UNASSIGNED);
+  std::vector<uint32_t> toTarjan(numNodes, UNASSIGNED);
+  for (GNode n = 0; n < numNodes; ++n) {
+    uint32_t c = graph.getData(n).component;
+    if (c >= numNodes) {
+      return false;
+    }
+    if (toComputed[tarjan[n]] == UNASSIGNED) {
+      toComputed[tarjan[n]] = c;
+    }
+    if (toTarjan[c] == UNASSIGNED) {
+      toTarjan[c] = tarjan[n];
+    }
+    if (toComputed[tarjan[n]] != c || toTarjan[c] != tarjan[n]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*******************************************************************************
+ * Main method for running
+ ******************************************************************************/
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, nullptr, &inputFile);
+
+  galois::StatTimer totalTime("TimerTotal");
+  totalTime.start();
+
+  galois::reportPageAlloc("MemAllocPre");
+
+  //! Read graph from disk and build its in-edges.
+  galois::StatTimer graphReadingTimer("GraphConstructTime", REGION_NAME);
+  graphReadingTimer.start();
+  Graph graph;
+  graph.readAndConstructBiGraphFromGRFile(inputFile);
+  graphReadingTimer.stop();
+  galois::gPrint("Read ", graph.size(), " nodes, ", graph.sizeEdges(),
+                 " edges\n");
+
+  //! Preallocate pages in memory so allocation doesn't occur during compute.
+  galois::StatTimer preallocTime("PreAllocTime", REGION_NAME);
+  preallocTime.start();
+  galois::preAlloc(
+      std::max(size_t{galois::getActiveThreads()} * (graph.size() / 1000000),
+               std::max(10U, galois::getActiveThreads()) * size_t{10}));
+  preallocTime.stop();
+  galois::reportPageAlloc("MemAllocMid");
+
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode n) {
+        auto& data     = graph.getData(n);
+        data.component = UNASSIGNED;
+        data.color     = 0;
+        data.fwVisited = 0;
+        data.bwVisited = 0;
+      },
+      galois::loopname("Initialize"));
+
+  galois::StatTimer execTime("Timer_0");
+  execTime.start();
+  computeSCC(graph);
+  execTime.stop();
+
+  galois::reportPageAlloc("MemAllocPost");
+
+  reportHistogram(graph);
+  if (componentsFilename != "") {
+    writeComponents(graph);
+  }
+
+  if (!skipVerify) {
+    if (verify(graph)) {
+      std::cout << "Verification successful.\n";
+    } else {
+      GALOIS_DIE("verification failed");
+    }
+  }
+
+  totalTime.stop();
+
+  return 0;
+}
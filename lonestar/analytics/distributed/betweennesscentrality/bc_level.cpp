@@ -107,9 +107,9 @@ using Graph = galois::graphs::DistGraph<NodeData, void>;
 using GNode = typename Graph::GraphNode;
 
 // bitsets for tracking updates
-galois::DynamicBitSet bitset_num_shortest_paths;
-galois::DynamicBitSet bitset_current_length;
-galois::DynamicBitSet bitset_dependency;
+galois::HierarchicalBitSet bitset_num_shortest_paths;
+galois::HierarchicalBitSet bitset_current_length;
+galois::HierarchicalBitSet bitset_dependency;
 
 std::unique_ptr<galois::graphs::GluonSubstrate<Graph>> syncSubstrate;
 
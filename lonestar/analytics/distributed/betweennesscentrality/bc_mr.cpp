@@ -96,8 +96,8 @@ using GNode = typename Graph::GraphNode;
 
 // Bitsets for tracking which nodes need to be sync'd with respect to a
 // particular field
-galois::DynamicBitSet bitset_minDistances;
-galois::DynamicBitSet bitset_dependency;
+galois::HierarchicalBitSet bitset_minDistances;
+galois::HierarchicalBitSet bitset_dependency;
 
 std::unique_ptr<galois::graphs::GluonSubstrate<Graph>> syncSubstrate;
 
@@ -556,6 +556,7 @@ int main(int argc, char** argv) {
   StatTimer_total.start();
 
   galois::gPrint("[", net.ID, "] InitializeGraph\n");
+  setSyncPattern(writeAny, readAny);
   std::unique_ptr<Graph> hg;
   // false = iterate over in edges
   std::tie(hg, syncSubstrate) =
@@ -73,7 +73,7 @@ struct NodeData {
 typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
 
-galois::DynamicBitSet bitset_dist_current;
+galois::HierarchicalBitSet bitset_dist_current;
 
 std::unique_ptr<galois::graphs::GluonSubstrate<Graph>> syncSubstrate;
 
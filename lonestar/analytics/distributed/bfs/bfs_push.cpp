@@ -76,7 +76,7 @@ struct NodeData {
   uint32_t dist_old;
 };
 
-galois::DynamicBitSet bitset_dist_current;
+galois::HierarchicalBitSet bitset_dist_current;
 
 typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
@@ -0,0 +1,1146 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "DistBench/Output.h"
+#include "DistBench/Start.h"
+#include "galois/DistGalois.h"
+#include "galois/DReducible.h"
+#include "galois/ParallelSTL.h"
+#include "galois/gstl.h"
+#include "galois/runtime/Tracer.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+constexpr static const char* const REGION_NAME = "LouvainClustering";
+
+/******************************************************************************/
+/* Declaration of command line arguments */
+/******************************************************************************/
+
+namespace cll = llvm::cl;
+
+static cll::opt<double> c_threshold("c_threshold",
+                                    cll::desc("Threshold for modularity gain "
+                                              "within a phase: Default 0.01"),
+                                    cll::init(0.01));
+
+static cll::opt<double>
+    threshold("threshold",
+              cll::desc("Total threshold for modularity gain across "
+                        "phases: Default 0.01"),
+              cll::init(0.01));
+
+static cll::opt<uint32_t>
+    max_iter("max_iter",
+             cll::desc("Maximum number of iterations to execute: Default 10"),
+             cll::init(10));
+
+static cll::opt<uint32_t>
+    min_graph_size("min_graph_size",
+                   cll::desc("Minimum coarsened graph size: Default 100"),
+                   cll::init(100));
+
+static cll::opt<std::string> coarseGraphDir(
+    "coarseGraphDir",
+    cll::desc("Directory used to write the coarsened graph of each phase "
+              "before it is re-partitioned with CuSP; must be visible to all "
+              "hosts and is required with more than one host: Default /tmp"),
+    cll::init("/tmp"));
+
+/******************************************************************************/
+/* Graph structure declarations + other initialization */
+/******************************************************************************/
+
+constexpr static const uint64_t UNASSIGNED =
+    std::numeric_limits<uint64_t>::max();
+
+//! Edge weights of the coarsened graphs
+typedef uint64_t EdgeTy;
+
+struct NodeData {
+  //! community this node belongs to (global ID of the community)
+  uint64_t curr_comm_ass;
+  //! community this node belonged to before the last round
+  uint64_t prev_comm_ass;
+  //! community this node will move to at the end of the round
+  uint64_t next_comm_ass;
+  //! sum of weights of the edges of this node
+  uint64_t degree_wt;
+  //! sum of weighted degrees of curr_comm_ass
+  uint64_t comm_degree_wt;
+  //! number of nodes in curr_comm_ass
+  uint64_t comm_size;
+  //! id of this node in the coarsened graph of the next phase
+  uint64_t coarse_id;
+  //! sum of weighted degrees of the community with this node's global ID;
+  //! only maintained on the master
+  std::atomic<uint64_t> total_degree_wt;
+  //! number of nodes in the community with this node's global ID; only
+  //! maintained on the master
+  std::atomic<uint64_t> total_size;
+};
+
+typedef galois::graphs::DistGraph<NodeData, void> Graph;
+typedef galois::graphs::DistGraph<NodeData, EdgeTy> CoarseGraph;
+typedef typename Graph::GraphNode GNode;
+
+std::unique_ptr<galois::graphs::GluonSubstrate<Graph>> syncSubstrate;
+
+#include "louvain_clustering_sync.hh"
+
+//! The input graph is unweighted
+inline EdgeTy edgeWeight(Graph&, Graph::edge_iterator) { return 1; }
+
+inline EdgeTy edgeWeight(CoarseGraph& graph, CoarseGraph::edge_iterator ii) {
+  return graph.getEdgeData(ii);
+}
+
+/******************************************************************************/
+/* Communication helpers */
+/******************************************************************************/
+
+//! Increments evilPhase, a phase counter used by communication.
+void incrementEvilPhase() {
+  ++galois::runtime::evilPhase;
+  // limit defined by MPI or LCI
+  if (galois::runtime::evilPhase >=
+      static_cast<uint32_t>(std::numeric_limits<int16_t>::max())) {
+    galois::runtime::evilPhase = 1;
+  }
+}
+
+/**
+ * Sends a value to every other host and returns the values of all hosts,
+ * indexed by host ID.
+ */
+std::vector<uint64_t> allGather(uint64_t localValue) {
+  auto& net = galois::runtime::getSystemNetworkInterface();
+  std::vector<uint64_t> values(net.Num);
+  values[net.ID] = localValue;
+
+  for (unsigned x = 0; x < net.Num; ++x) {
+    if (x == net.ID)
+      continue;
+    galois::runtime::SendBuffer b;
+    galois::runtime::gSerialize(b, localValue);
+    net.sendTagged(x, galois::runtime::evilPhase, b);
+  }
+
+  for (unsigned x = 0; x < net.Num; ++x) {
+    if (x == net.ID)
+      continue;
+    decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+    do {
+      p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+    } while (!p);
+    galois::runtime::gDeserialize(p->second, values[p->first]);
+  }
+  incrementEvilPhase();
+
+  return values;
+}
+
+/**
+ * Looks up a value for each of the given global IDs on the host that owns
+ * the ID. Requests are deduplicated per host before they are sent, so asking
+ * for the same community from many nodes costs a single lookup.
+ *
+ * @param graph graph whose master assignment determines the owners
+ * @param gids global IDs to look up; UNASSIGNED entries are skipped
+ * @param ownerValue functor called on the owner with the local ID of a
+ * requested node; returns the value to send back
+ * @param defaultValue value returned for UNASSIGNED entries
+ * @returns values in the same order as gids
+ */
+template <typename GraphTy, typename ValTy, typename ValueFn>
+std::vector<ValTy> fetchFromOwners(GraphTy& graph,
+                                   const std::vector<uint64_t>& gids,
+                                   ValueFn ownerValue, ValTy defaultValue) {
+  auto& net               = galois::runtime::getSystemNetworkInterface();
+  const unsigned numHosts = net.Num;
+
+  galois::substrate::PerThreadStorage<std::vector<std::vector<uint64_t>>>
+      threadRequests;
+  galois::on_each([&](unsigned, unsigned) {
+    threadRequests.getLocal()->resize(numHosts);
+  });
+  galois::do_all(
+      galois::iterate((size_t)0, gids.size()),
+      [&](size_t i) {
+        uint64_t gid = gids[i];
+        if (gid != UNASSIGNED) {
+          (*threadRequests.getLocal())[graph.getHostID(gid)].push_back(gid);
+        }
+      },
+      galois::no_stats(), galois::loopname("FetchBucket"));
+
+  std::vector<std::vector<uint64_t>> requests(numHosts);
+  for (unsigned t = 0; t < threadRequests.size(); ++t) {
+    auto& local = *threadRequests.getRemote(t);
+    for (unsigned h = 0; h < local.size(); ++h) {
+      requests[h].insert(requests[h].end(), local[h].begin(), local[h].end());
+    }
+  }
+  galois::do_all(
+      galois::iterate(0u, numHosts),
+      [&](unsigned h) {
+        std::sort(requests[h].begin(), requests[h].end());
+        requests[h].erase(std::unique(requests[h].begin(), requests[h].end()),
+                          requests[h].end());
+      },
+      galois::no_stats(), galois::loopname("FetchDedup"));
+
+  // send the requests to the owners
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    galois::runtime::SendBuffer b;
+    galois::runtime::gSerialize(b, requests[x]);
+    net.sendTagged(x, galois::runtime::evilPhase, b);
+  }
+
+  auto answer = [&](const std::vector<uint64_t>& request,
+                    std::vector<ValTy>& reply) {
+    reply.resize(request.size());
+    galois::do_all(
+        galois::iterate((size_t)0, request.size()),
+        [&](size_t i) { reply[i] = ownerValue(graph.getLID(request[i])); },
+        galois::no_stats(), galois::loopname("FetchAnswer"));
+  };
+
+  std::vector<std::vector<ValTy>> replies(numHosts);
+  answer(requests[net.ID], replies[net.ID]);
+
+  // answer requests of other hosts
+  std::vector<std::vector<ValTy>> remoteReplies(numHosts);
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+    do {
+      p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+    } while (!p);
+    std::vector<uint64_t> remoteRequest;
+    galois::runtime::gDeserialize(p->second, remoteRequest);
+    answer(remoteRequest, remoteReplies[p->first]);
+  }
+  incrementEvilPhase();
+
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    galois::runtime::SendBuffer b;
+    galois::runtime::gSerialize(b, remoteReplies[x]);
+    net.sendTagged(x, galois::runtime::evilPhase, b);
+  }
+
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+    do {
+      p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+    } while (!p);
+    galois::runtime::gDeserialize(p->second, replies[p->first]);
+  }
+  incrementEvilPhase();
+
+  std::vector<ValTy> values(gids.size());
+  galois::do_all(
+      galois::iterate((size_t)0, gids.size()),
+      [&](size_t i) {
+        uint64_t gid = gids[i];
+        if (gid == UNASSIGNED) {
+          values[i] = defaultValue;
+          return;
+        }
+        unsigned h   = graph.getHostID(gid);
+        auto pos     = std::lower_bound(requests[h].begin(), requests[h].end(),
+                                    gid);
+        assert(pos != requests[h].end() && *pos == gid);
+        values[i] = replies[h][pos - requests[h].begin()];
+      },
+      galois::no_stats(), galois::loopname("FetchScatter"));
+
+  return values;
+}
+
+/******************************************************************************/
+/* Community bookkeeping */
+/******************************************************************************/
+
+/**
+ * Recomputes the total weighted degree and size of every community.
+ *
+ * Masters send their contribution to the host that owns the community (the
+ * master of the node whose global ID is the community ID), get back the
+ * totals of their own community, and the totals are then broadcast to the
+ * mirrors so that neighbors can evaluate a move into the community.
+ */
+template <typename GraphTy>
+void updateCommunityTotals(
+    GraphTy& graph, galois::graphs::GluonSubstrate<GraphTy>& substrate) {
+  auto& net               = galois::runtime::getSystemNetworkInterface();
+  const unsigned numHosts = net.Num;
+  const auto& masters     = graph.masterNodesRange();
+
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        auto& n_data           = graph.getData(n);
+        n_data.total_degree_wt = 0;
+        n_data.total_size      = 0;
+      },
+      galois::no_stats(), galois::loopname("ResetCommunityTotals"));
+
+  // aggregate the contributions of the local masters per community
+  using Contribution = std::pair<uint64_t, uint64_t>; // degree wt, size
+  galois::substrate::PerThreadStorage<
+      std::unordered_map<uint64_t, Contribution>>
+      threadContributions;
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        auto& n_data = graph.getData(n);
+        auto& c      = (*threadContributions.getLocal())[n_data.curr_comm_ass];
+        c.first += n_data.degree_wt;
+        c.second += 1;
+      },
+      galois::steal(), galois::no_stats(),
+      galois::loopname("AggregateCommunityTotals"));
+
+  std::vector<std::vector<uint64_t>> comms(numHosts);
+  std::vector<std::vector<uint64_t>> degreeWts(numHosts);
+  std::vector<std::vector<uint64_t>> sizes(numHosts);
+  {
+    std::unordered_map<uint64_t, Contribution> merged;
+    for (unsigned t = 0; t < threadContributions.size(); ++t) {
+      for (auto& c : *threadContributions.getRemote(t)) {
+        auto& m = merged[c.first];
+        m.first += c.second.first;
+        m.second += c.second.second;
+      }
+    }
+    for (auto& c : merged) {
+      unsigned h = graph.getHostID(c.first);
+      comms[h].push_back(c.first);
+      degreeWts[h].push_back(c.second.first);
+      sizes[h].push_back(c.second.second);
+    }
+  }
+
+  auto apply = [&](const std::vector<uint64_t>& c,
+                   const std::vector<uint64_t>& w,
+                   const std::vector<uint64_t>& s) {
+    galois::do_all(
+        galois::iterate((size_t)0, c.size()),
+        [&](size_t i) {
+          auto& owner = graph.getData(graph.getLID(c[i]));
+          owner.total_degree_wt += w[i];
+          owner.total_size += s[i];
+        },
+        galois::no_stats(), galois::loopname("ApplyCommunityTotals"));
+  };
+
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    galois::runtime::SendBuffer b;
+    galois::runtime::gSerialize(b, comms[x], degreeWts[x], sizes[x]);
+    net.sendTagged(x, galois::runtime::evilPhase, b);
+  }
+
+  apply(comms[net.ID], degreeWts[net.ID], sizes[net.ID]);
+
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+    do {
+      p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+    } while (!p);
+    std::vector<uint64_t> c, w, s;
+    galois::runtime::gDeserialize(p->second, c, w, s);
+    apply(c, w, s);
+  }
+  incrementEvilPhase();
+
+  // every master gets the totals of its own community
+  std::vector<uint64_t> myComms(graph.numMasters());
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        myComms[n - *masters.begin()] = graph.getData(n).curr_comm_ass;
+      },
+      galois::no_stats(), galois::loopname("CollectCommunities"));
+
+  auto totals = fetchFromOwners(
+      graph, myComms,
+      [&](GNode owner) {
+        auto& o_data = graph.getData(owner);
+        return Contribution(o_data.total_degree_wt.load(),
+                            o_data.total_size.load());
+      },
+      Contribution(0, 0));
+
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        auto& n_data          = graph.getData(n);
+        auto& t               = totals[n - *masters.begin()];
+        n_data.comm_degree_wt = t.first;
+        n_data.comm_size      = t.second;
+      },
+      galois::no_stats(), galois::loopname("SetCommunityTotals"));
+
+  substrate.template sync<writeSource, readDestination,
+                          Reduce_set_comm_degree_wt>("CommunityTotals");
+  substrate.template sync<writeSource, readDestination, Reduce_set_comm_size>(
+      "CommunityTotals");
+}
+
+/**
+ * Computes the modularity of the current community assignment.
+ */
+template <typename GraphTy>
+double calModularity(GraphTy& graph, double constant_for_second_term,
+                     double& e_xx, double& a2_x) {
+  galois::DGAccumulator<double> acc_e_xx;
+  galois::DGAccumulator<double> acc_a2_x;
+  acc_e_xx.reset();
+  acc_a2_x.reset();
+
+  galois::do_all(
+      galois::iterate(graph.masterNodesRange()),
+      [&](GNode n) {
+        auto& n_data         = graph.getData(n);
+        uint64_t internal_wt = 0;
+        for (auto ii : graph.edges(n)) {
+          if (graph.getData(graph.getEdgeDst(ii)).curr_comm_ass ==
+              n_data.curr_comm_ass) {
+            internal_wt += edgeWeight(graph, ii);
+          }
+        }
+        acc_e_xx += internal_wt;
+        // owner side: community whose ID is this node's global ID
+        double a_x = n_data.total_degree_wt;
+        acc_a2_x += a_x * (a_x * constant_for_second_term);
+      },
+      galois::steal(), galois::no_stats(),
+      galois::loopname("CalModularity"));
+
+  e_xx = acc_e_xx.reduce();
+  a2_x = acc_a2_x.reduce();
+
+  return e_xx * constant_for_second_term - a2_x * constant_for_second_term;
+}
+
+/******************************************************************************/
+/* Algorithm structures */
+/******************************************************************************/
+
+/**
+ * Each master picks the neighboring community with the largest modularity
+ * gain, using the community assignments and community totals of its
+ * neighbors that were synchronized at the end of the previous round. All
+ * moves of a round are applied together.
+ *
+ * @returns number of nodes that changed community
+ */
+template <typename GraphTy>
+uint64_t findBestCommunities(GraphTy& graph, double constant) {
+  struct Candidate {
+    EdgeTy edge_wt        = 0;
+    uint64_t comm_deg_wt  = 0;
+    uint64_t comm_size    = 0;
+  };
+  galois::substrate::PerThreadStorage<std::unordered_map<uint64_t, Candidate>>
+      threadCounters;
+  galois::DGAccumulator<uint64_t> moved;
+  moved.reset();
+
+  galois::do_all(
+      galois::iterate(graph.masterNodesRange()),
+      [&](GNode n) {
+        auto& n_data         = graph.getData(n);
+        n_data.prev_comm_ass = n_data.curr_comm_ass;
+        n_data.next_comm_ass = n_data.curr_comm_ass;
+
+        if (graph.edge_begin(n) == graph.edge_end(n)) {
+          return;
+        }
+
+        auto& counter = *threadCounters.getLocal();
+        counter.clear();
+        uint64_t sc   = n_data.curr_comm_ass;
+        auto& own     = counter[sc];
+        own.comm_deg_wt = n_data.comm_degree_wt;
+        own.comm_size   = n_data.comm_size;
+
+        EdgeTy self_loop_wt = 0;
+        for (auto ii : graph.edges(n)) {
+          GNode dst     = graph.getEdgeDst(ii);
+          EdgeTy edge_wt = edgeWeight(graph, ii);
+          if (dst == n) {
+            self_loop_wt += edge_wt;
+          }
+          auto& d_data = graph.getData(dst);
+          auto& c      = counter[d_data.curr_comm_ass];
+          c.edge_wt += edge_wt;
+          c.comm_deg_wt = d_data.comm_degree_wt;
+          c.comm_size   = d_data.comm_size;
+        }
+
+        uint64_t max_index = sc;
+        double max_gain    = 0;
+        double degree_wt   = n_data.degree_wt;
+        double eix         = (double)counter[sc].edge_wt - self_loop_wt;
+        double ax          = (double)n_data.comm_degree_wt - degree_wt;
+        for (auto& c : counter) {
+          if (c.first == sc)
+            continue;
+          double eiy      = c.second.edge_wt;
+          double ay       = c.second.comm_deg_wt;
+          double cur_gain = 2 * constant * (eiy - eix) +
+                            2 * degree_wt * ((ax - ay) * constant * constant);
+          if ((cur_gain > max_gain) ||
+              ((cur_gain == max_gain) && (cur_gain != 0) &&
+               (c.first < max_index))) {
+            max_gain  = cur_gain;
+            max_index = c.first;
+          }
+        }
+
+        // avoid two singletons swapping into each other's community
+        if (max_index != sc && counter[max_index].comm_size == 1 &&
+            n_data.comm_size == 1 && max_index > sc) {
+          max_index = sc;
+        }
+
+        if (max_index != sc) {
+          n_data.next_comm_ass = max_index;
+          moved += 1;
+        }
+      },
+      galois::steal(), galois::no_stats(),
+      galois::loopname("FindBestCommunities"));
+
+  galois::do_all(
+      galois::iterate(graph.masterNodesRange()),
+      [&](GNode n) {
+        auto& n_data         = graph.getData(n);
+        n_data.curr_comm_ass = n_data.next_comm_ass;
+      },
+      galois::no_stats(), galois::loopname("ApplyMoves"));
+
+  return moved.reduce();
+}
+
+/**
+ * Puts every master in its own community and computes weighted degrees.
+ *
+ * @returns total edge weight of the graph (2m)
+ */
+template <typename GraphTy>
+uint64_t initializeCommunities(
+    GraphTy& graph, galois::graphs::GluonSubstrate<GraphTy>& substrate) {
+  galois::DGAccumulator<uint64_t> total_wt;
+  total_wt.reset();
+  galois::do_all(
+      galois::iterate(graph.masterNodesRange()),
+      [&](GNode n) {
+        auto& n_data         = graph.getData(n);
+        n_data.curr_comm_ass = graph.getGID(n);
+        n_data.prev_comm_ass = graph.getGID(n);
+        EdgeTy degree_wt     = 0;
+        for (auto ii : graph.edges(n)) {
+          degree_wt += edgeWeight(graph, ii);
+        }
+        n_data.degree_wt = degree_wt;
+        total_wt += degree_wt;
+      },
+      galois::steal(), galois::no_stats(),
+      galois::loopname("InitializeCommunities"));
+
+  substrate.template sync<writeSource, readDestination,
+                          Reduce_set_curr_comm_ass>("InitializeCommunities");
+  updateCommunityTotals(graph, substrate);
+
+  return total_wt.reduce();
+}
+
+/**
+ * Runs one phase of Louvain (rounds of local moves until the modularity gain
+ * drops below c_threshold) on the given graph.
+ *
+ * @returns modularity at the end of the phase
+ */
+template <typename GraphTy>
+double louvainPhase(GraphTy& graph,
+                    galois::graphs::GluonSubstrate<GraphTy>& substrate,
+                    double lower, uint32_t& iter) {
+  auto& net = galois::runtime::getSystemNetworkInterface();
+
+  /* Compute the total weight (2m) and 1/2m terms */
+  double constant_for_second_term =
+      1.0 / (double)initializeCommunities(graph, substrate);
+
+  double prev_mod = lower;
+  double curr_mod = -1;
+
+  if (net.ID == 0) {
+    galois::gPrint("========================================================"
+                   "================================\n");
+    galois::gPrint("Itr      Explore_xx            A_x2           Prev-Mod   "
+                   "        Curr-Mod          Moved\n");
+    galois::gPrint("========================================================"
+                   "================================\n");
+  }
+
+  while (true) {
+    iter++;
+    substrate.set_num_round(iter);
+
+    uint64_t moved = findBestCommunities(graph, constant_for_second_term);
+    substrate.template sync<writeSource, readDestination,
+                            Reduce_set_curr_comm_ass>("LouvainRound");
+    updateCommunityTotals(graph, substrate);
+
+    double e_xx = 0;
+    double a2_x = 0;
+    curr_mod = calModularity(graph, constant_for_second_term, e_xx, a2_x);
+
+    if (net.ID == 0) {
+      galois::gPrint(iter, "        ", e_xx, "        ", a2_x, "        ",
+                     prev_mod, "       ", curr_mod, "       ", moved, "\n");
+    }
+
+    if (moved == 0 || (curr_mod - prev_mod) < c_threshold) {
+      if (curr_mod < prev_mod) {
+        // the simultaneous moves of this round made things worse: undo them
+        galois::do_all(
+            galois::iterate(graph.masterNodesRange()),
+            [&](GNode n) {
+              auto& n_data         = graph.getData(n);
+              n_data.curr_comm_ass = n_data.prev_comm_ass;
+            },
+            galois::no_stats(), galois::loopname("RevertMoves"));
+        substrate.template sync<writeSource, readDestination,
+                                Reduce_set_curr_comm_ass>("RevertMoves");
+        updateCommunityTotals(graph, substrate);
+        curr_mod = prev_mod;
+      }
+      prev_mod = curr_mod;
+      break;
+    }
+    prev_mod = curr_mod;
+  }
+
+  return prev_mod;
+}
+
+/**
+ * Renumbers the non-empty communities contiguously; the new ID of each
+ * master's community is stored in coarse_id and broadcast to mirrors.
+ *
+ * @returns number of non-empty communities
+ */
+template <typename GraphTy>
+uint64_t
+renumberClustersContiguously(GraphTy& graph,
+                             galois::graphs::GluonSubstrate<GraphTy>& substrate) {
+  auto& net           = galois::runtime::getSystemNetworkInterface();
+  const auto& masters = graph.masterNodesRange();
+
+  // owners number the communities they own
+  std::vector<uint64_t> newIDs(graph.numMasters(), UNASSIGNED);
+  uint64_t numOwned = 0;
+  for (GNode n : masters) {
+    if (graph.getData(n).total_size > 0) {
+      newIDs[n - *masters.begin()] = numOwned++;
+    }
+  }
+
+  auto counts      = allGather(numOwned);
+  uint64_t offset  = 0;
+  uint64_t numComm = 0;
+  for (unsigned h = 0; h < counts.size(); ++h) {
+    if (h < net.ID)
+      offset += counts[h];
+    numComm += counts[h];
+  }
+
+  std::vector<uint64_t> myComms(graph.numMasters());
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        myComms[n - *masters.begin()] = graph.getData(n).curr_comm_ass;
+      },
+      galois::no_stats(), galois::loopname("CollectCommunities"));
+
+  auto ids = fetchFromOwners(
+      graph, myComms,
+      [&](GNode owner) {
+        assert(newIDs[owner - *masters.begin()] != UNASSIGNED);
+        return newIDs[owner - *masters.begin()] + offset;
+      },
+      UNASSIGNED);
+
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) { graph.getData(n).coarse_id = ids[n - *masters.begin()]; },
+      galois::no_stats(), galois::loopname("SetCoarseID"));
+
+  substrate.template sync<writeSource, readDestination, Reduce_set_coarse_id>(
+      "Renumber");
+
+  return numComm;
+}
+
+//! Writes all of buf to fd at the given offset.
+void writeFully(int fd, const void* buf, size_t bytes, off_t offset) {
+  const char* b = static_cast<const char*>(buf);
+  while (bytes > 0) {
+    ssize_t written = pwrite(fd, b, bytes, offset);
+    if (written < 0) {
+      GALOIS_SYS_DIE("failed writing coarsened graph");
+    }
+    b += written;
+    bytes -= written;
+    offset += written;
+  }
+}
+
+/**
+ * Builds the coarsened graph of the next phase (one node per community, edge
+ * weights summed over the edges between communities) and writes it as a
+ * Galois binary graph so that it can be re-partitioned with CuSP.
+ *
+ * Each host merges the coarse edges whose source falls in its block of
+ * coarse nodes and writes that block of the file; the file offsets of the
+ * blocks are known after exchanging the edge counts.
+ */
+template <typename GraphTy>
+void writeCoarseGraph(GraphTy& graph, uint64_t numCoarseNodes,
+                      const std::string& filename) {
+  auto& net               = galois::runtime::getSystemNetworkInterface();
+  const unsigned numHosts = net.Num;
+
+  // edges are keyed by (src << 32) | dst and the gr stores 32-bit
+  // destinations
+  if (numCoarseNodes > std::numeric_limits<uint32_t>::max()) {
+    GALOIS_DIE("coarsened graph has ", numCoarseNodes,
+               " nodes; at most 2^32 - 1 are supported");
+  }
+
+  std::vector<uint64_t> blockStarts(numHosts + 1);
+  for (unsigned h = 0; h < numHosts; ++h) {
+    blockStarts[h] =
+        galois::block_range((uint64_t)0, numCoarseNodes, h, numHosts).first;
+  }
+  blockStarts[numHosts] = numCoarseNodes;
+  auto blockOwner       = [&](uint64_t node) {
+    return (unsigned)(std::upper_bound(blockStarts.begin(),
+                                       blockStarts.end(), node) -
+                      blockStarts.begin() - 1);
+  };
+
+  // merge the edges between the same communities locally first
+  galois::substrate::PerThreadStorage<std::unordered_map<uint64_t, EdgeTy>>
+      threadEdges;
+  galois::do_all(
+      galois::iterate(graph.masterNodesRange()),
+      [&](GNode n) {
+        auto& local  = *threadEdges.getLocal();
+        uint64_t src = graph.getData(n).coarse_id;
+        for (auto ii : graph.edges(n)) {
+          uint64_t dst = graph.getData(graph.getEdgeDst(ii)).coarse_id;
+          local[(src << 32) | dst] += edgeWeight(graph, ii);
+        }
+      },
+      galois::steal(), galois::no_stats(),
+      galois::loopname("CoarsenEdges"));
+
+  std::vector<std::vector<uint64_t>> keys(numHosts);
+  std::vector<std::vector<EdgeTy>> weights(numHosts);
+  for (unsigned t = 0; t < threadEdges.size(); ++t) {
+    for (auto& e : *threadEdges.getRemote(t)) {
+      unsigned h = blockOwner(e.first >> 32);
+      keys[h].push_back(e.first);
+      weights[h].push_back(e.second);
+    }
+    threadEdges.getRemote(t)->clear();
+  }
+
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    galois::runtime::SendBuffer b;
+    galois::runtime::gSerialize(b, keys[x], weights[x]);
+    net.sendTagged(x, galois::runtime::evilPhase, b);
+  }
+
+  std::vector<std::pair<uint64_t, EdgeTy>> edges;
+  for (size_t i = 0; i < keys[net.ID].size(); ++i) {
+    edges.emplace_back(keys[net.ID][i], weights[net.ID][i]);
+  }
+  for (unsigned x = 0; x < numHosts; ++x) {
+    if (x == net.ID)
+      continue;
+    decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+    do {
+      p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+    } while (!p);
+    std::vector<uint64_t> k;
+    std::vector<EdgeTy> w;
+    galois::runtime::gDeserialize(p->second, k, w);
+    for (size_t i = 0; i < k.size(); ++i) {
+      edges.emplace_back(k[i], w[i]);
+    }
+  }
+  incrementEvilPhase();
+
+  galois::ParallelSTL::sort(edges.begin(), edges.end());
+
+  // build the CSR of this host's block of coarse nodes
+  uint64_t blockStart = blockStarts[net.ID];
+  uint64_t blockSize  = blockStarts[net.ID + 1] - blockStart;
+  std::vector<uint64_t> outIndex(blockSize, 0);
+  std::vector<uint32_t> dests;
+  std::vector<EdgeTy> edgeData;
+  dests.reserve(edges.size());
+  edgeData.reserve(edges.size());
+  for (size_t i = 0; i < edges.size(); ++i) {
+    if (!dests.empty() && edges[i].first == edges[i - 1].first) {
+      edgeData.back() += edges[i].second;
+      continue;
+    }
+    uint64_t src = edges[i].first >> 32;
+    assert(src >= blockStart && src < blockStart + blockSize);
+    outIndex[src - blockStart]++;
+    dests.push_back((uint32_t)(edges[i].first & 0xFFFFFFFF));
+    edgeData.push_back(edges[i].second);
+  }
+  std::vector<std::pair<uint64_t, EdgeTy>>().swap(edges);
+
+  auto edgeCounts    = allGather(dests.size());
+  uint64_t edgeStart = 0;
+  uint64_t numEdges  = 0;
+  for (unsigned h = 0; h < numHosts; ++h) {
+    if (h < net.ID)
+      edgeStart += edgeCounts[h];
+    numEdges += edgeCounts[h];
+  }
+
+  uint64_t running = edgeStart;
+  for (auto& count : outIndex) {
+    running += count;
+    count = running;
+  }
+
+  // version 1 Galois binary graph
+  if (net.ID == 0) {
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+      GALOIS_SYS_DIE("failed creating ", filename);
+    }
+    uint64_t header[4] = {1, sizeof(EdgeTy), numCoarseNodes, numEdges};
+    writeFully(fd, header, sizeof(header), 0);
+    close(fd);
+  }
+  galois::runtime::getHostBarrier().wait();
+
+  int fd = open(filename.c_str(), O_WRONLY);
+  if (fd == -1) {
+    GALOIS_SYS_DIE("failed opening ", filename);
+  }
+  off_t outIndexOffset = (4 + blockStart) * sizeof(uint64_t);
+  off_t destOffset =
+      (4 + numCoarseNodes) * sizeof(uint64_t) + edgeStart * sizeof(uint32_t);
+  off_t edgeDataOffset = (4 + numCoarseNodes) * sizeof(uint64_t) +
+                         numEdges * sizeof(uint32_t) +
+                         ((numEdges % 2) ? sizeof(uint32_t) : 0) +
+                         edgeStart * sizeof(EdgeTy);
+  writeFully(fd, outIndex.data(), outIndex.size() * sizeof(uint64_t),
+             outIndexOffset);
+  writeFully(fd, dests.data(), dests.size() * sizeof(uint32_t), destOffset);
+  writeFully(fd, edgeData.data(), edgeData.size() * sizeof(EdgeTy),
+             edgeDataOffset);
+  close(fd);
+
+  galois::runtime::getHostBarrier().wait();
+
+  if (net.ID == 0) {
+    galois::gPrint("Coarsened graph: ", numCoarseNodes, " nodes, ", numEdges,
+                   " edges\n");
+  }
+}
+
+/**
+ * Runs one Louvain phase on graph, renumbers the communities, and maps the
+ * nodes of the original graph to their new communities.
+ *
+ * @returns file name of the coarsened graph to use for the next phase, or an
+ * empty string if the algorithm has converged
+ */
+template <typename GraphTy>
+std::string runPhase(GraphTy& graph,
+                     galois::graphs::GluonSubstrate<GraphTy>& substrate,
+                     uint32_t phase, double& prev_mod, double& curr_mod,
+                     uint32_t& iter, std::vector<uint64_t>& clusters_orig) {
+  auto& net = galois::runtime::getSystemNetworkInterface();
+  if (net.ID == 0) {
+    galois::gPrint("Starting Phase : ", phase, "\n");
+    galois::gPrint("Graph size : ", graph.globalSize(), "\n");
+  }
+
+  galois::StatTimer phaseTimer(("Timer_Phase_" + std::to_string(phase)).c_str(),
+                               REGION_NAME);
+  phaseTimer.start();
+  if (graph.globalSize() > min_graph_size) {
+    curr_mod = louvainPhase(graph, substrate, curr_mod, iter);
+  } else {
+    // too small to be worth clustering further: keep every node in its own
+    // community so that the mapping below stays valid
+    initializeCommunities(graph, substrate);
+  }
+
+  uint64_t num_unique_clusters = renumberClustersContiguously(graph, substrate);
+  clusters_orig                = fetchFromOwners(
+      graph, clusters_orig,
+      [&](GNode owner) { return graph.getData(owner).coarse_id; }, UNASSIGNED);
+  phaseTimer.stop();
+
+  if (net.ID == 0) {
+    galois::gPrint("Number of unique clusters (renumber): ",
+                   num_unique_clusters, "\n");
+    galois::gPrint("Prev_mod main: ", prev_mod, "\n");
+  }
+
+  if (iter < max_iter && (curr_mod - prev_mod) > threshold &&
+      num_unique_clusters < graph.globalSize()) {
+    // pid of host 0 keeps the files of concurrent jobs apart
+    auto pids            = allGather(getpid());
+    std::string filename = coarseGraphDir + "/louvain_coarse_" +
+                           std::to_string(pids[0]) + "_" +
+                           std::to_string(phase) + ".gr";
+
+    galois::StatTimer coarsenTimer(
+        ("Timer_Coarsen_" + std::to_string(phase)).c_str(), REGION_NAME);
+    coarsenTimer.start();
+    writeCoarseGraph(graph, num_unique_clusters, filename);
+    coarsenTimer.stop();
+    prev_mod = curr_mod;
+    return filename;
+  }
+  return "";
+}
+
+/**
+ * Multi-phase Louvain: after every phase the graph is coarsened to one node
+ * per community and re-partitioned among the hosts with CuSP.
+ *
+ * @param clusters_orig on return, holds the community of each master of the
+ * input graph (in the order of the master nodes range)
+ * @returns modularity reported by the last phase
+ */
+double runMultiPhaseLouvainAlgorithm(Graph& graph,
+                                     std::vector<uint64_t>& clusters_orig) {
+  const auto& masters = graph.masterNodesRange();
+  clusters_orig.resize(graph.numMasters());
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) { clusters_orig[n - *masters.begin()] = graph.getGID(n); },
+      galois::no_stats(), galois::loopname("InitializeClusters"));
+
+  double prev_mod = -1; // Previous modularity
+  double curr_mod = -1; // Current modularity
+  uint32_t phase  = 1;
+  uint32_t iter   = 0;
+
+  std::string nextGraph = runPhase(graph, *syncSubstrate, phase, prev_mod,
+                                   curr_mod, iter, clusters_orig);
+
+  std::unique_ptr<CoarseGraph> coarseGraph;
+  std::unique_ptr<galois::graphs::GluonSubstrate<CoarseGraph>> coarseSubstrate;
+  const auto& net = galois::runtime::getSystemNetworkInterface();
+  while (!nextGraph.empty()) {
+    phase++;
+    galois::StatTimer partitionTimer(
+        ("Timer_Repartition_" + std::to_string(phase)).c_str(), REGION_NAME);
+    partitionTimer.start();
+    coarseSubstrate.reset();
+    coarseGraph.reset();
+    coarseGraph = galois::cuspPartitionGraph<NoCommunication, NodeData, EdgeTy>(
+        nextGraph, galois::CUSP_CSR, galois::CUSP_CSR, true);
+    coarseSubstrate =
+        std::make_unique<galois::graphs::GluonSubstrate<CoarseGraph>>(
+            *coarseGraph, net.ID, net.Num, coarseGraph->isTransposed(),
+            coarseGraph->cartesianGrid(), partitionAgnostic, commMetadata);
+    partitionTimer.stop();
+
+    galois::runtime::getHostBarrier().wait();
+    if (net.ID == 0) {
+      unlink(nextGraph.c_str());
+    }
+
+    nextGraph = runPhase(*coarseGraph, *coarseSubstrate, phase, prev_mod,
+                         curr_mod, iter, clusters_orig);
+  }
+
+  if (net.ID == 0) {
+    galois::gPrint("Phases : ", phase, "\n");
+    galois::gPrint("Iter : ", iter, "\n");
+  }
+  galois::runtime::reportStat_Single(REGION_NAME, "NumPhases", phase);
+  galois::runtime::reportStat_Single(REGION_NAME, "NumIterations", iter);
+  return curr_mod;
+}
+
+/******************************************************************************/
+/* Sanity check operators */
+/******************************************************************************/
+
+/**
+ * Recomputes the modularity of the final assignment on the input graph so
+ * that it can be compared with the shared-memory louvain-clustering-cpu
+ * ("FINAL MOD").
+ */
+double checkModularity(Graph& graph, std::vector<uint64_t>& clusters_orig) {
+  const auto& masters = graph.masterNodesRange();
+  uint64_t total_wt   = initializeCommunities(graph, *syncSubstrate);
+
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        graph.getData(n).curr_comm_ass = clusters_orig[n - *masters.begin()];
+      },
+      galois::no_stats(), galois::loopname("CheckModularity"));
+  syncSubstrate->sync<writeSource, readDestination, Reduce_set_curr_comm_ass>(
+      "CheckModularity");
+  updateCommunityTotals(graph, *syncSubstrate);
+
+  double e_xx = 0;
+  double a2_x = 0;
+  double mod  = calModularity(graph, 1.0 / (double)total_wt, e_xx, a2_x);
+
+  galois::DGAccumulator<uint64_t> num_clusters;
+  num_clusters.reset();
+  galois::do_all(
+      galois::iterate(masters),
+      [&](GNode n) {
+        if (graph.getData(n).total_size > 0) {
+          num_clusters += 1;
+        }
+      },
+      galois::no_stats(), galois::loopname("CountClusters"));
+  uint64_t clusters = num_clusters.reduce();
+
+  if (galois::runtime::getSystemNetworkInterface().ID == 0) {
+    galois::gPrint("Number of unique clusters (renumber): ", clusters, "\n");
+    galois::gPrint("FINAL MOD: ", mod, "\n");
+  }
+  return mod;
+}
+
+/******************************************************************************/
+/* Main */
+/******************************************************************************/
+
+constexpr static const char* const name = "Louvain Clustering - Distributed";
+constexpr static const char* const desc =
+    "Cluster nodes of the graph using Louvain Clustering on Distributed "
+    "Galois.";
+constexpr static const char* const url = nullptr;
+
+int main(int argc, char** argv) {
+  galois::DistMemSys G;
+  DistBenchStart(argc, argv, name, desc, url);
+
+  auto& net = galois::runtime::getSystemNetworkInterface();
+
+  // the default /tmp is local to each machine, so the hosts would not see
+  // the same coarsened graph
+  if (net.Num > 1 && !coarseGraphDir.getNumOccurrences()) {
+    GALOIS_DIE("-coarseGraphDir must name a directory shared by all hosts "
+               "when running on more than one host");
+  }
+
+  if (net.ID == 0) {
+    galois::runtime::reportParam(REGION_NAME, "Max Iterations", max_iter);
+    galois::runtime::reportParam(REGION_NAME, "Phase Threshold", c_threshold);
+    galois::runtime::reportParam(REGION_NAME, "Total Threshold", threshold);
+  }
+
+  galois::StatTimer StatTimer_total("TimerTotal", REGION_NAME);
+
+  StatTimer_total.start();
+
+  setSyncPattern(writeSource, readDestination);
+  std::unique_ptr<Graph> hg;
+  std::tie(hg, syncSubstrate) =
+      symmetricDistGraphInitialization<NodeData, void>();
+
+  if (hg->is_vertex_cut()) {
+    GALOIS_DIE("Louvain clustering needs every edge of a node on its master; "
+               "please use an edge-cut partitioning policy (e.g. "
+               "-partition=oec)");
+  }
+
+  std::vector<uint64_t> clusters_orig;
+
+  for (auto run = 0; run < numRuns; ++run) {
+    galois::gPrint("[", net.ID, "] Louvain::go run ", run, " called\n");
+    std::string timer_str("Timer_" + std::to_string(run));
+    galois::StatTimer StatTimer_main(timer_str.c_str(), REGION_NAME);
+
+    StatTimer_main.start();
+    runMultiPhaseLouvainAlgorithm(*hg, clusters_orig);
+    StatTimer_main.stop();
+
+    double mod = checkModularity(*hg, clusters_orig);
+    if (net.ID == 0) {
+      galois::runtime::reportStat_Single(
+          REGION_NAME, "Modularity_" + std::to_string(run), mod);
+    }
+
+    if ((run + 1) != numRuns) {
+      (*syncSubstrate).set_num_run(run + 1);
+      galois::runtime::getHostBarrier().wait();
+    }
+  }
+
+  StatTimer_total.stop();
+
+  if (output) {
+    auto globalIDs = hg->getMasterGlobalIDs();
+    assert(clusters_orig.size() == globalIDs.size());
+
+    writeOutput(outputLocation, "community", clusters_orig.data(),
+                clusters_orig.size(), globalIDs.data());
+  }
+
+  return 0;
+}
@@ -64,7 +64,7 @@ struct NodeData {
   uint32_t comp_current;
 };
 
-galois::DynamicBitSet bitset_comp_current;
+galois::HierarchicalBitSet bitset_comp_current;
 
 typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
@@ -304,6 +304,7 @@ int main(int argc, char** argv) {
 
   StatTimer_total.start();
 
+  setSyncPattern(writeSource, readDestination);
   std::unique_ptr<Graph> hg;
 #ifdef GALOIS_ENABLE_GPU
   std::tie(hg, syncSubstrate) =
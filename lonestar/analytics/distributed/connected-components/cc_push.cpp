@@ -65,7 +65,7 @@ struct NodeData {
   uint32_t comp_old;
 };
 
-galois::DynamicBitSet bitset_comp_current;
+galois::HierarchicalBitSet bitset_comp_current;
 
 typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
@@ -203,15 +203,28 @@ struct ConnectedComp {
         abort();
 #endif
       } else if (personality == CPU) {
-        galois::do_all(
-            galois::iterate(nodesWithEdges), ConnectedComp(&_graph, dga),
-            galois::no_stats(), galois::steal(),
-            galois::loopname(
-                syncSubstrate->get_run_identifier("ConnectedComp").c_str()));
+        auto compute = [&](auto begin, auto end) {
+          galois::do_all(
+              galois::iterate(begin, end), ConnectedComp(&_graph, dga),
+              galois::no_stats(), galois::steal(),
+              galois::loopname(
+                  syncSubstrate->get_run_identifier("ConnectedComp").c_str()));
+        };
+        if (overlapComm) {
+          syncSubstrate->overlapSync<writeDestination, readSource,
+                                     Reduce_min_comp_current,
+                                     Bitset_comp_current, async>(
+              "ConnectedComp", compute);
+        } else {
+          compute(nodesWithEdges.begin(), nodesWithEdges.end());
+        }
       }
 
-      syncSubstrate->sync<writeDestination, readSource, Reduce_min_comp_current,
-                          Bitset_comp_current, async>("ConnectedComp");
+      if (personality != CPU || !overlapComm) {
+        syncSubstrate->sync<writeDestination, readSource,
+                            Reduce_min_comp_current, Bitset_comp_current,
+                            async>("ConnectedComp");
+      }
 
       galois::runtime::reportStat_Tsum(
           REGION_NAME, "NumWorkItems_" + (syncSubstrate->get_run_identifier()),
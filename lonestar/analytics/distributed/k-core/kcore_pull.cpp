@@ -77,8 +77,8 @@ typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
 
 // bitset for tracking updates
-galois::DynamicBitSet bitset_current_degree;
-galois::DynamicBitSet bitset_trim;
+galois::HierarchicalBitSet bitset_current_degree;
+galois::HierarchicalBitSet bitset_trim;
 
 std::unique_ptr<galois::graphs::GluonSubstrate<Graph>> syncSubstrate;
 
@@ -457,6 +457,7 @@ int main(int argc, char** argv) {
 
   StatTimer_total.start();
 
+  setSyncPattern(writeSource, readAny);
   std::unique_ptr<Graph> h_graph;
 #ifdef GALOIS_ENABLE_GPU
   std::tie(h_graph, syncSubstrate) =
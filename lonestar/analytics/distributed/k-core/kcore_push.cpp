@@ -76,8 +76,8 @@ typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
 
 // bitset for tracking updates
-galois::DynamicBitSet bitset_current_degree;
-galois::DynamicBitSet bitset_trim;
+galois::HierarchicalBitSet bitset_current_degree;
+galois::HierarchicalBitSet bitset_trim;
 
 std::unique_ptr<galois::graphs::GluonSubstrate<Graph>> syncSubstrate;
 
@@ -314,6 +314,7 @@ int main(int argc, char** argv) {
   galois::StatTimer StatTimer_total("TimerTotal", REGION_NAME);
 
   StatTimer_total.start();
+  setSyncPattern(writeAny, readAny);
   std::unique_ptr<Graph> hg;
 #ifdef GALOIS_ENABLE_GPU
   std::tie(hg, syncSubstrate) =
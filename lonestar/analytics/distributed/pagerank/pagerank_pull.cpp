@@ -73,8 +73,8 @@ struct NodeData {
   float delta;
 };
 
-galois::DynamicBitSet bitset_residual;
-galois::DynamicBitSet bitset_nout;
+galois::HierarchicalBitSet bitset_residual;
+galois::HierarchicalBitSet bitset_nout;
 
 typedef galois::graphs::DistGraph<NodeData, void> Graph;
 typedef typename Graph::GraphNode GNode;
@@ -68,7 +68,7 @@ struct NodeData {
   uint32_t dist_current;
 };
 
-galois::DynamicBitSet bitset_dist_current;
+galois::HierarchicalBitSet bitset_dist_current;
 
 typedef galois::graphs::DistGraph<NodeData, unsigned int> Graph;
 typedef typename Graph::GraphNode GNode;
@@ -75,7 +75,7 @@ struct NodeData {
   uint32_t dist_old;
 };
 
-galois::DynamicBitSet bitset_dist_current;
+galois::HierarchicalBitSet bitset_dist_current;
 
 typedef galois::graphs::DistGraph<NodeData, unsigned int> Graph;
 typedef typename Graph::GraphNode GNode;
@@ -240,15 +240,29 @@ struct SSSP {
         abort();
 #endif
       } else if (personality == CPU) {
-        galois::do_all(
-            galois::iterate(nodesWithEdges),
-            SSSP{priority, &_graph, dga, work_edges}, galois::no_stats(),
-            galois::loopname(syncSubstrate->get_run_identifier("SSSP").c_str()),
-            galois::steal());
+        auto compute = [&](auto begin, auto end) {
+          galois::do_all(
+              galois::iterate(begin, end),
+              SSSP{priority, &_graph, dga, work_edges}, galois::no_stats(),
+              galois::loopname(
+                  syncSubstrate->get_run_identifier("SSSP").c_str()),
+              galois::steal());
+        };
+        if (overlapComm) {
+          syncSubstrate->overlapSync<writeDestination, readSource,
+                                     Reduce_min_dist_current,
+                                     Bitset_dist_current, async>("SSSP",
+                                                                 compute);
+        } else {
+          compute(nodesWithEdges.begin(), nodesWithEdges.end());
+        }
       }
 
-      syncSubstrate->sync<writeDestination, readSource, Reduce_min_dist_current,
-                          Bitset_dist_current, async>("SSSP");
+      if (personality != CPU || !overlapComm) {
+        syncSubstrate->sync<writeDestination, readSource,
+                            Reduce_min_dist_current, Bitset_dist_current,
+                            async>("SSSP");
+      }
 
       galois::runtime::reportStat_Tsum(
           "SSSP", "NumWorkItems_" + (syncSubstrate->get_run_identifier()),
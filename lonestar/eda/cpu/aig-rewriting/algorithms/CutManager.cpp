@@ -640,6 +640,10 @@ void CutManager::printCutStatistics() {
   std::cout << "###########################################" << std::endl;
 }
 
+long int CutManager::getNumCuts() {
+  return nCuts.reduce() + this->aig.getNumInputs();
+}
+
 void CutManager::printRuntimes() {
 
   std::cout << std::endl << "#### Runtimes in microsecond ####" << std::endl;
@@ -150,6 +150,7 @@ public:
   void printNodeCuts(int nodeId, long int& counter);
   void printAllCuts();
   void printCutStatistics();
+  long int getNumCuts();
   void printRuntimes();
 
   aig::Aig& getAig();
@@ -0,0 +1,426 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "LevelCutManager.h"
+#include "galois/Galois.h"
+#include "galois/Bag.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+namespace algorithm {
+
+// Truth tables of the elementary variables over 64 bits
+static const uint64_t varTruth[LEVEL_CUT_MAX_TRUTH_LEAVES] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+
+// Swaps variables i < j of a truth table
+static inline uint64_t swapVars(uint64_t truth, int i, int j) {
+  uint64_t shift = (1ULL << j) - (1ULL << i);
+  uint64_t up    = varTruth[i] & ~varTruth[j];
+  uint64_t down  = ~varTruth[i] & varTruth[j];
+  return (truth & ~(up | down)) | ((truth & up) << shift) |
+         ((truth & down) >> shift);
+}
+
+// Re-expresses the truth table of a cut over the leaves of a larger cut. The
+// variables at and above nLeaves are don't cares, so moving the leaves from
+// the highest one down only ever swaps with a don't care position.
+static inline uint64_t stretchTruth(uint64_t truth, const int* leaves,
+                                    int nLeaves, const int* resLeaves) {
+  int pos[LEVEL_CUT_MAX_TRUTH_LEAVES];
+  for (int i = 0, j = 0; i < nLeaves; i++, j++) {
+    while (resLeaves[j] != leaves[i]) {
+      j++;
+    }
+    pos[i] = j;
+  }
+  for (int i = nLeaves - 1; i >= 0; i--) {
+    if (pos[i] != i) {
+      truth = swapVars(truth, i, pos[i]);
+    }
+  }
+  return truth;
+}
+
+// Merges two sorted leaf arrays; returns the merged size or -1 if it exceeds K
+static inline int mergeLeaves(const int* lhs, int nLhs, const int* rhs,
+                              int nRhs, int* res, int K) {
+  int i = 0, j = 0, n = 0;
+  while (i < nLhs || j < nRhs) {
+    if (n == K) {
+      return -1;
+    }
+    if (j == nRhs || (i < nLhs && lhs[i] < rhs[j])) {
+      res[n++] = lhs[i++];
+    } else if (i == nLhs || rhs[j] < lhs[i]) {
+      res[n++] = rhs[j++];
+    } else {
+      res[n++] = lhs[i++];
+      j++;
+    }
+  }
+  return n;
+}
+
+// Checks if the sorted leaves of smaller are all contained in larger
+static inline bool containsLeaves(const int* smaller, int nSmaller,
+                                  const int* larger, int nLarger) {
+  int j = 0;
+  for (int i = 0; i < nSmaller; i++) {
+    while (j < nLarger && larger[j] < smaller[i]) {
+      j++;
+    }
+    if (j == nLarger || larger[j] != smaller[i]) {
+      return false;
+    }
+    j++;
+  }
+  return true;
+}
+
+LevelCutManager::LevelCutManager(aig::Aig& aig, int K, int C, bool compTruth)
+    : aig(aig), K(K), C(C), nIds(0), blockCapacity(std::max(C, 1 << 14)),
+      compTruth(compTruth), perThreadScratch(K, C) {
+
+  if (K < 2 || K > LEVEL_CUT_MAX_LEAVES) {
+    GALOIS_DIE("level cut size must be between 2 and ", LEVEL_CUT_MAX_LEAVES);
+  }
+  if (compTruth && K > LEVEL_CUT_MAX_TRUTH_LEAVES) {
+    GALOIS_DIE("level cut truth tables support at most ",
+               LEVEL_CUT_MAX_TRUTH_LEAVES, " leaves");
+  }
+  if (C < 1) {
+    GALOIS_DIE("level cut limit per node must be positive");
+  }
+}
+
+void LevelCutManager::buildFlatGraph() {
+
+  aig::Graph& aigGraph = this->aig.getGraph();
+  this->nIds           = this->aig.getNodes().size();
+
+  this->kind.assign(this->nIds, NONE);
+  this->fanin0.assign(this->nIds, -1);
+  this->fanin1.assign(this->nIds, -1);
+  this->faninPolarity.assign(this->nIds, 0);
+
+  galois::do_all(
+      galois::iterate(aigGraph),
+      [&](aig::GNode node) {
+        aig::NodeData& nodeData =
+            aigGraph.getData(node, galois::MethodFlag::UNPROTECTED);
+        int id = nodeData.id;
+        if (nodeData.type == aig::NodeType::AND) {
+          auto inEdgeIt = aigGraph.in_edge_begin(
+              node, galois::MethodFlag::UNPROTECTED);
+          this->fanin0[id] =
+              aigGraph
+                  .getData(aigGraph.getEdgeDst(inEdgeIt),
+                           galois::MethodFlag::UNPROTECTED)
+                  .id;
+          uint8_t polarity = aigGraph.getEdgeData(inEdgeIt) ? 1 : 0;
+          inEdgeIt++;
+          this->fanin1[id] =
+              aigGraph
+                  .getData(aigGraph.getEdgeDst(inEdgeIt),
+                           galois::MethodFlag::UNPROTECTED)
+                  .id;
+          polarity |= aigGraph.getEdgeData(inEdgeIt) ? 2 : 0;
+          this->faninPolarity[id] = polarity;
+          this->kind[id]          = AND;
+        } else if (nodeData.type != aig::NodeType::PO) {
+          // PIs, latch outputs and the constant node are cut leaves
+          this->kind[id] = SOURCE;
+        }
+      },
+      galois::steal(), galois::loopname("LevelCutFlatten"));
+
+  // Fanout CSR over the AND nodes
+  this->fanoutOffsets.assign(this->nIds + 1, 0);
+  for (int id = 0; id < this->nIds; id++) {
+    if (this->kind[id] == AND) {
+      this->fanoutOffsets[this->fanin0[id] + 1]++;
+      this->fanoutOffsets[this->fanin1[id] + 1]++;
+    }
+  }
+  for (int id = 0; id < this->nIds; id++) {
+    this->fanoutOffsets[id + 1] += this->fanoutOffsets[id];
+  }
+  this->fanouts.resize(this->fanoutOffsets[this->nIds]);
+  std::vector<int> fill(this->fanoutOffsets.begin(),
+                        this->fanoutOffsets.end() - 1);
+  for (int id = 0; id < this->nIds; id++) {
+    if (this->kind[id] == AND) {
+      this->fanouts[fill[this->fanin0[id]]++] = id;
+      this->fanouts[fill[this->fanin1[id]]++] = id;
+    }
+  }
+}
+
+void LevelCutManager::buildLevels() {
+
+  std::vector<std::atomic<int>> pending(this->nIds);
+  galois::do_all(galois::iterate(0, this->nIds), [&](int id) {
+    pending[id].store(this->kind[id] == AND ? 2 : 0,
+                      std::memory_order_relaxed);
+  });
+
+  this->levelNodes.clear();
+  this->levelOffsets.assign(1, 0);
+  for (int id = 0; id < this->nIds; id++) {
+    if (this->kind[id] == SOURCE) {
+      this->levelNodes.push_back(id);
+    }
+  }
+  this->levelOffsets.push_back(this->levelNodes.size());
+
+  // An AND node joins the level after its last fanin is levelized
+  while (this->levelOffsets.back() >
+         this->levelOffsets[this->levelOffsets.size() - 2]) {
+    galois::InsertBag<int> next;
+    galois::do_all(
+        galois::iterate(this->levelNodes.begin() +
+                            this->levelOffsets[this->levelOffsets.size() - 2],
+                        this->levelNodes.begin() + this->levelOffsets.back()),
+        [&](int id) {
+          for (int e = this->fanoutOffsets[id]; e < this->fanoutOffsets[id + 1];
+               e++) {
+            int fanout = this->fanouts[e];
+            if (pending[fanout].fetch_sub(1) == 1) {
+              next.push(fanout);
+            }
+          }
+        },
+        galois::steal(), galois::loopname("LevelCutLevelize"));
+
+    size_t begin = this->levelNodes.size();
+    this->levelNodes.insert(this->levelNodes.end(), next.begin(), next.end());
+    // Sorting keeps the traversal order deterministic and close to id order
+    std::sort(this->levelNodes.begin() + begin, this->levelNodes.end());
+    this->levelOffsets.push_back(this->levelNodes.size());
+  }
+  this->levelOffsets.pop_back();
+}
+
+void LevelCutManager::levelize() {
+  buildFlatGraph();
+  buildLevels();
+  this->nodeCuts.assign(this->nIds, LevelCutRange());
+}
+
+void LevelCutManager::computeTrivialCut(int nodeId) {
+
+  LevelCutScratch& scratch = *this->perThreadScratch.getLocal();
+  scratch.leaves[0]        = nodeId;
+  scratch.nLeaves[0]       = 1;
+  scratch.sig[0]           = 1ULL << (nodeId % 64);
+  scratch.truth[0]         = varTruth[0];
+  scratch.nCuts            = 1;
+  nCuts += 1;
+  nTriv += 1;
+}
+
+inline bool LevelCutManager::filterCut(LevelCutScratch& scratch,
+                                       const int* leaves, int nLeaves,
+                                       uint64_t sig) {
+
+  // check if this cut is dominated by a cut already kept (including an
+  // identical one); the trivial cut in slot 0 can never dominate
+  for (int c = 1; c < scratch.nCuts; c++) {
+    if (scratch.nLeaves[c] > nLeaves || (scratch.sig[c] & ~sig) != 0) {
+      continue;
+    }
+    if (containsLeaves(&scratch.leaves[(size_t)c * this->K],
+                       scratch.nLeaves[c], leaves, nLeaves)) {
+      nFilt += 1;
+      return true;
+    }
+  }
+
+  // remove the kept cuts dominated by this one
+  for (int c = 1; c < scratch.nCuts;) {
+    if (scratch.nLeaves[c] <= nLeaves || (sig & ~scratch.sig[c]) != 0 ||
+        !containsLeaves(leaves, nLeaves, &scratch.leaves[(size_t)c * this->K],
+                        scratch.nLeaves[c])) {
+      c++;
+      continue;
+    }
+    int last = --scratch.nCuts;
+    if (c != last) {
+      std::copy_n(&scratch.leaves[(size_t)last * this->K], this->K,
+                  &scratch.leaves[(size_t)c * this->K]);
+      scratch.nLeaves[c] = scratch.nLeaves[last];
+      scratch.sig[c]     = scratch.sig[last];
+      scratch.truth[c]   = scratch.truth[last];
+    }
+    nCuts -= 1;
+    nFilt += 1;
+  }
+
+  return false;
+}
+
+void LevelCutManager::computeNodeCuts(int nodeId) {
+
+  LevelCutScratch& scratch = *this->perThreadScratch.getLocal();
+  computeTrivialCut(nodeId);
+
+  const LevelCutRange& lhs = this->nodeCuts[this->fanin0[nodeId]];
+  const LevelCutRange& rhs = this->nodeCuts[this->fanin1[nodeId]];
+  uint64_t lhsMask = (this->faninPolarity[nodeId] & 1) ? 0 : ~0ULL;
+  uint64_t rhsMask = (this->faninPolarity[nodeId] & 2) ? 0 : ~0ULL;
+
+  for (int i = 0; i < lhs.nCuts; i++) {
+    const int* lhsLeaves = &lhs.leaves[(size_t)i * this->K];
+    for (int j = 0; j < rhs.nCuts; j++) {
+      // the signature bits are a lower bound on the number of leaves
+      uint64_t sig = lhs.sig[i] | rhs.sig[j];
+      if (__builtin_popcountll(sig) > this->K) {
+        continue;
+      }
+
+      const int* rhsLeaves = &rhs.leaves[(size_t)j * this->K];
+      int* resLeaves       = &scratch.leaves[(size_t)scratch.nCuts * this->K];
+      int nLeaves = mergeLeaves(lhsLeaves, lhs.nLeaves[i], rhsLeaves,
+                                rhs.nLeaves[j], resLeaves, this->K);
+      if (nLeaves < 0) {
+        continue;
+      }
+      if (filterCut(scratch, resLeaves, nLeaves, sig)) {
+        continue;
+      }
+      // the filter may have moved a cut into this slot, so merge again
+      resLeaves = &scratch.leaves[(size_t)scratch.nCuts * this->K];
+      mergeLeaves(lhsLeaves, lhs.nLeaves[i], rhsLeaves, rhs.nLeaves[j],
+                  resLeaves, this->K);
+
+      int c             = scratch.nCuts++;
+      scratch.nLeaves[c] = nLeaves;
+      scratch.sig[c]     = sig;
+      if (this->compTruth) {
+        scratch.truth[c] =
+            stretchTruth(lhs.truth[i] ^ lhsMask, lhsLeaves, lhs.nLeaves[i],
+                         resLeaves) &
+            stretchTruth(rhs.truth[j] ^ rhsMask, rhsLeaves, rhs.nLeaves[j],
+                         resLeaves);
+      }
+      nCuts += 1;
+
+      if (scratch.nCuts >= this->C) {
+        nSatu += 1;
+        commitCuts(nodeId, scratch);
+        return; // The Maximum number of cuts per node was reached
+      }
+    }
+  }
+
+  commitCuts(nodeId, scratch);
+}
+
+void LevelCutManager::commitCuts(int nodeId, LevelCutScratch& scratch) {
+
+  LevelCutArena& arena = *this->perThreadArena.getLocal();
+  if (arena.blocks.empty() ||
+      arena.blocks.back()->used + scratch.nCuts > this->blockCapacity) {
+    arena.blocks.emplace_back(new LevelCutBlock(this->K, this->blockCapacity));
+  }
+  LevelCutBlock& block = *arena.blocks.back();
+  int begin            = block.used;
+  block.used += scratch.nCuts;
+
+  std::copy_n(scratch.leaves.begin(), (size_t)scratch.nCuts * this->K,
+              block.leaves.begin() + (size_t)begin * this->K);
+  std::copy_n(scratch.sig.begin(), scratch.nCuts, block.sig.begin() + begin);
+  std::copy_n(scratch.truth.begin(), scratch.nCuts,
+              block.truth.begin() + begin);
+  std::copy_n(scratch.nLeaves.begin(), scratch.nCuts,
+              block.nLeaves.begin() + begin);
+
+  LevelCutRange& range = this->nodeCuts[nodeId];
+  range.leaves         = &block.leaves[(size_t)begin * this->K];
+  range.sig            = &block.sig[begin];
+  range.truth          = &block.truth[begin];
+  range.nLeaves        = &block.nLeaves[begin];
+  range.nCuts          = scratch.nCuts;
+}
+
+void LevelCutManager::enumerateCuts() {
+
+  galois::do_all(
+      galois::iterate(this->levelNodes.begin(),
+                      this->levelNodes.begin() + this->levelOffsets[1]),
+      [&](int id) {
+        computeTrivialCut(id);
+        commitCuts(id, *this->perThreadScratch.getLocal());
+      },
+      galois::loopname("LevelCutSources"));
+
+  for (size_t l = 1; l + 1 < this->levelOffsets.size(); l++) {
+    galois::do_all(
+        galois::iterate(this->levelNodes.begin() + this->levelOffsets[l],
+                        this->levelNodes.begin() + this->levelOffsets[l + 1]),
+        [&](int id) { computeNodeCuts(id); }, galois::steal(),
+        galois::loopname("LevelCutOperator"));
+  }
+}
+
+void LevelCutManager::printCutStatistics() {
+
+  long int nCutsRed = nCuts.reduce();
+  long int nTrivRed = nTriv.reduce();
+  long int nFiltRed = nFilt.reduce();
+  long int nSatuRed = nSatu.reduce();
+
+  std::cout << std::endl
+            << "############## Cut Statistics #############" << std::endl;
+  std::cout << "nLevels: " << getNumLevels() << std::endl;
+  std::cout << "nCuts: " << nCutsRed << std::endl;
+  std::cout << "nTriv: " << nTrivRed << std::endl;
+  std::cout << "nFilt: " << nFiltRed << std::endl;
+  std::cout << "nSatu: " << nSatuRed << std::endl;
+  std::cout << "nCutPerNode: "
+            << (((double)nCutsRed) / std::max<long int>(nTrivRed, 1))
+            << std::endl;
+  std::cout << "###########################################" << std::endl;
+}
+
+int LevelCutManager::getK() { return this->K; }
+
+int LevelCutManager::getC() { return this->C; }
+
+bool LevelCutManager::getCompTruthFlag() { return this->compTruth; }
+
+int LevelCutManager::getNumLevels() { return this->levelOffsets.size() - 1; }
+
+long int LevelCutManager::getNumCuts() { return nCuts.reduce(); }
+
+const LevelCutRange& LevelCutManager::getNodeCuts(int nodeId) {
+  return this->nodeCuts[nodeId];
+}
+
+void runLevelCutOperator(LevelCutManager& cutMan) {
+  cutMan.levelize();
+  cutMan.enumerateCuts();
+}
+
+} /* namespace algorithm */
@@ -0,0 +1,172 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/*
+
+ Level-synchronous K-feasible cut enumeration.
+
+ The AIG is flattened into fanin arrays indexed by node id plus a fanout CSR,
+ and nodes are grouped by topological level. Cuts of every node in a level
+ depend only on cuts of earlier levels, so each level is a single do_all.
+ Cuts are stored as structure-of-arrays blocks: fixed-width leaf arrays,
+ 64-bit signatures, leaf counts and 64-bit truth tables (K <= 6).
+
+*/
+
+#ifndef LEVELCUTMANAGER_H_
+#define LEVELCUTMANAGER_H_
+
+#include "Aig.h"
+#include "galois/Reduction.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace algorithm {
+
+// Largest cut size supported by the fixed-width leaf arrays
+constexpr int LEVEL_CUT_MAX_LEAVES = 16;
+// Largest cut size for which a 64-bit truth table can be computed
+constexpr int LEVEL_CUT_MAX_TRUTH_LEAVES = 6;
+
+// A fixed-capacity block of cuts in structure-of-arrays layout. The cuts of
+// one node always occupy a contiguous range of slots inside a single block,
+// and blocks are never resized, so pointers into them stay valid.
+typedef struct levelCutBlock_ {
+
+  int used;
+  std::vector<int> leaves;     // capacity * K leaf ids, sorted per cut
+  std::vector<uint64_t> sig;   // one bit per leaf id modulo 64
+  std::vector<uint64_t> truth; // cut function over the leaves
+  std::vector<uint8_t> nLeaves;
+
+  levelCutBlock_(int K, int capacity)
+      : used(0), leaves((size_t)capacity * K), sig(capacity), truth(capacity),
+        nLeaves(capacity) {}
+
+} LevelCutBlock;
+
+// Per-thread list of blocks holding the committed cuts
+typedef struct levelCutArena_ {
+
+  std::vector<std::unique_ptr<LevelCutBlock>> blocks;
+
+} LevelCutArena;
+
+// Per-thread scratch used while the cuts of one node are being built
+typedef struct levelCutScratch_ {
+
+  int nCuts;
+  std::vector<int> leaves;
+  std::vector<uint64_t> sig;
+  std::vector<uint64_t> truth;
+  std::vector<uint8_t> nLeaves;
+
+  levelCutScratch_(int K, int C)
+      : nCuts(0), leaves((size_t)C * K), sig(C), truth(C), nLeaves(C) {}
+
+} LevelCutScratch;
+
+// View of the committed cuts of one node
+typedef struct levelCutRange_ {
+
+  const int* leaves;
+  const uint64_t* sig;
+  const uint64_t* truth;
+  const uint8_t* nLeaves;
+  int nCuts;
+
+  levelCutRange_()
+      : leaves(nullptr), sig(nullptr), truth(nullptr), nLeaves(nullptr),
+        nCuts(0) {}
+
+} LevelCutRange;
+
+typedef galois::substrate::PerThreadStorage<LevelCutArena> PerThreadCutArena;
+typedef galois::substrate::PerThreadStorage<LevelCutScratch>
+    PerThreadCutScratch;
+
+class LevelCutManager {
+
+private:
+  enum NodeKind : uint8_t { NONE, SOURCE, AND };
+
+  aig::Aig& aig;
+  int K;
+  int C;
+  int nIds;
+  int blockCapacity;
+  bool compTruth;
+
+  // Flat AIG: two fanins per AND node, polarity bit 0 for lhs and bit 1 for
+  // rhs (set when the fanin is not complemented)
+  std::vector<NodeKind> kind;
+  std::vector<int> fanin0;
+  std::vector<int> fanin1;
+  std::vector<uint8_t> faninPolarity;
+  std::vector<int> fanoutOffsets;
+  std::vector<int> fanouts;
+
+  // Nodes grouped by level; level l is [levelOffsets[l], levelOffsets[l+1])
+  std::vector<int> levelOffsets;
+  std::vector<int> levelNodes;
+
+  std::vector<LevelCutRange> nodeCuts;
+  PerThreadCutArena perThreadArena;
+  PerThreadCutScratch perThreadScratch;
+
+  // Cuts Statistics //
+  galois::GAccumulator<long int> nCuts;
+  galois::GAccumulator<long int> nTriv;
+  galois::GAccumulator<long int> nFilt;
+  galois::GAccumulator<long int> nSatu;
+
+  void buildFlatGraph();
+  void buildLevels();
+  void computeTrivialCut(int nodeId);
+  void computeNodeCuts(int nodeId);
+  void commitCuts(int nodeId, LevelCutScratch& scratch);
+
+  inline bool filterCut(LevelCutScratch& scratch, const int* leaves,
+                        int nLeaves, uint64_t sig);
+
+public:
+  LevelCutManager(aig::Aig& aig, int K, int C, bool compTruth);
+
+  void levelize();
+  void enumerateCuts();
+  void printCutStatistics();
+
+  int getK();
+  int getC();
+  bool getCompTruthFlag();
+  int getNumLevels();
+  long int getNumCuts();
+  const LevelCutRange& getNodeCuts(int nodeId);
+};
+
+// Levelizes the AIG and enumerates the cuts of all nodes level by level //
+void runLevelCutOperator(LevelCutManager& cutMan);
+
+} /* namespace algorithm */
+
+#endif /* LEVELCUTMANAGER_H_ */
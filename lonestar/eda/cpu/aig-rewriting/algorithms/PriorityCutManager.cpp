@@ -1347,6 +1347,10 @@ void PriCutManager::printCutStatistics() {
   std::cout << "###########################################" << std::endl;
 }
 
+long int PriCutManager::getNumCuts() {
+  return nCuts.reduce() + this->aig.getNumInputs();
+}
+
 void PriCutManager::printRuntimes() {
 
   std::cout << std::endl << "#### Runtimes in microsecond ####" << std::endl;
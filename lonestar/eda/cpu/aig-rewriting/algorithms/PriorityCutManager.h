@@ -197,6 +197,7 @@ public:
   void printNodeBestCut(int nodeId);
   void printBestCuts();
   void printCutStatistics();
+  long int getNumCuts();
   void printRuntimes();
 
   int getNumLUTs();
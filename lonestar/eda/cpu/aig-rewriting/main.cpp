@@ -18,11 +18,14 @@
  */
 
 #include "parsers/AigParser.h"
+#include "parsers/FlatAigParser.h"
 #include "writers/AigWriter.h"
+#include "writers/FlatAigWriter.h"
 #include "writers/BlifWriter.h"
 #include "subjectgraph/aig/Aig.h"
 #include "algorithms/CutManager.h"
 #include "algorithms/PriorityCutManager.h"
+#include "algorithms/LevelCutManager.h"
 #include "algorithms/NPNManager.h"
 #include "algorithms/RewriteManager.h"
 #include "algorithms/PreCompGraphManager.h"
@@ -31,7 +34,10 @@
 #include "galois/Galois.h"
 #include "Lonestar/BoilerPlate.h"
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 
 static const char* name = "AIG Rewriting";
@@ -56,11 +62,53 @@ static cll::opt<bool> AIG(
     cll::desc("Specify that the input graph is a AND-Inverter Graph format"),
     cll::init(false));
 
+enum Algo { Rewrite, KCut, PriorityCut, LevelCut, LoadBenchmark };
+
+static cll::opt<Algo> algo(
+    "algo", cll::desc("Choose an algorithm (default value Rewrite):"),
+    cll::values(clEnumVal(Rewrite, "AIG rewriting"),
+                clEnumVal(KCut, "K-feasible cut enumeration (K=4, C=500)"),
+                clEnumVal(PriorityCut,
+                          "Priority cuts for LUT mapping (K=6, C=8)"),
+                clEnumVal(LevelCut, "Level-synchronous cut enumeration"),
+                clEnumVal(LoadBenchmark,
+                          "Compare sequential and parallel AIGER I/O")),
+    cll::init(Rewrite));
+
+static cll::opt<int>
+    cutSize("cutSize",
+            cll::desc("Maximum number of leaves per cut for LevelCut "
+                      "(default value 4)"),
+            cll::init(4));
+
+static cll::opt<int>
+    cutLimit("cutLimit",
+             cll::desc("Maximum number of cuts per node for LevelCut "
+                       "(default value 500)"),
+             cll::init(500));
+
+static cll::opt<bool>
+    cutTruth("cutTruth",
+             cll::desc("Compute cut truth tables for LevelCut; requires "
+                       "cutSize <= 6 (default value false)"),
+             cll::init(false));
+
+static cll::opt<bool> parallelIO(
+    "parallelIO",
+    cll::desc("Read and write binary AIGER with the parallel flat AIG "
+              "reader/writer (default value false)"),
+    cll::init(false));
+
 using namespace std::chrono;
 
 void aigRewriting(aig::Aig& aig, std::string& fileName, int nThreads,
                   bool verbose);
 void kcut(aig::Aig& aig, std::string& fileName, int nThreads, bool verbose);
+void loadBenchmark(std::string& path, std::string& fileName, int nThreads,
+                   bool verbose);
+void writeAig(aig::Aig& aig, std::string path);
+void levelcut(aig::Aig& aig, std::string& fileName, int nThreads, int K,
+              int C, bool compTruth, bool verbose);
 void prioritycut(aig::Aig& aig, std::string& fileName, int nThreads,
                  bool deterministic, bool verbose);
 void addChoices(aig::Aig& aig, std::string& fileName, int nThreads,
@@ -83,24 +131,52 @@ int main(int argc, char* argv[]) {
   std::string path     = inputFile;
   std::string fileName = getFileName(path);
 
+  if (algo == LoadBenchmark) {
+    loadBenchmark(path, fileName, nThreads, outputVerbose);
+    return 0;
+  }
+
   aig::Aig aig;
-  AigParser aigParser(path, aig);
-  aigParser.parseAig();
-  // aigParser.parseAag();
+  if (parallelIO) {
+    aig::FlatAig flatAig;
+    FlatAigParser flatAigParser(path, flatAig);
+    flatAigParser.parseAig();
+    flatAig.toAig(aig);
+  } else {
+    AigParser aigParser(path, aig);
+    aigParser.parseAig();
+    // aigParser.parseAag();
+  }
 
   if (outputVerbose) {
     std::cout << "############## AIG REWRITING ##############" << std::endl;
     std::cout << "Design Name: " << fileName << std::endl;
     std::cout << "|Nodes|: " << aig.getGraph().size() << std::endl;
-    std::cout << "|I|: " << aigParser.getI() << std::endl;
-    std::cout << "|L|: " << aigParser.getL() << std::endl;
-    std::cout << "|O|: " << aigParser.getO() << std::endl;
-    std::cout << "|A|: " << aigParser.getA() << std::endl;
-    std::cout << "|E|: " << aigParser.getE() << " (outgoing edges)"
-              << std::endl;
+    std::cout << "|I|: " << aig.getNumInputs() << std::endl;
+    std::cout << "|L|: " << aig.getNumLatches() << std::endl;
+    std::cout << "|O|: " << aig.getNumOutputs() << std::endl;
+    std::cout << "|A|: " << aig.getNumAnds() << std::endl;
+    std::cout << "|E|: "
+              << (2 * aig.getNumAnds() + aig.getNumLatches() +
+                  aig.getNumOutputs())
+              << " (outgoing edges)" << std::endl;
   }
 
-  aigRewriting(aig, fileName, nThreads, outputVerbose);
+  switch (algo) {
+  case KCut:
+    kcut(aig, fileName, nThreads, outputVerbose);
+    break;
+  case PriorityCut:
+    prioritycut(aig, fileName, nThreads, false, outputVerbose);
+    break;
+  case LevelCut:
+    levelcut(aig, fileName, nThreads, cutSize, cutLimit, cutTruth,
+             outputVerbose);
+    break;
+  default:
+    aigRewriting(aig, fileName, nThreads, outputVerbose);
+    break;
+  }
 
   return 0;
 }
@@ -161,8 +237,7 @@ void aigRewriting(aig::Aig& aig, std::string& fileName, int nThreads,
   }
 
   // WRITE AIG //
-  AigWriter aigWriter(fileName + "_rewritten.aig");
-  aigWriter.writeAig(aig);
+  writeAig(aig, fileName + "_rewritten.aig");
 
   // WRITE DOT //
   // aig.writeDot( fileName + "_rewritten.dot", aig.toDot() );
@@ -195,6 +270,7 @@ void prioritycut(aig::Aig& aig, std::string& fileName, int nThreads,
 
   high_resolution_clock::time_point t2 = high_resolution_clock::now();
   kcutTime = duration_cast<microseconds>(t2 - t1).count();
+  double cutsPerSec = cutMan.getNumCuts() / (kcutTime / 1e6);
 
   BlifWriter blifWriter(fileName + "_mapped.blif");
   blifWriter.writeNetlist(aig, cutMan);
@@ -214,11 +290,13 @@ void prioritycut(aig::Aig& aig, std::string& fileName, int nThreads,
     std::cout << "LUT Size: " << cutMan.getNumLUTs() << std::endl;
     std::cout << "LUT Depth: " << cutMan.getNumLevels() << std::endl;
     std::cout << "Runtime (us): " << kcutTime << std::endl;
+    std::cout << "Cuts/sec: " << cutsPerSec << std::endl;
   } else {
     std::cout << fileName << ";" << K << ";" << C << ";" << compTruth << ";"
               << aig.getNumAnds() << ";" << aig.getDepth() << ";"
               << cutMan.getNumLUTs() << ";" << cutMan.getNumLevels() << ";"
-              << numThreads << ";" << kcutTime << std::endl;
+              << numThreads << ";" << kcutTime << ";" << cutsPerSec
+              << std::endl;
   }
 }
 
@@ -313,6 +391,7 @@ void kcut(aig::Aig& aig, std::string& fileName, int nThreads, bool verbose) {
 
   high_resolution_clock::time_point t2 = high_resolution_clock::now();
   kcutTime = duration_cast<microseconds>(t2 - t1).count();
+  double cutsPerSec = cutMan.getNumCuts() / (kcutTime / 1e6);
 
   if (verbose) {
     std::cout << "################ Results ################## " << std::endl;
@@ -322,10 +401,53 @@ void kcut(aig::Aig& aig, std::string& fileName, int nThreads, bool verbose) {
     std::cout << "Size: " << aig.getNumAnds() << std::endl;
     std::cout << "Depth: " << aig.getDepth() << std::endl;
     std::cout << "Runtime (us): " << kcutTime << std::endl;
+    std::cout << "Cuts/sec: " << cutsPerSec << std::endl;
+  } else {
+    std::cout << fileName << ";" << K << ";" << C << ";" << compTruth << ";"
+              << aig.getNumAnds() << ";" << aig.getDepth() << ";" << numThreads
+              << ";" << kcutTime << ";" << cutsPerSec << std::endl;
+  }
+}
+
+void levelcut(aig::Aig& aig, std::string& fileName, int nThreads, int K,
+              int C, bool compTruth, bool verbose) {
+
+  int numThreads = galois::setActiveThreads(nThreads);
+
+  if (verbose) {
+    std::cout << "############# Configurations ############## " << std::endl;
+    std::cout << "K: " << K << std::endl;
+    std::cout << "C: " << C << std::endl;
+    std::cout << "CompTruth: " << (compTruth ? "yes" : "no") << std::endl;
+    std::cout << "nThreads: " << numThreads << std::endl;
+  }
+
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+
+  algorithm::LevelCutManager cutMan(aig, K, C, compTruth);
+  cutMan.levelize();
+
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+
+  cutMan.enumerateCuts();
+
+  high_resolution_clock::time_point t3 = high_resolution_clock::now();
+  long double levelizeTime = duration_cast<microseconds>(t2 - t1).count();
+  long double kcutTime     = duration_cast<microseconds>(t3 - t1).count();
+  double cutsPerSec        = cutMan.getNumCuts() / (kcutTime / 1e6);
+
+  if (verbose) {
+    std::cout << "################ Results ################## " << std::endl;
+    cutMan.printCutStatistics();
+    std::cout << "Size: " << aig.getNumAnds() << std::endl;
+    std::cout << "Depth: " << aig.getDepth() << std::endl;
+    std::cout << "Levelize (us): " << levelizeTime << std::endl;
+    std::cout << "Runtime (us): " << kcutTime << std::endl;
+    std::cout << "Cuts/sec: " << cutsPerSec << std::endl;
   } else {
     std::cout << fileName << ";" << K << ";" << C << ";" << compTruth << ";"
               << aig.getNumAnds() << ";" << aig.getDepth() << ";" << numThreads
-              << ";" << kcutTime << std::endl;
+              << ";" << kcutTime << ";" << cutsPerSec << std::endl;
   }
 }
 
@@ -361,6 +483,101 @@ void rdCut(aig::Aig& aig, std::string& fileName, int nThreads, bool verbose) {
   }
 }
 
+void writeAig(aig::Aig& aig, std::string path) {
+  if (parallelIO) {
+    aig::FlatAig flatAig;
+    flatAig.fromAig(aig);
+    FlatAigWriter flatAigWriter(path);
+    flatAigWriter.writeAig(flatAig);
+  } else {
+    AigWriter aigWriter(path);
+    aigWriter.writeAig(aig);
+  }
+}
+
+static std::string readWholeFile(std::string path) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+void loadBenchmark(std::string& path, std::string& fileName, int nThreads,
+                   bool verbose) {
+
+  int numThreads = galois::setActiveThreads(nThreads);
+
+  // Sequential path: AigParser straight into the Morph graph
+  high_resolution_clock::time_point t0 = high_resolution_clock::now();
+  aig::Aig seqAig;
+  AigParser aigParser(path, seqAig);
+  aigParser.parseAig();
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+
+  // Parallel path: flat AIG first, Morph graph only on demand
+  aig::FlatAig flatAig;
+  FlatAigParser flatAigParser(path, flatAig);
+  flatAigParser.parseAig();
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  aig::Aig parAig;
+  flatAig.toAig(parAig);
+  high_resolution_clock::time_point t3 = high_resolution_clock::now();
+
+  std::string seqPath = fileName + "_seq.aig";
+  std::string parPath = fileName + "_par.aig";
+  {
+    AigWriter aigWriter(seqPath);
+    aigWriter.writeAig(seqAig);
+  }
+  high_resolution_clock::time_point t4 = high_resolution_clock::now();
+  size_t bytesWritten;
+  {
+    aig::FlatAig outAig;
+    outAig.fromAig(parAig);
+    FlatAigWriter flatAigWriter(parPath);
+    flatAigWriter.writeAig(outAig);
+    bytesWritten = flatAigWriter.getBytesWritten();
+  }
+  high_resolution_clock::time_point t5 = high_resolution_clock::now();
+
+  bool match = readWholeFile(seqPath) == readWholeFile(parPath);
+  std::remove(seqPath.c_str());
+  std::remove(parPath.c_str());
+
+  long double seqReadTime  = duration_cast<microseconds>(t1 - t0).count();
+  long double flatReadTime = duration_cast<microseconds>(t2 - t1).count();
+  long double toAigTime    = duration_cast<microseconds>(t3 - t2).count();
+  long double seqWriteTime = duration_cast<microseconds>(t4 - t3).count();
+  long double parWriteTime = duration_cast<microseconds>(t5 - t4).count();
+  double readMB            = flatAigParser.getBytesRead() / 1e6;
+  double writeMB           = bytesWritten / 1e6;
+
+  if (verbose) {
+    std::cout << "############ AIGER I/O BENCHMARK ############" << std::endl;
+    std::cout << "File size (MB): " << readMB << std::endl;
+    std::cout << "|A|: " << flatAig.getNumAnds() << std::endl;
+    std::cout << "nThreads: " << numThreads << std::endl;
+    std::cout << "Sequential read (us): " << seqReadTime << " ("
+              << readMB / (seqReadTime / 1e6) << " MB/s)" << std::endl;
+    std::cout << "Parallel flat read (us): " << flatReadTime << " ("
+              << readMB / (flatReadTime / 1e6) << " MB/s)" << std::endl;
+    std::cout << "Flat to Aig (us): " << toAigTime << std::endl;
+    std::cout << "Sequential write (us): " << seqWriteTime << " ("
+              << writeMB / (seqWriteTime / 1e6) << " MB/s)" << std::endl;
+    std::cout << "Parallel write (us): " << parWriteTime << " ("
+              << writeMB / (parWriteTime / 1e6) << " MB/s)" << std::endl;
+    std::cout << "Outputs match: " << (match ? "yes" : "no") << std::endl;
+  } else {
+    std::cout << fileName << ";" << readMB << ";" << flatAig.getNumAnds()
+              << ";" << numThreads << ";" << seqReadTime << ";"
+              << flatReadTime << ";" << toAigTime << ";" << seqWriteTime << ";"
+              << parWriteTime << ";" << match << std::endl;
+  }
+
+  if (!match) {
+    GALOIS_DIE("sequential and parallel AIGER writers disagree");
+  }
+}
+
 std::string getFileName(std::string path) {
   std::size_t slash    = path.find_last_of("/") + 1;
   std::size_t dot      = path.find_last_of(".");
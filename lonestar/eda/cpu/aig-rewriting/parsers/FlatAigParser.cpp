@@ -0,0 +1,327 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "galois/Galois.h"
+#include "galois/ParallelSTL.h"
+#include <FlatAigParser.h>
+#include "../misc/util/utilString.h"
+
+#include <atomic>
+#include <fstream>
+#include <limits>
+
+// Smallest AND-section chunk decoded by one task
+static const size_t CHUNK_MIN_BYTES = 1 << 16;
+
+FlatAigParser::FlatAigParser(std::string fileName, aig::FlatAig& flatAig)
+    : fileName(fileName), pos(0), currLine(1), flatAig(flatAig) {}
+
+bool FlatAigParser::atEnd() const { return pos >= buffer.size(); }
+
+char FlatAigParser::peekChar() const { return atEnd() ? '\0' : buffer[pos]; }
+
+char FlatAigParser::parseChar() {
+  if (atEnd()) {
+    throw unexpected_eof(currLine, 0);
+  }
+  char c = buffer[pos++];
+  if (c == '\r' && !atEnd()) {
+    c = buffer[pos++];
+  }
+  if (c == '\n') {
+    currLine++;
+  }
+  return c;
+}
+
+unsigned FlatAigParser::parseUnsigned(char delimChar) {
+  char c = parseChar();
+  if (!isdigit(c)) {
+    throw syntax_error(currLine, 0,
+                       format("Expected integer but found: ASCII %d", c));
+  }
+  uint64_t result = c - '0';
+  while (true) {
+    c = parseChar();
+    if (isdigit(c)) {
+      result = result * 10 + (c - '0');
+      if (result > std::numeric_limits<unsigned>::max()) {
+        throw semantic_error(currLine, 0, "Integer out of range");
+      }
+    } else if (c == delimChar) {
+      return result;
+    } else {
+      throw syntax_error(currLine, 0,
+                         format("Expected integer but found: ASCII %d", c));
+    }
+  }
+}
+
+std::string FlatAigParser::parseLine() {
+  size_t begin = pos;
+  while (!atEnd() && buffer[pos] != '\n' && buffer[pos] != '\r' &&
+         buffer[pos] != '\0') {
+    pos++;
+  }
+  std::string line(buffer.begin() + begin, buffer.begin() + pos);
+  if (!atEnd()) {
+    parseChar();
+  }
+  return line;
+}
+
+void FlatAigParser::readFile() {
+  std::ifstream file(fileName.c_str(), std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw semantic_error(0, 0, format("Cannot open %s", fileName.c_str()));
+  }
+  std::streamsize size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  buffer.resize(size);
+  if (!file.read(buffer.data(), size)) {
+    throw unexpected_eof(0, 0, format("Cannot read %s", fileName.c_str()));
+  }
+  pos      = 0;
+  currLine = 1;
+}
+
+void FlatAigParser::parseHeader() {
+  if (buffer.size() < 4 || std::string(buffer.begin(), buffer.begin() + 4) !=
+                               "aig ") {
+    throw syntax_error(1, 0, "Expected aig header");
+  }
+  pos        = 4;
+  unsigned m = parseUnsigned(' ');
+  unsigned i = parseUnsigned(' ');
+  unsigned l = parseUnsigned(' ');
+  unsigned o = parseUnsigned(' ');
+  unsigned a = parseUnsigned('\n');
+
+  if ((uint64_t)m != (uint64_t)i + l + a) {
+    throw semantic_error(1, 4, "Incorrect value for M");
+  }
+  flatAig.resize(m, i, l, o, a);
+}
+
+void FlatAigParser::parseLatches() {
+  std::vector<unsigned>& latchLits = flatAig.getLatchLits();
+  for (unsigned in = 0; in < flatAig.getNumLatches(); in++) {
+    unsigned line = currLine;
+    unsigned lit  = 0;
+    // The next-state literal may be followed by an initial value
+    char c = parseChar();
+    while (isdigit(c)) {
+      lit = lit * 10 + (c - '0');
+      c   = parseChar();
+    }
+    if (c == ' ') {
+      parseLine();
+    } else if (c != '\n') {
+      throw syntax_error(line, 0,
+                         format("Expected integer but found: ASCII %d", c));
+    }
+    if (lit > 2 * flatAig.getM() + 1) {
+      throw semantic_error(line, 0, format("Invalid literal: %u", lit));
+    }
+    latchLits[in] = lit;
+  }
+}
+
+void FlatAigParser::parseOutputs() {
+  std::vector<unsigned>& outputLits = flatAig.getOutputLits();
+  for (unsigned in = 0; in < flatAig.getNumOutputs(); in++) {
+    unsigned lit = parseUnsigned('\n');
+    if (lit > 2 * flatAig.getM() + 1) {
+      throw semantic_error(currLine - 1, 0, format("Invalid literal: %u", lit));
+    }
+    outputLits[in] = lit;
+  }
+}
+
+void FlatAigParser::parseAnds() {
+
+  uint64_t nCodes = 2 * (uint64_t)flatAig.getNumAnds();
+  if (nCodes == 0) {
+    return;
+  }
+
+  const unsigned char* data = (const unsigned char*)buffer.data();
+  size_t begin              = pos;
+  size_t len                = buffer.size() - begin;
+  size_t nChunks            = std::max<size_t>(
+      1, std::min<size_t>(galois::getActiveThreads() * 16,
+                          len / CHUNK_MIN_BYTES));
+
+  std::vector<size_t> chunkBegin(nChunks + 1);
+  for (size_t c = 0; c <= nChunks; c++) {
+    chunkBegin[c] = begin + (len * c) / nChunks;
+  }
+
+  // Every code ends with a byte whose high bit is clear, so counting those
+  // bytes per chunk gives the index of the first code ending in each chunk
+  std::vector<uint64_t> codeOffsets(nChunks + 1, 0);
+  galois::do_all(
+      galois::iterate((size_t)0, nChunks),
+      [&](size_t c) {
+        uint64_t count = 0;
+        for (size_t p = chunkBegin[c]; p < chunkBegin[c + 1]; p++) {
+          count += (data[p] >> 7) ^ 1;
+        }
+        codeOffsets[c + 1] = count;
+      },
+      galois::loopname("FlatAigCountCodes"));
+  galois::ParallelSTL::partial_sum(codeOffsets.begin(), codeOffsets.end(),
+                                   codeOffsets.begin());
+  if (codeOffsets[nChunks] < nCodes) {
+    throw unexpected_eof(currLine, 0, "Truncated AND section");
+  }
+
+  // Deltas are decoded in place into the fanin arrays
+  std::vector<unsigned>& fanin0 = flatAig.getAndFanin0();
+  std::vector<unsigned>& fanin1 = flatAig.getAndFanin1();
+  std::atomic<bool> overflow(false);
+  size_t sectionEnd = begin;
+
+  galois::do_all(
+      galois::iterate((size_t)0, nChunks),
+      [&](size_t c) {
+        uint64_t code = codeOffsets[c];
+        uint64_t last = std::min(nCodes, codeOffsets[c + 1]);
+        if (code >= last) {
+          return;
+        }
+        // the first code ending in this chunk may start in the previous one
+        size_t p = chunkBegin[c];
+        while (p > begin && (data[p - 1] & 0x80)) {
+          p--;
+        }
+        for (; code < last; code++) {
+          uint64_t x = 0;
+          unsigned shift = 0;
+          unsigned char byte;
+          while ((byte = data[p++]) & 0x80) {
+            if (shift <= 28) {
+              x |= (uint64_t)(byte & 0x7f) << shift;
+            }
+            shift += 7;
+          }
+          if (shift <= 28) {
+            x |= (uint64_t)byte << shift;
+          }
+          if (shift > 28 || x > std::numeric_limits<unsigned>::max()) {
+            overflow = true;
+          }
+          if (code & 1) {
+            fanin1[code >> 1] = x;
+          } else {
+            fanin0[code >> 1] = x;
+          }
+        }
+        if (last == nCodes) {
+          sectionEnd = p;
+        }
+      },
+      galois::steal(), galois::loopname("FlatAigDecodeAnds"));
+
+  if (overflow) {
+    throw semantic_error(currLine, 0, "Delta out of range");
+  }
+
+  std::atomic<bool> invalid(false);
+  galois::do_all(
+      galois::iterate(0u, flatAig.getNumAnds()),
+      [&](unsigned k) {
+        unsigned lhs    = 2 * flatAig.getAndVar(k);
+        unsigned delta0 = fanin0[k];
+        unsigned delta1 = fanin1[k];
+        if (delta0 == 0 || delta0 > lhs || delta1 > lhs - delta0) {
+          invalid = true;
+          return;
+        }
+        fanin0[k] = lhs - delta0;
+        fanin1[k] = lhs - delta0 - delta1;
+      },
+      galois::loopname("FlatAigAndLiterals"));
+
+  if (invalid) {
+    throw semantic_error(currLine, 0, "Invalid AND deltas");
+  }
+  pos = sectionEnd;
+}
+
+void FlatAigParser::parseSymbolTable() {
+  unsigned n;
+  while (!atEnd()) {
+    char c = parseChar();
+    switch (c) {
+    case 'i':
+      n = parseUnsigned(' ');
+      if (n >= flatAig.getNumInputs())
+        throw semantic_error(currLine, 0,
+                             "Input number greater than number of inputs");
+      if (flatAig.getInputNames().empty()) {
+        flatAig.getInputNames().resize(flatAig.getNumInputs());
+      }
+      flatAig.getInputNames()[n] = parseLine();
+      break;
+    case 'l':
+      n = parseUnsigned(' ');
+      if (n >= flatAig.getNumLatches())
+        throw semantic_error(currLine, 0,
+                             "Latch number greater than number of latches");
+      if (flatAig.getLatchNames().empty()) {
+        flatAig.getLatchNames().resize(flatAig.getNumLatches());
+      }
+      flatAig.getLatchNames()[n] = parseLine();
+      break;
+    case 'o':
+      n = parseUnsigned(' ');
+      if (n >= flatAig.getNumOutputs())
+        throw semantic_error(currLine, 0,
+                             "Output number greater than number of outputs");
+      if (flatAig.getOutputNames().empty()) {
+        flatAig.getOutputNames().resize(flatAig.getNumOutputs());
+      }
+      flatAig.getOutputNames()[n] = parseLine();
+      break;
+    case 'c':
+      c = parseChar();
+      if (c != '\n')
+        throw syntax_error(currLine, 0);
+      if (peekChar() != '\0')
+        flatAig.getDesignName() = parseLine();
+      else
+        flatAig.getDesignName() = "Unnamed";
+      return;
+    }
+  }
+}
+
+void FlatAigParser::parseAig() {
+  readFile();
+  parseHeader();
+  parseLatches();
+  parseOutputs();
+  parseAnds();
+  parseSymbolTable();
+  flatAig.buildFanouts();
+}
+
+size_t FlatAigParser::getBytesRead() const { return buffer.size(); }
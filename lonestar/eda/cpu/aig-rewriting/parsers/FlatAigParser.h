@@ -0,0 +1,65 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#ifndef FLATAIGPARSER_H_
+#define FLATAIGPARSER_H_
+
+#include <string>
+#include <vector>
+
+#include "semantic_error.h"
+#include "syntax_error.h"
+#include "unexpected_eof.h"
+#include "../subjectgraph/aig/FlatAig.h"
+
+// Parallel reader for binary AIGER files. The whole file is read into
+// memory; the delta-encoded AND section is split into byte chunks that are
+// decoded in parallel into the fanin arrays of a FlatAig.
+class FlatAigParser {
+
+private:
+  std::string fileName;
+  std::vector<char> buffer;
+  size_t pos;
+  unsigned currLine;
+
+  aig::FlatAig& flatAig;
+
+  bool atEnd() const;
+  char peekChar() const;
+  char parseChar();
+  unsigned parseUnsigned(char delimChar);
+  std::string parseLine();
+
+  void readFile();
+  void parseHeader();
+  void parseLatches();
+  void parseOutputs();
+  void parseAnds();
+  void parseSymbolTable();
+
+public:
+  FlatAigParser(std::string fileName, aig::FlatAig& flatAig);
+
+  void parseAig();
+  size_t getBytesRead() const;
+};
+
+#endif /* FLATAIGPARSER_H_ */
@@ -0,0 +1,237 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "FlatAig.h"
+#include "galois/ParallelSTL.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace andInverterGraph {
+
+FlatAig::FlatAig() : m(0), i(0), l(0), o(0), a(0) {}
+
+void FlatAig::resize(unsigned m, unsigned i, unsigned l, unsigned o,
+                     unsigned a) {
+  this->m = m;
+  this->i = i;
+  this->l = l;
+  this->o = o;
+  this->a = a;
+  this->latchLits.resize(l);
+  this->outputLits.resize(o);
+  this->andFanin0.resize(a);
+  this->andFanin1.resize(a);
+}
+
+void FlatAig::buildFanouts() {
+
+  std::vector<std::atomic<unsigned>> cursor(this->m + 1);
+  galois::do_all(galois::iterate(0u, this->m + 1),
+                 [&](unsigned v) { cursor[v].store(0); });
+
+  galois::do_all(
+      galois::iterate(0u, this->a),
+      [&](unsigned k) {
+        cursor[this->andFanin0[k] >> 1].fetch_add(1);
+        cursor[this->andFanin1[k] >> 1].fetch_add(1);
+      },
+      galois::loopname("FlatAigCountFanouts"));
+
+  this->fanoutOffsets.resize(this->m + 2);
+  this->fanoutOffsets[0] = 0;
+  galois::do_all(galois::iterate(0u, this->m + 1), [&](unsigned v) {
+    this->fanoutOffsets[v + 1] = cursor[v].load();
+  });
+  galois::ParallelSTL::partial_sum(this->fanoutOffsets.begin(),
+                                   this->fanoutOffsets.end(),
+                                   this->fanoutOffsets.begin());
+
+  galois::do_all(galois::iterate(0u, this->m + 1), [&](unsigned v) {
+    cursor[v].store(this->fanoutOffsets[v]);
+  });
+  this->fanouts.resize(this->fanoutOffsets[this->m + 1]);
+  galois::do_all(
+      galois::iterate(0u, this->a),
+      [&](unsigned k) {
+        unsigned var = getAndVar(k);
+        this->fanouts[cursor[this->andFanin0[k] >> 1].fetch_add(1)] = var;
+        this->fanouts[cursor[this->andFanin1[k] >> 1].fetch_add(1)] = var;
+      },
+      galois::loopname("FlatAigFillFanouts"));
+
+  // Fanout lists are kept sorted so the result does not depend on scheduling
+  galois::do_all(
+      galois::iterate(0u, this->m + 1),
+      [&](unsigned v) {
+        std::sort(this->fanouts.begin() + this->fanoutOffsets[v],
+                  this->fanouts.begin() + this->fanoutOffsets[v + 1]);
+      },
+      galois::steal(), galois::loopname("FlatAigSortFanouts"));
+}
+
+void FlatAig::toAig(Aig& aig) const {
+
+  Graph& aigGraph = aig.getGraph();
+  aig.resizeNodeVectors(this->m + this->o + 1);
+  aig.setDesignName(this->designName);
+
+  // Nodes are created in the same order as AigParser::createAig
+  auto createNode = [&](int id, NodeType type) {
+    NodeData nodeData;
+    nodeData.id      = id;
+    nodeData.counter = 0;
+    nodeData.type    = type;
+    nodeData.level   = 0;
+    GNode node       = aigGraph.createNode(nodeData);
+    aigGraph.addNode(node);
+    aig.getNodes()[id] = node;
+    return node;
+  };
+
+  createNode(0, NodeType::CONSTZERO);
+  for (unsigned in = 0; in < this->i; in++) {
+    aig.getInputNodes().push_back(createNode(in + 1, NodeType::PI));
+  }
+  aig.setInputNames(this->inputNames);
+  for (unsigned in = 0; in < this->l; in++) {
+    aig.getLatchNodes().push_back(
+        createNode(this->i + in + 1, NodeType::LATCH));
+  }
+  aig.setLatchNames(this->latchNames);
+  for (unsigned in = 0; in < this->o; in++) {
+    aig.getOutputNodes().push_back(
+        createNode(this->m + in + 1, NodeType::PO));
+  }
+  aig.setOutputNames(this->outputNames);
+  for (unsigned k = 0; k < this->a; k++) {
+    createNode(getAndVar(k), NodeType::AND);
+  }
+
+  // Connecting the ANDs must follow the AIGER order since structural
+  // hashing and levels depend on it
+  for (unsigned k = 0; k < this->a; k++) {
+    GNode andNode     = aig.getNodes()[getAndVar(k)];
+    NodeData& andData = aigGraph.getData(andNode, galois::MethodFlag::WRITE);
+
+    unsigned lhsLit   = this->andFanin0[k];
+    GNode lhsNode     = aig.getNodes()[lhsLit >> 1];
+    NodeData& lhsData = aigGraph.getData(lhsNode, galois::MethodFlag::WRITE);
+    bool lhsPol       = !(lhsLit & 1);
+    lhsData.nFanout += 1;
+
+    unsigned rhsLit   = this->andFanin1[k];
+    GNode rhsNode     = aig.getNodes()[rhsLit >> 1];
+    NodeData& rhsData = aigGraph.getData(rhsNode, galois::MethodFlag::WRITE);
+    bool rhsPol       = !(rhsLit & 1);
+    rhsData.nFanout += 1;
+
+    aigGraph.getEdgeData(aigGraph.addMultiEdge(
+        lhsNode, andNode, galois::MethodFlag::UNPROTECTED)) = lhsPol;
+    aigGraph.getEdgeData(aigGraph.addMultiEdge(
+        rhsNode, andNode, galois::MethodFlag::UNPROTECTED)) = rhsPol;
+
+    aig.insertNodeInFanoutMap(andNode, lhsNode, rhsNode, lhsPol, rhsPol);
+
+    andData.level = 1 + std::max(lhsData.level, rhsData.level);
+  }
+
+  for (unsigned in = 0; in < this->l; in++) {
+    GNode latchNode     = aig.getNodes()[this->i + in + 1];
+    NodeData& latchData = aigGraph.getData(latchNode);
+    unsigned lit        = this->latchLits[in];
+    GNode inputNode     = aig.getNodes()[lit >> 1];
+    NodeData& inputData = aigGraph.getData(inputNode);
+    inputData.nFanout += 1;
+    aigGraph.getEdgeData(aigGraph.addEdge(inputNode, latchNode)) = !(lit & 1);
+    latchData.level = 1 + inputData.level;
+  }
+
+  for (unsigned in = 0; in < this->o; in++) {
+    GNode outputNode = aig.getNodes()[this->m + in + 1];
+    NodeData& outputData =
+        aigGraph.getData(outputNode, galois::MethodFlag::WRITE);
+    unsigned lit    = this->outputLits[in];
+    GNode inputNode = aig.getNodes()[lit >> 1];
+    NodeData& inputData =
+        aigGraph.getData(inputNode, galois::MethodFlag::WRITE);
+    inputData.nFanout += 1;
+    aigGraph.getEdgeData(aigGraph.addEdge(inputNode, outputNode)) = !(lit & 1);
+    outputData.level = 1 + inputData.level;
+  }
+}
+
+void FlatAig::fromAig(Aig& aig) {
+
+  aig.resetAndIds();
+
+  unsigned i = aig.getNumInputs();
+  unsigned l = aig.getNumLatches();
+  unsigned o = aig.getNumOutputs();
+  unsigned a = aig.getNumAnds();
+  resize(i + l + a, i, l, o, a);
+
+  Graph& aigGraph = aig.getGraph();
+
+  auto faninLit = [&](Graph::in_edge_iterator inEdge) {
+    NodeData& inData = aigGraph.getData(aigGraph.getEdgeDst(inEdge),
+                                        galois::MethodFlag::UNPROTECTED);
+    bool polarity =
+        aigGraph.getEdgeData(inEdge, galois::MethodFlag::UNPROTECTED);
+    return (unsigned)inData.id * 2 + (polarity ? 0 : 1);
+  };
+
+  galois::do_all(
+      galois::iterate(aigGraph),
+      [&](GNode node) {
+        NodeData& nodeData =
+            aigGraph.getData(node, galois::MethodFlag::UNPROTECTED);
+        if (nodeData.type != NodeType::AND) {
+          return;
+        }
+        auto inEdge  = aigGraph.in_edge_begin(node,
+                                             galois::MethodFlag::UNPROTECTED);
+        unsigned lhs = faninLit(inEdge);
+        inEdge++;
+        unsigned rhs = faninLit(inEdge);
+        unsigned k   = nodeData.id - (i + l + 1);
+        this->andFanin0[k] = std::max(lhs, rhs);
+        this->andFanin1[k] = std::min(lhs, rhs);
+      },
+      galois::steal(), galois::loopname("FlatAigFromAig"));
+
+  for (unsigned in = 0; in < l; in++) {
+    this->latchLits[in] = faninLit(aigGraph.in_edge_begin(
+        aig.getLatchNodes()[in], galois::MethodFlag::UNPROTECTED));
+  }
+  for (unsigned in = 0; in < o; in++) {
+    this->outputLits[in] = faninLit(aigGraph.in_edge_begin(
+        aig.getOutputNodes()[in], galois::MethodFlag::UNPROTECTED));
+  }
+
+  this->inputNames  = aig.getInputNames();
+  this->latchNames  = aig.getLatchNames();
+  this->outputNames = aig.getOutputNames();
+  this->designName  = aig.getDesignName();
+
+  buildFanouts();
+}
+
+} // namespace andInverterGraph
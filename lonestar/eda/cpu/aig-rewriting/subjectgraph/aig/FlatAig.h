@@ -0,0 +1,86 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#ifndef AIG_FLATAIG_H_
+#define AIG_FLATAIG_H_
+
+#include "Aig.h"
+
+#include <string>
+#include <vector>
+
+namespace andInverterGraph {
+
+// Compact immutable AIG built directly from (or written directly to) binary
+// AIGER. Variables follow the AIGER numbering: 0 is the constant, inputs are
+// 1..I, latches I+1..I+L and AND k is variable I+L+1+k. Fanins are AIGER
+// literals (2 * variable + complement) with andFanin0 >= andFanin1. The
+// fanout CSR lists, for every variable, the AND variables it feeds.
+class FlatAig {
+
+private:
+  unsigned m, i, l, o, a;
+  std::vector<unsigned> latchLits;
+  std::vector<unsigned> outputLits;
+  std::vector<unsigned> andFanin0;
+  std::vector<unsigned> andFanin1;
+  std::vector<unsigned> fanoutOffsets;
+  std::vector<unsigned> fanouts;
+  std::vector<std::string> inputNames;
+  std::vector<std::string> latchNames;
+  std::vector<std::string> outputNames;
+  std::string designName;
+
+public:
+  FlatAig();
+
+  void resize(unsigned m, unsigned i, unsigned l, unsigned o, unsigned a);
+  void buildFanouts();
+
+  // Conversion to and from the mutable representation. toAig must be given
+  // an empty Aig; fromAig renumbers the ANDs of aig topologically, as the
+  // AIGER writers do.
+  void toAig(Aig& aig) const;
+  void fromAig(Aig& aig);
+
+  unsigned getM() const { return m; }
+  unsigned getNumInputs() const { return i; }
+  unsigned getNumLatches() const { return l; }
+  unsigned getNumOutputs() const { return o; }
+  unsigned getNumAnds() const { return a; }
+  unsigned getAndVar(unsigned k) const { return i + l + 1 + k; }
+
+  std::vector<unsigned>& getLatchLits() { return latchLits; }
+  std::vector<unsigned>& getOutputLits() { return outputLits; }
+  std::vector<unsigned>& getAndFanin0() { return andFanin0; }
+  std::vector<unsigned>& getAndFanin1() { return andFanin1; }
+  const std::vector<unsigned>& getFanoutOffsets() const {
+    return fanoutOffsets;
+  }
+  const std::vector<unsigned>& getFanouts() const { return fanouts; }
+  std::vector<std::string>& getInputNames() { return inputNames; }
+  std::vector<std::string>& getLatchNames() { return latchNames; }
+  std::vector<std::string>& getOutputNames() { return outputNames; }
+  std::string& getDesignName() { return designName; }
+};
+
+} // namespace andInverterGraph
+
+#endif /* AIG_FLATAIG_H_ */
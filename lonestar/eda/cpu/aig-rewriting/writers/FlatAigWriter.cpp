@@ -0,0 +1,136 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "FlatAigWriter.h"
+#include "galois/Galois.h"
+
+#include <sstream>
+#include <vector>
+
+// Number of ANDs encoded by one task
+static const unsigned ANDS_PER_BLOCK = 1 << 16;
+
+static inline void encode(std::string& out, unsigned x) {
+  while (x & ~0x7f) {
+    out.push_back((char)((x & 0x7f) | 0x80));
+    x >>= 7;
+  }
+  out.push_back((char)x);
+}
+
+FlatAigWriter::FlatAigWriter(std::string path) : path(path), bytesWritten(0) {
+  aigerFile.open(path.c_str(), std::ios::trunc | std::ios::binary);
+}
+
+FlatAigWriter::~FlatAigWriter() { aigerFile.close(); }
+
+bool FlatAigWriter::isOpen() { return aigerFile.is_open(); }
+
+void FlatAigWriter::close() { aigerFile.close(); }
+
+void FlatAigWriter::write(const std::string& text) {
+  aigerFile.write(text.data(), text.size());
+  bytesWritten += text.size();
+}
+
+void FlatAigWriter::writeAig(aig::FlatAig& flatAig) {
+  writeHeader(flatAig);
+  writeLatches(flatAig);
+  writeOutputs(flatAig);
+  writeAnds(flatAig);
+  writeSymbolTable(flatAig);
+  aigerFile.flush();
+}
+
+void FlatAigWriter::writeHeader(aig::FlatAig& flatAig) {
+  std::ostringstream header;
+  header << "aig " << flatAig.getM() << " " << flatAig.getNumInputs() << " "
+         << flatAig.getNumLatches() << " " << flatAig.getNumOutputs() << " "
+         << flatAig.getNumAnds() << "\n";
+  write(header.str());
+}
+
+void FlatAigWriter::writeLatches(aig::FlatAig& flatAig) {
+  std::ostringstream latches;
+  for (unsigned lit : flatAig.getLatchLits()) {
+    latches << lit << "\n";
+  }
+  write(latches.str());
+}
+
+void FlatAigWriter::writeOutputs(aig::FlatAig& flatAig) {
+  std::ostringstream outputs;
+  for (unsigned lit : flatAig.getOutputLits()) {
+    outputs << lit << "\n";
+  }
+  write(outputs.str());
+}
+
+void FlatAigWriter::writeAnds(aig::FlatAig& flatAig) {
+
+  unsigned nAnds   = flatAig.getNumAnds();
+  unsigned nBlocks = (nAnds + ANDS_PER_BLOCK - 1) / ANDS_PER_BLOCK;
+  std::vector<std::string> blocks(nBlocks);
+  std::vector<unsigned>& fanin0 = flatAig.getAndFanin0();
+  std::vector<unsigned>& fanin1 = flatAig.getAndFanin1();
+
+  galois::do_all(
+      galois::iterate(0u, nBlocks),
+      [&](unsigned b) {
+        unsigned begin = b * ANDS_PER_BLOCK;
+        unsigned end   = std::min(nAnds, begin + ANDS_PER_BLOCK);
+        std::string& out = blocks[b];
+        out.reserve((size_t)(end - begin) * 4);
+        for (unsigned k = begin; k < end; k++) {
+          unsigned lhs = 2 * flatAig.getAndVar(k);
+          encode(out, lhs - fanin0[k]);
+          encode(out, fanin0[k] - fanin1[k]);
+        }
+      },
+      galois::steal(), galois::loopname("FlatAigEncodeAnds"));
+
+  for (std::string& block : blocks) {
+    write(block);
+  }
+}
+
+void FlatAigWriter::writeSymbolTable(aig::FlatAig& flatAig) {
+
+  std::ostringstream symbols;
+  int i = 0;
+  for (auto& inputName : flatAig.getInputNames()) {
+    symbols << "i" << i++ << " " << inputName << "\n";
+  }
+
+  i = 0;
+  for (auto& latchName : flatAig.getLatchNames()) {
+    symbols << "l" << i++ << " " << latchName << "\n";
+  }
+
+  i = 0;
+  for (auto& outputName : flatAig.getOutputNames()) {
+    symbols << "o" << i++ << " " << outputName << "\n";
+  }
+
+  symbols << "c\n" << flatAig.getDesignName() << "\n";
+  write(symbols.str());
+}
+
+size_t FlatAigWriter::getBytesWritten() const { return bytesWritten; }
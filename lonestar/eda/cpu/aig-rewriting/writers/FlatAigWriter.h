@@ -0,0 +1,58 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#ifndef FLATAIGWRITER_H_
+#define FLATAIGWRITER_H_
+
+#include <fstream>
+#include <string>
+
+#include "../subjectgraph/aig/FlatAig.h"
+
+// Parallel writer for binary AIGER files. Blocks of ANDs are delta-encoded
+// in parallel into separate buffers which are then written in order. The
+// output is byte-identical to AigWriter::writeAig.
+class FlatAigWriter {
+
+private:
+  std::ofstream aigerFile;
+  std::string path;
+  size_t bytesWritten;
+
+  void write(const std::string& text);
+
+  void writeHeader(aig::FlatAig& flatAig);
+  void writeLatches(aig::FlatAig& flatAig);
+  void writeOutputs(aig::FlatAig& flatAig);
+  void writeAnds(aig::FlatAig& flatAig);
+  void writeSymbolTable(aig::FlatAig& flatAig);
+
+public:
+  FlatAigWriter(std::string path);
+  virtual ~FlatAigWriter();
+
+  bool isOpen();
+  void close();
+
+  void writeAig(aig::FlatAig& flatAig);
+  size_t getBytesWritten() const;
+};
+
+#endif /* FLATAIGWRITER_H_ */
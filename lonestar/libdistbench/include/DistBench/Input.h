@@ -27,6 +27,7 @@
 #define GALOIS_DISTBENCH_INPUT_H
 
 #include "galois/graphs/CuSPPartitioner.h"
+#include "galois/graphs/GluonSubstrate.h"
 #include "llvm/Support/CommandLine.h"
 
 /*******************************************************************************
@@ -46,7 +47,8 @@ enum PARTITIONING_SCHEME {
   GINGER_I, //!< Ginger, incoming
   FENNEL_O, //!< Fennel, oec
   FENNEL_I, //!< Fennel, iec
-  SUGAR_O   //!< Sugar, oec
+  SUGAR_O,  //!< Sugar, oec
+  AUTO      //!< picked by a cost model; see resolveAutoPartition
 };
 
 /**
@@ -81,6 +83,8 @@ inline const char* EnumToString(PARTITIONING_SCHEME e) {
     return "fennel-iec";
   case SUGAR_O:
     return "sugar-oec";
+  case AUTO:
+    return "auto";
   default:
     GALOIS_DIE("unsupported partition scheme: ", e);
   }
@@ -109,9 +113,43 @@ extern cll::opt<std::string> localGraphFileName;
 extern cll::opt<bool> saveLocalGraph;
 //! file specifying blocking of masters
 extern cll::opt<std::string> mastersFile;
+//! max edges per streamed block during vertex-cut edge assignment; 0 = off
+extern cll::opt<uint64_t> streamBatchEdges;
 
 // @todo command line argument for read balancing across hosts
 
+/*******************************************************************************
+ * Automatic partitioning policy selection
+ ******************************************************************************/
+
+/**
+ * Declares how the app's operators access the graph, in the terms of its
+ * main sync call. Used by -partition=auto; must be called before the graph
+ * is loaded. Without it push (out-edge) loads assume writeDestination and
+ * readSource and pull (in-edge) loads writeSource and readDestination;
+ * symmetric loads count as push.
+ *
+ * @param writeLocation where the operator writes
+ * @param readLocation where the operator reads
+ */
+void setSyncPattern(WriteLocation writeLocation, ReadLocation readLocation);
+
+/**
+ * If -partition=auto, replaces it with the policy (and cartesian grid) that
+ * a replication factor and communication volume model predicts to be
+ * cheapest for the input and the app's sync pattern, and reports the
+ * prediction. Does nothing for any other policy.
+ *
+ * The model samples the degrees of the input (and of its transpose, if
+ * given), estimates the number of rounds from the degree distribution, and
+ * assumes each node's value is synchronized about once per run, as in the
+ * data-driven apps. Streaming policies (Ginger, Fennel, Sugar) are not
+ * modeled and never picked.
+ *
+ * @param iterateOut true if the app iterates over out-edges
+ */
+void resolveAutoPartition(bool iterateOut);
+
 /*******************************************************************************
  * Graph-loading functions
  ******************************************************************************/
@@ -138,6 +176,7 @@ constructSymmetricGraph(std::vector<unsigned>& GALOIS_UNUSED(scaleFactor)) {
                " please use the -symmetricGraph flag "
                " to indicate the input is a symmetric graph");
   }
+  resolveAutoPartition(true);
 
   switch (partitionScheme) {
   case OEC:
@@ -149,13 +188,15 @@ constructSymmetricGraph(std::vector<unsigned>& GALOIS_UNUSED(scaleFactor)) {
   case HIVC:
     return galois::cuspPartitionGraph<GenericHVC, NodeData, EdgeData>(
         inputFile, galois::CUSP_CSR, galois::CUSP_CSR, true,
-        inputFileTranspose);
+        inputFileTranspose, "", true, 100,
+        galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
 
   case CART_VCUT:
   case CART_VCUT_IEC:
     return galois::cuspPartitionGraph<GenericCVC, NodeData, EdgeData>(
         inputFile, galois::CUSP_CSR, galois::CUSP_CSR, true,
-        inputFileTranspose);
+        inputFileTranspose, "", true, 100,
+        galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
 
     // case CEC:
     //  return new Graph_customEdgeCut(inputFile, "", net.ID, net.Num,
@@ -207,6 +248,7 @@ constructGraph(std::vector<unsigned>& GALOIS_UNUSED(scaleFactor)) {
         inputFile, galois::CUSP_CSR, galois::CUSP_CSR, false,
         inputFileTranspose);
   }
+  resolveAutoPartition(true);
 
   switch (partitionScheme) {
   case OEC:
@@ -226,12 +268,14 @@ constructGraph(std::vector<unsigned>& GALOIS_UNUSED(scaleFactor)) {
   case HOVC:
     return galois::cuspPartitionGraph<GenericHVC, NodeData, EdgeData>(
         inputFile, galois::CUSP_CSR, galois::CUSP_CSR, false,
-        inputFileTranspose);
+        inputFileTranspose, "", true, 100,
+        galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
   case HIVC:
     if (inputFileTranspose.size()) {
       return galois::cuspPartitionGraph<GenericHVC, NodeData, EdgeData>(
           inputFile, galois::CUSP_CSC, galois::CUSP_CSR, false,
-          inputFileTranspose);
+          inputFileTranspose, "", true, 100,
+          galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
     } else {
       GALOIS_DIE("incoming hybrid cut requires transpose graph");
       break;
@@ -240,13 +284,15 @@ constructGraph(std::vector<unsigned>& GALOIS_UNUSED(scaleFactor)) {
   case CART_VCUT:
     return galois::cuspPartitionGraph<GenericCVC, NodeData, EdgeData>(
         inputFile, galois::CUSP_CSR, galois::CUSP_CSR, false,
-        inputFileTranspose);
+        inputFileTranspose, "", true, 100,
+        galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
 
   case CART_VCUT_IEC:
     if (inputFileTranspose.size()) {
       return galois::cuspPartitionGraph<GenericCVC, NodeData, EdgeData>(
           inputFile, galois::CUSP_CSC, galois::CUSP_CSR, false,
-          inputFileTranspose);
+          inputFileTranspose, "", true, 100,
+          galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
     } else {
       GALOIS_DIE("cvc incoming cut requires transpose graph");
       break;
@@ -330,6 +376,7 @@ DistGraphPtr<NodeData, EdgeData> constructGraph(std::vector<unsigned>&) {
           inputFileTranspose);
     }
   }
+  resolveAutoPartition(false);
 
   switch (partitionScheme) {
   case OEC:
@@ -349,12 +396,14 @@ DistGraphPtr<NodeData, EdgeData> constructGraph(std::vector<unsigned>&) {
   case HOVC:
     return galois::cuspPartitionGraph<GenericHVC, NodeData, EdgeData>(
         inputFile, galois::CUSP_CSR, galois::CUSP_CSC, false,
-        inputFileTranspose);
+        inputFileTranspose, "", true, 100,
+        galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
   case HIVC:
     if (inputFileTranspose.size()) {
       return galois::cuspPartitionGraph<GenericHVC, NodeData, EdgeData>(
           inputFile, galois::CUSP_CSC, galois::CUSP_CSC, false,
-          inputFileTranspose);
+          inputFileTranspose, "", true, 100,
+          galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
     } else {
       GALOIS_DIE("hivc requires transpose graph");
       break;
@@ -363,13 +412,15 @@ DistGraphPtr<NodeData, EdgeData> constructGraph(std::vector<unsigned>&) {
   case CART_VCUT:
     return galois::cuspPartitionGraph<GenericCVCColumnFlip, NodeData, EdgeData>(
         inputFile, galois::CUSP_CSR, galois::CUSP_CSC, false,
-        inputFileTranspose);
+        inputFileTranspose, "", true, 100,
+        galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
   case CART_VCUT_IEC:
     if (inputFileTranspose.size()) {
       return galois::cuspPartitionGraph<GenericCVCColumnFlip, NodeData,
-                                        EdgeData>(inputFile, galois::CUSP_CSC,
-                                                  galois::CUSP_CSC, false,
-                                                  inputFileTranspose);
+                                        EdgeData>(
+          inputFile, galois::CUSP_CSC, galois::CUSP_CSC, false,
+          inputFileTranspose, "", true, 100,
+          galois::graphs::BALANCED_EDGES_OF_MASTERS, 0, 0, streamBatchEdges);
     } else {
       GALOIS_DIE("cvc requires transpose graph");
       break;
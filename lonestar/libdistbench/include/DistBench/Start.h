@@ -27,6 +27,8 @@
 #include "galois/Version.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <fstream>
+
 #ifdef GALOIS_ENABLE_GPU
 #include "galois/cuda/HostDecls.h"
 #else
@@ -48,6 +50,14 @@ extern cll::opt<DataCommMode> commMetadata;
 //! Where to write output if output is set
 extern cll::opt<std::string> outputLocation;
 extern cll::opt<bool> output;
+//! If set, apps that support it overlap sync with interior computation
+extern cll::opt<bool> overlapComm;
+//! If set, print a partition quality report after partitioning
+extern cll::opt<bool> partitionReport;
+//! If non-empty, write the partition quality report to this file as JSON
+extern cll::opt<std::string> partitionReportFile;
+//! Size of a synchronized value used to estimate bytes per sync in the report
+extern cll::opt<unsigned> partitionReportFieldBytes;
 
 #ifdef GALOIS_ENABLE_GPU
 enum Personality { CPU, GPU_CUDA };
@@ -123,6 +133,32 @@ marshalGPUGraph(DistSubstratePtr<NodeData, EdgeData>& gluonSubstrate,
 }
 #endif
 
+/**
+ * Prints and/or writes the partition quality report of a loaded graph on
+ * host 0 if requested on the command line.
+ *
+ * @param gluonSubstrate Gluon substrate holding the gathered proxy counts
+ */
+template <typename NodeData, typename EdgeData>
+static void
+reportPartition(DistSubstratePtr<NodeData, EdgeData>& gluonSubstrate) {
+  if (galois::runtime::getHostID() != 0) {
+    return;
+  }
+  if (partitionReport) {
+    gluonSubstrate->printPartitionReport(partitionReportFieldBytes);
+  }
+  if (!partitionReportFile.empty()) {
+    std::ofstream reportFile(partitionReportFile);
+    if (!reportFile) {
+      GALOIS_DIE("failed to open partition report file ",
+                 partitionReportFile);
+    }
+    gluonSubstrate->writePartitionReport(reportFile,
+                                         partitionReportFieldBytes);
+  }
+}
+
 /**
  * Loads a graph into memory. Details/partitioning will be handled in the
  * construct graph call.
@@ -238,6 +274,7 @@ distGraphInitialization() {
   s = std::make_unique<Substrate>(*g, net.ID, net.Num, g->isTransposed(),
                                   g->cartesianGrid(), partitionAgnostic,
                                   commMetadata);
+  reportPartition(s);
 
 // marshal graph to GPU as necessary
 #ifdef GALOIS_ENABLE_GPU
@@ -283,6 +320,7 @@ symmetricDistGraphInitialization() {
   s = std::make_unique<Substrate>(*g, net.ID, net.Num, g->isTransposed(),
                                   g->cartesianGrid(), partitionAgnostic,
                                   commMetadata);
+  reportPartition(s);
 
 // marshal graph to GPU as necessary
 #ifdef GALOIS_ENABLE_GPU
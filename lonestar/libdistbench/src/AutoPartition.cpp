@@ -0,0 +1,339 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2019, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file AutoPartition.cpp
+ *
+ * Cost model behind -partition=auto: predicts the replication factor and
+ * sync volume of each partitioning policy from a sample of the input's
+ * degrees and picks the cheapest.
+ */
+
+#include "DistBench/Input.h"
+#include "galois/graphs/OfflineGraph.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace {
+
+//! Cost of one message in seconds; weighs the number of sync partners
+constexpr double MESSAGE_COST = 20e-6;
+//! Cost of one byte in seconds (about 1 GB/s per host)
+constexpr double BYTE_COST = 1e-9;
+//! Bytes synchronized per proxy (one 32-bit field)
+constexpr double VALUE_BYTES = 4;
+//! Number of nodes whose degrees are sampled
+constexpr uint64_t NUM_SAMPLES = 4096;
+//! Degree above which the hybrid cuts split a node's edges (see GenericHVC)
+constexpr uint64_t HVC_THRESHOLD = 1000;
+
+WriteLocation syncWrite = writeDestination;
+ReadLocation syncRead   = readSource;
+bool syncPatternSet     = false;
+
+//! Which proxies of a node a sync phase touches, in the input's orientation
+enum ProxySet { IN_PROXIES, OUT_PROXIES, ALL_PROXIES };
+
+//! Degrees of the sampled nodes plus the summaries the model needs
+struct DegreeSample {
+  std::vector<uint64_t> out; //!< out-degree of each sampled node
+  std::vector<uint64_t> in;  //!< in-degree of each sampled node
+  //! fraction of edges whose source has out-degree <= HVC_THRESHOLD
+  double lowOutEdges;
+  //! fraction of edges whose destination has in-degree <= HVC_THRESHOLD
+  double lowInEdges;
+  //! estimated number of rounds of a traversal
+  double rounds;
+};
+
+//! A policy (and grid) with its predictions
+struct Candidate {
+  PARTITIONING_SCHEME scheme;
+  unsigned columns;        //!< cartesian grid columns; 0 if not cartesian
+  double replication = 0;
+  double bytes       = 0; //!< bytes synchronized by all hosts during a run
+  double cost        = 0;
+};
+
+uint64_t degree(galois::graphs::OfflineGraph& g, uint64_t n) {
+  return *g.edge_end(n) - *g.edge_begin(n);
+}
+
+//! Fraction of the edges counted by degs that belong to low degree nodes
+double lowDegreeEdges(const std::vector<uint64_t>& degs) {
+  double all = 0, low = 0;
+  for (uint64_t d : degs) {
+    all += d;
+    if (d <= HVC_THRESHOLD) {
+      low += d;
+    }
+  }
+  return (all > 0) ? (low / all) : 1.0;
+}
+
+/**
+ * Samples node degrees of the input. In-degrees come from the transpose when
+ * it is given and from an independent sample of out-degrees otherwise.
+ */
+DegreeSample sampleDegrees() {
+  galois::graphs::OfflineGraph g(inputFile);
+  std::unique_ptr<galois::graphs::OfflineGraph> gt;
+  if (!inputFileSymmetric && inputFileTranspose.size()) {
+    gt = std::make_unique<galois::graphs::OfflineGraph>(inputFileTranspose);
+  }
+
+  const uint64_t numNodes = g.size();
+  const uint64_t samples  = std::min(numNodes, NUM_SAMPLES);
+  // fixed seed so that every host picks the same policy
+  std::mt19937_64 gen(0);
+  std::uniform_int_distribution<uint64_t> pick(0, numNodes - 1);
+
+  DegreeSample s;
+  s.out.resize(samples);
+  s.in.resize(samples);
+  for (uint64_t i = 0; i < samples; ++i) {
+    uint64_t n = (samples == numNodes) ? i : pick(gen);
+    s.out[i]   = degree(g, n);
+    if (inputFileSymmetric) {
+      s.in[i] = s.out[i];
+    } else if (gt) {
+      s.in[i] = degree(*gt, n);
+    } else {
+      s.in[i] = degree(g, pick(gen));
+    }
+  }
+  s.lowOutEdges = lowDegreeEdges(s.out);
+  s.lowInEdges  = lowDegreeEdges(s.in);
+
+  // low-skew graphs (meshes, road networks) have diameters that grow with
+  // the square root of their size, power-law graphs with its logarithm
+  double mean = 0, var = 0;
+  for (uint64_t d : s.out) {
+    mean += d;
+  }
+  mean /= samples;
+  for (uint64_t d : s.out) {
+    var += (d - mean) * (d - mean);
+  }
+  var /= samples;
+  double avgDegree = (double)g.sizeEdges() / numNodes;
+  if (mean == 0 || std::sqrt(var) < mean) {
+    s.rounds = std::sqrt((double)numNodes);
+  } else {
+    s.rounds = std::log((double)numNodes) / std::log(std::max(avgDegree, 2.0));
+  }
+  s.rounds = std::max(s.rounds, 1.0);
+  return s;
+}
+
+//! Expected number of distinct hosts out of k that d random edges touch,
+//! counted as a fraction of k
+double spread(double d, double k) { return 1.0 - std::pow(1.0 - 1.0 / k, d); }
+
+//! Translates the app's sync locations to proxy sets of the input graph
+ProxySet writeSet(bool iterateOut) {
+  ProxySet s = (syncWrite == writeDestination) ? IN_PROXIES
+               : (syncWrite == writeSource)    ? OUT_PROXIES
+                                               : ALL_PROXIES;
+  if (!iterateOut && s != ALL_PROXIES) {
+    // in-edge loads swap the roles of source and destination
+    s = (s == IN_PROXIES) ? OUT_PROXIES : IN_PROXIES;
+  }
+  return s;
+}
+
+//! Translates the app's read location to a proxy set of the input graph
+ProxySet readSet(bool iterateOut) {
+  ProxySet s = (syncRead == readSource)        ? OUT_PROXIES
+               : (syncRead == readDestination) ? IN_PROXIES
+                                               : ALL_PROXIES;
+  if (!iterateOut && s != ALL_PROXIES) {
+    s = (s == IN_PROXIES) ? OUT_PROXIES : IN_PROXIES;
+  }
+  return s;
+}
+
+/**
+ * Predicts replication factor, sync bytes, and cost of a policy.
+ *
+ * @param c candidate whose scheme and columns are set
+ * @param s degree sample
+ * @param numNodes nodes in the input
+ * @param numHosts hosts in the run
+ * @param writes proxies reduced by the app's syncs
+ * @param reads proxies broadcast by the app's syncs
+ */
+void evaluate(Candidate& c, const DegreeSample& s, uint64_t numNodes,
+              unsigned numHosts, ProxySet writes, ProxySet reads) {
+  const double others = numHosts - 1;
+  const bool cartesian =
+      (c.scheme == CART_VCUT) || (c.scheme == CART_VCUT_IEC);
+  // hosts an out-edge (in-edge) of a node may be placed on
+  double outHosts = numHosts, inHosts = numHosts;
+  if (cartesian) {
+    double columns = c.columns, rows = numHosts / c.columns;
+    outHosts = (c.scheme == CART_VCUT) ? columns : rows;
+    inHosts  = (c.scheme == CART_VCUT) ? rows : columns;
+  }
+
+  double outProxies = 0, inProxies = 0, allProxies = 0;
+  for (size_t i = 0; i < s.out.size(); ++i) {
+    double dOut = s.out[i], dIn = s.in[i], out = 0, in = 0;
+    switch (c.scheme) {
+    case OEC:
+      in = others * spread(dIn, numHosts);
+      break;
+    case IEC:
+      out = others * spread(dOut, numHosts);
+      break;
+    case HOVC:
+      // edges of high degree sources go to their destinations
+      if (dOut > HVC_THRESHOLD) {
+        out = others * spread(dOut, numHosts);
+      }
+      in = others * spread(dIn * s.lowOutEdges, numHosts);
+      break;
+    case HIVC:
+      if (dIn > HVC_THRESHOLD) {
+        in = others * spread(dIn, numHosts);
+      }
+      out = others * spread(dOut * s.lowInEdges, numHosts);
+      break;
+    default: // cartesian
+      out = (outHosts - 1) * spread(dOut, outHosts);
+      in  = (inHosts - 1) * spread(dIn, inHosts);
+      break;
+    }
+    outProxies += out;
+    inProxies += in;
+    // a cartesian row and column only share the master
+    allProxies += cartesian ? (out + in) : (out + in - out * in / others);
+  }
+  outProxies /= s.out.size();
+  inProxies /= s.out.size();
+  allProxies /= s.out.size();
+
+  auto proxies = [&](ProxySet set) {
+    return (set == IN_PROXIES)    ? inProxies
+           : (set == OUT_PROXIES) ? outProxies
+                                  : allProxies;
+  };
+  auto partners = [&](ProxySet set) -> double {
+    if (proxies(set) == 0) {
+      return 0;
+    }
+    if (!cartesian) {
+      return others;
+    }
+    return (set == IN_PROXIES)    ? (inHosts - 1)
+           : (set == OUT_PROXIES) ? (outHosts - 1)
+                                  : (inHosts + outHosts - 2);
+  };
+
+  c.replication = 1 + allProxies;
+  c.bytes = numNodes * (proxies(writes) + proxies(reads)) * VALUE_BYTES;
+  // every round pays for its messages; each value is sent about once a run
+  c.cost = s.rounds * MESSAGE_COST * (partners(writes) + partners(reads)) +
+           BYTE_COST * c.bytes / numHosts;
+}
+
+} // namespace
+
+void setSyncPattern(WriteLocation writeLocation, ReadLocation readLocation) {
+  syncWrite      = writeLocation;
+  syncRead       = readLocation;
+  syncPatternSet = true;
+}
+
+void resolveAutoPartition(bool iterateOut) {
+  if (partitionScheme != AUTO) {
+    return;
+  }
+
+  auto& net               = galois::runtime::getSystemNetworkInterface();
+  const unsigned numHosts = net.Num;
+  if (numHosts == 1) {
+    partitionScheme = OEC;
+    return;
+  }
+
+  galois::StatTimer autoTimer("AutoPartitionTime", "DistBench");
+  autoTimer.start();
+
+  if (!syncPatternSet && !iterateOut) {
+    syncWrite = writeSource;
+    syncRead  = readDestination;
+  }
+  const ProxySet writes = writeSet(iterateOut);
+  const ProxySet reads  = readSet(iterateOut);
+
+  DegreeSample sample = sampleDegrees();
+  uint64_t numNodes   = galois::graphs::OfflineGraph(inputFile).size();
+
+  // incoming policies need the transpose unless the input is symmetric, in
+  // which case they match the outgoing ones
+  std::vector<Candidate> candidates{{OEC, 0}, {HOVC, 0}};
+  bool incoming = !inputFileSymmetric && inputFileTranspose.size();
+  if (incoming) {
+    candidates.push_back({IEC, 0});
+    candidates.push_back({HIVC, 0});
+  }
+  for (unsigned columns = 2; columns < numHosts; ++columns) {
+    if ((numHosts % columns) == 0) {
+      candidates.push_back({CART_VCUT, columns});
+      if (incoming) {
+        candidates.push_back({CART_VCUT_IEC, columns});
+      }
+    }
+  }
+
+  Candidate* best = nullptr;
+  for (Candidate& c : candidates) {
+    evaluate(c, sample, numNodes, numHosts, writes, reads);
+    if (!best || c.cost < best->cost) {
+      best = &c;
+    }
+  }
+
+  partitionScheme      = best->scheme;
+  cartesianColumnHosts = best->columns;
+  autoTimer.stop();
+
+  if (net.ID == 0) {
+    std::string grid;
+    if (best->columns) {
+      grid = " (" + std::to_string(numHosts / best->columns) + " x " +
+             std::to_string(best->columns) + " grid)";
+    }
+    galois::gPrint("Auto partitioning picked ", EnumToString(best->scheme),
+                   grid, ": predicted replication factor ", best->replication,
+                   ", predicted sync bytes ", (uint64_t)best->bytes, " over ",
+                   (uint64_t)sample.rounds, " rounds\n");
+    galois::runtime::reportParam("DistBench", "AutoPartition",
+                                 std::string(EnumToString(best->scheme)) +
+                                     grid);
+    galois::runtime::reportStat_Single("DistBench",
+                                       "PredictedReplicationFactor",
+                                       best->replication);
+    galois::runtime::reportStat_Single("DistBench", "PredictedSyncBytes",
+                                       (uint64_t)best->bytes);
+  }
+}
@@ -57,7 +57,10 @@ cll::opt<PARTITIONING_SCHEME> partitionScheme(
         clEnumValN(FENNEL_I, "fennel-i",
                    "fennel, incoming edge cut, using CuSP"),
         clEnumValN(SUGAR_O, "sugar-o",
-                   "fennel, incoming edge cut, using CuSP")),
+                   "fennel, incoming edge cut, using CuSP"),
+        clEnumValN(AUTO, "auto",
+                   "Pick the policy with a replication factor and "
+                   "communication volume cost model")),
     cll::init(OEC));
 
 cll::opt<bool> readFromFile("readFromFile",
@@ -80,3 +83,11 @@ cll::opt<bool> saveLocalGraph("saveLocalGraph",
 cll::opt<std::string> mastersFile("mastersFile",
                                   cll::desc("File specifying masters blocking"),
                                   cll::init(""), cll::Hidden);
+
+cll::opt<uint64_t> streamBatchEdges(
+    "streamBatchEdges",
+    cll::desc("Stream edges from disk in blocks of at most this many edges "
+              "while partitioning with a vertex cut, overlapping reads with "
+              "edge assignment and sends (default 0: read the whole range "
+              "up front)"),
+    cll::init(0));
@@ -61,6 +61,30 @@ cll::opt<std::string> outputLocation(
 cll::opt<bool> output("output", cll::desc("Write result (default false)"),
                       cll::init(false));
 
+cll::opt<bool> overlapComm(
+    "overlapComm",
+    cll::desc("Overlap sync of boundary nodes with computation of interior "
+              "nodes in apps that support it (default false)"),
+    cll::init(false));
+
+cll::opt<bool> partitionReport(
+    "partitionReport",
+    cll::desc("Print replication factor, per-host load imbalance, the "
+              "host-to-host mirror matrix and estimated bytes per sync after "
+              "partitioning (default false)"),
+    cll::init(false));
+
+cll::opt<std::string> partitionReportFile(
+    "partitionReportFile",
+    cll::desc("Write the partition report to this file as JSON"),
+    cll::init(""));
+
+cll::opt<unsigned> partitionReportFieldBytes(
+    "partitionReportFieldBytes",
+    cll::desc("Bytes per synchronized value used to estimate bytes per sync "
+              "in the partition report (default 4)"),
+    cll::init(4));
+
 #ifdef GALOIS_ENABLE_GPU
 std::string personality_str(Personality p) {
   switch (p) {
@@ -1,8 +1,16 @@
 #include "lonestarmine.h"
+#ifdef DFS_MINING
+#include "pangolin/DfsMining/vertex_miner.h"
+#else
 #include "pangolin/BfsMining/vertex_miner.h"
+#endif
 
 const char* name = "Kcl";
+#ifdef DFS_MINING
+const char* desc = "Counts the K-Cliques in a graph using DFS extension";
+#else
 const char* desc = "Counts the K-Cliques in a graph using BFS extension";
+#endif
 const char* url  = nullptr;
 
 #include "pangolin/BfsMining/vertex_miner_api.h"
@@ -19,11 +27,15 @@ public:
   }
 };
 
-class AppMiner : public VertexMiner<SimpleElement, BaseEmbedding, MyAPI, true> {
+#ifdef DFS_MINING
+typedef DfsVertexMiner<SimpleElement, BaseEmbedding, MyAPI, true> MinerTy;
+#else
+typedef VertexMiner<SimpleElement, BaseEmbedding, MyAPI, true> MinerTy;
+#endif
+
+class AppMiner : public MinerTy {
 public:
-  AppMiner(unsigned ms, int nt)
-      : VertexMiner<SimpleElement, BaseEmbedding, MyAPI, true>(ms, nt,
-                                                               nblocks) {
+  AppMiner(unsigned ms, int nt) : MinerTy(ms, nt, nblocks) {
     if (ms <= 2) {
       printf("ERROR: command line argument k must be 3 or greater\n");
       exit(1);
@@ -1,9 +1,18 @@
 #include "lonestarmine.h"
+#ifdef DFS_MINING
+#include "pangolin/DfsMining/vertex_miner.h"
+#else
 #include "pangolin/BfsMining/vertex_miner.h"
+#endif
 
 const char* name = "Motif Counting";
+#ifdef DFS_MINING
+const char* desc =
+    "Counts the vertex-induced motifs in a graph using DFS extension";
+#else
 const char* desc =
     "Counts the vertex-induced motifs in a graph using BFS extension";
+#endif
 const char* url     = nullptr;
 int num_patterns[3] = {2, 6, 21};
 
@@ -19,12 +28,18 @@ public:
   }
 };
 
-class AppMiner : public VertexMiner<SimpleElement, VertexEmbedding, MyAPI,
-                                    false, false, true> {
+#ifdef DFS_MINING
+typedef DfsVertexMiner<SimpleElement, VertexEmbedding, MyAPI, false, false,
+                       true>
+    MinerTy;
+#else
+typedef VertexMiner<SimpleElement, VertexEmbedding, MyAPI, false, false, true>
+    MinerTy;
+#endif
+
+class AppMiner : public MinerTy {
 public:
-  AppMiner(unsigned ms, int nt)
-      : VertexMiner<SimpleElement, VertexEmbedding, MyAPI, false, false, true>(
-            ms, nt, nblocks) {
+  AppMiner(unsigned ms, int nt) : MinerTy(ms, nt, nblocks) {
     if (ms <= 2) {
       printf("ERROR: command line argument k must be 3 or greater\n");
       exit(1);
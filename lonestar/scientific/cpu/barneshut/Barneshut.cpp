@@ -21,6 +21,7 @@
 #include "galois/Timer.h"
 #include "galois/Bag.h"
 #include "galois/Reduction.h"
+#include "galois/ParallelSTL.h"
 #include "Lonestar/BoilerPlate.h"
 #include "galois/runtime/Profile.h"
 
@@ -54,6 +55,16 @@ static llvm::cl::opt<int> seed("seed",
                                llvm::cl::desc("Random seed (default value 7)"),
                                llvm::cl::init(7));
 
+enum Engine { pointer, flat };
+
+static llvm::cl::opt<Engine> engine(
+    "engine", llvm::cl::desc("Tree representation (default value pointer):"),
+    llvm::cl::values(clEnumVal(pointer, "Octree of heap nodes, one traversal "
+                                        "per body"),
+                     clEnumVal(flat, "Linearized octree over Morton-sorted "
+                                     "bodies, one traversal per leaf")),
+    llvm::cl::init(pointer));
+
 struct Node {
   Point pos;
   double mass;
@@ -294,8 +305,10 @@ struct ComputeForces {
     Frame(Octree* _node, double _dsq) : dsq(_dsq), node(_node) {}
   };
 
+  size_t ninter = 0, nb = 0;
   template <typename Context>
   void iterate(Body& b, Context& cnx) {
+    if (++nb % 10000 == 0) std::cerr << "pavg " << ninter / nb << " root " << root_dsq << "\n";
     std::deque<Frame, galois::PerIterAllocTy::rebind<Frame>::other> stack(
         cnx.getPerIterAlloc());
     stack.push_back(Frame(top, root_dsq));
@@ -310,6 +323,7 @@ struct ComputeForces {
       // Node is far enough away, summarize contribution
       if (psq >= f.dsq) {
         b.acc += updateForce(p, psq, f.node->mass);
+        ++ninter;
         continue;
       }
 
@@ -322,6 +336,7 @@ struct ComputeForces {
           if (static_cast<const Node*>(&b) != n) {
             Point p = b.pos - n->pos;
             b.acc += updateForce(p, p.dist2(), n->mass);
+            ++ninter;
           }
         } else {
 #ifndef GALOIS_CXX11_DEQUE_HAS_NO_EMPLACE
@@ -336,6 +351,314 @@ struct ComputeForces {
   }
 };
 
+/**
+ * Barnes-Hut over a linearized octree. Bodies are sorted by Morton code and
+ * copied into SoA arrays, so every octree node owns a contiguous range of
+ * them. The tree is built level by level: each node finds its children by
+ * binary searching its range for the next 3-bit digit, and the children of
+ * all nodes of a level are laid out contiguously after a prefix sum.
+ *
+ * Forces are computed per leaf: the bodies of a leaf share one traversal
+ * that opens a node unless it is far enough from the bounding box of the
+ * whole leaf. The traversal produces an interaction list of masses (node
+ * summaries and bodies of nearby leaves) that is then applied to each body
+ * of the leaf by a vectorizable loop.
+ */
+struct FlatOctree {
+  static const unsigned MAX_LEVEL = 21; // bits per axis in a Morton code
+  static const unsigned LEAF_SIZE = 1;
+  static const uint32_t NO_CHILD  = std::numeric_limits<uint32_t>::max();
+
+  // bodies in Morton order
+  std::vector<Body*> bodyPtrs;
+  std::vector<std::pair<uint64_t, uint32_t>> codes;
+  std::vector<double> bx, by, bz, bm;
+
+  // nodes in breadth first order; children of a node are contiguous
+  std::vector<uint32_t> begin, end, firstChild;
+  std::vector<uint8_t> numChildren;
+  std::vector<double> cx, cy, cz, cm;
+  std::vector<size_t> levelStart; // nodes of level l: [levelStart[l], [l+1])
+
+  double rootDsq;
+
+  struct InteractionList {
+    std::vector<double> x, y, z, m;
+    std::vector<std::pair<uint32_t, unsigned>> stack;
+
+    void clear() {
+      x.clear();
+      y.clear();
+      z.clear();
+      m.clear();
+    }
+
+    void push(double px, double py, double pz, double pm) {
+      x.push_back(px);
+      y.push_back(py);
+      z.push_back(pz);
+      m.push_back(pm);
+    }
+  };
+
+  galois::substrate::PerThreadStorage<InteractionList> lists;
+
+  explicit FlatOctree(BodyPtrs& pBodies)
+      : bodyPtrs(pBodies.begin(), pBodies.end()) {}
+
+  //! Spreads the low 21 bits of v so that there are two zeros between bits
+  static uint64_t spreadBits(uint64_t v) {
+    v &= 0x1FFFFF;
+    v = (v | v << 32) & 0x1F00000000FFFFULL;
+    v = (v | v << 16) & 0x1F0000FF0000FFULL;
+    v = (v | v << 8) & 0x100F00F00F00F00FULL;
+    v = (v | v << 4) & 0x10C30C30C30C30C3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+  }
+
+  //! Digit (child index) of code at the given level
+  static unsigned digit(uint64_t code, unsigned level) {
+    return (code >> (3 * (MAX_LEVEL - 1 - level))) & 7;
+  }
+
+  void sortBodies(const BoundingBox& box) {
+    size_t n     = bodyPtrs.size();
+    Point extent = box.max - box.min;
+    double side  = std::max(extent[0], std::max(extent[1], extent[2]));
+    double scale = side > 0 ? ((1 << MAX_LEVEL) - 1) / side : 0;
+
+    // cells of level l are side / 2^l wide
+    rootDsq = side * side * config.itolsq;
+
+    codes.resize(n);
+    galois::do_all(
+        galois::iterate(size_t{0}, n),
+        [&](size_t i) {
+          const Point& p = bodyPtrs[i]->pos;
+          uint64_t code  = 0;
+          for (int d = 0; d < 3; ++d)
+            code |= spreadBits((uint64_t)((p[d] - box.min[d]) * scale)) << d;
+          codes[i] = std::make_pair(code, (uint32_t)i);
+        },
+        galois::loopname("MortonCodes"));
+
+    galois::ParallelSTL::sort(codes.begin(), codes.end());
+
+    bx.resize(n);
+    by.resize(n);
+    bz.resize(n);
+    bm.resize(n);
+    galois::do_all(
+        galois::iterate(size_t{0}, n),
+        [&](size_t i) {
+          const Body* b = bodyPtrs[codes[i].second];
+          bx[i]         = b->pos[0];
+          by[i]         = b->pos[1];
+          bz[i]         = b->pos[2];
+          bm[i]         = b->mass;
+        },
+        galois::loopname("GatherBodies"));
+  }
+
+  //! Calls fn(digit, begin, end) for every nonempty child range of node
+  template <typename F>
+  void forEachChildRange(uint32_t node, unsigned level, const F& fn) const {
+    auto first = codes.begin() + begin[node];
+    auto last  = codes.begin() + end[node];
+    while (first != last) {
+      unsigned d = digit(first->first, level);
+      auto next  = std::partition_point(first, last, [&](const auto& c) {
+        return digit(c.first, level) == d;
+      });
+      fn(d, first - codes.begin(), next - codes.begin());
+      first = next;
+    }
+  }
+
+  void build() {
+    begin.assign(1, 0);
+    end.assign(1, bodyPtrs.size());
+    levelStart.assign(1, 0);
+
+    for (unsigned level = 0;; ++level) {
+      size_t levelBegin = levelStart.back();
+      size_t levelEnd   = begin.size();
+      levelStart.push_back(levelEnd);
+      if (levelBegin == levelEnd)
+        break;
+
+      numChildren.resize(levelEnd);
+      firstChild.resize(levelEnd);
+
+      galois::do_all(
+          galois::iterate(levelBegin, levelEnd),
+          [&](size_t node) {
+            unsigned count = 0;
+            if (end[node] - begin[node] > LEAF_SIZE && level < MAX_LEVEL)
+              forEachChildRange(node, level,
+                                [&](unsigned, uint32_t, uint32_t) { ++count; });
+            numChildren[node] = count;
+          },
+          galois::steal(), galois::loopname("CountChildren"));
+
+      size_t next = levelEnd;
+      for (size_t node = levelBegin; node < levelEnd; ++node) {
+        firstChild[node] = numChildren[node] ? next : NO_CHILD;
+        next += numChildren[node];
+      }
+
+      begin.resize(next);
+      end.resize(next);
+      galois::do_all(
+          galois::iterate(levelBegin, levelEnd),
+          [&](size_t node) {
+            if (!numChildren[node])
+              return;
+            uint32_t child = firstChild[node];
+            forEachChildRange(node, level,
+                              [&](unsigned, uint32_t b, uint32_t e) {
+                                begin[child] = b;
+                                end[child]   = e;
+                                ++child;
+                              });
+          },
+          galois::steal(), galois::loopname("LinkChildren"));
+    }
+    levelStart.pop_back(); // the empty level
+  }
+
+  void summarize() {
+    size_t numNodes = begin.size();
+    cx.resize(numNodes);
+    cy.resize(numNodes);
+    cz.resize(numNodes);
+    cm.resize(numNodes);
+
+    for (size_t level = levelStart.size() - 1; level-- > 0;) {
+      galois::do_all(
+          galois::iterate(levelStart[level], levelStart[level + 1]),
+          [&](size_t node) {
+            double x = 0, y = 0, z = 0, m = 0;
+            if (numChildren[node]) {
+              for (uint32_t c = firstChild[node],
+                            e = firstChild[node] + numChildren[node];
+                   c < e; ++c) {
+                x += cx[c] * cm[c];
+                y += cy[c] * cm[c];
+                z += cz[c] * cm[c];
+                m += cm[c];
+              }
+            } else {
+              for (uint32_t i = begin[node]; i < end[node]; ++i) {
+                x += bx[i] * bm[i];
+                y += by[i] * bm[i];
+                z += bz[i] * bm[i];
+                m += bm[i];
+              }
+            }
+            cm[node] = m;
+            if (m > 0.0) {
+              cx[node] = x / m;
+              cy[node] = y / m;
+              cz[node] = z / m;
+            }
+          },
+          galois::steal(), galois::loopname("Summarize"));
+    }
+  }
+
+  //! Fills the interaction list of the bodies in [first, last)
+  void traverse(uint32_t first, uint32_t last, InteractionList& list) const {
+    double lo[3] = {bx[first], by[first], bz[first]};
+    double hi[3] = {bx[first], by[first], bz[first]};
+    for (uint32_t i = first + 1; i < last; ++i) {
+      const double p[3] = {bx[i], by[i], bz[i]};
+      for (int d = 0; d < 3; ++d) {
+        lo[d] = std::min(lo[d], p[d]);
+        hi[d] = std::max(hi[d], p[d]);
+      }
+    }
+
+    list.clear();
+    list.stack.clear();
+    list.stack.emplace_back(0, 0);
+    while (!list.stack.empty()) {
+      uint32_t node;
+      unsigned level;
+      std::tie(node, level) = list.stack.back();
+      list.stack.pop_back();
+
+      // squared distance from the center of mass to the closest body
+      const double c[3] = {cx[node], cy[node], cz[node]};
+      double psq        = 0;
+      for (int d = 0; d < 3; ++d) {
+        double delta = std::max(0.0, std::max(lo[d] - c[d], c[d] - hi[d]));
+        psq += delta * delta;
+      }
+
+      if (psq >= std::ldexp(rootDsq, -2 * (int)level)) {
+        list.push(c[0], c[1], c[2], cm[node]);
+      } else if (!numChildren[node]) {
+        for (uint32_t i = begin[node]; i < end[node]; ++i)
+          list.push(bx[i], by[i], bz[i], bm[i]);
+      } else {
+        for (uint32_t ch = firstChild[node] + numChildren[node];
+             ch-- > firstChild[node];)
+          list.stack.emplace_back(ch, level + 1);
+      }
+    }
+  }
+
+  //! Same as updateForce, over a whole interaction list
+  static Point applyList(const Point& pos, const InteractionList& list) {
+    const double* lx = list.x.data();
+    const double* ly = list.y.data();
+    const double* lz = list.z.data();
+    const double* lm = list.m.data();
+    double ax = 0, ay = 0, az = 0;
+    for (size_t j = 0, e = list.x.size(); j < e; ++j) {
+      double dx    = pos[0] - lx[j];
+      double dy    = pos[1] - ly[j];
+      double dz    = pos[2] - lz[j];
+      double psq   = dx * dx + dy * dy + dz * dz;
+      double idr   = 1 / std::sqrt((float)(psq + config.epssq));
+      double scale = lm[j] * idr * idr * idr;
+      // a body's own entry has delta 0 and adds nothing
+      ax += dx * scale;
+      ay += dy * scale;
+      az += dz * scale;
+    }
+    return Point(ax, ay, az);
+  }
+
+  void computeForces() {
+    std::vector<uint32_t> leaves;
+    for (size_t node = 0; node < begin.size(); ++node)
+      if (!numChildren[node])
+        leaves.push_back(node);
+
+    galois::do_all(
+        galois::iterate(leaves),
+        [&](uint32_t leaf) {
+          InteractionList& list = *lists.getLocal();
+          traverse(begin[leaf], end[leaf], list);
+          static size_t tot = 0, cnt = 0; tot += list.x.size(); if (++cnt % 1000 == 0) std::cerr << "avg " << tot / cnt << " root " << rootDsq << " leafsize " << end[leaf]-begin[leaf] << "\n";
+
+          for (uint32_t i = begin[leaf]; i < end[leaf]; ++i) {
+            Body* b = bodyPtrs[codes[i].second];
+            Point p = b->acc;
+            b->acc  = applyList(Point(bx[i], by[i], bz[i]), list);
+            b->vel += (b->acc - p) * config.dthf;
+          }
+        },
+        galois::steal(), galois::chunk_size<4>(),
+        galois::loopname("compute"));
+  }
+
+  Point centerOfMass() const { return Point(cx[0], cy[0], cz[0]); }
+};
+
 struct centerXCmp {
   template <typename T>
   bool operator()(const T& lhs, const T& rhs) const {
@@ -477,6 +800,10 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
                        galois::runtime::pagePoolSize());
   galois::reportPageAlloc("MeminfoPre");
 
+  std::unique_ptr<FlatOctree> flatTree;
+  if (engine == flat)
+    flatTree.reset(new FlatOctree(pBodies));
+
   for (int step = 0; step < ntimesteps; step++) {
 
     auto mergeBoxes = [](const BoundingBox& lhs, const BoundingBox& rhs) {
@@ -494,39 +821,63 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
         galois::loopname("reduceBoxes"));
 
     BoundingBox box = boxes.reduce();
-
-    Tree t;
-    BuildOctree treeBuilder{t};
-    Octree& top = t.emplace(box.center());
+    Point centerOfMass;
 
     galois::StatTimer T_build("BuildTime");
-    T_build.start();
-    galois::do_all(
-        galois::iterate(pBodies),
-        [&](Body* body) { treeBuilder.insert(body, &top, box.radius()); },
-        galois::loopname("BuildTree"));
-    T_build.stop();
-
-    // update centers of mass in tree
-    galois::timeThis(
-        [&](void) {
-          unsigned size = computeCenterOfMass(&top);
-          // printTree(&top);
-          std::cout << "Tree Size: " << size << "\n";
-        },
-        "summarize-Serial");
+    galois::StatTimer T_compute("ComputeTime");
 
-    ComputeForces cf(&top, box.diameter());
+    if (engine == flat) {
+      T_build.start();
+      flatTree->sortBodies(box);
+      flatTree->build();
+      T_build.stop();
 
-    galois::StatTimer T_compute("ComputeTime");
-    T_compute.start();
-    galois::for_each(
-        galois::iterate(pBodies),
-        [&](Body* b, auto& cnx) { cf.computeForce(b, cnx); },
-        galois::loopname("compute"), galois::wl<WLL>(),
-        galois::disable_conflict_detection(), galois::no_pushes(),
-        galois::per_iter_alloc());
-    T_compute.stop();
+      galois::timeThis(
+          [&](void) {
+            flatTree->summarize();
+            std::cout << "Tree Size: " << flatTree->begin.size() << "\n";
+          },
+          "summarize");
+
+      T_compute.start();
+      flatTree->computeForces();
+      T_compute.stop();
+
+      centerOfMass = flatTree->centerOfMass();
+    } else {
+      Tree t;
+      BuildOctree treeBuilder{t};
+      Octree& top = t.emplace(box.center());
+
+      T_build.start();
+      galois::do_all(
+          galois::iterate(pBodies),
+          [&](Body* body) { treeBuilder.insert(body, &top, box.radius()); },
+          galois::loopname("BuildTree"));
+      T_build.stop();
+
+      // update centers of mass in tree
+      galois::timeThis(
+          [&](void) {
+            unsigned size = computeCenterOfMass(&top);
+            // printTree(&top);
+            std::cout << "Tree Size: " << size << "\n";
+          },
+          "summarize-Serial");
+
+      ComputeForces cf(&top, box.diameter());
+
+      T_compute.start();
+      galois::for_each(
+          galois::iterate(pBodies),
+          [&](Body* b, auto& cnx) { cf.computeForce(b, cnx); },
+          galois::loopname("compute"), galois::wl<WLL>(),
+          galois::disable_conflict_detection(), galois::no_pushes(),
+          galois::per_iter_alloc());
+      T_compute.stop();
+
+      centerOfMass = top.pos;
+    }
 
     if (!skipVerify) {
       galois::timeThis(
@@ -554,7 +905,7 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
     std::ios::fmtflags flags =
         std::cout.setf(std::ios::showpos | std::ios::right |
                        std::ios::scientific | std::ios::showpoint);
-    std::cout << top.pos;
+    std::cout << centerOfMass;
     std::cout.flags(flags);
     std::cout << "\n";
   }
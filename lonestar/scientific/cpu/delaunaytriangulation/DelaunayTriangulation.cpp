@@ -23,6 +23,7 @@
 
 #include "galois/Galois.h"
 #include "galois/Bag.h"
+#include "galois/ParallelSTL.h"
 #include "galois/Timer.h"
 #include "galois/graphs/SpatialTree.h"
 #include "Lonestar/BoilerPlate.h"
@@ -63,22 +64,36 @@ static cll::opt<bool>
     meshGraph("meshGraph", cll::desc("Specify that the input graph is a mesh"),
               cll::init(false));
 
+enum PointOrder { divide, brio };
+
+static cll::opt<PointOrder> pointOrder(
+    "pointOrder", cll::desc("Order in which points are inserted:"),
+    cll::values(clEnumVal(divide, "Recursive quadrant split, each point "
+                                  "located through a spatial tree"),
+                clEnumVal(brio, "Biased randomized rounds sorted along a "
+                                "Hilbert curve, each point located by "
+                                "walking from the last point inserted by "
+                                "the thread (default)")),
+    cll::init(brio));
+
 using Tree = typename galois::graphs::SpatialTree2d<Point*>;
 
 //! All Point* refer to elements in this bag
 using basePointBag = typename galois::InsertBag<Point>;
 
-//! [Define Insert Bag]
-using ptrPointBag = typename galois::InsertBag<Point*>;
+//! Points to insert, split into rounds that are inserted one after another
+using PointRounds = std::vector<std::vector<Point*>>;
 
 //! Our main functor
 struct Process {
   Graph& graph;
   Tree& tree;
-  ptrPointBag& ptrPoints;
+  PointRounds& rounds;
+  //! last point inserted by each thread; walks start from its triangle
+  galois::substrate::PerThreadStorage<Point*> lastPoint;
 
-  Process(Graph& g, Tree& t, ptrPointBag& p)
-      : graph(g), tree(t), ptrPoints(p) {}
+  Process(Graph& g, Tree& t, PointRounds& r, Point* boundary)
+      : graph(g), tree(t), rounds(r), lastPoint(boundary) {}
 
   typedef galois::PerIterAllocTy Alloc;
 
@@ -178,13 +193,20 @@ struct Process {
   }
 
   bool findContainingElement(const Point* p, GNode& node) {
-    Point** rp = tree.find(p->t().x(), p->t().y());
-    if (!rp)
-      return false;
+    Point* start;
+    if (pointOrder == divide) {
+      Point** rp = tree.find(p->t().x(), p->t().y());
+      if (!rp)
+        return false;
+      start = *rp;
+    } else {
+      // consecutive points are close along the Hilbert curve
+      start = *lastPoint.getLocal();
+    }
 
-    (*rp)->get(galois::MethodFlag::WRITE);
+    start->get(galois::MethodFlag::WRITE);
 
-    GNode someNode = (*rp)->someElement();
+    GNode someNode = start->someElement();
 
     // Not in mesh yet
     if (!someNode) {
@@ -195,10 +217,10 @@ struct Process {
     return planarSearch(p, someNode, node);
   }
 
-  void generateMesh() {
+  void insertRound(std::vector<Point*>& points) {
     typedef galois::worklists::PerThreadChunkLIFO<32> CA;
     galois::for_each(
-        galois::iterate(ptrPoints),
+        galois::iterate(points),
         [&, self = this](Point* p, auto& ctx) {
           p->get(galois::MethodFlag::WRITE);
           assert(!p->inMesh());
@@ -220,11 +242,21 @@ struct Process {
           cav.init(node, p);
           cav.build();
           cav.update();
-          self->tree.insert(p->t().x(), p->t().y(), p);
+          if (pointOrder == divide) {
+            self->tree.insert(p->t().x(), p->t().y(), p);
+          } else {
+            *self->lastPoint.getLocal() = p;
+          }
         },
         galois::no_pushes(), galois::per_iter_alloc(), galois::loopname("Main"),
         galois::wl<CA>());
   }
+
+  void generateMesh() {
+    for (auto& round : rounds) {
+      insertRound(round);
+    }
+  }
 };
 
 typedef std::vector<Point> PointList;
@@ -335,16 +367,41 @@ public:
   }
 };
 
+//! Position of (x, y) along a Hilbert curve filling a 2^order square
+static uint64_t hilbertIndex(uint32_t x, uint32_t y, unsigned order) {
+  uint32_t n = 1u << order;
+  uint64_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += (uint64_t)s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
 struct ReadInput {
+  //! bits per coordinate of the Hilbert curve
+  static const unsigned HILBERT_ORDER = 16;
+  //! smallest number of points worth a BRIO round of its own
+  static const size_t BRIO_MIN_ROUND = 1024;
+
   Graph& graph;
   Tree& tree;
   basePointBag& basePoints;
-  ptrPointBag& ptrPoints;
+  PointRounds& rounds;
+  Point* boundaryPoint = nullptr;
   std::random_device rng;
   std::mt19937 urng;
 
-  ReadInput(Graph& g, Tree& t, basePointBag& b, ptrPointBag& p)
-      : graph(g), tree(t), basePoints(b), ptrPoints(p), urng(rng()) {}
+  ReadInput(Graph& g, Tree& t, basePointBag& b, PointRounds& r)
+      : graph(g), tree(t), basePoints(b), rounds(r), urng(rng()) {}
 
   void addBoundaryNodes(Point* p1, Point* p2, Point* p3) {
     Element large_triangle(p1, p2, p3);
@@ -415,19 +472,107 @@ struct ReadInput {
     }
   }
 
+  /**
+   * Biased randomized insertion order: every point picks a round at random,
+   * the last round getting half of the points, the one before it a quarter,
+   * and so on. Rounds are inserted from the smallest to the largest, and the
+   * points of a round follow a Hilbert curve, so a point is usually close to
+   * the one inserted before it while the mesh still grows evenly.
+   *
+   * @returns point indices in insertion order; rounds[r] is resized to the
+   * size of round r
+   */
+  std::vector<uint32_t> brioOrder(const PointList& points, size_t num) {
+    size_t numRounds = 1;
+    while ((num >> numRounds) >= BRIO_MIN_ROUND)
+      ++numRounds;
+
+    double minX, minY, maxX, maxY;
+    minX = maxX = points[0].t().x();
+    minY = maxY = points[0].t().y();
+    for (size_t i = 1; i < num; ++i) {
+      minX = std::min(minX, points[i].t().x());
+      maxX = std::max(maxX, points[i].t().x());
+      minY = std::min(minY, points[i].t().y());
+      maxY = std::max(maxY, points[i].t().y());
+    }
+    double cells = (1u << HILBERT_ORDER) - 1;
+    double scale = cells / std::max(maxX - minX, maxY - minY);
+    if (!std::isfinite(scale))
+      scale = 0;
+
+    // key = round << 32 | Hilbert index
+    std::vector<std::pair<uint64_t, uint32_t>> keys(num);
+    uint64_t seed = urng();
+    galois::do_all(
+        galois::iterate(size_t{0}, num),
+        [&](size_t i) {
+          uint64_t h = seed + i * 0x9E3779B97F4A7C15ULL;
+          h          = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+          h          = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+          h ^= h >> 31;
+          size_t level = std::min<size_t>(__builtin_ctzll(h | (1ULL << 63)),
+                                          numRounds - 1);
+          uint64_t round = numRounds - 1 - level;
+
+          uint32_t x = (points[i].t().x() - minX) * scale;
+          uint32_t y = (points[i].t().y() - minY) * scale;
+          keys[i]    = std::make_pair(
+              (round << 32) | hilbertIndex(x, y, HILBERT_ORDER), (uint32_t)i);
+        },
+        galois::steal(), galois::loopname("HilbertKeys"));
+
+    galois::ParallelSTL::sort(keys.begin(), keys.end());
+
+    rounds.resize(numRounds);
+    auto roundBegin = keys.begin();
+    for (size_t r = 0; r < numRounds; ++r) {
+      auto roundEnd = std::lower_bound(
+          roundBegin, keys.end(), std::make_pair((r + 1) << 32, uint32_t{0}));
+      rounds[r].resize(roundEnd - roundBegin);
+      roundBegin = roundEnd;
+    }
+
+    std::vector<uint32_t> order(num);
+    galois::do_all(
+        galois::iterate(size_t{0}, num),
+        [&](size_t i) { order[i] = keys[i].second; }, galois::steal());
+    return order;
+  }
+
   void layoutPoints(PointList& points) {
-    divide(points.begin(), points.end() - 3);
-    galois::do_all(galois::iterate(points.begin(), points.end() - 3),
-                   [&](Point& p) {
-                     Point* pr = &basePoints.push(p);
-                     ptrPoints.push(pr);
-                   });
+    size_t num = points.size() - 3;
+    std::vector<uint32_t> order;
+
+    if (pointOrder == ::divide) {
+      divide(points.begin(), points.end() - 3);
+      rounds.resize(1);
+      rounds[0].resize(num);
+    } else {
+      order = brioOrder(points, num);
+    }
+
+    // flatten the rounds so that point i of the order goes to slot i
+    std::vector<Point**> slots;
+    slots.reserve(num);
+    for (auto& round : rounds)
+      for (auto& slot : round)
+        slots.push_back(&slot);
+
+    galois::do_all(
+        galois::iterate(size_t{0}, num),
+        [&](size_t i) {
+          Point& p  = order.empty() ? points[i] : points[order[i]];
+          *slots[i] = &basePoints.push(p);
+        },
+        galois::steal());
     //! [Insert elements into InsertBag]
     Point* p1 = &basePoints.push(*(points.end() - 1));
     Point* p2 = &basePoints.push(*(points.end() - 2));
     Point* p3 = &basePoints.push(*(points.end() - 3));
     //! [Insert elements into InsertBag]
     addBoundaryNodes(p1, p2, p3);
+    boundaryPoint = p1;
   }
 
   void operator()(const std::string& filename) {
@@ -533,14 +678,17 @@ int main(int argc, char** argv) {
   Graph graph;
   Tree tree;
   basePointBag basePoints;
-  ptrPointBag ptrPoints;
+  PointRounds rounds;
 
-  ReadInput(graph, tree, basePoints, ptrPoints)(inputFile);
+  ReadInput reader(graph, tree, basePoints, rounds);
+  reader(inputFile);
 
   galois::StatTimer execTime("Timer_0");
   execTime.start();
   galois::runtime::profileVtune(
-      [&]() { Process(graph, tree, ptrPoints).generateMesh(); },
+      [&]() {
+        Process(graph, tree, rounds, reader.boundaryPoint).generateMesh();
+      },
       "MeshGeneration");
   execTime.stop();
   std::cout << "mesh size: " << graph.size() << "\n";
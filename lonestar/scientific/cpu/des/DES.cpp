@@ -0,0 +1,212 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+
+const char* name = "Discrete-Event Simulation";
+const char* desc =
+    "Simulates a network of stations where every event schedules a later "
+    "event at another station, comparing the ordered and deterministic "
+    "executors";
+const char* url = "des";
+
+namespace cll = llvm::cl;
+
+static cll::opt<unsigned>
+    numStations("stations",
+                cll::desc("Number of stations (default value 1024)"),
+                cll::init(1024));
+static cll::opt<unsigned>
+    numEvents("events", cll::desc("Number of initial events (default value "
+                                  "10000)"),
+              cll::init(10000));
+static cll::opt<unsigned>
+    horizon("horizon",
+            cll::desc("Simulated time at which the simulation stops (default "
+                      "value 2000)"),
+            cll::init(2000));
+static cll::opt<unsigned>
+    minDelay("delay",
+             cll::desc("Minimum delay between an event and the event it "
+                       "schedules, i.e., the lookahead (default value 4)"),
+             cll::init(4));
+static cll::opt<int> seed("seed",
+                          cll::desc("Random seed (default value 0)"),
+                          cll::init(0));
+
+struct Station : public galois::runtime::Lockable {
+  std::vector<unsigned> log; //!< times of the events processed here
+};
+
+struct Event {
+  unsigned time;
+  unsigned station;
+  unsigned id; //!< the chain of events this event belongs to
+};
+
+struct EventLess {
+  bool operator()(const Event& a, const Event& b) const {
+    return a.time < b.time;
+  }
+};
+
+struct EventGreater {
+  bool operator()(const Event& a, const Event& b) const {
+    return a.time > b.time;
+  }
+};
+
+struct Simulation {
+  std::vector<Station> stations;
+
+  explicit Simulation(unsigned n) : stations(n) {}
+
+  //! processes e and returns whether it schedules a next event
+  bool process(const Event& e, Event& next) {
+    stations[e.station].log.push_back(e.time);
+    next.time    = e.time + minDelay + (e.time * 7 + e.id) % 5;
+    next.station = (e.id * 2654435761u + e.time * 40503u) % stations.size();
+    next.id      = e.id;
+    return next.time < horizon;
+  }
+
+  size_t numProcessed() const {
+    size_t n = 0;
+    for (auto& s : stations)
+      n += s.log.size();
+    return n;
+  }
+};
+
+std::vector<Event> generateEvents() {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<unsigned> station(0, numStations - 1);
+  std::uniform_int_distribution<unsigned> time(0, horizon / 4);
+  std::vector<Event> initial;
+  initial.reserve(numEvents);
+  for (unsigned i = 0; i < numEvents; ++i)
+    initial.push_back(Event{time(gen), station(gen), i});
+  return initial;
+}
+
+void runSerial(Simulation& sim, const std::vector<Event>& initial) {
+  std::priority_queue<Event, std::vector<Event>, EventGreater> pq(
+      initial.begin(), initial.end());
+  while (!pq.empty()) {
+    Event e = pq.top();
+    pq.pop();
+    Event next;
+    if (sim.process(e, next))
+      pq.push(next);
+  }
+}
+
+void runOrdered(Simulation& sim, const std::vector<Event>& initial) {
+  // an event schedules events at least minDelay later, so every event
+  // earlier than the earliest pending one plus the lookahead is safe
+  galois::for_each_ordered(
+      initial.begin(), initial.end(), EventLess(),
+      [&](const Event& e) {
+        galois::runtime::acquire(&sim.stations[e.station],
+                                 galois::MethodFlag::WRITE);
+      },
+      [&](const Event& e, galois::UserContext<Event>& ctx) {
+        Event next;
+        if (sim.process(e, next))
+          ctx.push(next);
+      },
+      [&](const Event& e, const Event& earliest) {
+        return e.time < earliest.time + minDelay;
+      },
+      "OrderedDES");
+}
+
+//! Same events under the deterministic executor, which ignores time order
+void runDeterministic(Simulation& sim, const std::vector<Event>& initial) {
+  galois::for_each(
+      galois::iterate(initial),
+      [&](const Event& e, galois::UserContext<Event>& ctx) {
+        galois::runtime::acquire(&sim.stations[e.station],
+                                 galois::MethodFlag::WRITE);
+        ctx.cautiousPoint();
+        Event next;
+        if (sim.process(e, next))
+          ctx.push(next);
+      },
+      galois::wl<galois::worklists::Deterministic<>>(),
+      galois::loopname("DeterministicDES"));
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url, nullptr);
+
+  galois::StatTimer totalTime("TimerTotal");
+  totalTime.start();
+
+  if (!numStations || !minDelay)
+    GALOIS_DIE("number of stations and delay must be positive");
+
+  std::cout << numStations << " stations, " << numEvents
+            << " initial events, horizon " << horizon << ", lookahead "
+            << minDelay << "\n";
+
+  std::vector<Event> initial = generateEvents();
+
+  Simulation ordered(numStations);
+  galois::StatTimer execTime("Timer_0");
+  execTime.start();
+  runOrdered(ordered, initial);
+  execTime.stop();
+
+  Simulation det(numStations);
+  galois::StatTimer detTime("TimerDeterministic");
+  detTime.start();
+  runDeterministic(det, initial);
+  detTime.stop();
+
+  std::cout << "Processed " << ordered.numProcessed() << " events\n";
+  std::cout << "ordered: " << execTime.get() << " ms, deterministic: "
+            << detTime.get() << " ms\n";
+
+  if (!skipVerify) {
+    Simulation serial(numStations);
+    runSerial(serial, initial);
+    for (unsigned s = 0; s < numStations; ++s) {
+      if (ordered.stations[s].log != serial.stations[s].log)
+        GALOIS_DIE("station ", s, " differs from serial simulation");
+    }
+    if (det.numProcessed() != serial.numProcessed())
+      GALOIS_DIE("deterministic executor processed ", det.numProcessed(),
+                 " events instead of ", serial.numProcessed());
+    std::cout << "Verification successful.\n";
+  }
+
+  totalTime.stop();
+
+  return 0;
+}
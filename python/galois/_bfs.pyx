@@ -167,30 +167,64 @@ cdef bool verify_bfs(Graph_CSR *graph, GNodeCSR source):
 
     gPrint(b"Max distance : ", maxDist.reduce(), b"\n")
 #
-# Main callsite for Bfs
-#        
-def bfs(int numThreads, unsigned long source, string filename):
+# Graph owned by Python, so that results can be viewed without copying
+#
+cdef class _Graph:
+    cdef Graph_CSR graph
+    # arrays the graph topology points into; kept alive with the graph
+    cdef object arrays
+
+#
+# Runs bfs on g and returns the distances as a view of the node data
+#
+cdef NodeArray run_bfs(_Graph g, int numThreads, unsigned long source):
     ## Hack: Need a better way to initialize shared
     ## memory runtime.
     sys = new SharedMemSys()
     cdef int new_numThreads = setActiveThreads(numThreads)
-    gPrint(b"Hello this is gprint\n")
     if new_numThreads != numThreads:
         print("Warning, using fewer threads than requested")
-    
+
     print("Using {0} thread(s).".format(new_numThreads))
-    cdef Graph_CSR graph
-    
+    cdef unsigned long numNodes = g.graph.size()
+    if source >= numNodes:
+        raise ValueError("source node {0} out of range".format(source))
+    gPrint(b"Using Source Node: ", source, b"\n");
+    Initialize(&g.graph, source)
+    #printValue(&g.graph)
+    #bfs_pull_topo(&g.graph)
+    bfs_sync(&g.graph, <GNodeCSR>source)
+    verify_bfs(&g.graph, <GNodeCSR>source)
+
+    cdef NodeArray dist = NodeArray()
+    dist.wrap(g, &g.graph.getData(0),
+              &g.graph.getData(1) if numNodes > 1 else NULL,
+              numNodes, sizeof(uint32_t), b"I")
+    return dist
+
+#
+# Main callsite for Bfs
+#        
+def bfs(int numThreads, unsigned long source, string filename):
+    """Runs bfs on a gr file and returns the distance of each node."""
+    g = _Graph()
     ## Read the CSR format of graph
     ## directly from disk.
-    graph.readGraphFromGRFile(filename)
-    gPrint(b"Using Source Node: ", source, b"\n");
-    Initialize(&graph, source)
-    #printValue(&graph)
-    #bfs_pull_topo(&graph)
-    bfs_sync(&graph, <GNodeCSR>source)
-    verify_bfs(&graph, <GNodeCSR>source)
-    gPrint(b"Node 1 has dist : ", graph.getData(1), b"\n")
-    
+    g.graph.readGraphFromGRFile(filename)
+    return run_bfs(g, numThreads, source)
+
+def bfs_from_arrays(int numThreads, unsigned long source,
+                    const uint64_t[::1] offsets,
+                    const uint32_t[::1] destinations):
+    """Runs bfs on a graph given by CSR arrays (numNodes + 1 offsets
+    starting at 0 and one destination per edge) and returns the distance of
+    each node. The arrays are used in place and must not change while the
+    result is alive."""
+    check_csr_arrays(offsets, destinations.shape[0])
+    g = _Graph()
+    g.arrays = (offsets, destinations)
+    g.graph.fromArrays(<uint32_t>(offsets.shape[0] - 1), <uint64_t*>&offsets[0],
+                       <uint32_t*>&destinations[0] if destinations.shape[0] else NULL)
+    return run_bfs(g, numThreads, source)
 
 
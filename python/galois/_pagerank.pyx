@@ -152,27 +152,63 @@ cdef void pagerankPullTopo(Graph *graph, uint32_t max_iterations) nogil:
     
 
 #
-# Main callsite for Pagerank
-#   
-def pagerank(int numThreads, uint32_t max_iterations, string filename):
+# Graph owned by Python, so that results can be viewed without copying
+#
+cdef class _Graph:
+    cdef Graph graph
+    # arrays the graph topology points into; kept alive with the graph
+    cdef object arrays
+
+#
+# Runs pagerank on g and returns the ranks as a view of the node data
+#
+cdef NodeArray run_pagerank(_Graph g, int numThreads, uint32_t max_iterations):
     ## Hack: Need a better way to initialize shared
     ## memory runtime.
     sys = new SharedMemSys()
     cdef int new_numThreads = setActiveThreads(numThreads)
-    gPrint(b"Running Pagerank on : ", filename, b"\n")
     if new_numThreads != numThreads:
         print("Warning, using fewer threads than requested")
-    
+
     print("Using {0} thread(s).".format(new_numThreads))
-    cdef Graph graph
-    
+
+    InitializePR(&g.graph)
+    computeOutDeg(&g.graph)
+    pagerankPullTopo(&g.graph, max_iterations)
+    #printValuePR(&g.graph)
+
+    cdef unsigned long numNodes = g.graph.size()
+    cdef NodeArray ranks = NodeArray()
+    if numNodes > 0:
+        ranks.wrap(g, &g.graph.getData(0).rank,
+                   &g.graph.getData(1).rank if numNodes > 1 else NULL,
+                   numNodes, sizeof(float), b"f")
+    else:
+        ranks.wrap(g, NULL, NULL, 0, sizeof(float), b"f")
+    return ranks
+
+#
+# Main callsite for Pagerank
+#   
+def pagerank(int numThreads, uint32_t max_iterations, string filename):
+    """Runs pagerank on a gr file and returns the rank of each node."""
+    gPrint(b"Running Pagerank on : ", filename, b"\n")
+    g = _Graph()
     ## Read the CSR format of graph
     ## directly from disk.
-    graph.readGraphFromGRFile(filename)
-    
-    InitializePR(&graph)
-    computeOutDeg(&graph)
-    pagerankPullTopo(&graph, max_iterations)
-    #printValuePR(&graph)
-    
-   
+    g.graph.readGraphFromGRFile(filename)
+    return run_pagerank(g, numThreads, max_iterations)
+
+def pagerank_from_arrays(int numThreads, uint32_t max_iterations,
+                         const uint64_t[::1] offsets,
+                         const uint32_t[::1] destinations):
+    """Runs pagerank on a graph given by CSR arrays (numNodes + 1 offsets
+    starting at 0 and one destination per edge) and returns the rank of each
+    node. The arrays are used in place and must not change while the result
+    is alive."""
+    check_csr_arrays(offsets, destinations.shape[0])
+    g = _Graph()
+    g.arrays = (offsets, destinations)
+    g.graph.fromArrays(<uint32_t>(offsets.shape[0] - 1), <uint64_t*>&offsets[0],
+                       <uint32_t*>&destinations[0] if destinations.shape[0] else NULL)
+    return run_pagerank(g, numThreads, max_iterations)
@@ -0,0 +1,61 @@
+"""
+Conversion of NumPy and Arrow arrays to the CSR arrays used by the graph
+constructors, copying only when the input cannot be used in place.
+
+Graphs take numNodes + 1 edge offsets as uint64 (starting at 0) and one
+destination per edge as uint32. int64 offsets and int32 destinations are
+reinterpreted without copying; other types are converted.
+"""
+
+import numpy as np
+
+
+def _to_numpy(array):
+    # pyarrow.Array and pyarrow.ChunkedArray
+    if hasattr(array, "combine_chunks"):
+        array = array.combine_chunks()
+    if hasattr(array, "to_numpy"):
+        if array.null_count:
+            raise ValueError("CSR arrays must not contain nulls")
+        return array.to_numpy(zero_copy_only=False)
+    return np.asarray(array)
+
+
+def _as(array, same_size, target):
+    array = np.ascontiguousarray(array)
+    if array.dtype == target:
+        return array
+    if array.dtype == same_size:
+        return array.view(target)
+    return array.astype(target)
+
+
+def csr_arrays(offsets, destinations):
+    """
+    Returns (offsets, destinations) as uint64 and uint32 NumPy arrays that
+    share memory with the inputs whenever their types allow it.
+    """
+    offsets = _as(_to_numpy(offsets), np.int64, np.uint64)
+    destinations = _as(_to_numpy(destinations), np.int32, np.uint32)
+    return offsets, destinations
+
+
+def csr_arrays_from_arrow(adjacency):
+    """
+    Returns the CSR arrays of an Arrow list (or large list) array holding the
+    neighbors of each node, e.g., a column read from Parquet.
+
+    The neighbor values are used in place. The offsets are used in place for
+    large lists; 32-bit list offsets are widened, and the offsets of sliced
+    arrays are rebased to start at 0.
+    """
+    if hasattr(adjacency, "combine_chunks"):
+        adjacency = adjacency.combine_chunks()
+    offsets = _to_numpy(adjacency.offsets)
+    first = int(offsets[0]) if len(offsets) else 0
+    last = int(offsets[-1]) if len(offsets) else 0
+    if first:
+        offsets = offsets - first
+    # values are not sliced with the list array
+    destinations = _to_numpy(adjacency.values)[first:last]
+    return csr_arrays(offsets, destinations)
@@ -1 +1,14 @@
 from ._bfs import *
+from ._bfs import bfs_from_arrays as _bfs_from_arrays
+
+
+def bfs_from_arrays(numThreads, source, offsets, destinations):
+    """
+    Runs bfs on a graph given by CSR arrays (NumPy or Arrow) and returns the
+    distances as a NumPy array backed by the node data of the graph.
+    """
+    import numpy as np
+    from .arrays import csr_arrays
+
+    offsets, destinations = csr_arrays(offsets, destinations)
+    return np.asarray(_bfs_from_arrays(numThreads, source, offsets, destinations))
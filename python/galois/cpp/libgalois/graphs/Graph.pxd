@@ -1,5 +1,6 @@
 
 from libcpp.string cimport string
+from libc.stdint cimport uint32_t, uint64_t
 from ..Galois cimport MethodFlag
 
 # Fake types to work around Cython's lack of support
@@ -88,7 +89,11 @@ cdef extern from "galois/graphs/Graph.h" namespace "galois::graphs" nogil:
         node_data& getData(unsigned long)
         node_data& getData(unsigned long, MethodFlag)
         void readGraphFromGRFile(string filename)
+        # Uses the arrays in place; they must outlive the graph.
+        void fromArrays(uint32_t, uint64_t*, uint32_t*)
+        void fromArrays(uint32_t, uint64_t*, uint32_t*, void*)
         unsigned long size()
+        unsigned long sizeEdges()
         edge_data getEdgeData(edge_iterator)
         edge_data getEdgeData(edge_iterator, MethodFlag)
 
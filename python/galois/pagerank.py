@@ -1 +1,16 @@
 from ._pagerank import *
+from ._pagerank import pagerank_from_arrays as _pagerank_from_arrays
+
+
+def pagerank_from_arrays(numThreads, max_iterations, offsets, destinations):
+    """
+    Runs pagerank on a graph given by CSR arrays (NumPy or Arrow) and returns
+    the ranks as a NumPy array backed by the node data of the graph.
+    """
+    import numpy as np
+    from .arrays import csr_arrays
+
+    offsets, destinations = csr_arrays(offsets, destinations)
+    return np.asarray(
+        _pagerank_from_arrays(numThreads, max_iterations, offsets, destinations)
+    )
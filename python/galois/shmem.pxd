@@ -16,6 +16,19 @@ from libc.math cimport fabs
 cdef class _galois_runtime_wrapper:
     cdef SharedMemSys _galois_runtime
 
+# One field of the node data of a graph, exported through the buffer
+# protocol so that numpy.asarray() views it without copying. The owner
+# (usually the object holding the graph) is kept alive by the view.
+cdef class NodeArray:
+    cdef object owner
+    cdef char *ptr
+    cdef Py_ssize_t shape[1]
+    cdef Py_ssize_t strides[1]
+    cdef Py_ssize_t itemsize
+    cdef bytes fmt
+    cdef void wrap(self, object owner, void *first, void *second,
+                   Py_ssize_t size, Py_ssize_t itemsize, bytes fmt)
+
 cdef extern from * nogil:
     # hack to bind leading arguments by value to something that can be passed
     # to for_each. The returned lambda needs to be usable after the scope
@@ -76,5 +89,6 @@ cdef extern from "algorithm" namespace "std" nogil:
 #    preincrement(data[0])
 #    gPrint("n : ", deref(data), "\n");
 
-
-
+# Checks the shape of CSR arrays passed from Python; raises ValueError.
+cdef int check_csr_arrays(const uint64_t[::1] offsets,
+                          Py_ssize_t numEdges) except -1
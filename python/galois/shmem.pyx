@@ -1,4 +1,56 @@
 # cython: cdivision = True
+from cpython.buffer cimport PyBUF_FORMAT, PyBUF_STRIDES, PyBUF_ND
+
 _galois_runtime = _galois_runtime_wrapper()
 
 
+cdef int check_csr_arrays(const uint64_t[::1] offsets,
+                          Py_ssize_t numEdges) except -1:
+    cdef Py_ssize_t numNodes = offsets.shape[0] - 1
+    if numNodes < 0:
+        raise ValueError("offsets must have one entry per node plus one")
+    if numNodes > UINT32_MAX:
+        raise ValueError("at most 2^32 - 1 nodes are supported")
+    if offsets[0] != 0:
+        raise ValueError("offsets must start at 0")
+    if offsets[numNodes] != <uint64_t>numEdges:
+        raise ValueError("last offset must be the number of destinations")
+    return 0
+
+
+cdef class NodeArray:
+    cdef void wrap(self, object owner, void *first, void *second,
+                   Py_ssize_t size, Py_ssize_t itemsize, bytes fmt):
+        # first and second point to the field of nodes 0 and 1; their
+        # distance is the size of the node data including any lock
+        self.owner = owner
+        self.ptr = <char*>first
+        self.shape[0] = size
+        self.itemsize = itemsize
+        if second != NULL:
+            self.strides[0] = <char*>second - <char*>first
+        else:
+            self.strides[0] = itemsize
+        self.fmt = fmt
+
+    def __len__(self):
+        return self.shape[0]
+
+    def __getbuffer__(self, Py_buffer *buffer, int flags):
+        if (flags & PyBUF_STRIDES) != PyBUF_STRIDES and \
+                self.strides[0] != self.itemsize:
+            raise BufferError("node fields are strided")
+        buffer.buf = self.ptr
+        buffer.obj = self
+        buffer.len = self.shape[0] * self.itemsize
+        buffer.readonly = 0
+        buffer.itemsize = self.itemsize
+        buffer.format = <char*>self.fmt if flags & PyBUF_FORMAT else NULL
+        buffer.ndim = 1
+        buffer.shape = self.shape if flags & PyBUF_ND else NULL
+        buffer.strides = self.strides if flags & PyBUF_STRIDES else NULL
+        buffer.suboffsets = NULL
+        buffer.internal = NULL
+
+    def __releasebuffer__(self, Py_buffer *buffer):
+        pass
@@ -19,7 +19,9 @@
 
 #include "galois/Galois.h"
 #include "galois/LargeArray.h"
+#include "galois/Timer.h"
 #include "galois/graphs/FileGraph.h"
+#include "galois/substrate/ThreadPool.h"
 
 #include <llvm/Support/CommandLine.h>
 
@@ -29,12 +31,20 @@
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <optional>
 #include <cstdint>
 #include <vector>
 #include <random>
 #include <string>
 
+#include <charconv>
+#include <cstring>
+#include <numeric>
+
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstdlib>
 
 // TODO: move these enums to a common location for all graph convert tools
@@ -177,7 +187,9 @@ static cll::opt<ConvertMode> convertMode(
         clEnumVal(gr2totem, "Convert binary gr totem input format"),
         clEnumVal(gr2neo4j, "Convert binary gr to a vertex/edge csv for neo4j"),
         clEnumVal(mtx2gr, "Convert matrix market format to binary gr"),
-        clEnumVal(nodelist2gr, "Convert node list to binary gr"),
+        clEnumVal(nodelist2gr,
+                  "Convert node list to binary gr (one line per node: "
+                  "<node id> <num neighbors> <neighbor id>*)"),
         clEnumVal(pbbs2gr, "Convert pbbs graph to binary gr"),
         clEnumVal(svmlight2gr, "Convert svmlight file to binary gr"),
         clEnumVal(edgelist2binary,
@@ -200,6 +212,11 @@ static cll::opt<int>
              cll::init(1));
 static cll::opt<int> maxDegree("maxDegree", cll::desc("maximum degree to keep"),
                                cll::init(2 * 1024));
+static cll::opt<unsigned>
+    numThreads("t",
+               cll::desc("Number of threads for parallel conversions "
+                         "(default value 0 uses all threads)"),
+               cll::init(0));
 
 struct Conversion {};
 struct HasOnlyVoidSpecialization {};
@@ -338,196 +355,335 @@ void skipLine(std::ifstream& infile) {
 }
 
 /**
- * Common parsing for edgelist style text files.
- *
- * src dst [weight]
- * ...
- *
- * If delim is set, this function expects that each entry is separated by delim
- * surrounded by optional whitespace.
+ * Read-only memory mapping of a whole input file.
  */
-template <typename EdgeTy>
-void convertEdgelist(const std::string& infilename,
-                     const std::string& outfilename, const bool skipFirstLine,
-                     std::optional<char> delim) {
-  typedef galois::graphs::FileGraphWriter Writer;
-  typedef galois::LargeArray<EdgeTy> EdgeData;
-  typedef typename EdgeData::value_type edge_value_type;
-
-  Writer p;
-  EdgeData edgeData;
-  std::ifstream infile(infilename.c_str());
-
-  size_t numNodes   = 0;
-  size_t numEdges   = 0;
-  size_t lineNumber = 0;
-
-  if (skipFirstLine) {
-    galois::gWarn(
-        "first line is assumed to contain labels and will be ignored\n");
-    skipLine(infile);
-    ++lineNumber;
+class MappedFile {
+  int fd;
+  char* base;
+  size_t length;
+
+public:
+  explicit MappedFile(const std::string& filename) : base(nullptr) {
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+    struct stat buf;
+    if (fstat(fd, &buf) == -1)
+      GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+    length = buf.st_size;
+    if (length > 0) {
+      void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m == MAP_FAILED)
+        GALOIS_SYS_DIE("failed mapping ", "'", filename, "'");
+      base = static_cast<char*>(m);
+      madvise(base, length, MADV_SEQUENTIAL);
+    }
   }
 
-  const bool hasDelim = static_cast<bool>(delim);
-  std::optional<size_t> skippedLine;
-  std::string line;
-  char readDelim;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
 
-  for (; std::getline(infile, line); ++lineNumber) {
-    std::stringstream iss(line);
-
-    size_t src;
-    if (!(iss >> src)) {
-      skippedLine = lineNumber;
-      continue;
-    }
-
-    if (hasDelim) {
-      if (!(iss >> readDelim) || readDelim != delim) {
-        skippedLine = lineNumber;
-        continue;
-      }
-    }
+  ~MappedFile() {
+    if (base)
+      munmap(base, length);
+    close(fd);
+  }
 
-    size_t dst;
-    if (!(iss >> dst)) {
-      skippedLine = lineNumber;
-      continue;
-    }
+  const char* begin() const { return base; }
+  const char* end() const { return base + length; }
+  size_t size() const { return length; }
+};
 
-    edge_value_type data{};
-    if (EdgeData::has_value) {
-      if (hasDelim) {
-        if (!(iss >> readDelim) || readDelim != delim) {
-          skippedLine = lineNumber;
-          continue;
-        }
-      }
+//! Returns the first line boundary at or after p
+static const char* nextLine(const char* p, const char* begin,
+                            const char* end) {
+  if (p == begin || p == end || p[-1] == '\n')
+    return p;
+  const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+  return nl ? nl + 1 : end;
+}
 
-      if (!(iss >> data)) {
-        skippedLine = lineNumber;
-        continue;
-      }
-    }
+/**
+ * Cursor over one line of text. Fields are parsed with std::from_chars,
+ * which needs no locale or stream state.
+ */
+struct LineParser {
+  const char* p;
+  const char* end;
 
-    if (infile) {
-      ++numEdges;
-      if (src > numNodes)
-        numNodes = src;
-      if (dst > numNodes)
-        numNodes = dst;
-    }
+  void skipBlanks() {
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+      ++p;
   }
 
-  if (skippedLine) {
-    galois::gWarn("ignored at least one line (line ", *skippedLine,
-                  ") because it did not match the expected format\n");
+  bool atEnd() {
+    skipBlanks();
+    return p == end;
   }
 
-  numNodes++;
-  p.setNumNodes(numNodes);
-  p.setNumEdges(numEdges);
-  p.setSizeofEdgeData(EdgeData::size_of::value);
-  edgeData.create(numEdges);
-
-  infile.clear();
-  infile.seekg(0, std::ios::beg);
-  p.phase1();
+  template <typename T>
+  bool parse(T& v) {
+    skipBlanks();
+    auto r = std::from_chars(p, end, v);
+    if (r.ec != std::errc())
+      return false;
+    p = r.ptr;
+    return true;
+  }
 
-  if (skipFirstLine) {
-    skipLine(infile);
+  bool expect(char c) {
+    skipBlanks();
+    if (p == end || *p != c)
+      return false;
+    ++p;
+    return true;
   }
+};
 
-  while (std::getline(infile, line)) {
-    std::stringstream iss(line);
+/**
+ * Parallel conversion of a text file with one or more edges per line to a
+ * binary gr.
+ *
+ * The text from dataBegin on is split into one block of whole lines per
+ * thread. parseLine(LineParser&, emit, node) calls emit(src, dst, value) for
+ * each edge on a line, may call node(id) to declare a node without edges, and
+ * returns false if the line does not match the format. A line that does not
+ * match must not emit anything, so that it is dropped as a whole.
+ * The blocks are parsed three times: to count edges and nodes, to count
+ * degrees and to place edges. Edges of a node keep the order they have in
+ * the file.
+ *
+ * @param numNodes number of nodes, or 0 to use the largest id seen plus one;
+ * set to the number of nodes written
+ * @param firstLine line number of dataBegin, used for warnings
+ * @returns number of edges
+ */
+template <typename EdgeTy, typename ParseLine>
+size_t convertText(const MappedFile& file, const char* dataBegin,
+                   size_t& numNodes, size_t firstLine, ParseLine parseLine,
+                   const std::string& outfilename) {
+  typedef galois::graphs::FileGraphWriter Writer;
+  typedef galois::LargeArray<EdgeTy> EdgeData;
+  typedef typename EdgeData::value_type edge_value_type;
 
-    size_t src;
-    if (!(iss >> src)) {
-      continue;
+  const char* dataEnd = file.end();
+  unsigned numThreads = galois::getActiveThreads();
+
+  auto forEachLine = [&](unsigned tid, auto f) {
+    size_t len = dataEnd - dataBegin;
+    const char* b =
+        nextLine(dataBegin + len * tid / numThreads, dataBegin, dataEnd);
+    const char* e =
+        nextLine(dataBegin + len * (tid + 1) / numThreads, dataBegin, dataEnd);
+    while (b < e) {
+      const char* nl = static_cast<const char*>(std::memchr(b, '\n', e - b));
+      const char* lineEnd = nl ? nl : e;
+      f(b, lineEnd);
+      b = lineEnd + 1;
     }
+  };
 
-    if (hasDelim) {
-      if (!(iss >> readDelim) || readDelim != delim) {
-        continue;
-      }
+  // pass 1: count edges, lines and the largest id per thread
+  std::vector<size_t> threadEdges(numThreads + 1, 0);
+  std::vector<size_t> threadLines(numThreads + 1, 0);
+  std::vector<size_t> threadMaxId(numThreads, 0);
+  std::vector<size_t> threadSkipped(numThreads, 0);
+  std::vector<size_t> threadFirstSkipped(numThreads, 0);
+
+  galois::Timer parseTimer;
+  parseTimer.start();
+  galois::on_each([&](unsigned tid, unsigned) {
+    size_t edges = 0, lines = 0, maxId = 0, skipped = 0;
+    auto emit = [&](size_t src, size_t dst, edge_value_type) {
+      ++edges;
+      maxId = std::max(maxId, std::max(src, dst));
+    };
+    auto node = [&](size_t id) { maxId = std::max(maxId, id); };
+    forEachLine(tid, [&](const char* b, const char* e) {
+      LineParser line{b, e};
+      if (!parseLine(line, emit, node)) {
+        if (skipped++ == 0)
+          threadFirstSkipped[tid] = lines;
+      }
+      ++lines;
+    });
+    threadEdges[tid + 1] = edges;
+    threadLines[tid + 1] = lines;
+    threadMaxId[tid]     = maxId;
+    threadSkipped[tid]   = skipped;
+  });
+  parseTimer.stop();
+
+  for (unsigned t = 0; t < numThreads; ++t) {
+    threadEdges[t + 1] += threadEdges[t];
+    threadLines[t + 1] += threadLines[t];
+  }
+  size_t numEdges = threadEdges[numThreads];
+  size_t maxId    = *std::max_element(threadMaxId.begin(), threadMaxId.end());
+  if (!numNodes)
+    numNodes = maxId + 1;
+  else if (maxId >= numNodes)
+    GALOIS_DIE("node id out of range: ", maxId);
+
+  for (unsigned t = 0; t < numThreads; ++t) {
+    if (threadSkipped[t]) {
+      galois::gWarn("ignored at least one line (line ",
+                    firstLine + threadLines[t] + threadFirstSkipped[t],
+                    ") because it did not match the expected format\n");
+      break;
     }
+  }
 
-    size_t dst;
-    if (!(iss >> dst)) {
-      continue;
-    }
+  double mb = (dataEnd - dataBegin) / 1e6;
+  std::cout << "Parsed " << mb << " MB with " << numThreads << " threads in "
+            << parseTimer.get_usec() / 1e6 << " s ("
+            << mb / std::max(parseTimer.get_usec() / 1e6, 1e-6)
+            << " MB/s per pass)\n";
 
-    edge_value_type data{};
-    if (EdgeData::has_value) {
-      if (hasDelim) {
-        if (!(iss >> readDelim) || readDelim != delim) {
-          continue;
-        }
-      }
+  auto ignoreNode = [](size_t) {};
 
-      if (!(iss >> data)) {
-        continue;
-      }
-    }
+  // pass 2: degrees
+  galois::LargeArray<uint64_t> cursor;
+  cursor.allocateInterleaved(numNodes);
+  galois::do_all(
+      galois::iterate(size_t{0}, numNodes), [&](size_t n) { cursor[n] = 0; },
+      galois::no_stats());
 
-    if (infile) {
-      p.incrementDegree(src);
-    }
-  }
+  galois::on_each([&](unsigned tid, unsigned) {
+    auto emit = [&](size_t src, size_t, edge_value_type) {
+      __sync_fetch_and_add(&cursor[src], 1);
+    };
+    forEachLine(tid, [&](const char* b, const char* e) {
+      LineParser line{b, e};
+      parseLine(line, emit, ignoreNode);
+    });
+  });
 
-  infile.clear();
-  infile.seekg(0, std::ios::beg);
+  Writer p;
+  p.setNumNodes(numNodes);
+  p.setNumEdges(numEdges);
+  p.setSizeofEdgeData(EdgeData::size_of::value);
+  p.phase1();
+  galois::do_all(
+      galois::iterate(size_t{0}, numNodes),
+      [&](size_t n) {
+        p.incrementDegree(n, cursor[n]);
+        cursor[n] = 0;
+      },
+      galois::no_stats());
   p.phase2();
 
-  if (skipFirstLine) {
-    skipLine(infile);
-  }
-
-  while (std::getline(infile, line)) {
-    std::stringstream iss(line);
-
-    size_t src;
-    if (!(iss >> src)) {
-      continue;
-    }
+  // pass 3: place edges; order records the position of each edge in the file
+  // so that edges placed concurrently can be put back in file order
+  galois::LargeArray<uint64_t> order;
+  galois::LargeArray<uint64_t> dsts;
+  EdgeData edgeData;
+  order.allocateInterleaved(numEdges);
+  dsts.allocateInterleaved(numEdges);
+  edgeData.allocateInterleaved(numEdges);
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    size_t pos = threadEdges[tid];
+    auto emit  = [&](size_t src, size_t dst, edge_value_type value) {
+      size_t idx = p.edgeBegin(src) + __sync_fetch_and_add(&cursor[src], 1);
+      order[idx] = pos++;
+      dsts[idx]  = dst;
+      if constexpr (EdgeData::has_value)
+        edgeData.set(idx, value);
+    };
+    forEachLine(tid, [&](const char* b, const char* e) {
+      LineParser line{b, e};
+      parseLine(line, emit, ignoreNode);
+    });
+  });
+
+  galois::do_all(
+      galois::iterate(size_t{0}, numNodes),
+      [&](size_t n) {
+        size_t b = p.edgeBegin(n);
+        size_t e = b + cursor[n];
+        if (!std::is_sorted(order.begin() + b, order.begin() + e)) {
+          std::vector<size_t> perm(e - b);
+          std::iota(perm.begin(), perm.end(), b);
+          std::sort(perm.begin(), perm.end(),
+                    [&](size_t x, size_t y) { return order[x] < order[y]; });
+          std::vector<uint64_t> tmpDsts(e - b);
+          for (size_t i = 0; i < perm.size(); ++i)
+            tmpDsts[i] = dsts[perm[i]];
+          if constexpr (EdgeData::has_value) {
+            std::vector<edge_value_type> tmpData(e - b);
+            for (size_t i = 0; i < perm.size(); ++i)
+              tmpData[i] = edgeData[perm[i]];
+            std::copy(tmpData.begin(), tmpData.end(), edgeData.begin() + b);
+          }
+          std::copy(tmpDsts.begin(), tmpDsts.end(), dsts.begin() + b);
+        }
+        for (size_t i = b; i < e; ++i)
+          p.setNeighbor(i, dsts[i]);
+      },
+      galois::steal(), galois::no_stats());
 
-    if (hasDelim) {
-      if (!(iss >> readDelim) || readDelim != delim) {
-        continue;
-      }
-    }
+  edge_value_type* rawEdgeData = p.finish<edge_value_type>();
+  if constexpr (EdgeData::has_value) {
+    galois::do_all(
+        galois::iterate(size_t{0}, numEdges),
+        [&](size_t e) { rawEdgeData[e] = edgeData[e]; }, galois::no_stats());
+  }
 
-    size_t dst;
-    if (!(iss >> dst)) {
-      continue;
-    }
+  p.toFile(outfilename);
+  return numEdges;
+}
 
-    edge_value_type data{};
-    if (EdgeData::has_value) {
-      if (hasDelim) {
-        if (!(iss >> readDelim) || readDelim != delim) {
-          continue;
-        }
-      }
+/**
+ * Common parsing for edgelist style text files.
+ *
+ * src dst [weight]
+ * ...
+ *
+ * If delim is set, this function expects that each entry is separated by delim
+ * surrounded by optional whitespace.
+ */
+template <typename EdgeTy>
+void convertEdgelist(const std::string& infilename,
+                     const std::string& outfilename, const bool skipFirstLine,
+                     std::optional<char> delim) {
+  typedef galois::LargeArray<EdgeTy> EdgeData;
+  typedef typename EdgeData::value_type edge_value_type;
 
-      if (!(iss >> data)) {
-        continue;
-      }
-    }
+  MappedFile file(infilename);
+  const char* dataBegin = file.begin();
+  size_t firstLine      = 0;
 
-    if (infile) {
-      edgeData.set(p.addNeighbor(src, dst), data);
-    }
+  if (skipFirstLine) {
+    galois::gWarn(
+        "first line is assumed to contain labels and will be ignored\n");
+    if (file.size() > 0)
+      dataBegin = nextLine(dataBegin + 1, file.begin(), file.end());
+    ++firstLine;
   }
 
-  edge_value_type* rawEdgeData = p.finish<edge_value_type>();
-  if (EdgeData::has_value)
-    std::uninitialized_copy(std::make_move_iterator(edgeData.begin()),
-                            std::make_move_iterator(edgeData.end()),
-                            rawEdgeData);
+  auto parseLine = [&](LineParser& line, auto& emit, auto&) {
+    size_t src, dst;
+    edge_value_type data{};
+    if (!line.parse(src))
+      return false;
+    if (delim && !line.expect(*delim))
+      return false;
+    if (!line.parse(dst))
+      return false;
+    if constexpr (EdgeData::has_value) {
+      if (delim && !line.expect(*delim))
+        return false;
+      if (!line.parse(data))
+        return false;
+    }
+    emit(src, dst, data);
+    return true;
+  };
 
-  p.toFile(outfilename);
+  size_t numNodes = 0;
+  size_t numEdges = convertText<EdgeTy>(file, dataBegin, numNodes, firstLine,
+                                        parseLine, outfilename);
   printStatus(numNodes, numEdges);
 }
 
@@ -640,103 +796,72 @@ struct Edgelist2Binary : public Conversion {
 struct Mtx2Gr : public HasNoVoidSpecialization {
   template <typename EdgeTy>
   void convert(const std::string& infilename, const std::string& outfilename) {
-    typedef galois::graphs::FileGraphWriter Writer;
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
 
-    Writer p;
-    EdgeData edgeData;
-    uint32_t nnodes;
-    size_t nedges;
-
-    for (int phase = 0; phase < 2; ++phase) {
-      std::ifstream infile(infilename.c_str());
-      if (!infile) {
-        GALOIS_DIE("failed to open input file");
-      }
-
-      // Skip comments
-      while (infile) {
-        if (infile.peek() != '%') {
-          break;
-        }
-        skipLine(infile);
-      }
-
-      // Read header
-      char header[256];
-      infile.getline(header, 256);
-      std::istringstream line(header, std::istringstream::in);
-      std::vector<std::string> tokens;
-      while (line) {
-        std::string tmp;
-        line >> tmp;
-        if (line) {
-          tokens.push_back(tmp);
-        }
-      }
-      if (tokens.size() != 3) {
-        GALOIS_DIE("unknown problem specification line: ", line.str());
-      }
-      // Prefer C functions for maximum compatibility
-      // nnodes = std::stoull(tokens[0]);
-      // nedges = std::stoull(tokens[2]);
-      nnodes = strtoull(tokens[0].c_str(), NULL, 0);
-      nedges = strtoull(tokens[2].c_str(), NULL, 0);
-
-      // Parse edges
-      if (phase == 0) {
-        p.setNumNodes(nnodes);
-        p.setNumEdges(nedges);
-        p.setSizeofEdgeData(EdgeData::size_of::value);
-        edgeData.create(nedges);
-        p.phase1();
-      } else {
-        p.phase2();
-      }
-
-      for (size_t edge_num = 0; edge_num < nedges; ++edge_num) {
-        if ((edge_num % (nedges / 500)) == 0) {
-          printf("Phase %d: current edge progress %lf%%\n", phase,
-                 ((double)edge_num / nedges) * 100);
-        }
-        uint32_t cur_id, neighbor_id;
-        double weight = 1;
-
-        infile >> cur_id >> neighbor_id >> weight;
-        if (cur_id == 0 || cur_id > nnodes) {
-          GALOIS_DIE("node id out of range: ", cur_id);
-        }
-        if (neighbor_id == 0 || neighbor_id > nnodes) {
-          GALOIS_DIE("neighbor id out of range: ", neighbor_id);
-        }
-
-        // 1 indexed
-        if (phase == 0) {
-          p.incrementDegree(cur_id - 1);
-        } else {
-          edgeData.set(p.addNeighbor(cur_id - 1, neighbor_id - 1),
-                       static_cast<edge_value_type>(weight));
-        }
-
-        skipLine(infile);
-      }
+    MappedFile file(infilename);
+    const char* dataBegin = file.begin();
+    size_t firstLine      = 0;
+
+    // Skip comments
+    while (dataBegin != file.end() && *dataBegin == '%') {
+      dataBegin = nextLine(dataBegin + 1, file.begin(), file.end());
+      ++firstLine;
+    }
+
+    // Read header
+    const char* headerEnd = nextLine(
+        dataBegin == file.end() ? dataBegin : dataBegin + 1, file.begin(),
+        file.end());
+    std::istringstream line(std::string(dataBegin, headerEnd),
+                            std::istringstream::in);
+    std::vector<std::string> tokens;
+    while (line) {
+      std::string tmp;
+      line >> tmp;
+      if (line) {
+        tokens.push_back(tmp);
+      }
+    }
+    if (tokens.size() != 3) {
+      GALOIS_DIE("unknown problem specification line: ", line.str());
+    }
+    // Prefer C functions for maximum compatibility
+    // nnodes = std::stoull(tokens[0]);
+    // nedges = std::stoull(tokens[2]);
+    size_t nnodes = strtoull(tokens[0].c_str(), NULL, 0);
+    size_t nedges = strtoull(tokens[2].c_str(), NULL, 0);
+    dataBegin     = headerEnd;
+    ++firstLine;
+
+    // 1 indexed; blank and comment lines are ignored
+    auto parseLine = [&](LineParser& line, auto& emit, auto&) {
+      if (line.atEnd() || *line.p == '%')
+        return true;
+      size_t cur_id, neighbor_id;
+      double weight = 1;
+      if (!line.parse(cur_id) || !line.parse(neighbor_id))
+        GALOIS_DIE("malformed edge: ", std::string(line.p, line.end));
+      line.parse(weight);
+      if (cur_id == 0 || cur_id > nnodes) {
+        GALOIS_DIE("node id out of range: ", cur_id);
+      }
+      if (neighbor_id == 0 || neighbor_id > nnodes) {
+        GALOIS_DIE("neighbor id out of range: ", neighbor_id);
+      }
+      emit(cur_id - 1, neighbor_id - 1, static_cast<edge_value_type>(weight));
+      return true;
+    };
 
-      infile.peek();
-      if (!infile.eof()) {
-        GALOIS_DIE("additional lines in file");
-      }
+    size_t numNodes = nnodes;
+    size_t numEdges = convertText<EdgeTy>(file, dataBegin, numNodes, firstLine,
+                                          parseLine, outfilename);
+    if (numEdges > nedges) {
+      GALOIS_DIE("additional lines in file");
+    } else if (numEdges < nedges) {
+      GALOIS_DIE("expected ", nedges, " edges but found ", numEdges);
     }
-    // this is for the progress print
-
-    edge_value_type* rawEdgeData = p.finish<edge_value_type>();
-    if (EdgeData::has_value)
-      std::uninitialized_copy(std::make_move_iterator(edgeData.begin()),
-                              std::make_move_iterator(edgeData.end()),
-                              rawEdgeData);
-
-    p.toFile(outfilename);
-    printStatus(p.size(), p.sizeEdges());
+    printStatus(numNodes, numEdges);
   }
 };
 
@@ -769,79 +894,45 @@ struct Gr2Mtx : public HasNoVoidSpecialization {
 };
 
 /**
- * List of node adjacencies:
+ * List of node adjacencies, one line per node:
  *
  * <node id> <num neighbors> <neighbor id>*
  * ...
+ *
+ * The neighbors of a node must be on the same line as the node. Lines with
+ * fewer neighbors than announced are ignored.
  */
 struct Nodelist2Gr : public HasOnlyVoidSpecialization {
   template <typename EdgeTy>
   void convert(const std::string& infilename, const std::string& outfilename) {
     static_assert(std::is_same<EdgeTy, void>::value,
                   "conversion undefined for non-void graphs");
-    typedef galois::graphs::FileGraphWriter Writer;
-
-    Writer p;
-    std::ifstream infile(infilename.c_str());
-
-    size_t numNodes = 0;
-    size_t numEdges = 0;
-
-    while (infile) {
-      size_t src;
-      size_t numNeighbors;
 
-      infile >> src >> numNeighbors;
+    MappedFile file(infilename);
 
-      if (infile) {
-        if (src > numNodes)
-          numNodes = src;
-        numEdges += numNeighbors;
-      }
-      skipLine(infile);
-    }
-
-    numNodes++;
-    p.setNumNodes(numNodes);
-    p.setNumEdges(numEdges);
-
-    infile.clear();
-    infile.seekg(0, std::ios::beg);
-    p.phase1();
-    while (infile) {
-      size_t src;
-      size_t numNeighbors;
-
-      infile >> src >> numNeighbors;
-
-      if (infile) {
-        p.incrementDegree(src, numNeighbors);
-      }
-      skipLine(infile);
-    }
-
-    infile.clear();
-    infile.seekg(0, std::ios::beg);
-    p.phase2();
-    while (infile) {
+    auto parseLine = [&](LineParser& line, auto& emit, auto& node) {
       size_t src;
       size_t numNeighbors;
+      if (!line.parse(src) || !line.parse(numNeighbors))
+        return false;
+      // check the whole line before emitting any of its edges
+      LineParser neighbors = line;
+      size_t dst;
+      for (size_t i = 0; i < numNeighbors; ++i) {
+        if (!line.parse(dst))
+          return false;
+      }
+      node(src);
+      for (; numNeighbors > 0; --numNeighbors) {
+        neighbors.parse(dst);
+        emit(src, dst, nullptr);
+      }
+      return true;
+    };
 
-      infile >> src >> numNeighbors;
-
-      for (; infile && numNeighbors > 0; --numNeighbors) {
-        size_t dst;
-        infile >> dst;
-        if (infile)
-          p.addNeighbor(src, dst);
-      }
-
-      skipLine(infile);
-    }
-
-    p.finish<void>();
-
-    p.toFile(outfilename);
+    size_t numNodes = 0;
+    size_t numEdges = convertText<void>(file, file.begin(), numNodes, 0,
+                                        parseLine, outfilename);
     printStatus(numNodes, numEdges);
   }
 };
@@ -2995,6 +3086,9 @@ int main(int argc, char** argv) {
   galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
   std::ios_base::sync_with_stdio(false);
+  galois::setActiveThreads(
+      numThreads ? numThreads
+                 : galois::substrate::getThreadPool().getMaxUsableThreads());
   switch (convertMode) {
   case bipartitegr2bigpetsc:
     convert<Bipartitegr2Petsc<double, false>>();
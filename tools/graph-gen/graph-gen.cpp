@@ -0,0 +1,591 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting
+ * parallelism. The code is being released under the terms of the 3-Clause BSD
+ * License (a copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * Generates synthetic graphs in parallel and writes them as binary gr files.
+ *
+ * Edges are generated in fixed-size blocks, each with its own random stream
+ * derived from the seed, so the output depends only on the options and not
+ * on the number of threads.
+ */
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/Timer.h"
+#include "galois/substrate/ThreadPool.h"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace cll = llvm::cl;
+
+enum class GeneratorKind { rmat, kronecker, random, grid2d, grid3d, powerlaw };
+
+static cll::opt<std::string>
+    outputFilename(cll::Positional, cll::desc("<output file>"), cll::Required);
+static cll::opt<GeneratorKind> generator(
+    "gen", cll::desc("Graph generator:"),
+    cll::values(
+        clEnumValN(GeneratorKind::rmat, "rmat",
+                   "R-MAT with probabilities a, b, c (default)"),
+        clEnumValN(GeneratorKind::kronecker, "kronecker",
+                   "Graph500 Kronecker: R-MAT with Graph500 probabilities and "
+                   "scrambled node ids"),
+        clEnumValN(GeneratorKind::random, "random",
+                   "Uniform random (Erdos-Renyi G(n, m))"),
+        clEnumValN(GeneratorKind::grid2d, "grid2d",
+                   "2D grid with 4-neighbor connectivity"),
+        clEnumValN(GeneratorKind::grid3d, "grid3d",
+                   "3D grid with 6-neighbor connectivity"),
+        clEnumValN(GeneratorKind::powerlaw, "powerlaw",
+                   "Chung-Lu graph with power-law expected degrees")),
+    cll::init(GeneratorKind::rmat));
+static cll::opt<unsigned>
+    scale("scale",
+          cll::desc("log2 of the number of nodes for rmat and kronecker "
+                    "(default value 16)"),
+          cll::init(16));
+static cll::opt<uint64_t>
+    numNodes("numNodes",
+             cll::desc("Number of nodes for random and powerlaw (default value "
+                       "65536)"),
+             cll::init(1 << 16));
+static cll::opt<double>
+    edgeFactor("edgeFactor",
+               cll::desc("Generated edges per node for rmat, kronecker, random "
+                         "and powerlaw (default value 16)"),
+               cll::init(16));
+static cll::opt<double> probA("a", cll::desc("R-MAT probability a"),
+                              cll::init(0.57));
+static cll::opt<double> probB("b", cll::desc("R-MAT probability b"),
+                              cll::init(0.19));
+static cll::opt<double> probC("c", cll::desc("R-MAT probability c"),
+                              cll::init(0.19));
+static cll::opt<double>
+    exponent("alpha", cll::desc("Power-law degree exponent (default value 2.1)"),
+             cll::init(2.1));
+static cll::opt<uint64_t> width("width", cll::desc("Grid width"),
+                                cll::init(256));
+static cll::opt<uint64_t> height("height", cll::desc("Grid height"),
+                                 cll::init(256));
+static cll::opt<uint64_t> depth("depth", cll::desc("Grid depth (grid3d)"),
+                                cll::init(16));
+static cll::opt<uint64_t> seed("seed", cll::desc("Random seed"), cll::init(0));
+static cll::opt<uint32_t>
+    maxWeight("maxWeight",
+              cll::desc("Add uint32 edge weights uniform in [1, maxWeight]; 0 "
+                        "writes a graph without edge data (default value 0)"),
+              cll::init(0));
+static cll::opt<bool>
+    symmetric("symmetric",
+              cll::desc("Add the reverse of every edge (default value false)"),
+              cll::init(false));
+static cll::opt<bool> dedup("dedup",
+                            cll::desc("Remove duplicate edges, keeping the "
+                                      "smallest weight (default value false)"),
+                            cll::init(false));
+static cll::opt<bool>
+    selfLoops("selfLoops", cll::desc("Keep self loops (default value false)"),
+              cll::init(false));
+static cll::opt<unsigned>
+    numThreads("t",
+               cll::desc("Number of threads (default value 0: all available "
+                         "threads)"),
+               cll::init(0));
+
+//! Number of generated edges sharing one random stream
+static constexpr uint64_t BLOCK_SIZE = 1 << 16;
+
+struct EdgeList {
+  galois::LargeArray<uint64_t> src;
+  galois::LargeArray<uint64_t> dst;
+  galois::LargeArray<uint32_t> weight;
+  uint64_t size = 0;
+
+  void allocate(uint64_t n) {
+    size = n;
+    src.allocateInterleaved(n);
+    dst.allocateInterleaved(n);
+    if (maxWeight)
+      weight.allocateInterleaved(n);
+  }
+};
+
+//! splitmix64 finalizer; derives independent stream seeds
+static uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * Calls f(i, gen) for each of n items in parallel, with gen the random stream
+ * of the block that contains i.
+ */
+template <typename F>
+void forEachGenerated(uint64_t n, uint64_t stream, F f) {
+  uint64_t numBlocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  galois::do_all(
+      galois::iterate(uint64_t{0}, numBlocks),
+      [&](uint64_t block) {
+        std::mt19937_64 gen(mix(seed ^ mix(stream * numBlocks + block)));
+        uint64_t end = std::min(n, (block + 1) * BLOCK_SIZE);
+        for (uint64_t i = block * BLOCK_SIZE; i < end; ++i)
+          f(i, gen);
+      },
+      galois::steal(), galois::chunk_size<1>(), galois::no_stats());
+}
+
+//! Draws the weights of all edges from their own streams
+void generateWeights(EdgeList& edges) {
+  if (!maxWeight)
+    return;
+  forEachGenerated(edges.size, 1, [&](uint64_t i, std::mt19937_64& gen) {
+    edges.weight[i] = std::uniform_int_distribution<uint32_t>(1, maxWeight)(gen);
+  });
+}
+
+/**
+ * Exclusive prefix sum of a[0, n) in place; returns the total.
+ */
+template <typename A>
+uint64_t prefixSum(A& a, uint64_t n) {
+  unsigned nthreads = galois::getActiveThreads();
+  std::vector<uint64_t> blockSums(nthreads + 1, 0);
+  galois::on_each([&](unsigned tid, unsigned total) {
+    auto r     = galois::block_range(uint64_t{0}, n, tid, total);
+    uint64_t s = 0;
+    for (uint64_t i = r.first; i < r.second; ++i)
+      s += a[i];
+    blockSums[tid + 1] = s;
+  });
+  for (unsigned t = 0; t < nthreads; ++t)
+    blockSums[t + 1] += blockSums[t];
+  galois::on_each([&](unsigned tid, unsigned total) {
+    auto r     = galois::block_range(uint64_t{0}, n, tid, total);
+    uint64_t s = blockSums[tid];
+    for (uint64_t i = r.first; i < r.second; ++i) {
+      uint64_t v = a[i];
+      a[i]       = s;
+      s += v;
+    }
+  });
+  return blockSums[nthreads];
+}
+
+/**
+ * R-MAT: each edge picks one of four quadrants of the adjacency matrix per
+ * bit of the node ids with probabilities a, b, c and 1 - a - b - c.
+ */
+void generateRmat(EdgeList& edges, uint64_t n, double a, double b, double c,
+                  bool scramble) {
+  if (a < 0 || b < 0 || c < 0 || a + b + c > 1)
+    GALOIS_DIE("R-MAT probabilities must be non-negative and sum to at most 1");
+  edges.allocate(static_cast<uint64_t>(edgeFactor * n));
+
+  // scrambling is a bijection on [0, 2^scale): multiplication by an odd
+  // constant and xor-shifts, both invertible modulo 2^scale
+  uint64_t mask = n - 1;
+  uint64_t mul1 = mix(seed + 1) | 1;
+  uint64_t mul2 = mix(seed + 2) | 1;
+  unsigned half = std::max(1u, static_cast<unsigned>(scale) / 2);
+  auto permute  = [&](uint64_t v) {
+    v = (v * mul1) & mask;
+    v ^= v >> half;
+    v = (v * mul2) & mask;
+    v ^= v >> half;
+    return v;
+  };
+
+  // quadrant choices compare 32-bit random numbers against fixed-point
+  // thresholds, two levels per draw from the 64-bit generator
+  auto threshold = [](double p) {
+    return static_cast<uint64_t>(std::min(std::ldexp(p, 32), 4294967296.0));
+  };
+  uint64_t ta   = threshold(a);
+  uint64_t tab  = threshold(a + b);
+  uint64_t tabc = threshold(a + b + c);
+  forEachGenerated(edges.size, 0, [&](uint64_t i, std::mt19937_64& gen) {
+    uint64_t src = 0, dst = 0;
+    uint64_t bits = 0;
+    for (unsigned level = 0; level < scale; ++level) {
+      if (level % 2 == 0)
+        bits = gen();
+      uint64_t r = bits & 0xffffffff;
+      bits >>= 32;
+      src <<= 1;
+      dst <<= 1;
+      if (r < ta) {
+      } else if (r < tab) {
+        dst |= 1;
+      } else if (r < tabc) {
+        src |= 1;
+      } else {
+        src |= 1;
+        dst |= 1;
+      }
+    }
+    edges.src[i] = scramble ? permute(src) : src;
+    edges.dst[i] = scramble ? permute(dst) : dst;
+  });
+}
+
+//! Uniform random endpoints
+void generateRandom(EdgeList& edges, uint64_t n) {
+  edges.allocate(static_cast<uint64_t>(edgeFactor * n));
+  forEachGenerated(edges.size, 0, [&](uint64_t i, std::mt19937_64& gen) {
+    std::uniform_int_distribution<uint64_t> node(0, n - 1);
+    edges.src[i] = node(gen);
+    edges.dst[i] = node(gen);
+  });
+}
+
+/**
+ * Chung-Lu: both endpoints of an edge are drawn with probability
+ * proportional to the node weight (i + 1)^(-1 / (alpha - 1)), which gives a
+ * power-law degree distribution with exponent alpha.
+ */
+void generatePowerlaw(EdgeList& edges, uint64_t n) {
+  if (exponent <= 1)
+    GALOIS_DIE("power-law exponent must be greater than 1");
+  edges.allocate(static_cast<uint64_t>(edgeFactor * n));
+
+  // cumulative weights; prefix sums are done in fixed point to reuse
+  // prefixSum, with the heaviest node scaled to 2^32
+  galois::LargeArray<uint64_t> cdf;
+  cdf.allocateInterleaved(n + 1);
+  double power = -1.0 / (exponent - 1);
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n),
+      [&](uint64_t i) {
+        cdf[i] = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ldexp(std::pow(i + 1.0, power), 32)));
+      },
+      galois::no_stats());
+  cdf[n]         = 0;
+  uint64_t total = prefixSum(cdf, n + 1);
+
+  forEachGenerated(edges.size, 0, [&](uint64_t i, std::mt19937_64& gen) {
+    std::uniform_int_distribution<uint64_t> point(0, total - 1);
+    auto draw = [&]() {
+      // last node whose cumulative weight starts at or before the point
+      return std::upper_bound(cdf.begin(), cdf.begin() + n, point(gen)) -
+             cdf.begin() - 1;
+    };
+    edges.src[i] = draw();
+    edges.dst[i] = draw();
+  });
+}
+
+/**
+ * Grid with edges to the neighbors along each axis, in both directions.
+ */
+void generateGrid(EdgeList& edges, uint64_t w, uint64_t h, uint64_t d) {
+  uint64_t n = w * h * d;
+  galois::LargeArray<uint64_t> offsets;
+  offsets.allocateInterleaved(n);
+
+  auto forEachNeighbor = [&](uint64_t v, auto f) {
+    uint64_t x = v % w;
+    uint64_t y = (v / w) % h;
+    uint64_t z = v / (w * h);
+    if (x > 0)
+      f(v - 1);
+    if (x + 1 < w)
+      f(v + 1);
+    if (y > 0)
+      f(v - w);
+    if (y + 1 < h)
+      f(v + w);
+    if (z > 0)
+      f(v - w * h);
+    if (z + 1 < d)
+      f(v + w * h);
+  };
+
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n),
+      [&](uint64_t v) {
+        uint64_t degree = 0;
+        forEachNeighbor(v, [&](uint64_t) { ++degree; });
+        offsets[v] = degree;
+      },
+      galois::no_stats());
+  edges.allocate(prefixSum(offsets, n));
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n),
+      [&](uint64_t v) {
+        uint64_t e = offsets[v];
+        forEachNeighbor(v, [&](uint64_t u) {
+          edges.src[e] = v;
+          edges.dst[e] = u;
+          ++e;
+        });
+      },
+      galois::no_stats());
+}
+
+//! Appends the reverse of every edge; the reverse keeps the weight
+void symmetrize(EdgeList& edges) {
+  EdgeList both;
+  both.allocate(2 * edges.size);
+  uint64_t m = edges.size;
+  galois::do_all(
+      galois::iterate(uint64_t{0}, m),
+      [&](uint64_t i) {
+        both.src[i]     = edges.src[i];
+        both.dst[i]     = edges.dst[i];
+        both.src[m + i] = edges.dst[i];
+        both.dst[m + i] = edges.src[i];
+        if (maxWeight) {
+          both.weight[i]     = edges.weight[i];
+          both.weight[m + i] = edges.weight[i];
+        }
+      },
+      galois::no_stats());
+  std::swap(edges, both);
+}
+
+struct Neighbor {
+  uint64_t dst;
+  uint32_t weight;
+
+  bool operator<(const Neighbor& o) const {
+    return dst < o.dst || (dst == o.dst && weight < o.weight);
+  }
+  bool operator==(const Neighbor& o) const { return dst == o.dst; }
+};
+
+/**
+ * Memory-mapped output gr file; sections are filled in place in parallel.
+ */
+class GrFile {
+  int fd;
+  char* base;
+  size_t length;
+
+public:
+  uint64_t* outIdx;
+  char* outs;
+  char* edgeData;
+  bool wide;
+
+  GrFile(const std::string& filename, uint64_t nodes, uint64_t edges,
+         uint64_t sizeofEdgeData) {
+    wide             = nodes > std::numeric_limits<uint32_t>::max();
+    size_t sizeofDst = wide ? sizeof(uint64_t) : sizeof(uint32_t);
+    size_t outsBytes = sizeofDst * edges;
+    if (!wide && edges % 2)
+      outsBytes += sizeof(uint32_t); // padding
+    length = sizeof(uint64_t) * (4 + nodes) + outsBytes + sizeofEdgeData * edges;
+
+    mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+    fd          = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, mode);
+    if (fd == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+    if (ftruncate(fd, length) == -1)
+      GALOIS_SYS_DIE("failed resizing ", "'", filename, "'");
+    void* m = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED)
+      GALOIS_SYS_DIE("failed mapping ", "'", filename, "'");
+    base = static_cast<char*>(m);
+
+    uint64_t* header = reinterpret_cast<uint64_t*>(base);
+    header[0]        = wide ? 2 : 1;
+    header[1]        = sizeofEdgeData;
+    header[2]        = nodes;
+    header[3]        = edges;
+    outIdx           = header + 4;
+    outs             = reinterpret_cast<char*>(outIdx + nodes);
+    edgeData         = outs + outsBytes;
+    if (!wide && edges % 2)
+      std::memset(outs + sizeofDst * edges, 0, sizeof(uint32_t));
+  }
+
+  GrFile(const GrFile&) = delete;
+  GrFile& operator=(const GrFile&) = delete;
+
+  ~GrFile() {
+    munmap(base, length);
+    close(fd);
+  }
+
+  size_t size() const { return length; }
+
+  void setNeighbor(uint64_t e, uint64_t dst) {
+    if (wide)
+      reinterpret_cast<uint64_t*>(outs)[e] = dst;
+    else
+      reinterpret_cast<uint32_t*>(outs)[e] = dst;
+  }
+};
+
+/**
+ * Sorts edges by source with a parallel counting sort, sorts each adjacency
+ * list, drops self loops and duplicates as requested and writes the gr.
+ */
+void writeGraph(EdgeList& edges, uint64_t n) {
+  galois::LargeArray<uint64_t> offsets;
+  offsets.allocateInterleaved(n + 1);
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n + 1), [&](uint64_t v) { offsets[v] = 0; },
+      galois::no_stats());
+
+  auto keep = [&](uint64_t i) {
+    return selfLoops || edges.src[i] != edges.dst[i];
+  };
+
+  galois::do_all(
+      galois::iterate(uint64_t{0}, edges.size),
+      [&](uint64_t i) {
+        if (keep(i))
+          __sync_fetch_and_add(&offsets[edges.src[i]], 1);
+      },
+      galois::no_stats());
+  uint64_t m = prefixSum(offsets, n + 1);
+
+  galois::LargeArray<uint64_t> cursor;
+  cursor.allocateInterleaved(n);
+  galois::LargeArray<Neighbor> adj;
+  adj.allocateInterleaved(m);
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n), [&](uint64_t v) { cursor[v] = 0; },
+      galois::no_stats());
+  galois::do_all(
+      galois::iterate(uint64_t{0}, edges.size),
+      [&](uint64_t i) {
+        if (!keep(i))
+          return;
+        uint64_t v = edges.src[i];
+        uint64_t e = offsets[v] + __sync_fetch_and_add(&cursor[v], 1);
+        adj[e]     = Neighbor{edges.dst[i], maxWeight ? edges.weight[i] : 0};
+      },
+      galois::no_stats());
+
+  // sorting makes the output independent of the placement order above
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n),
+      [&](uint64_t v) {
+        auto b = adj.begin() + offsets[v];
+        auto e = adj.begin() + offsets[v + 1];
+        std::sort(b, e);
+        cursor[v] = dedup ? std::unique(b, e) - b : e - b;
+      },
+      galois::steal(), galois::no_stats());
+
+  uint64_t finalEdges = prefixSum(cursor, n);
+  size_t sizeofEdge   = maxWeight ? sizeof(uint32_t) : 0;
+
+  galois::Timer writeTimer;
+  writeTimer.start();
+  GrFile out(outputFilename, n, finalEdges, sizeofEdge);
+  galois::do_all(
+      galois::iterate(uint64_t{0}, n),
+      [&](uint64_t v) {
+        uint64_t base   = cursor[v];
+        uint64_t degree = (v + 1 < n ? cursor[v + 1] : finalEdges) - base;
+        out.outIdx[v]   = base + degree;
+        for (uint64_t i = 0; i < degree; ++i) {
+          const Neighbor& nb = adj[offsets[v] + i];
+          out.setNeighbor(base + i, nb.dst);
+          if (maxWeight)
+            reinterpret_cast<uint32_t*>(out.edgeData)[base + i] = nb.weight;
+        }
+      },
+      galois::steal(), galois::no_stats());
+  writeTimer.stop();
+
+  double seconds = std::max(writeTimer.get_usec() / 1e6, 1e-6);
+  std::cout << "Wrote " << out.size() / 1e6 << " MB in " << seconds << " s ("
+            << out.size() / 1e9 / seconds << " GB/s)\n";
+  std::cout << "Graph: |V| = " << n << ", |E| = " << finalEdges << "\n";
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+  galois::setActiveThreads(
+      numThreads ? numThreads
+                 : galois::substrate::getThreadPool().getMaxUsableThreads());
+
+  if ((generator == GeneratorKind::rmat ||
+       generator == GeneratorKind::kronecker) &&
+      (scale == 0 || scale > 40)) {
+    GALOIS_DIE("scale must be between 1 and 40");
+  }
+
+  EdgeList edges;
+  uint64_t n = 0;
+
+  galois::Timer genTimer;
+  genTimer.start();
+  switch (generator) {
+  case GeneratorKind::rmat:
+    n = uint64_t{1} << scale;
+    generateRmat(edges, n, probA, probB, probC, false);
+    break;
+  case GeneratorKind::kronecker:
+    n = uint64_t{1} << scale;
+    generateRmat(edges, n, 0.57, 0.19, 0.19, true);
+    break;
+  case GeneratorKind::random:
+    n = numNodes;
+    generateRandom(edges, n);
+    break;
+  case GeneratorKind::powerlaw:
+    n = numNodes;
+    generatePowerlaw(edges, n);
+    break;
+  case GeneratorKind::grid2d:
+    n = width * height;
+    generateGrid(edges, width, height, 1);
+    break;
+  case GeneratorKind::grid3d:
+    n = width * height * depth;
+    generateGrid(edges, width, height, depth);
+    break;
+  default:
+    abort();
+  }
+  if (n == 0)
+    GALOIS_DIE("graph must have at least one node");
+  generateWeights(edges);
+  if (symmetric)
+    symmetrize(edges);
+  genTimer.stop();
+  std::cout << "Generated " << edges.size << " edges in "
+            << genTimer.get_usec() / 1e6 << " s\n";
+
+  writeGraph(edges, n);
+  return 0;
+}